@@ -0,0 +1,402 @@
+#!/usr/bin/env python3
+"""Build the shared icon pack that apps can draw their icons from.
+
+An app's assets folder is built into its .fap, so icons that several apps draw are carried by
+each of them.  The pack keeps one copy of each image on the SD card instead, in 1 bit per pixel
+XBM rows (the layout canvas_draw_xbm() takes), heatshrink compressed, and stored once per
+distinct frame no matter how many names or animations use it.  Apps read it through
+common/asset_pack.c:
+
+    python3 asset_pack.py build images -o icons.pack
+    python3 asset_pack.py list icons.pack
+
+A PNG becomes an icon named after the file.  A folder holding frame_0.png, frame_1.png, ... and
+an optional frame_rate file becomes an animated icon named after the folder, the same layout
+the firmware uses for its own animated icons.  Dark, opaque pixels are set.  Only the Python
+standard library is used.
+
+Pack layout, little endian:
+    header   16 bytes  magic "APAK", version, window bits, lookahead bits, 0,
+                       icon count u16, frame count u16, blob count u16, 0 u16
+    icons    12 bytes  name hash u32 (FNV-1a), width, height, frames, frame rate,
+                       first frame u16, 0 u16 -- sorted by name hash
+    frames    2 bytes  blob index u16
+    blobs    16 bytes  first 8 bytes of the SHA-256 of the bitmap, offset u32,
+                       packed size u16, size u16 -- packed size == size means stored as is
+    data               the blobs
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"APAK"
+VERSION = 1
+WINDOW_BITS = 8
+LOOKAHEAD_BITS = 4
+HEADER = struct.Struct("<4sBBBBHHHH")
+ICON = struct.Struct("<IBBBBHH")
+FRAME = struct.Struct("<H")
+BLOB = struct.Struct("<8sIHH")
+MAX_SIZE = 255  # Width and height are stored in one byte
+
+
+class PackError(Exception):
+    pass
+
+
+def name_hash(name):
+    """FNV-1a, the same as asset_pack_hash() in common/asset_pack.c."""
+    value = 0x811C9DC5
+    for byte in name.encode():
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def read_png(path):
+    """Return (width, height, rows) with rows[y][x] True for a set pixel."""
+    with open(path, "rb") as file:
+        data = file.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise PackError(f"{path}: not a PNG")
+
+    position = 8
+    idat = b""
+    palette = []
+    transparency = b""
+    while position < len(data):
+        length, kind = struct.unpack(">I4s", data[position : position + 8])
+        body = data[position + 8 : position + 8 + length]
+        position += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i : i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            transparency = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    if interlace:
+        raise PackError(f"{path}: interlaced PNGs are not supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color)
+    if channels is None or depth not in (1, 2, 4, 8, 16) or (depth < 8 and channels != 1):
+        raise PackError(f"{path}: unsupported PNG format")
+
+    raw = zlib.decompress(idat)
+    stride = (width * channels * depth + 7) // 8
+    step = max(1, channels * depth // 8)
+    previous = bytearray(stride)
+    rows = []
+    offset = 0
+    for _ in range(height):
+        kind = raw[offset]
+        line = bytearray(raw[offset + 1 : offset + 1 + stride])
+        offset += 1 + stride
+        for i in range(stride):
+            left = line[i - step] if i >= step else 0
+            up = previous[i]
+            corner = previous[i - step] if i >= step else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (left + up) // 2) & 0xFF
+            elif kind == 4:
+                estimate = left + up - corner
+                pa, pb, pc = abs(estimate - left), abs(estimate - up), abs(estimate - corner)
+                nearest = left if pa <= pb and pa <= pc else up if pb <= pc else corner
+                line[i] = (line[i] + nearest) & 0xFF
+        previous = line
+        rows.append(
+            [pixel_set(line, x, depth, color, palette, transparency) for x in range(width)]
+        )
+    return width, height, rows
+
+
+def pixel_set(line, x, depth, color, palette, transparency):
+    if depth < 8:
+        per_byte = 8 // depth
+        shift = 8 - depth * (x % per_byte + 1)
+        value = (line[x // per_byte] >> shift) & ((1 << depth) - 1)
+        samples = [value]
+        top = (1 << depth) - 1
+    else:
+        size = depth // 8
+        channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+        start = x * channels * size
+        samples = [line[start + c * size] for c in range(channels)]  # High byte is enough
+        top = 255
+
+    alpha = 255
+    if color == 3:
+        index = samples[0]
+        r, g, b = palette[index]
+        if index < len(transparency):
+            alpha = transparency[index]
+    elif color in (0, 4):
+        r = g = b = samples[0] * 255 // top
+        if color == 4:
+            alpha = samples[1]
+    else:
+        r, g, b = samples[:3]
+        if color == 6:
+            alpha = samples[3]
+    return alpha >= 128 and (r * 299 + g * 587 + b * 114) // 1000 < 128
+
+
+def to_xbm(width, height, rows):
+    """Rows padded to whole bytes, lowest bit first."""
+    out = bytearray()
+    for row in rows:
+        for start in range(0, width, 8):
+            byte = 0
+            for bit, pixel in enumerate(row[start : start + 8]):
+                if pixel:
+                    byte |= 1 << bit
+            out.append(byte)
+    return bytes(out)
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.current = 0
+        self.count = 0
+
+    def write(self, value, bits):
+        for shift in range(bits - 1, -1, -1):
+            self.current = (self.current << 1) | ((value >> shift) & 1)
+            self.count += 1
+            if self.count == 8:
+                self.out.append(self.current)
+                self.current = 0
+                self.count = 0
+
+    def finish(self):
+        if self.count:
+            self.out.append(self.current << (8 - self.count))
+        return bytes(self.out)
+
+
+def heatshrink(data, window_bits=WINDOW_BITS, lookahead_bits=LOOKAHEAD_BITS):
+    """Heatshrink's bit stream: 1 + 8 bit literal, or 0 + (distance - 1) + (length - 1)."""
+    window = 1 << window_bits
+    longest = 1 << lookahead_bits
+    # A back reference only pays off once it replaces more bits than it costs.
+    shortest = (1 + window_bits + lookahead_bits) // 9 + 1
+    writer = BitWriter()
+    chains = {}  # Every earlier position, by the two bytes starting there
+    indexed = 0
+    position = 0
+    while position < len(data):
+        while indexed < position:
+            chains.setdefault(data[indexed : indexed + 2], []).append(indexed)
+            indexed += 1
+        # Nearest candidates first, so ties go to the shortest distance.
+        best_length, best_distance = 0, 0
+        for start in reversed(chains.get(data[position : position + 2], ())):
+            distance = position - start
+            if distance > window:
+                break
+            length = 0
+            while (
+                length < longest
+                and position + length < len(data)
+                and data[position + length - distance] == data[position + length]
+            ):
+                length += 1
+            if length > best_length:
+                best_length, best_distance = length, distance
+                if length == longest:
+                    break
+        if best_length >= shortest:
+            writer.write(0, 1)
+            writer.write(best_distance - 1, window_bits)
+            writer.write(best_length - 1, lookahead_bits)
+            position += best_length
+        else:
+            writer.write(1, 1)
+            writer.write(data[position], 8)
+            position += 1
+    return writer.finish()
+
+
+def unheatshrink(packed, size, window_bits=WINDOW_BITS, lookahead_bits=LOOKAHEAD_BITS):
+    """Python copy of heatshrink_decode() in common/heatshrink.c."""
+    bits = "".join(f"{byte:08b}" for byte in packed)
+    position = 0
+    out = bytearray()
+
+    def take(count):
+        nonlocal position
+        if position + count > len(bits):
+            raise PackError("truncated blob")
+        value = int(bits[position : position + count], 2)
+        position += count
+        return value
+
+    while len(out) < size:
+        if take(1):
+            out.append(take(8))
+        else:
+            distance = take(window_bits) + 1
+            length = take(lookahead_bits) + 1
+            if distance > len(out):
+                raise PackError("back reference before the start")
+            for _ in range(min(length, size - len(out))):
+                out.append(out[-distance])
+    return bytes(out)
+
+
+def collect(directory):
+    """Return [(name, width, height, frame_rate, [bitmap, ...])] for every icon in directory."""
+    icons = []
+    for entry in sorted(os.listdir(directory)):
+        path = os.path.join(directory, entry)
+        if os.path.isdir(path):
+            names = [n for n in os.listdir(path) if n.startswith("frame_") and n.endswith(".png")]
+            names.sort(key=lambda n: int(n[len("frame_") : -len(".png")]))
+            if not names:
+                continue
+            frames = [read_png(os.path.join(path, n)) for n in names]
+            if len({(w, h) for w, h, _ in frames}) != 1:
+                raise PackError(f"{entry}: frames differ in size")
+            rate_path = os.path.join(path, "frame_rate")
+            rate = int(open(rate_path).read().strip()) if os.path.exists(rate_path) else 1
+            name = entry
+        elif entry.endswith(".png"):
+            frames = [read_png(path)]
+            rate = 0
+            name = entry[: -len(".png")]
+        else:
+            continue
+        width, height, _ = frames[0]
+        if width > MAX_SIZE or height > MAX_SIZE or len(frames) > 255:
+            raise PackError(f"{name}: icons are limited to 255x255 and 255 frames")
+        bitmaps = [to_xbm(w, h, rows) for w, h, rows in frames]
+        icons.append((name, width, height, min(rate, 255), bitmaps))
+    return icons
+
+
+def build(directory, output):
+    icons = collect(directory)
+    hashes = {}
+    for name, *_ in icons:
+        value = name_hash(name)
+        if value in hashes:
+            raise PackError(f"{name} and {hashes[value]} have the same name hash")
+        hashes[value] = name
+    icons.sort(key=lambda icon: name_hash(icon[0]))
+
+    blobs = []  # (digest, bitmap, packed)
+    blob_index = {}
+    frames = []
+    records = []
+    for name, width, height, rate, bitmaps in icons:
+        records.append((name_hash(name), width, height, len(bitmaps), rate, len(frames)))
+        for bitmap in bitmaps:
+            digest = hashlib.sha256(bitmap).digest()
+            if digest not in blob_index:
+                packed = heatshrink(bitmap)
+                if len(packed) >= len(bitmap):
+                    packed = bitmap
+                elif unheatshrink(packed, len(bitmap)) != bitmap:
+                    raise PackError(f"{name}: compressed bitmap does not round trip")
+                blob_index[digest] = len(blobs)
+                blobs.append((digest, bitmap, packed))
+            frames.append(blob_index[digest])
+
+    offset = (
+        HEADER.size + ICON.size * len(records) + FRAME.size * len(frames) + BLOB.size * len(blobs)
+    )
+    counts = (len(records), len(frames), len(blobs))
+    out = bytearray(HEADER.pack(MAGIC, VERSION, WINDOW_BITS, LOOKAHEAD_BITS, 0, *counts, 0))
+    for record in records:
+        out += ICON.pack(*record, 0)
+    for index in frames:
+        out += FRAME.pack(index)
+    for digest, bitmap, packed in blobs:
+        out += BLOB.pack(digest[:8], offset, len(packed), len(bitmap))
+        offset += len(packed)
+    for _, _, packed in blobs:
+        out += packed
+
+    with open(output, "wb") as file:
+        file.write(out)
+    raw = sum(len(bitmap) for _, _, _, _, bitmaps in icons for bitmap in bitmaps)
+    print(
+        f"{len(records)} icons, {len(frames)} frames, {len(blobs)} distinct: "
+        f"{raw} bitmap bytes -> {len(out)} byte pack"
+    )
+
+
+def parse(path):
+    with open(path, "rb") as file:
+        data = file.read()
+    header = HEADER.unpack_from(data)
+    magic, version, window_bits, lookahead_bits, _, icon_count, frame_count, blob_count, _ = header
+    if magic != MAGIC or version != VERSION:
+        raise PackError(f"{path}: not a version {VERSION} icon pack")
+    position = HEADER.size
+    icons = [ICON.unpack_from(data, position + i * ICON.size) for i in range(icon_count)]
+    position += ICON.size * icon_count
+    frames = [FRAME.unpack_from(data, position + i * FRAME.size)[0] for i in range(frame_count)]
+    position += FRAME.size * frame_count
+    blobs = [BLOB.unpack_from(data, position + i * BLOB.size) for i in range(blob_count)]
+    return data, window_bits, lookahead_bits, icons, frames, blobs
+
+
+def list_pack(path, runs):
+    data, window_bits, lookahead_bits, icons, frames, blobs = parse(path)
+    print(f"{path}: {len(data)} bytes, heatshrink window {window_bits} lookahead {lookahead_bits}")
+    print(f"{'hash':<10}{'size':>8}{'frames':>8}{'rate':>6}  blobs")
+    for value, width, height, count, rate, first, _ in icons:
+        indices = frames[first : first + count]
+        print(f"{value:08x}{width:>6}x{height:<3}{count:>6}{rate:>6}  {indices}")
+
+    print(f"\n{'blob':<6}{'digest':<18}{'packed':>8}{'size':>6}{'unpack us':>11}")
+    for index, (digest, offset, packed_size, size) in enumerate(blobs):
+        packed = data[offset : offset + packed_size]
+        start = time.perf_counter()
+        for _ in range(runs):
+            bitmap = packed if packed_size == size else unheatshrink(packed, size)
+        elapsed = (time.perf_counter() - start) / runs
+        if hashlib.sha256(bitmap).digest()[:8] != digest:
+            raise PackError(f"blob {index}: digest mismatch")
+        print(f"{index:<6}{digest.hex():<18}{packed_size:>8}{size:>6}{elapsed * 1e6:>11.1f}")
+    print(
+        "\nEvery blob unpacked and matched its digest.  The unpack time is this computer's "
+        "Python copy, the flipper pays it once per blob and then draws from its cache."
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    build_parser = commands.add_parser("build", help="pack every icon in a folder")
+    build_parser.add_argument("directory")
+    build_parser.add_argument("-o", "--output", default="icons.pack")
+    list_parser = commands.add_parser("list", help="show and check the contents of a pack")
+    list_parser.add_argument("pack")
+    list_parser.add_argument("--runs", type=int, default=100)
+    args = parser.parse_args()
+
+    try:
+        if args.command == "build":
+            build(args.directory, args.output)
+        else:
+            list_pack(args.pack, args.runs)
+    except PackError as error:
+        print(error, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+"""Stand-in for the ESP32 Wi-Fi board on the other end of the Solana Wallet UART link.
+
+Speaks the frame protocol from SolanaWallet/solana_link_frame.h over a pseudo terminal, so the
+link can be exercised (and its throughput and latency measured) without hardware.
+
+    serve   Open a pty, print its path and answer requests until Ctrl+C.
+    bench   Run the emulator in-process and drive it with a Flipper-side client that keeps
+            several requests in flight, then report throughput and latency.
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import binascii
+import collections
+import json
+import os
+import random
+import select
+import struct
+import sys
+import threading
+import time
+import tty
+import urllib.request
+
+SOF = 0x7E
+HEADER = struct.Struct("<BBBBH")  # sof, type, seq, flags, length
+MAX_PAYLOAD = 512
+# Answers remembered for retransmitted requests.  The Flipper sends every retry under a new
+# sequence number, so this only catches a frame repeated on the wire; keeping more would hand
+# stale answers to a new request once the 8 bit sequence wraps.
+RECENT_ANSWERS = 8
+
+FRAME_REQUEST = 0x01
+FRAME_RESPONSE = 0x02
+FRAME_EVENT = 0x03
+FLAG_MORE = 0x01
+
+CMD_PING = 0x00
+CMD_WIFI_CONNECT = 0x01
+CMD_WIFI_STATUS = 0x02
+CMD_RPC = 0x10
+
+STATUS_OK = 0x00
+STATUS_FAILED = 0x01
+STATUS_UNKNOWN_COMMAND = 0x02
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, same as solana_link_crc16(0xFFFF, ...)."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def encode_frame(frame_type, seq, flags, payload):
+    header = HEADER.pack(SOF, frame_type, seq, flags, len(payload))
+    return header + payload + struct.pack("<H", crc16(header[1:] + payload))
+
+
+class Decoder:
+    """Frame decoder matching SolanaLinkDecoder: bad frames are dropped and it hunts for 0x7E."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data):
+        self.buffer += data
+        frames = []
+        while True:
+            start = self.buffer.find(bytes([SOF]))
+            if start < 0:
+                self.buffer.clear()
+                return frames
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER.size:
+                return frames
+            _, frame_type, seq, flags, length = HEADER.unpack_from(self.buffer)
+            if length > MAX_PAYLOAD:
+                self.crc_errors += 1
+                del self.buffer[:1]
+                continue
+            total = HEADER.size + length + 2
+            if len(self.buffer) < total:
+                return frames
+            body = bytes(self.buffer[1 : HEADER.size + length])
+            (crc,) = struct.unpack_from("<H", self.buffer, HEADER.size + length)
+            if crc16(body) != crc:
+                self.crc_errors += 1
+                del self.buffer[:1]
+                continue
+            frames.append((frame_type, seq, flags, bytes(self.buffer[HEADER.size : total - 2])))
+            del self.buffer[:total]
+
+
+class Board:
+    """Answers link requests the way the board firmware is expected to."""
+
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.decoder = Decoder()
+        self.write_lock = threading.Lock()
+        self.recent = collections.OrderedDict()  # seq -> (request payload, response frames)
+        self.recent_lock = threading.Lock()
+        self.rng = random.Random(args.seed)
+        self.stats = {"requests": 0, "duplicates": 0, "dropped": 0, "bytes_in": 0, "bytes_out": 0}
+        self.wifi_connected = False
+
+    def write(self, data):
+        with self.write_lock:
+            if self.args.baud:
+                # 10 bits per byte on the wire (start + 8 data + stop).
+                time.sleep(len(data) * 10 / self.args.baud)
+            if self.rng.random() < self.args.corrupt_rate:
+                data = bytearray(data)
+                data[self.rng.randrange(len(data))] ^= 0x40
+            os.write(self.fd, bytes(data))
+            self.stats["bytes_out"] += len(data)
+
+    def handle(self, payload):
+        """Return (status, response bytes) for a request payload."""
+        command, body = payload[0], payload[1:]
+        if command == CMD_PING:
+            return STATUS_OK, b""
+        if command == CMD_WIFI_CONNECT:
+            ssid, _, _password = body.partition(b"\0")
+            time.sleep(self.args.wifi_delay)
+            self.wifi_connected = not self.args.wifi_fail
+            log(f"wifi connect to {ssid.decode(errors='replace')!r}: {self.wifi_connected}")
+            return (STATUS_OK if self.wifi_connected else STATUS_FAILED), b""
+        if command == CMD_WIFI_STATUS:
+            return STATUS_OK, bytes([1 if self.wifi_connected else 0])
+        if command == CMD_RPC:
+            return self.rpc(body)
+        return STATUS_UNKNOWN_COMMAND, b""
+
+    def rpc(self, body):
+        if self.args.rpc_url:
+            request = urllib.request.Request(
+                self.args.rpc_url, data=body, headers={"Content-Type": "application/json"}
+            )
+            try:
+                with urllib.request.urlopen(request, timeout=10) as response:
+                    return STATUS_OK, response.read()
+            except OSError as error:
+                log(f"rpc forward failed: {error}")
+                return STATUS_FAILED, b""
+        # Without an upstream, echo the call back as a JSON-RPC result so clients get an answer.
+        try:
+            call = json.loads(body)
+        except ValueError:
+            return STATUS_FAILED, b""
+        calls = call if isinstance(call, list) else [call]
+        results = [
+            {"jsonrpc": "2.0", "id": c.get("id"), "result": {"method": c.get("method")}}
+            for c in calls
+        ]
+        reply = results if isinstance(call, list) else results[0]
+        return STATUS_OK, json.dumps(reply).encode()
+
+    def respond(self, seq, payload):
+        time.sleep(self.args.latency / 1000)
+        status, data = self.handle(payload)
+        frames = []
+        chunk = MAX_PAYLOAD - 1
+        pieces = [data[i : i + chunk] for i in range(0, len(data), chunk)] or [b""]
+        for index, piece in enumerate(pieces):
+            flags = FLAG_MORE if index < len(pieces) - 1 else 0
+            frames.append(encode_frame(FRAME_RESPONSE, seq, flags, bytes([status]) + piece))
+        with self.recent_lock:
+            if seq in self.recent:
+                self.recent[seq] = (payload, frames)
+        for frame in frames:
+            self.write(frame)
+
+    def on_frame(self, frame_type, seq, _flags, payload):
+        if frame_type != FRAME_REQUEST or not payload:
+            return
+        if self.rng.random() < self.args.drop_rate:
+            self.stats["dropped"] += 1
+            return
+        with self.recent_lock:
+            previous = self.recent.get(seq)
+            duplicate = previous is not None and previous[0] == payload
+            if not duplicate:
+                self.recent[seq] = (payload, None)
+                self.recent.move_to_end(seq)
+                while len(self.recent) > RECENT_ANSWERS:
+                    self.recent.popitem(last=False)
+        if duplicate:
+            # The Flipper retried because our answer was lost; resend rather than re-execute.
+            # A retry that overtakes the first answer is dropped, that answer is on its way.
+            self.stats["duplicates"] += 1
+            for frame in previous[1] or []:
+                self.write(frame)
+            return
+        self.stats["requests"] += 1
+        threading.Thread(target=self.respond, args=(seq, payload), daemon=True).start()
+
+    def run(self, stop):
+        while not stop.is_set():
+            ready, _, _ = select.select([self.fd], [], [], 0.1)
+            if not ready:
+                continue
+            try:
+                data = os.read(self.fd, 4096)
+            except OSError:
+                break
+            self.stats["bytes_in"] += len(data)
+            for frame in self.decoder.feed(data):
+                self.on_frame(*frame)
+
+
+def log(message):
+    print(f"[board] {message}", file=sys.stderr)
+
+
+def open_pty():
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    return master, slave, os.ttyname(slave)
+
+
+def serve(args):
+    master, _slave, path = open_pty()
+    print(path, flush=True)
+    log(f"listening on {path}")
+    board = Board(master, args)
+    stop = threading.Event()
+    try:
+        board.run(stop)
+    except KeyboardInterrupt:
+        pass
+    log(f"stats: {board.stats}, crc errors: {board.decoder.crc_errors}")
+
+
+class Client:
+    """Flipper-side stand-in: the same in-flight window, timeouts and retries as solana_link.c."""
+
+    def __init__(self, fd, window, timeout, retries):
+        self.fd = fd
+        self.window = window
+        self.timeout = timeout
+        self.retries = retries
+        self.decoder = Decoder()
+        self.next_seq = 1
+        self.pending = {}  # seq -> [frame, sent_at, deadline, retries left, first_sent_at]
+        self.latencies = []
+        self.timeouts = 0
+        self.retried = 0
+
+    def take_seq(self):
+        seq = self.next_seq
+        self.next_seq = self.next_seq % 255 + 1
+        return seq
+
+    def send(self, command, body):
+        seq = self.take_seq()
+        frame = encode_frame(FRAME_REQUEST, seq, 0, bytes([command]) + body)
+        now = time.monotonic()
+        self.pending[seq] = [frame, now, now + self.timeout, self.retries, now]
+        os.write(self.fd, frame)
+
+    def poll(self):
+        ready, _, _ = select.select([self.fd], [], [], 0.01)
+        if ready:
+            for _type, seq, flags, _payload in self.decoder.feed(os.read(self.fd, 4096)):
+                entry = self.pending.get(seq)
+                if entry is None:
+                    continue
+                entry[2] = time.monotonic() + self.timeout
+                if not flags & FLAG_MORE:
+                    self.latencies.append(time.monotonic() - entry[4])
+                    del self.pending[seq]
+        now = time.monotonic()
+        for seq, entry in list(self.pending.items()):
+            if now < entry[2]:
+                continue
+            if entry[3] > 0:
+                # Like solana_link.c, a retry goes out under a new sequence number.
+                del self.pending[seq]
+                seq = self.take_seq()
+                _, frame_type, _, flags, _ = HEADER.unpack_from(entry[0])
+                entry[0] = encode_frame(frame_type, seq, flags, entry[0][HEADER.size : -2])
+                entry[2] = now + self.timeout
+                entry[3] -= 1
+                self.pending[seq] = entry
+                self.retried += 1
+                os.write(self.fd, entry[0])
+            else:
+                self.timeouts += 1
+                del self.pending[seq]
+
+
+def bench(args):
+    master, slave, path = open_pty()
+    board = Board(master, args)
+    stop = threading.Event()
+    thread = threading.Thread(target=board.run, args=(stop,), daemon=True)
+    thread.start()
+    log(f"benchmarking over {path}")
+
+    client = Client(slave, args.window, args.timeout / 1000, args.retries)
+    body = json.dumps(
+        {"jsonrpc": "2.0", "id": 1, "method": "getBalance", "params": ["x" * args.size]}
+    ).encode()
+    command = CMD_RPC if args.size else CMD_PING
+    if not args.size:
+        body = b""
+    if len(body) + 1 > MAX_PAYLOAD:
+        sys.exit(f"--size too large, request must fit in {MAX_PAYLOAD} bytes")
+
+    started = time.monotonic()
+    sent = 0
+    while sent < args.count or client.pending:
+        while sent < args.count and len(client.pending) < args.window:
+            client.send(command, body)
+            sent += 1
+        client.poll()
+    elapsed = time.monotonic() - started
+    stop.set()
+    thread.join()
+
+    latencies = sorted(client.latencies) or [0.0]
+
+    def percentile(p):
+        return latencies[min(len(latencies) - 1, int(p * len(latencies)))] * 1000
+
+    total = board.stats["bytes_in"] + board.stats["bytes_out"]
+    print(f"requests      {args.count} ({args.window} in flight)")
+    print(f"completed     {len(client.latencies)}, timeouts {client.timeouts}")
+    print(f"retries       {client.retried}, board saw {board.stats['duplicates']} duplicates")
+    print(f"elapsed       {elapsed:.3f} s, {args.count / elapsed:.1f} req/s")
+    print(f"wire bytes    {total} ({total / elapsed / 1024:.1f} KiB/s)")
+    print(f"latency ms    p50 {percentile(0.5):.1f}  p90 {percentile(0.9):.1f}  "
+          f"p99 {percentile(0.99):.1f}  max {latencies[-1] * 1000:.1f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="mode", required=True)
+
+    def common(p):
+        p.add_argument("--latency", type=float, default=5, help="board processing delay, ms")
+        p.add_argument("--baud", type=int, default=115200, help="simulated UART speed, 0 = off")
+        p.add_argument("--drop-rate", type=float, default=0, help="fraction of requests ignored")
+        p.add_argument("--corrupt-rate", type=float, default=0, help="fraction of frames mangled")
+        p.add_argument("--wifi-delay", type=float, default=1.0, help="seconds to join Wi-Fi")
+        p.add_argument("--wifi-fail", action="store_true", help="refuse to join Wi-Fi")
+        p.add_argument("--rpc-url", help="forward RPC bodies to this JSON-RPC endpoint")
+        p.add_argument("--seed", type=int, default=1, help="fault injection seed")
+
+    common(sub.add_parser("serve", help="answer requests on a new pty"))
+    bench_parser = sub.add_parser("bench", help="measure link throughput and latency")
+    common(bench_parser)
+    bench_parser.add_argument("--count", type=int, default=500)
+    bench_parser.add_argument("--window", type=int, default=4, help="requests in flight")
+    bench_parser.add_argument("--size", type=int, default=0, help="RPC body padding, 0 = ping")
+    bench_parser.add_argument("--timeout", type=float, default=2000, help="per attempt, ms")
+    bench_parser.add_argument("--retries", type=int, default=2)
+
+    args = parser.parse_args()
+    if args.mode == "serve":
+        serve(args)
+    else:
+        bench(args)
+
+
+if __name__ == "__main__":
+    main()
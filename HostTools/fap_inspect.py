@@ -0,0 +1,387 @@
+#!/usr/bin/env python3
+"""Look inside .fap files and time how long loading them takes.
+
+A FAP is a relocatable ARM ELF.  Before the app's entry point runs, the flipper's loader reads
+every section, looks up each imported firmware function and patches every relocation.  This
+tool shows where that work comes from:
+
+    python3 fap_inspect.py report ../ExportedApps/skeleton_app.fap
+    python3 fap_inspect.py report --by-function ../ExportedApps/*.fap
+    python3 fap_inspect.py bench ../ExportedApps/*.fap --runs 200
+
+"report" lists the sections, relocations by type and target, imported symbols and the
+.fast.rel records fbt precomputes.  "--by-function" shows which functions the relocations come
+from, which is where to look when trying to get the count down.  "bench" runs a Python copy of
+the firmware's loader over the file, once through the plain .rel sections and once through
+.fast.rel, so the two can be compared.  Only the Python standard library is used.
+"""
+
+import argparse
+import bisect
+import collections
+import struct
+import sys
+import time
+
+SHT_SYMTAB = 2
+SHT_REL = 9
+SHF_ALLOC = 0x2
+SHN_UNDEF = 0
+STT_FUNC = 2
+STT_SECTION = 3
+
+RELOCATION_TYPES = {
+    2: "R_ARM_ABS32",
+    3: "R_ARM_REL32",
+    10: "R_ARM_THM_CALL",
+    30: "R_ARM_THM_JUMP24",
+    47: "R_ARM_THM_MOVW_ABS_NC",
+    48: "R_ARM_THM_MOVT_ABS",
+}
+FAST_RELOCATION_VERSION = 1
+MANIFEST_MAGIC = 0x52474448
+FIRMWARE_API_SIZE = 2000  # Roughly how many symbols the firmware exports to FAPs
+
+
+class FapError(Exception):
+    pass
+
+
+def symbol_hash(name):
+    """Hash the loader uses to find firmware symbols (the GNU ELF hash)."""
+    value = 0x1505
+    for byte in name.encode():
+        value = (value * 33 + byte) & 0xFFFFFFFF
+    return value
+
+
+Section = collections.namedtuple("Section", "index name type flags offset size link info")
+Symbol = collections.namedtuple("Symbol", "name value size kind section")
+Relocation = collections.namedtuple("Relocation", "offset type symbol")
+FastRecord = collections.namedtuple("FastRecord", "type is_section name value offsets")
+
+
+class Fap:
+    def __init__(self, path):
+        with open(path, "rb") as file:
+            self.data = file.read()
+        self.path = path
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise FapError(f"{path}: not a 32 bit little endian ELF")
+        header = struct.unpack_from("<HHIIIIIHHHHHH", self.data, 16)
+        section_offset = header[5]
+        entry_size, count, names_index = header[10:13]
+
+        raw = [
+            struct.unpack_from("<IIIIIIIIII", self.data, section_offset + i * entry_size)
+            for i in range(count)
+        ]
+        names = raw[names_index]
+        self.sections = [
+            Section(i, self.string(names[4], r[0]), r[1], r[2], r[4], r[5], r[6], r[7])
+            for i, r in enumerate(raw)
+        ]
+        self.by_name = {s.name: s for s in self.sections}
+        self.symbols = self.read_symbols()
+        self.relocations = {
+            self.sections[s.info].name: self.read_relocations(s)
+            for s in self.sections
+            if s.type == SHT_REL
+        }
+        self.fast = {
+            s.name[len(".fast.rel") :]: self.read_fast(s)
+            for s in self.sections
+            if s.name.startswith(".fast.rel")
+        }
+
+    def string(self, offset, index):
+        end = self.data.index(b"\0", offset + index)
+        return self.data[offset + index : end].decode(errors="replace")
+
+    def contents(self, section):
+        return self.data[section.offset : section.offset + section.size]
+
+    def read_symbols(self):
+        table = next((s for s in self.sections if s.type == SHT_SYMTAB), None)
+        if table is None:
+            return []
+        strings = self.sections[table.link].offset
+        symbols = []
+        for i in range(table.size // 16):
+            name, value, size, info, _, shndx = struct.unpack_from(
+                "<IIIBBH", self.data, table.offset + i * 16
+            )
+            kind = info & 0xF
+            if kind == STT_SECTION and shndx < len(self.sections):
+                text = self.sections[shndx].name
+            else:
+                text = self.string(strings, name)
+            symbols.append(Symbol(text, value, size, kind, shndx))
+        return symbols
+
+    def read_relocations(self, section):
+        relocations = []
+        for i in range(section.size // 8):
+            offset, info = struct.unpack_from("<II", self.data, section.offset + i * 8)
+            relocations.append(Relocation(offset, info & 0xFF, self.symbols[info >> 8]))
+        return relocations
+
+    def read_fast(self, section):
+        """Parse a .fast.rel section: every distinct target once, followed by its offsets."""
+        data = self.contents(section)
+        if not data or data[0] != FAST_RELOCATION_VERSION:
+            raise FapError(f"{self.path}: unknown {section.name} version")
+        (count,) = struct.unpack_from("<I", data, 1)
+        position = 5
+        records = []
+        for _ in range(count):
+            flags = data[position]
+            is_section = bool(flags & 0x80)
+            (name,) = struct.unpack_from("<I", data, position + 1)
+            position += 5
+            value = 0
+            if is_section:
+                (value,) = struct.unpack_from("<I", data, position)
+                position += 4
+            (offset_count,) = struct.unpack_from("<I", data, position)
+            position += 4
+            offsets = [
+                int.from_bytes(data[position + j * 3 : position + j * 3 + 3], "little")
+                for j in range(offset_count)
+            ]
+            position += offset_count * 3
+            records.append(FastRecord(flags & 0x7F, is_section, name, value, offsets))
+        return records
+
+    def imports(self):
+        """Undefined symbols and how many relocations point at each."""
+        uses = collections.Counter()
+        for relocations in self.relocations.values():
+            for relocation in relocations:
+                if relocation.symbol.section == SHN_UNDEF and relocation.symbol.name:
+                    uses[relocation.symbol.name] += 1
+        return uses
+
+    def manifest(self):
+        section = self.by_name.get(".fapmeta")
+        if section is None or section.size < 16:
+            return None
+        data = self.contents(section)
+        magic, version, api, target = struct.unpack_from("<IIIH", data)
+        if magic != MANIFEST_MAGIC:
+            return None
+        stack, app_version = struct.unpack_from("<HI", data, 14)
+        name = data[20:52].split(b"\0")[0].decode(errors="replace")
+        return {
+            "name": name,
+            "api": f"{api >> 16}.{api & 0xFFFF}",
+            "target": target,
+            "stack": stack,
+            "version": app_version,
+            "manifest": version,
+        }
+
+    def function_at(self, section_index, offset):
+        for symbol in self.symbols:
+            start = symbol.value & ~1  # Thumb functions have the low bit set
+            if (
+                symbol.kind == STT_FUNC
+                and symbol.section == section_index
+                and start <= offset < start + symbol.size
+            ):
+                return symbol.name
+        return "?"
+
+
+def type_name(kind):
+    return RELOCATION_TYPES.get(kind, f"type {kind}")
+
+
+def report(fap, by_function):
+    print(f"== {fap.path}")
+    manifest = fap.manifest()
+    if manifest:
+        print(
+            f"app '{manifest['name']}' version {manifest['version']}, API {manifest['api']}, "
+            f"target f{manifest['target']}, stack {manifest['stack']}"
+        )
+
+    print(f"\n{'section':<20}{'size':>8}  loaded")
+    loaded = 0
+    for section in fap.sections[1:]:
+        alloc = bool(section.flags & SHF_ALLOC)
+        loaded += section.size if alloc else 0
+        print(f"{section.name:<20}{section.size:>8}  {'yes' if alloc else ''}")
+    print(f"{'loaded total':<20}{loaded:>8}")
+
+    print(f"\n{'relocations':<20}{'count':>8}  by type")
+    total = 0
+    for target, relocations in fap.relocations.items():
+        kinds = collections.Counter(type_name(r.type) for r in relocations)
+        total += len(relocations)
+        detail = ", ".join(f"{name} {count}" for name, count in kinds.most_common())
+        print(f"{target:<20}{len(relocations):>8}  {detail}")
+    internal = sum(
+        1
+        for relocations in fap.relocations.values()
+        for r in relocations
+        if r.symbol.section != SHN_UNDEF
+    )
+    print(f"{'total':<20}{total:>8}  ({internal} internal, {total - internal} to firmware)")
+
+    imports = fap.imports()
+    print(f"\n{len(imports)} imported symbols, by relocations:")
+    for name, count in sorted(imports.items(), key=lambda item: (-item[1], item[0])):
+        print(f"  {count:>3}  {name}")
+
+    if fap.fast:
+        records = sum(len(r) for r in fap.fast.values())
+        offsets = sum(len(x.offsets) for r in fap.fast.values() for x in r)
+        print(f"\n.fast.rel: {records} distinct targets for {offsets} relocations")
+
+    if by_function:
+        print("\nrelocations by function:")
+        counts = collections.Counter()
+        for target, relocations in fap.relocations.items():
+            section = fap.by_name[target]
+            for relocation in relocations:
+                counts[(target, fap.function_at(section.index, relocation.offset))] += 1
+        for (target, function), count in counts.most_common():
+            where = function if function != "?" else f"(data in {target})"
+            print(f"  {count:>3}  {where}")
+    print()
+
+
+class FirmwareApi:
+    """Stand-in for the firmware's API table: every import of the given FAPs plus filler, sorted
+    by name hash so it can be binary searched like the real one."""
+
+    def __init__(self, faps, size=FIRMWARE_API_SIZE):
+        names = set()
+        for fap in faps:
+            names.update(fap.imports())
+        names.update(f"firmware_symbol_{i}" for i in range(max(0, size - len(names))))
+        table = sorted((symbol_hash(name), 0x08000000 + i * 4) for i, name in enumerate(names))
+        self.hashes = [h for h, _ in table]
+        self.addresses = [a for _, a in table]
+
+
+class ReferenceLoader:
+    """The relocation part of the firmware's ELF loader, in Python.
+
+    Only R_ARM_ABS32 is patched, which is all fbt emits for FAPs since it builds them with
+    -mlong-calls and -mword-relocations.
+    """
+
+    def __init__(self, fap, api):
+        self.fap = fap
+        self.api = api
+        # Sections are laid out one after the other, like the loader does in a single block.
+        self.base = {}
+        address = 0x20000000
+        for section in fap.sections:
+            if section.flags & SHF_ALLOC:
+                self.base[section.index] = address
+                address += (section.size + 3) & ~3
+        self.images = {
+            s.name: bytearray(fap.contents(s)) for s in fap.sections if s.flags & SHF_ALLOC
+        }
+        self.lookups = 0
+
+    def resolve(self, name_hash):
+        self.lookups += 1
+        hashes = self.api.hashes
+        index = bisect.bisect_left(hashes, name_hash)
+        if index == len(hashes) or hashes[index] != name_hash:
+            raise FapError(f"unresolved symbol hash {name_hash:#x}")
+        return self.api.addresses[index]
+
+    @staticmethod
+    def patch(image, offset, kind, address):
+        if kind != 2:
+            raise FapError(f"{type_name(kind)} is not supported by the reference loader")
+        (addend,) = struct.unpack_from("<I", image, offset)
+        struct.pack_into("<I", image, offset, (addend + address) & 0xFFFFFFFF)
+
+    def load_plain(self):
+        for target, relocations in self.fap.relocations.items():
+            image = self.images[target]
+            for relocation in relocations:
+                symbol = relocation.symbol
+                if symbol.section == SHN_UNDEF:
+                    address = self.resolve(symbol_hash(symbol.name))
+                else:
+                    address = self.base[symbol.section] + symbol.value
+                self.patch(image, relocation.offset, relocation.type, address)
+
+    def load_fast(self):
+        for target, records in self.fap.fast.items():
+            image = self.images[target]
+            for record in records:
+                if record.is_section:
+                    address = self.base[record.name] + record.value
+                else:
+                    address = self.resolve(record.name)
+                for offset in record.offsets:
+                    self.patch(image, offset, record.type, address)
+
+
+def bench(faps, runs):
+    print(
+        f"{'fap':<22}{'relocs':>8}{'imports':>9}{'plain us':>10}{'lookups':>9}"
+        f"{'fast us':>9}{'lookups':>9}"
+    )
+    api = FirmwareApi(faps)
+    for fap in faps:
+        results = []
+        for method in ("load_plain", "load_fast"):
+            if method == "load_fast" and not fap.fast:
+                results.append((float("nan"), 0))
+                continue
+            # Each run copies the sections like the loader does, then relocates them.
+            start = time.perf_counter()
+            for _ in range(runs):
+                loader = ReferenceLoader(fap, api)
+                getattr(loader, method)()
+            results.append(((time.perf_counter() - start) / runs, loader.lookups))
+        relocations = sum(len(r) for r in fap.relocations.values())
+        name = fap.path.rsplit("/", 1)[-1]
+        (plain, plain_lookups), (fast, fast_lookups) = results
+        print(
+            f"{name:<22}{relocations:>8}{len(fap.imports()):>9}{plain * 1e6:>10.1f}"
+            f"{plain_lookups:>9}{fast * 1e6:>9.1f}{fast_lookups:>9}"
+        )
+    print(
+        "\nTimes are for the Python reference loader on this computer, only useful to compare "
+        "files and the two paths with each other.  Lookups are binary searches in a "
+        f"{FIRMWARE_API_SIZE} symbol API table."
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    report_parser = commands.add_parser("report", help="sections, relocations and imports")
+    report_parser.add_argument("faps", nargs="+")
+    report_parser.add_argument(
+        "--by-function", action="store_true", help="count relocations per function"
+    )
+    bench_parser = commands.add_parser("bench", help="time the reference loader")
+    bench_parser.add_argument("faps", nargs="+")
+    bench_parser.add_argument("--runs", type=int, default=100)
+    args = parser.parse_args()
+
+    try:
+        faps = [Fap(path) for path in args.faps]
+        if args.command == "report":
+            for fap in faps:
+                report(fap, args.by_function)
+        else:
+            bench(faps, args.runs)
+    except (OSError, FapError) as error:
+        print(error, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
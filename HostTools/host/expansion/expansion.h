@@ -0,0 +1,14 @@
+// The expansion module service of the firmware's expansion/expansion.h.  It has nothing to give
+// up on the computer, see host_serial.c.
+
+#ifndef HOST_EXPANSION_H
+#define HOST_EXPANSION_H
+
+#define RECORD_EXPANSION "expansion"
+
+typedef struct Expansion Expansion;
+
+void expansion_disable(Expansion* instance);
+void expansion_enable(Expansion* instance);
+
+#endif // HOST_EXPANSION_H
@@ -0,0 +1,151 @@
+// Just enough of the Flipper firmware's furi.h to build the app modules that keep their firmware
+// use to mutexes, threads, timers, ticks, stream buffers, records, pubsub and logging on the
+// computer.  See host_furi.c.
+
+#ifndef HOST_FURI_H
+#define HOST_FURI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNUSED(x)   (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof((x)[0]))
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define furi_assert(x) \
+    do {               \
+        if(!(x)) {     \
+            abort();   \
+        }              \
+    } while(0)
+#define furi_check furi_assert
+
+// Quiet unless HOST_FURI_LOG is set in the environment, so tests only print their own lines.
+// Not checked as printf: the apps print uint32_t with %lu, which is right on the Flipper only,
+// so host_furi_log() drops the l.
+void host_furi_log(char level, const char* tag, const char* format, ...);
+
+// Host only: also append every log line to buffer, NULL to stop.
+void host_furi_log_capture(char* buffer, size_t size);
+#define FURI_LOG_E(tag, ...) host_furi_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) host_furi_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) host_furi_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) host_furi_log('D', tag, __VA_ARGS__)
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+} FuriStatus;
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+typedef struct FuriMutex FuriMutex;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+typedef void (*FuriTimerCallback)(void* context);
+
+typedef enum {
+    FuriTimerTypeOnce = 0,
+    FuriTimerTypePeriodic = 1,
+} FuriTimerType;
+
+typedef struct FuriTimer FuriTimer;
+
+// Each timer has its own thread instead of the firmware's one timer thread.  Deadlines are ticks,
+// so host_furi_advance_ticks() makes them due.
+FuriTimer* furi_timer_alloc(FuriTimerCallback callback, FuriTimerType type, void* context);
+void furi_timer_free(FuriTimer* timer);
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks);
+FuriStatus furi_timer_stop(FuriTimer* timer);
+uint32_t furi_timer_is_running(FuriTimer* timer);
+
+// One tick is one millisecond, as on the Flipper.
+uint32_t furi_get_tick(void);
+uint32_t furi_kernel_get_tick_frequency(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+void furi_delay_ms(uint32_t milliseconds);
+
+// Host only: move furi_get_tick() forward.  Timers due on the way run at their own deadline, in
+// order, and this returns once their callbacks are done, so minutes can be simulated at once.
+// Don't hold a lock a timer callback takes.  Negative ticks (as uint32_t) go back in time.
+void host_furi_advance_ticks(uint32_t ticks);
+
+typedef enum {
+    FuriFlagWaitAny = 0x00000000U,
+    FuriFlagWaitAll = 0x00000001U,
+    FuriFlagNoClear = 0x00000002U,
+    FuriFlagError = 0x80000000U,
+    FuriFlagErrorTimeout = 0xFFFFFFFEU,
+} FuriFlag;
+
+typedef int32_t (*FuriThreadCallback)(void* context);
+typedef struct FuriThread FuriThread;
+typedef FuriThread* FuriThreadId;
+
+// A pthread, the stack size is ignored.
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadId furi_thread_get_id(FuriThread* thread);
+
+// Only for threads made by furi_thread_alloc_ex().  The timeout is in real milliseconds.
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+typedef struct FuriStreamBuffer FuriStreamBuffer;
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level);
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer);
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout);
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout);
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer);
+
+typedef struct FuriPubSub FuriPubSub;
+typedef struct FuriPubSubSubscription FuriPubSubSubscription;
+typedef void (*FuriPubSubCallback)(const void* message, void* context);
+
+FuriPubSub* furi_pubsub_alloc(void);
+void furi_pubsub_free(FuriPubSub* pubsub);
+FuriPubSubSubscription*
+    furi_pubsub_subscribe(FuriPubSub* pubsub, FuriPubSubCallback callback, void* context);
+void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* subscription);
+void furi_pubsub_publish(FuriPubSub* pubsub, void* message);
+
+// RECORD_INPUT_EVENTS is a FuriPubSub, publish InputEvents to it to press keys.  Every other
+// record is a handle the host versions ignore.
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+#endif // HOST_FURI_H
@@ -0,0 +1,70 @@
+// The part of the firmware's furi_hal.h the app modules use: the hardware RNG, the secure
+// enclave's device-unique key, the cycle counter (see host_furi.c) and the USART (see
+// host_serial.c).
+
+#ifndef HOST_FURI_HAL_H
+#define HOST_FURI_HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT 11U
+
+uint32_t furi_hal_random_get(void);
+void furi_hal_random_fill_buf(uint8_t* buffer, uint32_t length);
+
+// Host only: while stuck the "hardware" RNG returns this byte over and over, as a broken one
+// might.  A negative value makes it random again.
+void host_furi_random_stuck(int value);
+
+bool furi_hal_crypto_enclave_ensure_key(uint8_t slot);
+bool furi_hal_crypto_enclave_load_key(uint8_t slot, const uint8_t* iv);
+bool furi_hal_crypto_enclave_unload_key(uint8_t slot);
+bool furi_hal_crypto_encrypt(const uint8_t* input, uint8_t* output, size_t size);
+
+// DWT->CYCCNT counts at 64 MHz, from the monotonic clock.
+typedef struct {
+    uint32_t CYCCNT;
+} HostFuriDwt;
+
+HostFuriDwt* host_furi_dwt(void);
+#define DWT (host_furi_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+typedef enum {
+    FuriHalSerialIdUsart,
+    FuriHalSerialIdLpuart,
+} FuriHalSerialId;
+
+typedef enum {
+    FuriHalSerialRxEventData = (1 << 0),
+    FuriHalSerialRxEventIdle = (1 << 1),
+} FuriHalSerialRxEvent;
+
+typedef struct FuriHalSerialHandle FuriHalSerialHandle;
+
+typedef void (*FuriHalSerialAsyncRxCallback)(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    void* context);
+
+// The USART is the terminal named by HOST_FURI_SERIAL, such as the pty esp32_link_emulator.py
+// serves.  Without it, or while acquired, there is none to acquire.
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id);
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle);
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud);
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle);
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size);
+
+// The callback runs on a reader thread, once per byte as from the interrupt.
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors);
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle);
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle);
+
+#endif // HOST_FURI_HAL_H
@@ -0,0 +1,33 @@
+// The framebuffer callbacks of the firmware's gui/gui.h, for the energy profiler.  See
+// host_gui.c.
+
+#ifndef HOST_GUI_H
+#define HOST_GUI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECORD_GUI "gui"
+
+typedef enum {
+    CanvasOrientationHorizontal,
+    CanvasOrientationHorizontalFlip,
+    CanvasOrientationVertical,
+    CanvasOrientationVerticalFlip,
+} CanvasOrientation;
+
+typedef struct Gui Gui;
+
+typedef void (*GuiCanvasCommitCallback)(
+    uint8_t* data,
+    size_t size,
+    CanvasOrientation orientation,
+    void* context);
+
+void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context);
+void gui_remove_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context);
+
+// Host only: send one frame to the display, which calls every framebuffer callback.
+void host_gui_commit(void);
+
+#endif // HOST_GUI_H
@@ -0,0 +1,769 @@
+// Host versions of the firmware calls declared in furi.h, furi_hal.h and storage/storage.h.
+//
+// Files: a path like /data/keystore.bin or /ext/todo.md becomes a file in the directory named by
+// HOST_FURI_ROOT (the current directory if unset), with the slashes after the first turned into
+// underscores, so every test can start from an empty directory.
+//
+// The secure enclave key is replaced by a fixed key: furi_hal_crypto_encrypt() XORs the input with
+// SHA-256(key, iv, block number).  That is enough to keep the keystore code paths honest (a wrong
+// salt gives a wrong key) but of course protects nothing.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include "sha256.h"
+
+static pthread_mutex_t host_furi_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char* host_furi_log_buffer;
+static size_t host_furi_log_size;
+
+void host_furi_log_capture(char* buffer, size_t size) {
+    pthread_mutex_lock(&host_furi_log_mutex);
+    host_furi_log_buffer = buffer;
+    host_furi_log_size = size;
+    if(buffer) {
+        buffer[0] = '\0';
+    }
+    pthread_mutex_unlock(&host_furi_log_mutex);
+}
+
+// The apps print uint32_t with %lu, right on the Flipper where it is an unsigned long.  Here it
+// is an unsigned int, so one l is dropped from each conversion (%llu stays).
+static void host_furi_log_format(const char* format, char* out, size_t size) {
+    size_t length = 0;
+    while(*format && length + 1 < size) {
+        char c = *format++;
+        out[length++] = c;
+        if(c != '%') {
+            continue;
+        }
+        while(*format && strchr("-+ #0123456789.*", *format) && length + 1 < size) {
+            out[length++] = *format++;
+        }
+        if(format[0] == 'l' && format[1] != 'l') {
+            format++;
+        }
+    }
+    out[length] = '\0';
+}
+
+void host_furi_log(char level, const char* tag, const char* format, ...) {
+    static int enabled = -1;
+    if(enabled < 0) {
+        enabled = getenv("HOST_FURI_LOG") != NULL;
+    }
+    char fixed[256], line[512];
+    host_furi_log_format(format, fixed, sizeof(fixed));
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), fixed, args);
+    va_end(args);
+
+    if(enabled) {
+        fprintf(stderr, "%c [%s] %s\n", level, tag, line);
+    }
+    pthread_mutex_lock(&host_furi_log_mutex);
+    if(host_furi_log_buffer) {
+        size_t used = strlen(host_furi_log_buffer);
+        snprintf(
+            host_furi_log_buffer + used,
+            host_furi_log_size - used,
+            "%c [%s] %s\n",
+            level,
+            tag,
+            line);
+    }
+    pthread_mutex_unlock(&host_furi_log_mutex);
+}
+
+// Mutexes
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(
+        &attributes,
+        type == FuriMutexTypeRecursive ? PTHREAD_MUTEX_RECURSIVE : PTHREAD_MUTEX_ERRORCHECK);
+    pthread_mutex_init(&mutex->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    int error = timeout == FuriWaitForever ? pthread_mutex_lock(&mutex->mutex) :
+                                             pthread_mutex_trylock(&mutex->mutex);
+    // A normal mutex taken twice by one thread deadlocks on the Flipper, so fail loudly here.
+    furi_assert(error != EDEADLK);
+    return error ? FuriStatusErrorTimeout : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    return pthread_mutex_unlock(&mutex->mutex) ? FuriStatusError : FuriStatusOk;
+}
+
+// Time
+
+static uint32_t host_furi_tick_offset;
+
+uint32_t furi_get_tick(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000) +
+           __atomic_load_n(&host_furi_tick_offset, __ATOMIC_RELAXED);
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    struct timespec delay = {milliseconds / 1000, (long)(milliseconds % 1000) * 1000000};
+    nanosleep(&delay, NULL);
+}
+
+// The CLOCK_MONOTONIC time milliseconds from now, for pthread_cond_timedwait() on conditions
+// made by host_furi_cond_init().
+static struct timespec host_furi_deadline(uint32_t milliseconds) {
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_sec += milliseconds / 1000;
+    until.tv_nsec += (long)(milliseconds % 1000) * 1000000;
+    if(until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+    return until;
+}
+
+static void host_furi_cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attributes);
+    pthread_condattr_destroy(&attributes);
+}
+
+// Timers.  A timer's deadline is a tick, so host_furi_advance_ticks() can run it early.
+
+struct FuriTimer {
+    pthread_t thread;
+    pthread_cond_t changed; // Started, stopped, freed or the ticks moved
+    pthread_cond_t idle; // Not due any more
+    FuriTimerCallback callback;
+    FuriTimerType type;
+    void* context;
+    bool running;
+    bool quit;
+    uint32_t period;
+    uint32_t deadline; // Tick
+    FuriTimer* next;
+};
+
+// Every timer, for host_furi_advance_ticks().  Also guards the fields of every timer.
+static pthread_mutex_t host_furi_timers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static FuriTimer* host_furi_timers;
+
+static bool host_furi_timer_due(FuriTimer* timer) {
+    return timer->running && (int32_t)(timer->deadline - furi_get_tick()) <= 0;
+}
+
+static void* host_furi_timer_thread(void* context) {
+    FuriTimer* timer = context;
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    while(!timer->quit) {
+        if(!timer->running) {
+            pthread_cond_wait(&timer->changed, &host_furi_timers_mutex);
+        } else if(!host_furi_timer_due(timer)) {
+            struct timespec until = host_furi_deadline(timer->deadline - furi_get_tick());
+            pthread_cond_timedwait(&timer->changed, &host_furi_timers_mutex, &until);
+        } else {
+            timer->running = timer->type == FuriTimerTypePeriodic;
+            timer->deadline = furi_get_tick() + timer->period;
+            // Unlocked, so the callback may start or stop its own timer.
+            pthread_mutex_unlock(&host_furi_timers_mutex);
+            timer->callback(timer->context);
+            pthread_mutex_lock(&host_furi_timers_mutex);
+            pthread_cond_broadcast(&timer->idle);
+        }
+    }
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+    return NULL;
+}
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback callback, FuriTimerType type, void* context) {
+    FuriTimer* timer = calloc(1, sizeof(FuriTimer));
+    host_furi_cond_init(&timer->changed);
+    pthread_cond_init(&timer->idle, NULL);
+    timer->callback = callback;
+    timer->type = type;
+    timer->context = context;
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    timer->next = host_furi_timers;
+    host_furi_timers = timer;
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+    furi_assert(pthread_create(&timer->thread, NULL, host_furi_timer_thread, timer) == 0);
+    return timer;
+}
+
+// Waits for a callback that is running, as furi_timer_free() does on the Flipper.
+void furi_timer_free(FuriTimer* timer) {
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    timer->quit = true;
+    pthread_cond_signal(&timer->changed);
+    for(FuriTimer** link = &host_furi_timers; *link; link = &(*link)->next) {
+        if(*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+    pthread_join(timer->thread, NULL);
+    pthread_cond_destroy(&timer->changed);
+    pthread_cond_destroy(&timer->idle);
+    free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks) {
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    timer->deadline = furi_get_tick() + ticks;
+    timer->period = ticks;
+    timer->running = true;
+    pthread_cond_signal(&timer->changed);
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* timer) {
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    timer->running = false;
+    pthread_cond_signal(&timer->changed);
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+    return FuriStatusOk;
+}
+
+uint32_t furi_timer_is_running(FuriTimer* timer) {
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    bool running = timer->running;
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+    return running;
+}
+
+void host_furi_advance_ticks(uint32_t ticks) {
+    if((int32_t)ticks < 0) {
+        // Back in time, nothing gets due.
+        __atomic_add_fetch(&host_furi_tick_offset, ticks, __ATOMIC_RELAXED);
+        return;
+    }
+    uint32_t target = furi_get_tick() + ticks;
+    pthread_mutex_lock(&host_furi_timers_mutex);
+    while(true) {
+        // Stop at the next deadline on the way, so its callback sees the tick it was due at.
+        FuriTimer* next = NULL;
+        for(FuriTimer* timer = host_furi_timers; timer; timer = timer->next) {
+            if(timer->running && (int32_t)(timer->deadline - target) <= 0 &&
+               (!next || (int32_t)(timer->deadline - next->deadline) < 0)) {
+                next = timer;
+            }
+        }
+        uint32_t now = furi_get_tick();
+        uint32_t until = next && (int32_t)(next->deadline - now) > 0 ? next->deadline : target;
+        if((int32_t)(until - now) > 0) {
+            __atomic_add_fetch(&host_furi_tick_offset, until - now, __ATOMIC_RELAXED);
+        }
+        if(!next) {
+            break;
+        }
+        pthread_cond_signal(&next->changed);
+        while(host_furi_timer_due(next)) {
+            pthread_cond_wait(&next->idle, &host_furi_timers_mutex);
+        }
+    }
+    pthread_mutex_unlock(&host_furi_timers_mutex);
+}
+
+// Threads and their flags
+
+struct FuriThread {
+    pthread_t thread;
+    FuriThreadCallback callback;
+    void* context;
+    pthread_mutex_t mutex; // Guards flags
+    pthread_cond_t changed;
+    uint32_t flags;
+};
+
+static __thread FuriThread* host_furi_thread_current;
+
+static void* host_furi_thread_main(void* context) {
+    FuriThread* thread = context;
+    host_furi_thread_current = thread;
+    thread->callback(thread->context);
+    return NULL;
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    UNUSED(stack_size);
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    thread->callback = callback;
+    thread->context = context;
+    pthread_mutex_init(&thread->mutex, NULL);
+    host_furi_cond_init(&thread->changed);
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    pthread_mutex_destroy(&thread->mutex);
+    pthread_cond_destroy(&thread->changed);
+    free(thread);
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_assert(pthread_create(&thread->thread, NULL, host_furi_thread_main, thread) == 0);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    return pthread_join(thread->thread, NULL) == 0;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return thread;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    pthread_mutex_lock(&thread_id->mutex);
+    thread_id->flags |= flags;
+    flags = thread_id->flags;
+    pthread_cond_broadcast(&thread_id->changed);
+    pthread_mutex_unlock(&thread_id->mutex);
+    return flags;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    FuriThread* thread = host_furi_thread_current;
+    furi_assert(thread);
+    struct timespec until = host_furi_deadline(timeout == FuriWaitForever ? 0 : timeout);
+    uint32_t result = FuriFlagErrorTimeout;
+
+    pthread_mutex_lock(&thread->mutex);
+    while(true) {
+        uint32_t set = thread->flags & flags;
+        if(options & FuriFlagWaitAll ? set == flags : set != 0) {
+            if(!(options & FuriFlagNoClear)) {
+                thread->flags &= ~set;
+            }
+            result = set;
+            break;
+        }
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&thread->changed, &thread->mutex);
+        } else if(
+            !timeout || pthread_cond_timedwait(&thread->changed, &thread->mutex, &until) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&thread->mutex);
+    return result;
+}
+
+// Stream buffers
+
+struct FuriStreamBuffer {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    size_t size;
+    size_t head; // Oldest byte
+    size_t count;
+    uint8_t data[];
+};
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level) {
+    UNUSED(trigger_level);
+    FuriStreamBuffer* stream_buffer = calloc(1, sizeof(FuriStreamBuffer) + size);
+    stream_buffer->size = size;
+    pthread_mutex_init(&stream_buffer->mutex, NULL);
+    host_furi_cond_init(&stream_buffer->changed);
+    return stream_buffer;
+}
+
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer) {
+    pthread_mutex_destroy(&stream_buffer->mutex);
+    pthread_cond_destroy(&stream_buffer->changed);
+    free(stream_buffer);
+}
+
+// Never waits for room, as from an interrupt: what doesn't fit is dropped.
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout) {
+    UNUSED(timeout);
+    pthread_mutex_lock(&stream_buffer->mutex);
+    length = MIN(length, stream_buffer->size - stream_buffer->count);
+    for(size_t i = 0; i < length; i++) {
+        size_t tail = (stream_buffer->head + stream_buffer->count++) % stream_buffer->size;
+        stream_buffer->data[tail] = ((const uint8_t*)data)[i];
+    }
+    pthread_cond_broadcast(&stream_buffer->changed);
+    pthread_mutex_unlock(&stream_buffer->mutex);
+    return length;
+}
+
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout) {
+    struct timespec until = host_furi_deadline(timeout == FuriWaitForever ? 0 : timeout);
+    pthread_mutex_lock(&stream_buffer->mutex);
+    while(!stream_buffer->count && timeout) {
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&stream_buffer->changed, &stream_buffer->mutex);
+        } else if(
+            pthread_cond_timedwait(&stream_buffer->changed, &stream_buffer->mutex, &until) !=
+            0) {
+            break;
+        }
+    }
+    length = MIN(length, stream_buffer->count);
+    for(size_t i = 0; i < length; i++) {
+        ((uint8_t*)data)[i] = stream_buffer->data[stream_buffer->head];
+        stream_buffer->head = (stream_buffer->head + 1) % stream_buffer->size;
+        stream_buffer->count--;
+    }
+    pthread_mutex_unlock(&stream_buffer->mutex);
+    return length;
+}
+
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer) {
+    pthread_mutex_lock(&stream_buffer->mutex);
+    stream_buffer->head = 0;
+    stream_buffer->count = 0;
+    pthread_mutex_unlock(&stream_buffer->mutex);
+    return FuriStatusOk;
+}
+
+// Records and pubsub
+
+struct FuriPubSubSubscription {
+    FuriPubSubCallback callback;
+    void* context;
+    FuriPubSubSubscription* next;
+};
+
+struct FuriPubSub {
+    pthread_mutex_t mutex;
+    FuriPubSubSubscription* subscriptions;
+};
+
+FuriPubSub* furi_pubsub_alloc(void) {
+    FuriPubSub* pubsub = calloc(1, sizeof(FuriPubSub));
+    pthread_mutex_init(&pubsub->mutex, NULL);
+    return pubsub;
+}
+
+void furi_pubsub_free(FuriPubSub* pubsub) {
+    furi_assert(!pubsub->subscriptions);
+    pthread_mutex_destroy(&pubsub->mutex);
+    free(pubsub);
+}
+
+FuriPubSubSubscription*
+    furi_pubsub_subscribe(FuriPubSub* pubsub, FuriPubSubCallback callback, void* context) {
+    FuriPubSubSubscription* subscription = malloc(sizeof(FuriPubSubSubscription));
+    subscription->callback = callback;
+    subscription->context = context;
+    pthread_mutex_lock(&pubsub->mutex);
+    subscription->next = pubsub->subscriptions;
+    pubsub->subscriptions = subscription;
+    pthread_mutex_unlock(&pubsub->mutex);
+    return subscription;
+}
+
+void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* subscription) {
+    pthread_mutex_lock(&pubsub->mutex);
+    for(FuriPubSubSubscription** link = &pubsub->subscriptions; *link; link = &(*link)->next) {
+        if(*link == subscription) {
+            *link = subscription->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+    free(subscription);
+}
+
+void furi_pubsub_publish(FuriPubSub* pubsub, void* message) {
+    pthread_mutex_lock(&pubsub->mutex);
+    for(FuriPubSubSubscription* subscription = pubsub->subscriptions; subscription;
+        subscription = subscription->next) {
+        subscription->callback(message, subscription->context);
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+}
+
+// The input events record is a pubsub a test can publish key presses to.  The others are only
+// handles, host_gui.c keeps their state.
+static FuriPubSub* host_furi_input_events;
+
+static void host_furi_input_events_alloc(void) {
+    host_furi_input_events = furi_pubsub_alloc();
+}
+
+void* furi_record_open(const char* name) {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    static int record;
+    if(strcmp(name, "input_events") == 0) {
+        pthread_once(&once, host_furi_input_events_alloc);
+        return host_furi_input_events;
+    }
+    return &record;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+// Hardware RNG and enclave
+
+static int host_furi_random_value = -1;
+
+void host_furi_random_stuck(int value) {
+    host_furi_random_value = value;
+}
+
+void furi_hal_random_fill_buf(uint8_t* buffer, uint32_t length) {
+    static FILE* random;
+    if(host_furi_random_value >= 0) {
+        memset(buffer, host_furi_random_value, length);
+        return;
+    }
+    if(!random) {
+        random = fopen("/dev/urandom", "rb");
+        furi_assert(random);
+    }
+    furi_assert(fread(buffer, 1, length, random) == length);
+}
+
+uint32_t furi_hal_random_get(void) {
+    uint32_t value;
+    furi_hal_random_fill_buf((uint8_t*)&value, sizeof(value));
+    return value;
+}
+
+static uint8_t host_furi_enclave_iv[16];
+static bool host_furi_enclave_loaded;
+
+bool furi_hal_crypto_enclave_ensure_key(uint8_t slot) {
+    return slot == FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT;
+}
+
+bool furi_hal_crypto_enclave_load_key(uint8_t slot, const uint8_t* iv) {
+    if(slot != FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT || host_furi_enclave_loaded) {
+        return false;
+    }
+    memcpy(host_furi_enclave_iv, iv, sizeof(host_furi_enclave_iv));
+    host_furi_enclave_loaded = true;
+    return true;
+}
+
+bool furi_hal_crypto_enclave_unload_key(uint8_t slot) {
+    bool ok = slot == FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT && host_furi_enclave_loaded;
+    host_furi_enclave_loaded = false;
+    return ok;
+}
+
+bool furi_hal_crypto_encrypt(const uint8_t* input, uint8_t* output, size_t size) {
+    static const char key[] = "host device unique key";
+    if(!host_furi_enclave_loaded || size % 16) {
+        return false;
+    }
+    for(size_t block = 0; block < size / 16; block++) {
+        uint8_t message[sizeof(key) + 16 + sizeof(block)];
+        uint8_t stream[SHA256_DIGEST_SIZE];
+        memcpy(message, key, sizeof(key));
+        memcpy(message + sizeof(key), host_furi_enclave_iv, 16);
+        memcpy(message + sizeof(key) + 16, &block, sizeof(block));
+        sha256(message, sizeof(message), stream);
+        for(size_t i = 0; i < 16; i++) {
+            output[block * 16 + i] = input[block * 16 + i] ^ stream[i];
+        }
+    }
+    return true;
+}
+
+// Cycle counter
+
+HostFuriDwt* host_furi_dwt(void) {
+    static __thread HostFuriDwt dwt;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    dwt.CYCCNT = (uint32_t)(now.tv_sec * 64000000 + now.tv_nsec * 64 / 1000);
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
+
+// Storage
+
+struct File {
+    FILE* file;
+};
+
+static void host_furi_path(const char* path, char* out, size_t size) {
+    const char* root = getenv("HOST_FURI_ROOT");
+    int length = snprintf(out, size, "%s/", root ? root : ".");
+    // "/data/keystore.bin" -> "data_keystore.bin"
+    for(const char* p = path[0] == '/' ? path + 1 : path; *p && length + 1 < (int)size; p++) {
+        out[length++] = *p == '/' ? '_' : *p;
+    }
+    out[length] = '\0';
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access, FS_OpenMode mode) {
+    char name[512];
+    struct stat info;
+    host_furi_path(path, name, sizeof(name));
+    bool exists = stat(name, &info) == 0;
+
+    if((mode == FSOM_OPEN_EXISTING && !exists) || (mode == FSOM_CREATE_NEW && exists)) {
+        return false;
+    }
+    if(mode == FSOM_CREATE_ALWAYS || !exists) {
+        FILE* created = fopen(name, "wb");
+        if(!created) {
+            return false;
+        }
+        fclose(created);
+    }
+    file->file = fopen(name, access == FSAM_READ ? "rb" : "r+b");
+    if(file->file && mode == FSOM_OPEN_APPEND) {
+        fseek(file->file, 0, SEEK_END);
+    }
+    return file->file != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->file) {
+        fclose(file->file);
+        file->file = NULL;
+    }
+    return true;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->file != NULL;
+}
+
+size_t storage_file_read(File* file, void* buffer, size_t size) {
+    return file->file ? fread(buffer, 1, size, file->file) : 0;
+}
+
+size_t storage_file_write(File* file, const void* buffer, size_t size) {
+    return file->file ? fwrite(buffer, 1, size, file->file) : 0;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return file->file && fseek(file->file, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_tell(File* file) {
+    return file->file ? (uint64_t)ftell(file->file) : 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    if(!file->file) {
+        return 0;
+    }
+    long position = ftell(file->file);
+    fseek(file->file, 0, SEEK_END);
+    long size = ftell(file->file);
+    fseek(file->file, position, SEEK_SET);
+    return size;
+}
+
+bool storage_file_eof(File* file) {
+    return !file->file || storage_file_tell(file) >= storage_file_size(file);
+}
+
+bool storage_file_sync(File* file) {
+    return file->file && fflush(file->file) == 0;
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char name[512];
+    struct stat info;
+    host_furi_path(path, name, sizeof(name));
+    return stat(name, &info) == 0;
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    char name[512];
+    struct stat info;
+    host_furi_path(path, name, sizeof(name));
+    if(stat(name, &info) != 0) {
+        return errno == ENOENT ? FSE_NOT_EXIST : FSE_INTERNAL;
+    }
+    if(fileinfo) {
+        fileinfo->flags = S_ISDIR(info.st_mode) ? 1 : 0; // FSF_DIRECTORY
+        fileinfo->size = info.st_size;
+    }
+    return FSE_OK;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char name[512];
+    host_furi_path(path, name, sizeof(name));
+    return remove(name) == 0 ? FSE_OK : FSE_NOT_EXIST;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    FS_Error error = storage_common_remove(storage, path);
+    return error == FSE_OK || error == FSE_NOT_EXIST;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char from[512], to[512];
+    host_furi_path(old_path, from, sizeof(from));
+    host_furi_path(new_path, to, sizeof(to));
+    return rename(from, to) == 0 ? FSE_OK : FSE_INTERNAL;
+}
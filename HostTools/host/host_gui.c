@@ -0,0 +1,174 @@
+// Host versions of the GUI framebuffer callbacks and of the notification service, declared in
+// gui/gui.h and notification/notification.h.
+//
+// Notifications are played on their own thread a little after they were queued, as on the
+// Flipper, so a sequence that is freed too early is read after the free and AddressSanitizer
+// reports it.
+
+#include <pthread.h>
+#include <furi.h>
+#include <gui/gui.h>
+#include <notification/notification.h>
+#include <notification/notification_messages.h>
+
+// GUI
+
+#define HOST_GUI_CALLBACKS 4
+
+static struct {
+    GuiCanvasCommitCallback callback;
+    void* context;
+} host_gui_callbacks[HOST_GUI_CALLBACKS];
+
+void gui_add_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
+    UNUSED(gui);
+    for(size_t i = 0; i < HOST_GUI_CALLBACKS; i++) {
+        if(!host_gui_callbacks[i].callback) {
+            host_gui_callbacks[i].callback = callback;
+            host_gui_callbacks[i].context = context;
+            return;
+        }
+    }
+    furi_check(false);
+}
+
+void gui_remove_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, void* context) {
+    UNUSED(gui);
+    for(size_t i = 0; i < HOST_GUI_CALLBACKS; i++) {
+        if(host_gui_callbacks[i].callback == callback &&
+           host_gui_callbacks[i].context == context) {
+            host_gui_callbacks[i].callback = NULL;
+        }
+    }
+}
+
+void host_gui_commit(void) {
+    static uint8_t frame[1024]; // 128x64 at 1bpp
+    for(size_t i = 0; i < HOST_GUI_CALLBACKS; i++) {
+        if(host_gui_callbacks[i].callback) {
+            host_gui_callbacks[i].callback(
+                frame, sizeof(frame), CanvasOrientationHorizontal, host_gui_callbacks[i].context);
+        }
+    }
+}
+
+// Notifications
+
+static const NotificationMessage host_message_display_backlight_on = {
+    .type = NotificationMessageTypeLedDisplayBacklight,
+    .data.led.value = 0xFF,
+};
+
+static const NotificationMessage host_message_display_backlight_enforce_on = {
+    .type = NotificationMessageTypeLedDisplayBacklightEnforceOn,
+    .data.led.value = 0xFF,
+};
+
+static const NotificationMessage host_message_display_backlight_enforce_auto = {
+    .type = NotificationMessageTypeLedDisplayBacklightEnforceAuto,
+    .data.led.value = 0x00,
+};
+
+const NotificationSequence sequence_display_backlight_on = {
+    &host_message_display_backlight_on,
+    NULL,
+};
+
+const NotificationSequence sequence_display_backlight_enforce_on = {
+    &host_message_display_backlight_enforce_on,
+    NULL,
+};
+
+const NotificationSequence sequence_display_backlight_enforce_auto = {
+    &host_message_display_backlight_enforce_auto,
+    NULL,
+};
+
+#define HOST_NOTIFICATION_QUEUE  16
+#define HOST_NOTIFICATION_PLAYED 256
+
+static pthread_mutex_t host_notification_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t host_notification_changed = PTHREAD_COND_INITIALIZER;
+static const NotificationSequence* host_notification_queue[HOST_NOTIFICATION_QUEUE];
+static size_t host_notification_head; // Next to play
+static size_t host_notification_tail; // Next free slot, a count that only grows
+static NotificationMessage host_notification_log[HOST_NOTIFICATION_PLAYED];
+static size_t host_notification_log_count;
+
+static void* host_notification_thread(void* context) {
+    UNUSED(context);
+    pthread_mutex_lock(&host_notification_mutex);
+    while(true) {
+        while(host_notification_head == host_notification_tail) {
+            pthread_cond_wait(&host_notification_changed, &host_notification_mutex);
+        }
+        const NotificationSequence* sequence =
+            host_notification_queue[host_notification_head % HOST_NOTIFICATION_QUEUE];
+        pthread_mutex_unlock(&host_notification_mutex);
+
+        // The firmware takes a moment too, and the sender may have moved on by now.
+        furi_delay_ms(2);
+        NotificationMessage played[8];
+        size_t count = 0;
+        for(const NotificationMessage* const* message = *sequence; *message && count < 8;
+            message++) {
+            played[count++] = **message;
+        }
+
+        pthread_mutex_lock(&host_notification_mutex);
+        for(size_t i = 0; i < count && host_notification_log_count < HOST_NOTIFICATION_PLAYED;
+            i++) {
+            host_notification_log[host_notification_log_count++] = played[i];
+        }
+        host_notification_head++;
+        pthread_cond_broadcast(&host_notification_changed);
+    }
+    return NULL;
+}
+
+// Returns the queue position of sequence, played once host_notification_head passes it.
+static size_t host_notification_queue_sequence(const NotificationSequence* sequence) {
+    static bool started;
+    pthread_mutex_lock(&host_notification_mutex);
+    if(!started) {
+        pthread_t thread;
+        furi_check(pthread_create(&thread, NULL, host_notification_thread, NULL) == 0);
+        pthread_detach(thread);
+        started = true;
+    }
+    while(host_notification_tail - host_notification_head == HOST_NOTIFICATION_QUEUE) {
+        pthread_cond_wait(&host_notification_changed, &host_notification_mutex);
+    }
+    size_t position = host_notification_tail++;
+    host_notification_queue[position % HOST_NOTIFICATION_QUEUE] = sequence;
+    pthread_cond_broadcast(&host_notification_changed);
+    pthread_mutex_unlock(&host_notification_mutex);
+    return position;
+}
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    host_notification_queue_sequence(sequence);
+}
+
+void notification_message_block(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    size_t position = host_notification_queue_sequence(sequence);
+    pthread_mutex_lock(&host_notification_mutex);
+    while(host_notification_head <= position) {
+        pthread_cond_wait(&host_notification_changed, &host_notification_mutex);
+    }
+    pthread_mutex_unlock(&host_notification_mutex);
+}
+
+size_t host_notification_played(NotificationMessage* messages, size_t max) {
+    pthread_mutex_lock(&host_notification_mutex);
+    while(host_notification_head != host_notification_tail) {
+        pthread_cond_wait(&host_notification_changed, &host_notification_mutex);
+    }
+    size_t count = MIN(max, host_notification_log_count);
+    memcpy(messages, host_notification_log, count * sizeof(NotificationMessage));
+    host_notification_log_count = 0;
+    pthread_mutex_unlock(&host_notification_mutex);
+    return count;
+}
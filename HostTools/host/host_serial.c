@@ -0,0 +1,121 @@
+// Host versions of the USART calls declared in furi_hal.h and of the expansion service, which
+// the Solana Wallet's link switches off while it holds the USART.
+//
+// The USART is the terminal named by HOST_FURI_SERIAL, usually the pty that
+// esp32_link_emulator.py serves.  Received bytes are read on a thread of their own and handed to
+// the rx callback one at a time, as the interrupt does on the Flipper.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <furi.h>
+#include <furi_hal.h>
+#include <expansion/expansion.h>
+
+struct FuriHalSerialHandle {
+    int fd;
+    pthread_t reader;
+    bool reading;
+    volatile bool stop;
+    FuriHalSerialAsyncRxCallback callback;
+    void* context;
+    uint8_t byte; // The one being handed to the callback
+};
+
+static FuriHalSerialHandle host_serial_usart = {.fd = -1};
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id) {
+    const char* path = getenv("HOST_FURI_SERIAL");
+    if(serial_id != FuriHalSerialIdUsart || !path || host_serial_usart.fd >= 0) {
+        return NULL;
+    }
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if(fd < 0) {
+        return NULL;
+    }
+    struct termios raw;
+    if(tcgetattr(fd, &raw) == 0) {
+        cfmakeraw(&raw);
+        tcsetattr(fd, TCSANOW, &raw);
+    }
+    host_serial_usart.fd = fd;
+    return &host_serial_usart;
+}
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle) {
+    furi_assert(!handle->reading);
+    close(handle->fd);
+    handle->fd = -1;
+}
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud) {
+    UNUSED(handle);
+    UNUSED(baud);
+}
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size) {
+    while(buffer_size) {
+        ssize_t written = write(handle->fd, buffer, buffer_size);
+        furi_assert(written > 0);
+        buffer += written;
+        buffer_size -= written;
+    }
+}
+
+static void* host_serial_reader(void* context) {
+    FuriHalSerialHandle* handle = context;
+    uint8_t buffer[256];
+    while(!handle->stop) {
+        // Woken every 10ms to see if it should stop
+        struct pollfd ready = {.fd = handle->fd, .events = POLLIN};
+        if(poll(&ready, 1, 10) <= 0) {
+            continue;
+        }
+        ssize_t size = read(handle->fd, buffer, sizeof(buffer));
+        for(ssize_t i = 0; i < size; i++) {
+            handle->byte = buffer[i];
+            handle->callback(handle, FuriHalSerialRxEventData, handle->context);
+        }
+    }
+    return NULL;
+}
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors) {
+    UNUSED(report_errors);
+    furi_assert(!handle->reading);
+    handle->callback = callback;
+    handle->context = context;
+    handle->stop = false;
+    handle->reading = true;
+    furi_assert(pthread_create(&handle->reader, NULL, host_serial_reader, handle) == 0);
+}
+
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle) {
+    if(handle->reading) {
+        handle->stop = true;
+        pthread_join(handle->reader, NULL);
+        handle->reading = false;
+    }
+}
+
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle) {
+    return handle->byte;
+}
+
+void expansion_disable(Expansion* instance) {
+    UNUSED(instance);
+}
+
+void expansion_enable(Expansion* instance) {
+    UNUSED(instance);
+}
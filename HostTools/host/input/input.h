@@ -0,0 +1,36 @@
+// The input events of the firmware's input/input.h.  Key presses are published to the
+// RECORD_INPUT_EVENTS pubsub, see furi.h.
+
+#ifndef HOST_INPUT_H
+#define HOST_INPUT_H
+
+#include <stdint.h>
+
+#define RECORD_INPUT_EVENTS "input_events"
+
+typedef enum {
+    InputKeyUp,
+    InputKeyDown,
+    InputKeyRight,
+    InputKeyLeft,
+    InputKeyOk,
+    InputKeyBack,
+    InputKeyMAX,
+} InputKey;
+
+typedef enum {
+    InputTypePress,
+    InputTypeRelease,
+    InputTypeShort,
+    InputTypeLong,
+    InputTypeRepeat,
+    InputTypeMAX,
+} InputType;
+
+typedef struct {
+    uint32_t sequence;
+    InputKey key;
+    InputType type;
+} InputEvent;
+
+#endif // HOST_INPUT_H
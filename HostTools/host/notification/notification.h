@@ -0,0 +1,46 @@
+// The backlight part of the firmware's notification/notification.h.  See host_gui.c.
+
+#ifndef HOST_NOTIFICATION_H
+#define HOST_NOTIFICATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECORD_NOTIFICATION "notification"
+
+typedef enum {
+    NotificationMessageTypeLedDisplayBacklight,
+    NotificationMessageTypeLedDisplayBacklightEnforceOn,
+    NotificationMessageTypeLedDisplayBacklightEnforceAuto,
+} NotificationMessageType;
+
+typedef struct {
+    uint8_t value;
+} NotificationMessageDataLed;
+
+typedef union {
+    NotificationMessageDataLed led;
+} NotificationMessageData;
+
+typedef struct {
+    NotificationMessageType type;
+    NotificationMessageData data;
+} NotificationMessage;
+
+typedef const NotificationMessage* NotificationSequence[];
+
+typedef struct NotificationApp NotificationApp;
+
+// Queued and played later on the notification thread, as on the Flipper: the sequence and its
+// messages must stay valid until then.
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
+
+// Queued behind the messages already waiting, returns once all of them were played.
+void notification_message_block(NotificationApp* app, const NotificationSequence* sequence);
+
+// Host only: wait for the queue to empty, then copy up to max of the messages played so far,
+// oldest first, and forget them.
+size_t host_notification_played(NotificationMessage* messages, size_t max);
+
+#endif // HOST_NOTIFICATION_H
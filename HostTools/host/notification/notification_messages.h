@@ -0,0 +1,12 @@
+// The backlight sequences of the firmware's notification/notification_messages.h.
+
+#ifndef HOST_NOTIFICATION_MESSAGES_H
+#define HOST_NOTIFICATION_MESSAGES_H
+
+#include "notification.h"
+
+extern const NotificationSequence sequence_display_backlight_on;
+extern const NotificationSequence sequence_display_backlight_enforce_on;
+extern const NotificationSequence sequence_display_backlight_enforce_auto;
+
+#endif // HOST_NOTIFICATION_MESSAGES_H
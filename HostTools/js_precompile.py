@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Precompile the Flipper JS scripts into compact cached copies and measure the difference.
+
+The firmware's JS engine (mJS) has no way to load bytecode or a heap snapshot from the SD card, it
+always reads and parses the source.  So the nearest thing to a compile cache is to do the
+expensive parts of the source once on the computer: strip comments and whitespace, and write the
+result next to the original as <name>.min.js.  The cache is keyed by the SHA-256 of the source,
+so unchanged scripts are skipped and edited ones are rebuilt:
+
+    python3 js_precompile.py build ../Scripts
+    python3 js_precompile.py bench ../Scripts --runs 200
+
+Line breaks that could end a statement are kept, so automatic semicolon insertion behaves the
+same in the cached copy.  mJS has no regular expression literals, so the lexer does not handle
+them either.  Only the Python standard library is used.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import sys
+import time
+import tracemalloc
+
+MANIFEST = ".jscache"
+SUFFIX = ".min.js"
+
+PUNCTUATORS = sorted(
+    """>>>= ... === !== **= <<= >>= >>> && || ?? ?. == != <= >= += -= *= /= %= &= |= ^= ++ -- << >>
+    ** => { } ( ) [ ] ; , < > + - * / % & | ^ ! ~ ? : = . @""".split(),
+    key=len,
+    reverse=True,
+)
+TOKEN = re.compile(
+    r"""
+    (?P<space>[ \t\r\f\v\u00a0\ufeff]+)
+  | (?P<newline>\n)
+  | (?P<comment>//[^\n]*|/\*[\s\S]*?\*/)
+  | (?P<string>"(?:[^"\\\n]|\\[\s\S])*"|'(?:[^'\\\n]|\\[\s\S])*'|`(?:[^`\\]|\\[\s\S])*`)
+  | (?P<number>0[xX][0-9a-fA-F]+|(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)
+  | (?P<word>[A-Za-z_$][\w$]*)
+  | (?P<punct>"""
+    + "|".join(re.escape(p) for p in PUNCTUATORS)
+    + r""")
+    """,
+    re.VERBOSE,
+)
+
+# Nothing can follow these so that a line break after them would end a statement.
+NO_BREAK_AFTER = {"{", "(", "[", ",", ";", ":", "=", "&&", "||", "?", "."}
+
+
+class LexError(Exception):
+    pass
+
+
+def tokenize(source):
+    """Yield (kind, text) for every token, comments and whitespace included."""
+    position = 0
+    while position < len(source):
+        match = TOKEN.match(source, position)
+        if not match:
+            line = source.count("\n", 0, position) + 1
+            raise LexError(f"line {line}: unexpected {source[position]!r}")
+        yield match.lastgroup, match.group()
+        position = match.end()
+
+
+def significant(source):
+    """Tokens that matter to the parser, with "\n" standing in for line breaks."""
+    tokens = []
+    for kind, text in tokenize(source):
+        if kind == "comment":
+            if "\n" in text:
+                tokens.append(("newline", "\n"))
+        elif kind != "space":
+            tokens.append((kind, text))
+    return tokens
+
+
+def needs_space(left, right):
+    """True if writing left and right back to back would lex differently."""
+    try:
+        joined = [text for _, text in tokenize(left + right)]
+    except LexError:
+        return True
+    return joined != [left, right]
+
+
+def minify(source):
+    out = []
+    previous = None  # Last token written, newlines excluded
+    pending_break = False
+    for kind, text in significant(source):
+        if kind == "newline":
+            pending_break = previous is not None
+            continue
+        if pending_break and previous not in NO_BREAK_AFTER:
+            out.append("\n")
+        elif previous is not None and needs_space(previous, text):
+            out.append(" ")
+        out.append(text)
+        previous = text
+        pending_break = False
+    return "".join(out) + "\n"
+
+
+def source_hash(data):
+    return hashlib.sha256(data).hexdigest()
+
+
+def scripts_in(directory):
+    return sorted(
+        name
+        for name in os.listdir(directory)
+        if name.endswith(".js") and not name.endswith(SUFFIX)
+    )
+
+
+def load_manifest(directory):
+    try:
+        with open(os.path.join(directory, MANIFEST)) as file:
+            return json.load(file)
+    except (OSError, ValueError):
+        return {}
+
+
+def cached_path(directory, name):
+    return os.path.join(directory, name[: -len(".js")] + SUFFIX)
+
+
+def build(directory, force=False, quiet=False):
+    """Bring every cached copy up to date.  Returns the number of scripts rebuilt."""
+    manifest = load_manifest(directory)
+    rebuilt = 0
+    for name in scripts_in(directory):
+        with open(os.path.join(directory, name), "rb") as file:
+            data = file.read()
+        digest = source_hash(data)
+        target = cached_path(directory, name)
+        entry = manifest.get(name)
+        if not force and entry and entry["hash"] == digest and os.path.exists(target):
+            continue
+        try:
+            text = minify(data.decode("utf-8"))
+        except LexError as error:
+            print(f"{name}: {error}, not cached", file=sys.stderr)
+            continue
+        with open(target, "w", newline="\n") as file:
+            file.write(text)
+        manifest[name] = {"hash": digest, "size": len(data), "cached_size": len(text.encode())}
+        rebuilt += 1
+        if not quiet:
+            print(f"{name}: {len(data)} -> {len(text.encode())} bytes")
+
+    for name in list(manifest):
+        if not os.path.exists(os.path.join(directory, name)):
+            del manifest[name]
+    with open(os.path.join(directory, MANIFEST), "w") as file:
+        json.dump(manifest, file, indent=2, sort_keys=True)
+        file.write("\n")
+    return rebuilt
+
+
+def measure(path, runs):
+    """Average seconds to read and tokenize path, and the peak Python heap doing it once."""
+    start = time.perf_counter()
+    for _ in range(runs):
+        with open(path, "rb") as file:
+            tokens = significant(file.read().decode("utf-8"))
+    elapsed = (time.perf_counter() - start) / runs
+
+    tracemalloc.start()
+    with open(path, "rb") as file:
+        significant(file.read().decode("utf-8"))
+    peak = tracemalloc.get_traced_memory()[1]
+    tracemalloc.stop()
+    return elapsed, len(tokens), peak
+
+
+def bench(directory, runs):
+    build(directory, quiet=True)
+    print(
+        f"{'script':<26}{'bytes':>7}{'cached':>8}{'tokens':>8}"
+        f"{'cold us':>10}{'cached us':>11}{'cold heap':>11}{'cached heap':>13}"
+    )
+    for name in scripts_in(directory):
+        source = os.path.join(directory, name)
+        target = cached_path(directory, name)
+        cold, tokens, cold_peak = measure(source, runs)
+        cached, _, cached_peak = measure(target, runs)
+        print(
+            f"{name:<26}{os.path.getsize(source):>7}{os.path.getsize(target):>8}{tokens:>8}"
+            f"{cold * 1e6:>10.1f}{cached * 1e6:>11.1f}{cold_peak:>11}{cached_peak:>13}"
+        )
+    print(
+        "\nTimes and heap are for reading and tokenizing on this computer.  The bytes columns are "
+        "what the flipper reads from SD and holds in RAM while mJS parses.  Running the scripts "
+        "needs the firmware's keyboard and math modules, so execution is not measured here."
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    build_parser = commands.add_parser("build", help="write <name>.min.js for changed scripts")
+    build_parser.add_argument("directory", nargs="?", default="Scripts")
+    build_parser.add_argument("--force", action="store_true", help="rebuild every script")
+    bench_parser = commands.add_parser("bench", help="compare source and cached copies")
+    bench_parser.add_argument("directory", nargs="?", default="Scripts")
+    bench_parser.add_argument("--runs", type=int, default=100)
+    args = parser.parse_args()
+
+    if args.command == "build":
+        rebuilt = build(args.directory, force=args.force)
+        print(f"{rebuilt} rebuilt")
+    else:
+        bench(args.directory, args.runs)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,582 @@
+// Host build of the apps' hot kernels, run by kernel_bench.py.  Each kernel runs a fixed number of
+// iterations and prints one JSON line: ns per op, allocations per op and peak heap bytes.
+// malloc and free are wrapped at link time (-Wl,--wrap) to count the heap use.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <furi.h>
+#include "aes_gcm.h"
+#include "base58.h"
+#include "ed25519.h"
+#include "entropy.h"
+#include "heatshrink.h"
+#include "kernel_fixtures.h"
+#include "qr_code.h"
+#include "sha256.h"
+#include "sha512.h"
+#include "solana_json.h"
+#include "solana_keystore.h"
+#include "solana_pda.h"
+#include "solana_tx.h"
+#include "todo_markdown.h"
+#include "todo_tasks.h"
+
+void* __real_malloc(size_t size);
+void __real_free(void* ptr);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+// Every block carries its size in front, so free knows how much stops being live.
+#define KERNEL_BENCH_HEADER 16
+
+static size_t bench_allocs;
+static size_t bench_live;
+static size_t bench_peak;
+
+void* __wrap_malloc(size_t size) {
+    uint8_t* block = __real_malloc(size + KERNEL_BENCH_HEADER);
+    if(!block) {
+        return NULL;
+    }
+    memcpy(block, &size, sizeof(size));
+    bench_allocs++;
+    bench_live += size;
+    if(bench_live > bench_peak) {
+        bench_peak = bench_live;
+    }
+    return block + KERNEL_BENCH_HEADER;
+}
+
+void __wrap_free(void* ptr) {
+    if(!ptr) {
+        return;
+    }
+    uint8_t* block = (uint8_t*)ptr - KERNEL_BENCH_HEADER;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    bench_live -= size;
+    __real_free(block);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __wrap_malloc(count * size);
+    if(ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    void* moved = __wrap_malloc(size);
+    if(ptr && moved) {
+        size_t old;
+        memcpy(&old, (uint8_t*)ptr - KERNEL_BENCH_HEADER, sizeof(old));
+        memcpy(moved, ptr, old < size ? old : size);
+        __wrap_free(ptr);
+    }
+    return moved;
+}
+
+static uint8_t bench_data[4096]; // Pseudo random, the same every run
+static uint8_t bench_text[4096]; // Repetitive text, for the compressor
+static uint8_t bench_seed[ED25519_SEED_SIZE];
+static uint8_t bench_public_key[ED25519_PUBLIC_KEY_SIZE];
+static uint8_t bench_signatures[16][ED25519_SIGNATURE_SIZE];
+#define BENCH_BATCH_MAX 64
+static uint8_t bench_batch_keys[BENCH_BATCH_MAX][ED25519_PUBLIC_KEY_SIZE];
+// Signature i is over bench_data + i, by key i in [0] and by key i % 2 in [1]
+static uint8_t bench_batch_signatures[2][BENCH_BATCH_MAX][ED25519_SIGNATURE_SIZE];
+static uint8_t bench_transaction[SOLANA_TX_MAX_SIZE];
+static size_t bench_transaction_size;
+static uint8_t bench_transaction_max[SOLANA_TX_MAX_SIZE]; // As many instructions as fit
+static size_t bench_transaction_max_size;
+static char bench_json[4096];
+static char bench_json_signatures[256 * 1024]; // getSignaturesForAddress, 1000 entries
+static size_t bench_json_signatures_size;
+static char bench_json_account[96 * 1024]; // getAccountInfo with 64 KB of account data
+static size_t bench_json_account_size;
+static SolanaKeystore* bench_keystore; // One key, PIN "1234", in the host storage directory
+static Entropy* bench_entropy;
+static TodoTasks bench_markdown_tasks; // Filled by the first import
+static volatile uint32_t bench_sink; // Keeps results alive
+
+static void bench_tasks_fill(void) {
+    TodoTasks tasks;
+    todo_tasks_init(&tasks, 1);
+    for(size_t i = 0; i < MAX_TASKS; i++) {
+        todo_tasks_add(&tasks, "Water the plants before the weekend");
+    }
+    bench_sink += tasks.count;
+}
+
+static void bench_tasks_find(void) {
+    static TodoTasks tasks;
+    if(!tasks.count) {
+        todo_tasks_init(&tasks, 1);
+        for(size_t i = 0; i < MAX_TASKS; i++) {
+            todo_tasks_add(&tasks, "Water the plants before the weekend");
+        }
+    }
+    for(size_t i = 0; i < tasks.count; i++) {
+        bench_sink += todo_tasks_find(&tasks, tasks.tasks[MAX_TASKS - 1 - i].id) != NULL;
+    }
+}
+
+static void bench_sha256(void) {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256(bench_data, 1024, digest);
+    bench_sink += digest[0];
+}
+
+// One derivation per op, for each of the batch keys in turn as the owner, so the number of tries
+// is the average over 64 accounts.  Derivations per second is 1e9 over ns/op.
+static void bench_pda_token_account(void) {
+    static size_t owner;
+    uint8_t address[SOLANA_PDA_ADDRESS_SIZE], bump;
+    bench_sink += solana_pda_find_token_account(
+        bench_batch_keys[owner], bench_data, solana_pda_token_program, address, &bump);
+    bench_sink += bump;
+    owner = (owner + 1) % BENCH_BATCH_MAX;
+}
+
+// The curve test of one try
+static void bench_pda_is_on_curve(void) {
+    static size_t offset;
+    bench_sink += ed25519_is_on_curve(bench_data + offset);
+    offset = (offset + 1) % 64;
+}
+
+static void bench_sha512(void) {
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    sha512(bench_data, 1024, digest);
+    bench_sink += digest[0];
+}
+
+static void bench_ed25519_sign(void) {
+    uint8_t signature[ED25519_SIGNATURE_SIZE];
+    ed25519_sign(bench_data, 300, bench_seed, signature);
+    bench_sink += signature[0];
+}
+
+static void bench_ed25519_verify(void) {
+    bench_sink += ed25519_verify(bench_data, 300, bench_public_key, bench_signatures[0]);
+}
+
+// count signatures over 300 byte messages, by count different keys or by 2
+static void bench_ed25519_verify_batch(size_t count, bool two_keys) {
+    Ed25519VerifyItem items[BENCH_BATCH_MAX];
+    bool valid[BENCH_BATCH_MAX];
+    for(size_t i = 0; i < count; i++) {
+        size_t key = two_keys ? i % 2 : i;
+        items[i] = (Ed25519VerifyItem){
+            bench_data + i, 300, bench_batch_keys[key], bench_batch_signatures[two_keys][i]};
+    }
+    bench_sink += ed25519_verify_batch(items, count, valid);
+}
+
+static void bench_ed25519_verify_batch1(void) {
+    bench_ed25519_verify_batch(1, false);
+}
+
+static void bench_ed25519_verify_batch4(void) {
+    bench_ed25519_verify_batch(4, false);
+}
+
+static void bench_ed25519_verify_batch16(void) {
+    bench_ed25519_verify_batch(16, false);
+}
+
+static void bench_ed25519_verify_batch64(void) {
+    bench_ed25519_verify_batch(64, false);
+}
+
+static void bench_ed25519_verify_batch64_2keys(void) {
+    bench_ed25519_verify_batch(64, true);
+}
+
+static void bench_base58_encode(void) {
+    char text[64];
+    base58_encode(bench_public_key, sizeof(bench_public_key), text, sizeof(text));
+    bench_sink += text[0];
+}
+
+static void bench_base58_decode(void) {
+    static char text[64];
+    uint8_t key[32];
+    if(!text[0]) {
+        base58_encode(bench_public_key, sizeof(bench_public_key), text, sizeof(text));
+    }
+    bench_sink += base58_decode(text, key, sizeof(key));
+}
+
+static void bench_qr_code(void) {
+    static char address[64];
+    QrCode qr;
+    uint8_t bitmap[QR_CODE_BITMAP_SIZE(2)];
+    if(!address[0]) {
+        base58_encode(bench_public_key, sizeof(bench_public_key), address, sizeof(address));
+    }
+    qr_code_encode(&qr, address, QrCodeEccMedium);
+    bench_sink += qr_code_render(&qr, 2, bitmap, sizeof(bitmap));
+}
+
+static void bench_tx_parse_bytes(const uint8_t* tx, size_t size) {
+    uint8_t ring[256];
+    SolanaTxParser* parser = solana_tx_parser_alloc(ring, sizeof(ring));
+    SolanaTxEvent event;
+    size_t written = 0;
+    while(true) {
+        if(written < size) {
+            written += solana_tx_parser_write(parser, tx + written, size - written);
+            if(written == size) {
+                solana_tx_parser_finish(parser);
+            }
+        }
+        if(!solana_tx_parser_poll(parser, &event)) {
+            continue;
+        }
+        if(event.type == SolanaTxEventDone || event.type == SolanaTxEventError) {
+            break;
+        }
+    }
+    bench_sink += event.type;
+    solana_tx_parser_free(parser);
+}
+
+static void bench_tx_parse(void) {
+    bench_tx_parse_bytes(bench_transaction, bench_transaction_size);
+}
+
+static void bench_tx_parse_max(void) {
+    bench_tx_parse_bytes(bench_transaction_max, bench_transaction_max_size);
+}
+
+static void bench_json_callback(const SolanaJsonEvent* event, void* context) {
+    (void)context;
+    bench_sink += event->length;
+}
+
+static void bench_json_stream(void) {
+    static const char* const selectors[] = {"result.*.signature", "result.*.slot"};
+    SolanaJson json;
+    solana_json_init(&json, selectors, 2, bench_json_callback, NULL);
+    // The way it comes off the link, a frame at a time
+    size_t size = strlen(bench_json);
+    for(size_t i = 0; i < size; i += 200) {
+        solana_json_feed(&json, bench_json + i, size - i < 200 ? size - i : 200);
+    }
+    bench_sink += solana_json_finish(&json);
+}
+
+// The way a large answer comes off the link, a full frame at a time
+static void bench_json_frames(
+    const char* text,
+    size_t size,
+    const char* const* selectors,
+    size_t selector_count) {
+    SolanaJson json;
+    solana_json_init(&json, selectors, selector_count, bench_json_callback, NULL);
+    for(size_t i = 0; i < size; i += 511) {
+        solana_json_feed(&json, text + i, size - i < 511 ? size - i : 511);
+    }
+    bench_sink += solana_json_finish(&json);
+}
+
+static void bench_json_signatures_1000(void) {
+    static const char* const selectors[] = {"result.*.signature", "result.*.slot"};
+    bench_json_frames(bench_json_signatures, bench_json_signatures_size, selectors, 2);
+}
+
+static void bench_json_account_64k(void) {
+    static const char* const selectors[] = {"result.value.lamports", "result.value.data.0"};
+    bench_json_frames(bench_json_account, bench_json_account_size, selectors, 2);
+}
+
+// What the unlock thread pays once per session: the PIN key derivation
+static void bench_keystore_unlock(void) {
+    solana_keystore_lock(bench_keystore);
+    bench_sink += solana_keystore_unlock(bench_keystore, "1234");
+}
+
+// Every signature after that: decrypt the seed with the session key, then sign
+static void bench_sign_after_unlock(void) {
+    uint8_t seed[ED25519_SEED_SIZE], signature[ED25519_SIGNATURE_SIZE];
+    bench_sink += solana_keystore_load_seed(bench_keystore, 0, seed);
+    ed25519_sign(bench_data, 300, seed, signature);
+    memset(seed, 0, sizeof(seed));
+    bench_sink += signature[0];
+}
+
+static void bench_aes_gcm(void) {
+    uint8_t output[64], tag[AES_GCM_TAG_SIZE];
+    aes_gcm_encrypt(
+        bench_data, bench_data + 32, bench_data + 64, 32, bench_data + 96, output, 64, tag);
+    bench_sink += tag[0];
+}
+
+static void bench_heatshrink_encode(void) {
+    uint8_t out[2048];
+    bench_sink += heatshrink_encode(
+        bench_text, 1024, out, sizeof(out), HEATSHRINK_WINDOW_BITS, HEATSHRINK_LOOKAHEAD_BITS);
+}
+
+static void bench_heatshrink_decode(void) {
+    static uint8_t packed[2048];
+    static size_t packed_size;
+    uint8_t out[1024];
+    if(!packed_size) {
+        packed_size = heatshrink_encode(
+            bench_text,
+            sizeof(out),
+            packed,
+            sizeof(packed),
+            HEATSHRINK_WINDOW_BITS,
+            HEATSHRINK_LOOKAHEAD_BITS);
+    }
+    bench_sink += heatshrink_decode(
+        packed, packed_size, out, sizeof(out), HEATSHRINK_WINDOW_BITS, HEATSHRINK_LOOKAHEAD_BITS);
+}
+
+#define BENCH_CHECKLIST_1M APP_DATA_PATH("checklist_1m.md")
+#define BENCH_CHECKLIST_4K APP_DATA_PATH("checklist_4k.md")
+
+// The whole file goes through the parser.  Its 10 different tasks fill the list, the rest are
+// duplicates, ticked items and notes, so every run reads to the end.
+static void bench_markdown_import(const char* path) {
+    TodoMarkdownResult result;
+    todo_tasks_init(&bench_markdown_tasks, 1);
+    bench_sink += todo_markdown_import(&bench_markdown_tasks, path, 0, &result);
+    bench_sink += result.added;
+}
+
+// The same peak heap as the 4 KB file, only the time grows with the file
+static void bench_markdown_import_1m(void) {
+    bench_markdown_import(BENCH_CHECKLIST_1M);
+}
+
+static void bench_markdown_import_4k(void) {
+    bench_markdown_import(BENCH_CHECKLIST_4K);
+}
+
+static void bench_markdown_export(void) {
+    bench_sink += todo_markdown_export(&bench_markdown_tasks, APP_DATA_PATH("export.md"));
+}
+
+// Bulk output, what games and animations use
+static void bench_entropy_fast(void) {
+    uint8_t out[4096];
+    entropy_fill(bench_entropy, EntropyQualityFast, out, sizeof(out));
+    bench_sink += out[0];
+}
+
+// One key or nonce: fresh, health tested hardware bytes mixed in first
+static void bench_entropy_crypto(void) {
+    uint8_t out[32];
+    bench_sink += entropy_fill(bench_entropy, EntropyQualityCrypto, out, sizeof(out));
+}
+
+static void bench_entropy_uniform(void) {
+    bench_sink += entropy_fast_uniform(bench_entropy, 100);
+}
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    unsigned iterations; // About 50ms on a desktop
+} BenchKernel;
+
+static const BenchKernel bench_kernels[] = {
+    {"todo.tasks_fill", bench_tasks_fill, 200000},
+    {"todo.tasks_find", bench_tasks_find, 2000000},
+    {"solana.sha256_1k", bench_sha256, 20000},
+    {"solana.pda_token_account", bench_pda_token_account, 2000},
+    {"solana.pda_is_on_curve", bench_pda_is_on_curve, 5000},
+    {"solana.sha512_1k", bench_sha512, 20000},
+    {"solana.ed25519_sign", bench_ed25519_sign, 30},
+    {"solana.ed25519_verify", bench_ed25519_verify, 30},
+    {"solana.keystore_unlock", bench_keystore_unlock, 5},
+    {"solana.sign_after_unlock", bench_sign_after_unlock, 30},
+    {"solana.ed25519_verify_batch1", bench_ed25519_verify_batch1, 30},
+    {"solana.ed25519_verify_batch4", bench_ed25519_verify_batch4, 8},
+    {"solana.ed25519_verify_batch16", bench_ed25519_verify_batch16, 2},
+    {"solana.ed25519_verify_batch64", bench_ed25519_verify_batch64, 1},
+    {"solana.ed25519_verify_batch64_2keys", bench_ed25519_verify_batch64_2keys, 1},
+    {"solana.base58_encode", bench_base58_encode, 50000},
+    {"solana.base58_decode", bench_base58_decode, 50000},
+    {"solana.qr_code", bench_qr_code, 2000},
+    {"solana.tx_parse", bench_tx_parse, 50000},
+    {"solana.tx_parse_max", bench_tx_parse_max, 5000},
+    {"solana.json_stream", bench_json_stream, 20000},
+    {"solana.json_signatures_1000", bench_json_signatures_1000, 100},
+    {"solana.json_account_64k", bench_json_account_64k, 200},
+    {"solana.aes_gcm_64", bench_aes_gcm, 20000},
+    {"common.heatshrink_encode_1k", bench_heatshrink_encode, 2000},
+    {"common.heatshrink_decode_1k", bench_heatshrink_decode, 50000},
+    {"todo.markdown_import_1m", bench_markdown_import_1m, 10},
+    {"todo.markdown_import_4k", bench_markdown_import_4k, 2500},
+    {"todo.markdown_export", bench_markdown_export, 1500},
+    {"common.entropy_fast_4k", bench_entropy_fast, 4000},
+    {"common.entropy_crypto_32", bench_entropy_crypto, 50000},
+    {"common.entropy_uniform", bench_entropy_uniform, 1000000},
+};
+
+static void bench_setup(void) {
+    uint32_t x = 0x12345678;
+    for(size_t i = 0; i < sizeof(bench_data); i++) {
+        x = x * 1103515245 + 12345;
+        bench_data[i] = x >> 16;
+    }
+    static const char* const words[] = {"buy ", "milk ", "and ", "call ", "the ", "plumber\n"};
+    for(size_t i = 0; i < sizeof(bench_text); i++) {
+        const char* word = words[(i / 7) % 6];
+        bench_text[i] = word[i % strlen(word)];
+    }
+
+    memcpy(bench_seed, bench_data + 512, sizeof(bench_seed));
+    ed25519_public_key(bench_seed, bench_public_key);
+    for(size_t i = 0; i < 16; i++) {
+        ed25519_sign(bench_data + i, 300, bench_seed, bench_signatures[i]);
+    }
+    for(size_t i = 0; i < BENCH_BATCH_MAX; i++) {
+        uint8_t seed[ED25519_SEED_SIZE], second[ED25519_SEED_SIZE];
+        kernel_fixture_bytes(i, seed, sizeof(seed));
+        kernel_fixture_bytes(i % 2, second, sizeof(second));
+        ed25519_public_key(seed, bench_batch_keys[i]);
+        ed25519_sign(bench_data + i, 300, seed, bench_batch_signatures[0][i]);
+        ed25519_sign(bench_data + i, 300, second, bench_batch_signatures[1][i]);
+    }
+
+    // A legacy transfer: 1 signature, 3 keys, a blockhash and one instruction.
+    uint8_t* tx = bench_transaction;
+    size_t n = 0;
+    tx[n++] = 1;
+    memcpy(tx + n, bench_signatures[0], ED25519_SIGNATURE_SIZE);
+    n += ED25519_SIGNATURE_SIZE;
+    tx[n++] = 1;
+    tx[n++] = 0;
+    tx[n++] = 1;
+    tx[n++] = 3;
+    memcpy(tx + n, bench_data, 3 * 32 + 32);
+    n += 3 * 32 + 32;
+    const uint8_t instruction[] = {1, 2, 2, 0, 1, 12, 2, 0, 0, 0, 0x40, 0x42, 0x0f, 0, 0, 0, 0, 0};
+    memcpy(tx + n, instruction, sizeof(instruction));
+    bench_transaction_size = n + sizeof(instruction);
+
+    // The same keys with 45 byte instructions up to the packet size
+    memcpy(bench_transaction_max, tx, n);
+    size_t count_offset = n++;
+    uint8_t count = 0;
+    while(n + 45 <= SOLANA_TX_MAX_SIZE) {
+        const uint8_t header[] = {2, 2, 0, 1, 40};
+        memcpy(bench_transaction_max + n, header, sizeof(header));
+        memcpy(bench_transaction_max + n + sizeof(header), bench_data + n, 40);
+        n += 45;
+        count++;
+    }
+    bench_transaction_max[count_offset] = count;
+    bench_transaction_max_size = n;
+
+    // A getSignaturesForAddress answer with 16 entries
+    size_t length =
+        snprintf(bench_json, sizeof(bench_json), "{\"jsonrpc\":\"2.0\",\"result\":[");
+    for(size_t i = 0; i < 16; i++) {
+        length += snprintf(
+            bench_json + length,
+            sizeof(bench_json) - length,
+            "%s{\"signature\":\"5h6xBEauJ3PK6SWCZ1PGjBvj8vDdWG3KpwATGy1ARAXF%02zu\","
+            "\"slot\":%zu,\"err\":null,\"memo\":null,\"blockTime\":1700000000}",
+            i ? "," : "",
+            i,
+            283746512 + i);
+    }
+    snprintf(bench_json + length, sizeof(bench_json) - length, "],\"id\":1}");
+
+    bench_entropy = entropy_alloc();
+    bench_keystore = solana_keystore_alloc(bench_entropy);
+    if(solana_keystore_create(bench_keystore, "1234") != SolanaKeystoreOk ||
+       solana_keystore_generate(bench_keystore, NULL) != SolanaKeystoreOk) {
+        fprintf(stderr, "can't create the keystore\n");
+        exit(1);
+    }
+
+    bench_json_signatures_size =
+        kernel_fixture_signatures(bench_json_signatures, sizeof(bench_json_signatures), 1000);
+    static uint8_t account[64 * 1024];
+    kernel_fixture_bytes(0, account, sizeof(account));
+    bench_json_account_size = kernel_fixture_account(
+        bench_json_account, sizeof(bench_json_account), account, sizeof(account));
+
+    KernelFixtureChecklist counts;
+    char* checklist = malloc(1024 * 1024);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    size_t size = kernel_fixture_checklist(checklist, 1024 * 1024, &counts);
+    storage_file_open(file, BENCH_CHECKLIST_1M, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    storage_file_write(file, checklist, size);
+    storage_file_close(file);
+    size = kernel_fixture_checklist(checklist, 4096, &counts);
+    storage_file_open(file, BENCH_CHECKLIST_4K, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    storage_file_write(file, checklist, size);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    free(checklist);
+    bench_markdown_import_4k(); // Tasks to export, also when only the export runs
+}
+
+static double bench_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(int argc, char** argv) {
+    double scale = argc > 1 ? atof(argv[1]) : 1.0;
+    int repeat = argc > 2 ? atoi(argv[2]) : 5;
+    const char* only = argc > 3 ? argv[3] : NULL;
+
+    bench_setup();
+    for(size_t k = 0; k < sizeof(bench_kernels) / sizeof(bench_kernels[0]); k++) {
+        const BenchKernel* kernel = &bench_kernels[k];
+        if(only && !strstr(kernel->name, only)) {
+            continue;
+        }
+        unsigned iterations = kernel->iterations * scale;
+        if(!iterations) {
+            iterations = 1;
+        }
+
+        // Once to warm up and to count the heap use, which is the same every run
+        kernel->run();
+        bench_allocs = 0;
+        bench_peak = bench_live;
+        size_t base = bench_live;
+        kernel->run();
+        size_t allocs = bench_allocs;
+        size_t peak = bench_peak - base;
+
+        // Best of repeat, the least disturbed by the rest of the machine
+        double best = 0;
+        for(int r = 0; r < repeat; r++) {
+            double start = bench_now();
+            for(unsigned i = 0; i < iterations; i++) {
+                kernel->run();
+            }
+            double ns = (bench_now() - start) / iterations;
+            if(r == 0 || ns < best) {
+                best = ns;
+            }
+        }
+        printf(
+            "{\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.1f, "
+            "\"allocs_per_op\": %zu, \"peak_bytes\": %zu}\n",
+            kernel->name,
+            iterations,
+            best,
+            allocs,
+            peak);
+        fflush(stdout);
+    }
+    return 0;
+}
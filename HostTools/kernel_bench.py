@@ -0,0 +1,342 @@
+#!/usr/bin/env python3
+"""Time the apps' hot kernels on this computer and catch slowdowns against a saved baseline.
+
+Builds kernel_bench.c together with the app sources that don't need the Flipper firmware
+(hashing, Ed25519, AES-GCM, base58, the QR encoder, the transaction and JSON parsers, the
+keystore, the entropy service, heatshrink, the ToDo task list, its desktop sync, word completion
+and Markdown import and export) with the system C compiler, runs every kernel a fixed number of
+times and records ns per op, heap allocations per op and peak heap bytes.
+
+    python3 kernel_bench.py run --out results.json
+    python3 kernel_bench.py compare --results results.json --threshold 10
+    python3 kernel_bench.py test
+
+    run       Build, run and print every kernel.  --out saves the results as JSON.
+    compare   Compare results (or a fresh run when --results is left out) with the baseline
+              (kernel_bench_baseline.json next to this script).  A kernel is flagged when it got
+              more than --threshold percent slower or allocates more than before.  The exit
+              status is 1 if anything was flagged.
+    test      Build kernel_tests.c with the same sources, with AddressSanitizer and
+              UndefinedBehaviorSanitizer unless --no-sanitize is given, and run the host tests:
+              known answers, fuzzing and round trips.  The RPC client test talks to
+              mock_rpc_server.py through esp32_link_emulator.py, both started for the run.  The
+              exit status is 1 if any test failed.
+
+Times depend on the machine, so make your own baseline with "run --out kernel_bench_baseline.json"
+before changing anything and compare on the same machine.  The draw callbacks and the rest of
+the app code need the firmware headers, so they aren't covered.  Needs a C compiler and a GNU
+compatible linker (for -Wl,--wrap); otherwise only the Python standard library is used.
+"""
+
+import argparse
+import json
+import os
+import platform
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import qr_decode
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+APPS = os.path.join(HERE, "..", "OpenSourceApps", "applications_user")
+BASELINE = os.path.join(HERE, "kernel_bench_baseline.json")
+
+SOURCES = [
+    "SolanaWallet/aes_gcm.c",
+    "SolanaWallet/base58.c",
+    "SolanaWallet/ed25519.c",
+    "SolanaWallet/qr_code.c",
+    "SolanaWallet/sha256.c",
+    "SolanaWallet/sha512.c",
+    "SolanaWallet/solana_json.c",
+    "SolanaWallet/solana_keystore.c",
+    "SolanaWallet/solana_link.c",
+    "SolanaWallet/solana_link_frame.c",
+    "SolanaWallet/solana_pda.c",
+    "SolanaWallet/solana_rpc.c",
+    "SolanaWallet/solana_signer.c",
+    "SolanaWallet/solana_tx.c",
+    "SolanaWallet/solana_verify.c",
+    "ToDoList/todo_markdown.c",
+    "ToDoList/todo_sync.c",
+    "ToDoList/todo_tasks.c",
+    "ToDoList/todo_words.c",
+    "common/energy.c",
+    "common/entropy.c",
+    "common/heatshrink.c",
+]
+INCLUDES = ["SolanaWallet", "ToDoList", "common"]
+# Built from this directory into both binaries.  host/ stands in for the firmware headers the
+# keystore, signer, entropy service, energy profiler and the RPC client over the link include;
+# files they write go to a temporary directory and the USART is an esp32_link_emulator.py pty.
+HOST_SOURCES = ["kernel_fixtures.c", "host/host_furi.c", "host/host_gui.c", "host/host_serial.c"]
+HOST_INCLUDES = ["host"]
+WRAPPED = ["malloc", "free", "calloc", "realloc"]
+
+
+class BenchError(Exception):
+    pass
+
+
+def build(cc, directory, name, flags):
+    if not shutil.which(cc):
+        raise BenchError("no C compiler %r, pass --cc" % cc)
+    binary = os.path.join(directory, name)
+    command = [cc, "-std=gnu11", "-pthread", "-o", binary, os.path.join(HERE, name + ".c")]
+    command += flags
+    command += ["-I" + os.path.join(HERE, include) for include in HOST_INCLUDES]
+    command += ["-I" + os.path.join(APPS, include) for include in INCLUDES]
+    command += [os.path.join(APPS, source) for source in SOURCES]
+    command += [os.path.join(HERE, source) for source in HOST_SOURCES]
+    result = subprocess.run(command, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise BenchError("build failed:\n" + result.stderr)
+    sys.stderr.write(result.stderr)
+    return binary
+
+
+def host_environment(directory):
+    """Environment for the binaries: the host storage lives in the build directory."""
+    return dict(os.environ, HOST_FURI_ROOT=directory)
+
+
+def run_kernels(cc, scale, repeat, only):
+    with tempfile.TemporaryDirectory() as directory:
+        wrap = "-Wl," + ",".join("--wrap=" + name for name in WRAPPED)
+        binary = build(cc, directory, "kernel_bench", ["-O2", "-Wall", "-Wextra", wrap])
+        command = [binary, str(scale), str(repeat)] + ([only] if only else [])
+        kernels = {}
+        process = subprocess.Popen(
+            command, stdout=subprocess.PIPE, text=True, env=host_environment(directory)
+        )
+        for line in process.stdout:
+            kernel = json.loads(line)
+            name = kernel.pop("name")
+            kernels[name] = kernel
+            print_kernel(name, kernel)
+        if process.wait() != 0:
+            raise BenchError("kernel_bench exited with %d" % process.returncode)
+    return {
+        "version": 1,
+        "machine": platform.machine(),
+        "compiler": compiler_version(cc),
+        "scale": scale,
+        "repeat": repeat,
+        "kernels": kernels,
+    }
+
+
+def start_board():
+    """Start mock_rpc_server.py and an esp32_link_emulator.py forwarding to it, for the
+    solana.rpc_link test.  Returns the processes and the emulator's pty."""
+    mock = subprocess.Popen(
+        [sys.executable, os.path.join(HERE, "mock_rpc_server.py"), "--port", "0"]
+        + ["--latency", "5"],
+        stdout=subprocess.PIPE,
+        text=True,
+    )
+    url = mock.stdout.readline().split()[-1]
+    board = subprocess.Popen(
+        [sys.executable, os.path.join(HERE, "esp32_link_emulator.py"), "serve"]
+        + ["--rpc-url", url, "--latency", "2"],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.DEVNULL,
+        text=True,
+    )
+    pty = board.stdout.readline().strip()
+    if not pty:
+        mock.terminate()
+        raise BenchError("esp32_link_emulator.py didn't start")
+    return [mock, board], pty
+
+
+def run_tests(cc, sanitize, only):
+    flags = ["-O1", "-g", "-Wall", "-Wextra"]
+    if sanitize:
+        flags += ["-fsanitize=address,undefined", "-fno-sanitize-recover=undefined"]
+    with tempfile.TemporaryDirectory() as directory:
+        binary = build(cc, directory, "kernel_tests", flags)
+        command = [binary] + ([only] if only else [])
+        processes, pty = start_board()
+        try:
+            env = dict(host_environment(directory), HOST_FURI_SERIAL=pty)
+            failed = subprocess.run(command, env=env).returncode
+        finally:
+            for process in processes:
+                process.terminate()
+                process.wait()
+        codes = os.path.join(directory, "qr_codes.txt")
+        if os.path.exists(codes):
+            failed += not check_qr_codes(codes)
+    if failed:
+        print("\n%d test(s) failed" % failed)
+        return 1
+    print("\nall tests passed")
+    return 0
+
+
+def check_qr_codes(path):
+    """Decode what solana.qr_encode wrote with the reference decoder, as one more test.
+
+    Each code must decode to its text, and still does with as many modules flipped as its error
+    correction is sure to fix.
+    """
+    codes = []
+    with open(path) as file:
+        for line in file:
+            if line.startswith("text"):
+                codes.append((bytes.fromhex(line[4:].strip()), []))
+            else:
+                codes[-1][1].append(line.strip())
+    rng = random.Random(1)
+    checked = 0
+    for text, rows in codes:
+        details = {}
+        try:
+            decoded = qr_decode.decode(rows, details)
+            level = details["level"]
+            fixable = qr_decode.EC_CODEWORDS[level][details["version"]] // 2
+            damaged = qr_decode.decode(qr_decode.damage(rows, fixable, rng))
+        except qr_decode.QrError as error:
+            print("  %r: %s" % (text, error))
+            print("FAIL solana.qr_decode")
+            return False
+        if decoded != text or damaged != text:
+            print("  %r decoded as %r, %r when damaged" % (text, decoded, damaged))
+            print("FAIL solana.qr_decode")
+            return False
+        checked += 1
+    print("  %d codes decoded by qr_decode.py, also with errors" % checked)
+    print("ok   solana.qr_decode")
+    return True
+
+
+def compiler_version(cc):
+    result = subprocess.run([cc, "--version"], capture_output=True, text=True)
+    return result.stdout.splitlines()[0] if result.stdout else cc
+
+
+def print_kernel(name, kernel):
+    print(
+        "%-32s %14.1f ns/op %6d allocs/op %8d peak bytes"
+        % (name, kernel["ns_per_op"], kernel["allocs_per_op"], kernel["peak_bytes"])
+    )
+
+
+def load(path):
+    try:
+        with open(path) as file:
+            results = json.load(file)
+    except (OSError, ValueError) as error:
+        raise BenchError("can't read %s: %s" % (path, error))
+    if results.get("version") != 1 or "kernels" not in results:
+        raise BenchError("%s isn't a kernel_bench result" % path)
+    return results
+
+
+def compare(results, baseline, threshold, only=None):
+    """Print every kernel against the baseline and return the names of the regressions."""
+    flagged = []
+    for name, base in sorted(baseline["kernels"].items()):
+        if only and only not in name:
+            continue
+        new = results["kernels"].get(name)
+        if new is None:
+            print("%-32s missing from the results" % name)
+            continue
+        change = (new["ns_per_op"] / base["ns_per_op"] - 1) * 100 if base["ns_per_op"] else 0
+        problems = []
+        if change > threshold:
+            problems.append("%+.1f%% time" % change)
+        # The heap use is the same every run, so any growth is real.
+        if new["allocs_per_op"] > base["allocs_per_op"]:
+            problems.append("allocs %d -> %d" % (base["allocs_per_op"], new["allocs_per_op"]))
+        if new["peak_bytes"] > base["peak_bytes"]:
+            problems.append("peak %d -> %d bytes" % (base["peak_bytes"], new["peak_bytes"]))
+        print(
+            "%-32s %14.1f -> %14.1f ns/op %+7.1f%%  %s"
+            % (
+                name,
+                base["ns_per_op"],
+                new["ns_per_op"],
+                change,
+                "REGRESSION " + ", ".join(problems) if problems else "ok",
+            )
+        )
+        if problems:
+            flagged.append(name)
+    for name in sorted(set(results["kernels"]) - set(baseline["kernels"])):
+        print("%-32s new, not in the baseline" % name)
+    return flagged
+
+
+def write(results, path):
+    with open(path, "w") as file:
+        json.dump(results, file, indent=2, sort_keys=True)
+        file.write("\n")
+    print("wrote %s" % path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    def add_run_options(command_parser):
+        command_parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+        command_parser.add_argument(
+            "--scale", type=float, default=1.0, help="multiply every iteration count"
+        )
+        command_parser.add_argument(
+            "--repeat", type=int, default=5, help="time each kernel this often, keep the best"
+        )
+        command_parser.add_argument("--filter", help="only kernels whose name contains this")
+
+    run_parser = commands.add_parser("run", help="build and time the kernels")
+    add_run_options(run_parser)
+    run_parser.add_argument("--out", help="save the results as JSON")
+
+    compare_parser = commands.add_parser("compare", help="check results against the baseline")
+    add_run_options(compare_parser)
+    compare_parser.add_argument("--results", help="saved results, a fresh run if left out")
+    compare_parser.add_argument("--baseline", default=BASELINE)
+    compare_parser.add_argument(
+        "--threshold", type=float, default=10.0, help="percent slower that counts"
+    )
+
+    test_parser = commands.add_parser("test", help="build and run the host tests")
+    test_parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    test_parser.add_argument("--no-sanitize", action="store_true", help="build without ASan/UBSan")
+    test_parser.add_argument("--filter", help="only tests whose name contains this")
+
+    args = parser.parse_args()
+    try:
+        if args.command == "test":
+            return run_tests(args.cc, not args.no_sanitize, args.filter)
+        if args.command == "run":
+            results = run_kernels(args.cc, args.scale, args.repeat, args.filter)
+            if args.out:
+                write(results, args.out)
+            return 0
+
+        baseline = load(args.baseline)
+        if args.results:
+            results = load(args.results)
+        else:
+            results = run_kernels(args.cc, args.scale, args.repeat, args.filter)
+            print()
+        flagged = compare(results, baseline, args.threshold, args.filter)
+        if flagged:
+            print("\n%d regression(s): %s" % (len(flagged), ", ".join(flagged)))
+            return 1
+        print("\nno regressions")
+        return 0
+    except BenchError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,146 @@
+// Inputs shared by kernel_bench.c and kernel_tests.c.
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "base58.h"
+#include "kernel_fixtures.h"
+
+typedef struct {
+    char* out;
+    size_t size;
+    size_t length;
+    bool overflow;
+} KernelFixtureText;
+
+static void kernel_fixture_printf(KernelFixtureText* text, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t room = text->length < text->size ? text->size - text->length : 0;
+    int written = vsnprintf(text->out + text->length, room, format, args);
+    va_end(args);
+    if(written < 0 || (size_t)written >= room) {
+        text->overflow = true;
+        return;
+    }
+    text->length += written;
+}
+
+void kernel_fixture_bytes(uint32_t seed, uint8_t* data, size_t size) {
+    uint32_t x = seed * 2654435761u + 0x12345678;
+    for(size_t i = 0; i < size; i++) {
+        x = x * 1103515245 + 12345;
+        data[i] = x >> 16;
+    }
+}
+
+size_t kernel_fixture_signatures(char* out, size_t size, size_t count) {
+    KernelFixtureText text = {out, size, 0, false};
+    kernel_fixture_printf(&text, "{\"jsonrpc\":\"2.0\",\"result\":[");
+    for(size_t i = 0; i < count && !text.overflow; i++) {
+        uint8_t signature[64];
+        char encoded[96];
+        kernel_fixture_bytes(i, signature, sizeof(signature));
+        base58_encode(signature, sizeof(signature), encoded, sizeof(encoded));
+        kernel_fixture_printf(
+            &text,
+            "%s{\"blockTime\":%zu,\"confirmationStatus\":\"finalized\",\"err\":%s,\"memo\":%s,"
+            "\"signature\":\"%s\",\"slot\":%zu}",
+            i ? "," : "",
+            (size_t)1700000000 - i * 7,
+            i % 13 == 5 ? "{\"InstructionError\":[0,{\"Custom\":1}]}" : "null",
+            i % 9 == 2 ? "\"[12] order \\\"7\\\" \\u00e9t\\u00e9\"" : "null",
+            encoded,
+            (size_t)KERNEL_FIXTURE_SLOT + i);
+    }
+    kernel_fixture_printf(&text, "],\"id\":1}");
+    return text.overflow ? 0 : text.length;
+}
+
+size_t kernel_fixture_account(char* out, size_t size, const uint8_t* data, size_t data_size) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    KernelFixtureText text = {out, size, 0, false};
+    kernel_fixture_printf(
+        &text,
+        "{\"jsonrpc\":\"2.0\",\"result\":{\"context\":{\"apiVersion\":\"2.1.13\",\"slot\":%d},"
+        "\"value\":{\"data\":[\"",
+        KERNEL_FIXTURE_SLOT);
+    for(size_t i = 0; i < data_size && !text.overflow; i += 3) {
+        uint32_t group = (uint32_t)data[i] << 16;
+        group |= i + 1 < data_size ? (uint32_t)data[i + 1] << 8 : 0;
+        group |= i + 2 < data_size ? data[i + 2] : 0;
+        kernel_fixture_printf(
+            &text,
+            "%c%c%c%c",
+            alphabet[group >> 18],
+            alphabet[(group >> 12) & 63],
+            i + 1 < data_size ? alphabet[(group >> 6) & 63] : '=',
+            i + 2 < data_size ? alphabet[group & 63] : '=');
+    }
+    kernel_fixture_printf(
+        &text,
+        "\",\"base64\"],\"executable\":false,\"lamports\":%d,"
+        "\"owner\":\"TokenkegQfeZyiNwAJbNbGKPFXCWuBvf9Ss623VQ5DA\","
+        "\"rentEpoch\":18446744073709551615,\"space\":%zu}},\"id\":1}",
+        KERNEL_FIXTURE_LAMPORTS,
+        data_size);
+    return text.overflow ? 0 : text.length;
+}
+
+const char* const kernel_fixture_tasks[KERNEL_FIXTURE_TASKS] = {
+    "Buy milk",
+    "Call the plumber about the kitchen tap",
+    "Renew the car insurance",
+    "Email Sam the photos from Saturday",
+    "Water the plants",
+    "Return the library books",
+    "Fix the bike's back light",
+    "Pay the electricity bill",
+    "Café with Noor on Thursday",
+    "Book the ferry, the hotel and the tickets for the trip up to Sète in June",
+};
+
+size_t kernel_fixture_checklist(char* out, size_t size, KernelFixtureChecklist* counts) {
+    KernelFixtureText text = {out, size, 0, false};
+    counts->unticked = 0;
+    counts->ticked = 0;
+    for(size_t i = 0; !text.overflow; i++) {
+        size_t week = i / 8;
+        switch(i % 8) {
+        case 0:
+            kernel_fixture_printf(&text, "## Week %zu\n", week);
+            break;
+        case 1:
+            kernel_fixture_printf(
+                &text, "- [ ] %s\n", kernel_fixture_tasks[week % KERNEL_FIXTURE_TASKS]);
+            counts->unticked += !text.overflow;
+            break;
+        case 2:
+            kernel_fixture_printf(&text, "- [x] Done in week %zu\n", week);
+            counts->ticked += !text.overflow;
+            break;
+        case 3:
+            kernel_fixture_printf(&text, "Notes for week %zu, not a task at all.\n", week);
+            break;
+        case 4:
+            kernel_fixture_printf(
+                &text, "  * [ ] %s\r\n", kernel_fixture_tasks[(week + 3) % KERNEL_FIXTURE_TASKS]);
+            counts->unticked += !text.overflow;
+            break;
+        case 5:
+            kernel_fixture_printf(&text, "- [X] Also done in week %zu\r\n", week);
+            counts->ticked += !text.overflow;
+            break;
+        case 6:
+            kernel_fixture_printf(&text, "\n");
+            break;
+        case 7:
+            kernel_fixture_printf(
+                &text, "+ [ ] %s\n", kernel_fixture_tasks[(week + 7) % KERNEL_FIXTURE_TASKS]);
+            counts->unticked += !text.overflow;
+            break;
+        }
+    }
+    return text.length;
+}
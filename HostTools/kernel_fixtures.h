@@ -0,0 +1,54 @@
+// Inputs shared by kernel_bench.c and kernel_tests.c, built the same on every run so timings and
+// results can be compared between runs.
+
+#ifndef KERNEL_FIXTURES_H
+#define KERNEL_FIXTURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief      Fill data with the fixed pseudo random byte sequence of the given seed.
+*/
+void kernel_fixture_bytes(uint32_t seed, uint8_t* data, size_t size);
+
+/**
+ * @brief      Write a getSignaturesForAddress answer with count entries, shaped like a mainnet
+ *            capture: base58 signatures, slots, block times and the odd memo and error.
+ * @details    Entry i has slot KERNEL_FIXTURE_SLOT + i and the signature of
+ *            kernel_fixture_bytes(i, 64).
+ * @return     length of the text, without the NUL, or 0 if it did not fit in size.
+*/
+size_t kernel_fixture_signatures(char* out, size_t size, size_t count);
+
+#define KERNEL_FIXTURE_SLOT     283746512
+#define KERNEL_FIXTURE_LAMPORTS 2039280
+
+/**
+ * @brief      Write a getAccountInfo answer whose base64 account data holds data.
+ * @return     length of the text, without the NUL, or 0 if it did not fit in size.
+*/
+size_t kernel_fixture_account(char* out, size_t size, const uint8_t* data, size_t data_size);
+
+#define KERNEL_FIXTURE_TASKS 10
+
+/**
+ * The different unticked tasks in a checklist.  The last one is 74 bytes, too long for a task,
+ * and the cut after 63 bytes falls inside its "è".
+ */
+extern const char* const kernel_fixture_tasks[KERNEL_FIXTURE_TASKS];
+
+typedef struct {
+    size_t unticked; // Items from kernel_fixture_tasks, each many times
+    size_t ticked; // "- [x]" and "- [X]" items, all different
+} KernelFixtureChecklist;
+
+/**
+ * @brief      Write a Markdown checklist of as many whole lines as fit in size: headings, notes,
+ *            blank lines, ticked items and unticked items from kernel_fixture_tasks, with "-",
+ *            "*" and "+" bullets, indents and some "\r\n" line ends.  Not NUL terminated.
+ * @return     length of the text.
+*/
+size_t kernel_fixture_checklist(char* out, size_t size, KernelFixtureChecklist* counts);
+
+#endif // KERNEL_FIXTURES_H
@@ -0,0 +1,2252 @@
+// Host tests of the app modules, run by "kernel_bench.py test".  Each test prints one line, ok or
+// FAIL with the line that failed, and the exit status is the number of failed tests.  They are
+// built with AddressSanitizer unless --no-sanitize is given, so the fuzz tests also catch reads
+// and writes out of bounds.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <furi.h>
+#include <furi_hal.h>
+#include <gui/gui.h>
+#include <input/input.h>
+#include <notification/notification.h>
+#include <storage/storage.h>
+#include "base58.h"
+#include "ed25519.h"
+#include "energy.h"
+#include "entropy.h"
+#include "heatshrink.h"
+#include "kernel_fixtures.h"
+#include "qr_code.h"
+#include "sha256.h"
+#include "solana_json.h"
+#include "solana_keystore.h"
+#include "solana_pda.h"
+#include "solana_rpc.h"
+#include "solana_tx.h"
+#include "todo_markdown.h"
+#include "todo_sync.h"
+#include "todo_words.h"
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if(!(condition)) {                                             \
+            printf("  %s:%d: %s\n", __func__, __LINE__, #condition); \
+            return false;                                              \
+        }                                                              \
+    } while(0)
+
+static uint32_t tests_random_state = 1;
+
+// Small fixed generator, so every run of a test sees the same inputs
+static uint32_t tests_random(void) {
+    tests_random_state ^= tests_random_state << 13;
+    tests_random_state ^= tests_random_state >> 17;
+    tests_random_state ^= tests_random_state << 5;
+    return tests_random_state;
+}
+
+static void tests_random_fill(uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        data[i] = tests_random();
+    }
+}
+
+static void tests_hex(const char* hex, uint8_t* out) {
+    for(size_t i = 0; hex[2 * i]; i++) {
+        sscanf(hex + 2 * i, "%2hhx", &out[i]);
+    }
+}
+
+static double tests_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Transaction parser
+
+typedef struct {
+    SolanaTxHeader header;
+    SolanaTxError error; // SolanaTxErrorNone when the parser got to SolanaTxEventDone
+    size_t polls;
+    size_t events;
+    bool views_match; // Every view held the bytes at its offset in the input
+} TestsTxResult;
+
+/**
+ * @brief      Feed a transaction to the parser chunk bytes at a time (random sizes for 0) and
+ *            poll it until it is done or fails.
+*/
+static void tests_tx_parse(
+    const uint8_t* tx,
+    size_t size,
+    size_t ring_size,
+    size_t chunk,
+    TestsTxResult* result) {
+    uint8_t* ring = malloc(ring_size);
+    uint8_t view[SOLANA_TX_MAX_SIZE];
+    SolanaTxParser* parser = solana_tx_parser_alloc(ring, ring_size);
+    SolanaTxEvent event;
+    size_t written = 0;
+    bool finished = false;
+
+    memset(result, 0, sizeof(TestsTxResult));
+    result->views_match = true;
+    result->error = SolanaTxErrorTruncated;
+    while(true) {
+        if(!finished) {
+            size_t size_now = chunk ? chunk : 1 + tests_random() % 97;
+            if(size_now > size - written) {
+                size_now = size - written;
+            }
+            written += solana_tx_parser_write(parser, tx + written, size_now);
+            if(written == size) {
+                solana_tx_parser_finish(parser);
+                finished = true;
+            }
+        }
+        result->polls++;
+        if(!solana_tx_parser_poll(parser, &event)) {
+            if(finished) {
+                break;
+            }
+            continue;
+        }
+        result->events++;
+        if(event.view.length) {
+            solana_tx_parser_view_copy(parser, event.view, view);
+            if(event.view.offset + event.view.length > size ||
+               memcmp(view, tx + event.view.offset, event.view.length) != 0) {
+                result->views_match = false;
+            }
+        }
+        if(event.type == SolanaTxEventDone) {
+            result->error = SolanaTxErrorNone;
+            break;
+        }
+        if(event.type == SolanaTxEventError) {
+            result->error = solana_tx_parser_get_error(parser);
+            break;
+        }
+    }
+    result->header = *solana_tx_parser_get_header(parser);
+    solana_tx_parser_free(parser);
+    free(ring);
+}
+
+// A legacy transfer: 1 signature, 3 keys, a blockhash and one instruction.
+static size_t tests_tx_legacy(uint8_t* tx) {
+    static const uint8_t instruction[] = {
+        1, 2, 2, 0, 1, 12, 2, 0, 0, 0, 0x40, 0x42, 0x0f, 0, 0, 0, 0, 0};
+    size_t n = 0;
+    tx[n++] = 1;
+    memset(tx + n, 0xaa, 64);
+    n += 64;
+    tx[n++] = 1;
+    tx[n++] = 0;
+    tx[n++] = 1;
+    tx[n++] = 3;
+    for(int key = 0; key < 3; key++) {
+        memset(tx + n, key + 1, 32);
+        n += 32;
+    }
+    memset(tx + n, 0xbb, 32);
+    n += 32;
+    memcpy(tx + n, instruction, sizeof(instruction));
+    return n + sizeof(instruction);
+}
+
+// A version 0 message with 2 signers, an instruction and an address lookup table.
+static size_t tests_tx_v0(uint8_t* tx) {
+    size_t n = 0;
+    tx[n++] = 2;
+    memset(tx + n, 0xaa, 128);
+    n += 128;
+    tx[n++] = 0x80;
+    tx[n++] = 2;
+    tx[n++] = 0;
+    tx[n++] = 1;
+    tx[n++] = 3;
+    for(int key = 0; key < 3; key++) {
+        memset(tx + n, key + 1, 32);
+        n += 32;
+    }
+    memset(tx + n, 0xbb, 32);
+    n += 32;
+    static const uint8_t instruction[] = {1, 2, 3, 0, 1, 3, 4, 9, 8, 7, 6};
+    memcpy(tx + n, instruction, sizeof(instruction));
+    n += sizeof(instruction);
+    tx[n++] = 1;
+    memset(tx + n, 0xcc, 32);
+    n += 32;
+    static const uint8_t lookups[] = {2, 0, 1, 1, 2};
+    memcpy(tx + n, lookups, sizeof(lookups));
+    return n + sizeof(lookups);
+}
+
+static bool test_tx_valid(void) {
+    uint8_t tx[SOLANA_TX_MAX_SIZE];
+    TestsTxResult result;
+    size_t sizes[2] = {tests_tx_legacy(tx), 0};
+    uint8_t v0[SOLANA_TX_MAX_SIZE];
+    sizes[1] = tests_tx_v0(v0);
+
+    for(int n = 0; n < 2; n++) {
+        const uint8_t* data = n ? v0 : tx;
+        for(size_t ring = SOLANA_TX_RING_MIN_SIZE; ring <= 1024; ring *= 2) {
+            for(size_t chunk = 0; chunk < 40; chunk += 3) {
+                tests_tx_parse(data, sizes[n], ring, chunk, &result);
+                CHECK(result.error == SolanaTxErrorNone);
+                CHECK(result.views_match);
+                CHECK(result.header.versioned == (n == 1));
+                CHECK(result.header.message_offset == 1 + 64 * (n + 1));
+                CHECK(result.header.message_offset + result.header.message_length == sizes[n]);
+            }
+        }
+    }
+    return true;
+}
+
+static bool test_tx_malformed(void) {
+    uint8_t tx[SOLANA_TX_MAX_SIZE + 1];
+    TestsTxResult result;
+    size_t size = tests_tx_legacy(tx);
+
+    // Every prefix is truncated, one byte more is trailing data.
+    for(size_t n = 0; n < size; n++) {
+        tests_tx_parse(tx, n, 64, 5, &result);
+        CHECK(result.error == SolanaTxErrorTruncated);
+    }
+    tx[size] = 0;
+    tests_tx_parse(tx, size + 1, 64, 7, &result);
+    CHECK(result.error == SolanaTxErrorTrailingData);
+
+    // The instruction's program id index points past the 3 keys.
+    tx[size - 17] = 3;
+    tests_tx_parse(tx, size, 64, 7, &result);
+    CHECK(result.error == SolanaTxErrorIndex);
+
+    // An overlong compact-u16 for the signature count
+    tx[0] = 0x81;
+    tx[1] = 0x00;
+    tests_tx_parse(tx, size, 64, 7, &result);
+    CHECK(result.error == SolanaTxErrorCompactU16);
+
+    memset(tx, 0, sizeof(tx));
+    tests_tx_parse(tx, sizeof(tx), 64, 100, &result);
+    CHECK(result.error != SolanaTxErrorNone);
+    return true;
+}
+
+// Random inputs and bit flipped transactions must end in Done or Error after a number of polls
+// proportional to their size, and every view must point at the input.
+static bool test_tx_fuzz(void) {
+    uint8_t valid[2][SOLANA_TX_MAX_SIZE];
+    size_t valid_size[2] = {tests_tx_legacy(valid[0]), tests_tx_v0(valid[1])};
+    uint8_t tx[SOLANA_TX_MAX_SIZE + 64];
+    TestsTxResult result;
+    size_t parsed = 0, rejected = 0, bytes = 0, most_polls = 0;
+
+    double start = tests_now();
+    for(int i = 0; i < 100000; i++) {
+        size_t size;
+        if(tests_random() % 2) {
+            const int n = tests_random() % 2;
+            size = valid_size[n];
+            memcpy(tx, valid[n], size);
+            for(uint32_t flips = 1 + tests_random() % 4; flips; flips--) {
+                tx[tests_random() % size] ^= 1 << (tests_random() % 8);
+            }
+        } else {
+            size = tests_random() % sizeof(tx);
+            for(size_t n = 0; n < size; n++) {
+                tx[n] = tests_random();
+            }
+            // Mostly small counts, or nearly every input would be rejected at the first byte.
+            if(size) {
+                tx[0] &= 3;
+            }
+        }
+        tests_tx_parse(tx, size, SOLANA_TX_RING_MIN_SIZE << (tests_random() % 4), 0, &result);
+        CHECK(result.views_match);
+        CHECK(result.polls <= 2 * size + 16);
+        if(result.polls > most_polls) {
+            most_polls = result.polls;
+        }
+        result.error == SolanaTxErrorNone ? parsed++ : rejected++;
+        bytes += size;
+    }
+    double seconds = tests_now() - start;
+    printf(
+        "  %zu parsed, %zu rejected, most polls %zu, %.1f MB/s with random chunks\n",
+        parsed,
+        rejected,
+        most_polls,
+        bytes / seconds / 1e6);
+    CHECK(parsed > 0 && rejected > 0);
+    return true;
+}
+
+// Ed25519 signing
+
+typedef struct {
+    const char* seed;
+    const char* public_key;
+    const char* message;
+    const char* signature;
+} TestsEd25519Vector;
+
+// RFC 8032 section 7.1, tests 1 to 3
+static const TestsEd25519Vector tests_ed25519_vectors[] = {
+    {"9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+     "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+     "",
+     "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701c"
+     "f9b46bd25bf5f0595bbe24655141438e7a100b"},
+    {"4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+     "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+     "72",
+     "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0"
+     "f11d8c387b2eaeb4302aeeb00d291612bb0c00"},
+    {"c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+     "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+     "af82",
+     "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac18ff9b538d16f290ae67f76098"
+     "4dc6594a7c15e9716ed28dc027beceea1ec40a"},
+};
+
+static bool test_ed25519_vectors(void) {
+    for(size_t i = 0; i < sizeof(tests_ed25519_vectors) / sizeof(tests_ed25519_vectors[0]); i++) {
+        const TestsEd25519Vector* vector = &tests_ed25519_vectors[i];
+        uint8_t seed[32], public_key[32], message[8], signature[64];
+        uint8_t derived[32], signed_now[64];
+        size_t size = strlen(vector->message) / 2;
+        tests_hex(vector->seed, seed);
+        tests_hex(vector->public_key, public_key);
+        tests_hex(vector->message, message);
+        tests_hex(vector->signature, signature);
+
+        ed25519_public_key(seed, derived);
+        CHECK(memcmp(derived, public_key, 32) == 0);
+        ed25519_sign(message, size, seed, signed_now);
+        CHECK(memcmp(signed_now, signature, 64) == 0);
+        CHECK(ed25519_verify(message, size, public_key, signature));
+        signature[10] ^= 1;
+        CHECK(!ed25519_verify(message, size, public_key, signature));
+    }
+    return true;
+}
+
+/**
+ * @brief      Stream message through both passes in random chunks.
+ * @param      second  What the second pass sends, normally message itself.
+*/
+static bool tests_ed25519_stream(
+    const uint8_t* message,
+    size_t size,
+    const uint8_t* second,
+    size_t second_size,
+    const uint8_t seed[32],
+    uint8_t signature[64]) {
+    Ed25519SignStream stream;
+    ed25519_sign_stream_init(&stream, seed);
+    for(size_t i = 0; i < size;) {
+        size_t chunk = 1 + tests_random() % 300;
+        chunk = chunk < size - i ? chunk : size - i;
+        ed25519_sign_stream_update(&stream, message + i, chunk);
+        i += chunk;
+    }
+    ed25519_sign_stream_next_pass(&stream);
+    for(size_t i = 0; i < second_size;) {
+        size_t chunk = 1 + tests_random() % 300;
+        chunk = chunk < second_size - i ? chunk : second_size - i;
+        ed25519_sign_stream_update(&stream, second + i, chunk);
+        i += chunk;
+    }
+    return ed25519_sign_stream_final(&stream, signature);
+}
+
+// The streamed signer must give the one-shot signature byte for byte, whatever the chunking.
+static bool test_ed25519_stream(void) {
+    static uint8_t message[4096];
+    uint8_t seed[32], public_key[32], one_shot[64], streamed[64];
+
+    for(int i = 0; i < 100; i++) {
+        size_t size = i < 4 ? (size_t)i : tests_random() % sizeof(message);
+        tests_random_fill(seed, sizeof(seed));
+        tests_random_fill(message, size);
+        ed25519_public_key(seed, public_key);
+        ed25519_sign(message, size, seed, one_shot);
+        CHECK(tests_ed25519_stream(message, size, message, size, seed, streamed));
+        CHECK(memcmp(one_shot, streamed, 64) == 0);
+        CHECK(ed25519_verify(message, size, public_key, streamed));
+    }
+    return true;
+}
+
+// A second pass that differs in any way must not release a signature.
+static bool test_ed25519_stream_mismatch(void) {
+    static uint8_t message[1000], changed[1001];
+    uint8_t seed[32], signature[64];
+    const uint8_t zero[64] = {0};
+    tests_random_fill(seed, sizeof(seed));
+    tests_random_fill(message, sizeof(message));
+
+    memcpy(changed, message, sizeof(message));
+    changed[500] ^= 0x20;
+    CHECK(!tests_ed25519_stream(message, 1000, changed, 1000, seed, signature));
+    CHECK(memcmp(signature, zero, 64) == 0);
+
+    memcpy(changed, message, sizeof(message));
+    CHECK(!tests_ed25519_stream(message, 1000, changed, 999, seed, signature));
+    changed[1000] = 0;
+    CHECK(!tests_ed25519_stream(message, 1000, changed, 1001, seed, signature));
+    CHECK(tests_ed25519_stream(message, 1000, changed, 1000, seed, signature));
+    return true;
+}
+
+// Ed25519 verification of many signatures
+
+typedef struct {
+    const char* public_key;
+    const char* message;
+    const char* signature;
+    bool valid;
+} TestsEd25519Strict;
+
+static const TestsEd25519Strict tests_ed25519_strict[] = {
+    // R is r B plus a point of order 8, and S was made for the challenge over that R.  S B - k A
+    // is R minus that point, so it passes a batch equation multiplied by the cofactor, but
+    // verify_strict rejects it.
+    {"03a107bff3ce10be1d70dd18e74bc09967e4d6309ba50d5f1ddc8664125531b8",
+     "Transfer 1 SOL, R with a small order part added",
+     "df3c5ba13ec2d0085f2345aa55e1b50adfde49ab07e38fe375fd815edc89a684f1edf22f2cdbcfc0734527776b"
+     "c5713122977239490f10e8fd69fec112a80106",
+     false},
+    // The public key has a part of order 8, and the message was picked so k is a multiple of 8,
+    // so S B - k A is R exactly and verify_strict accepts it.
+    {"2144432c47d6e1014b97775a774d49204d42afe004ebb2186bdeb23f5f117dfd",
+     "Mixed order key 19",
+     "90267cbaec94b7000008fa89a95769db6e1c126553ddf54a003edd10adb88e3cc45da5b60e7d1c988e66f57a36"
+     "b0bd3345dad72188ece745039a498a81fad900",
+     true},
+};
+
+#define TESTS_BATCH_MAX 40
+
+// The group order, to make S non-canonical
+static const uint8_t tests_ed25519_l[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde,
+    0x14, 0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0x10};
+
+// ed25519_verify_batch() must give every signature the answer ed25519_verify() gives it.
+static bool test_ed25519_batch(void) {
+    static uint8_t messages[TESTS_BATCH_MAX][100], signatures[TESTS_BATCH_MAX][64];
+    uint8_t seeds[3][32], keys[4][32] = {{0}}, strict_keys[2][32], strict_signatures[2][64];
+    Ed25519VerifyItem items[TESTS_BATCH_MAX];
+    bool valid[TESTS_BATCH_MAX];
+    size_t accepted = 0, rejected = 0;
+
+    for(size_t i = 0; i < 2; i++) {
+        const TestsEd25519Strict* vector = &tests_ed25519_strict[i];
+        tests_hex(vector->public_key, strict_keys[i]);
+        tests_hex(vector->signature, strict_signatures[i]);
+        items[i] = (Ed25519VerifyItem){
+            (const uint8_t*)vector->message,
+            strlen(vector->message),
+            strict_keys[i],
+            strict_signatures[i]};
+        bool expected =
+            ed25519_verify(items[i].message, items[i].size, strict_keys[i], strict_signatures[i]);
+        CHECK(expected == vector->valid);
+    }
+    CHECK(!ed25519_verify_batch(items, 2, valid));
+    CHECK(!valid[0] && valid[1]);
+
+    for(size_t i = 0; i < 3; i++) {
+        tests_random_fill(seeds[i], 32);
+        ed25519_public_key(seeds[i], keys[i]);
+    }
+    keys[3][0] = 1; // The identity, of small order
+
+    for(int round = 0; round < 40; round++) {
+        size_t count = 1 + tests_random() % TESTS_BATCH_MAX;
+        for(size_t i = 0; i < count; i++) {
+            size_t key = tests_random() % 3, size = tests_random() % sizeof(messages[i]);
+            tests_random_fill(messages[i], size);
+            ed25519_sign(messages[i], size, seeds[key], signatures[i]);
+            items[i] = (Ed25519VerifyItem){messages[i], size, keys[key], signatures[i]};
+
+            switch(tests_random() % 12) {
+            case 0:
+                signatures[i][tests_random() % 32] ^= 1 << (tests_random() % 8);
+                break;
+            case 1:
+                signatures[i][32 + tests_random() % 31] ^= 1 << (tests_random() % 8);
+                break;
+            case 2:
+                for(int b = 0, carry = 0; b < 32; b++) {
+                    carry += signatures[i][32 + b] + tests_ed25519_l[b];
+                    signatures[i][32 + b] = carry;
+                    carry >>= 8;
+                }
+                break;
+            case 3:
+                if(size) {
+                    messages[i][tests_random() % size] ^= 1 << (tests_random() % 8);
+                } else {
+                    items[i].size = 1;
+                }
+                break;
+            case 4:
+                items[i].public_key = keys[3];
+                break;
+            case 5:
+            case 6: {
+                size_t v = tests_random() % 2;
+                size_t length = strlen(tests_ed25519_strict[v].message);
+                memcpy(messages[i], tests_ed25519_strict[v].message, length);
+                memcpy(signatures[i], strict_signatures[v], 64);
+                items[i] = (Ed25519VerifyItem){messages[i], length, strict_keys[v], signatures[i]};
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        bool all = ed25519_verify_batch(items, count, valid);
+        bool expected_all = true;
+        for(size_t i = 0; i < count; i++) {
+            const Ed25519VerifyItem* item = &items[i];
+            bool expected =
+                ed25519_verify(item->message, item->size, item->public_key, item->signature);
+            CHECK(valid[i] == expected);
+            expected_all = expected_all && expected;
+            accepted += expected;
+            rejected += !expected;
+        }
+        CHECK(all == expected_all);
+    }
+    printf("  %zu accepted and %zu rejected, the same as one at a time\n", accepted, rejected);
+    CHECK(accepted > 100 && rejected > 100);
+    return true;
+}
+
+// Program derived addresses
+
+typedef struct {
+    unsigned index; // owner is SHA-256("owner <index>"), mint SHA-256("mint <index>")
+    const char* address;
+    uint8_t bump;
+} TestsPdaTokenAccount;
+
+// Token program accounts, from a separate derivation that takes a square root per try
+static const TestsPdaTokenAccount tests_pda_token_accounts[] = {
+    {0, "d71f6435a940181cf1f31974f79fceb7f80a87ec0c7e2a43b0d342c733f8c98a", 254},
+    {1, "1513fde29a158e929321e7a2e416993cb021e7e869ec461f801cf1bc56727146", 255},
+    {3, "5fc018a60e012f860ff08c0c2f3fbcdde9a2d773f64595ecc8300c872ad1af66", 252},
+    {4, "2938c43d3a82e1c3560f3abdad14e3211cdee2a7d6b97421333d2a8c3244520d", 253},
+};
+
+// Seed j of n is (j*11 + n) % 33 bytes j, j + 1, ..., under the Token program id
+static const TestsPdaTokenAccount tests_pda_seeds[] = {
+    {0, "110de42d0edb466de8cf925d7d2c132d88f3a0214029351a85895caaa5b752f2", 255},
+    {1, "81cf38702c7dc3621fdca655f1a225a04501dfb9be195c8cd693c36532794495", 255},
+    {2, "0be974385bd0b2e1bd7dc7126afd81b31e00a23a32627edad9bb2915eb73fda1", 253},
+    {5, "9615e81c212f1709fb306d744cc175db285f3a755b12ec160693b805925f9b8b", 255},
+    {15, "b2cc0c271fad58fd303ea55808141202f34bdee2e069fcf061ca25425c5c81ce", 255},
+};
+
+static void tests_pda_keys(unsigned index, uint8_t owner[32], uint8_t mint[32]) {
+    char text[32];
+    snprintf(text, sizeof(text), "owner %u", index);
+    sha256((const uint8_t*)text, strlen(text), owner);
+    snprintf(text, sizeof(text), "mint %u", index);
+    sha256((const uint8_t*)text, strlen(text), mint);
+}
+
+// Token accounts whose first few bumps land on the curve, and Token-2022.
+static bool test_pda_token_account(void) {
+    uint8_t owner[32], mint[32], expected[32], address[32], bump;
+    for(size_t i = 0; i < sizeof(tests_pda_token_accounts) / sizeof(tests_pda_token_accounts[0]);
+        i++) {
+        const TestsPdaTokenAccount* vector = &tests_pda_token_accounts[i];
+        tests_pda_keys(vector->index, owner, mint);
+        tests_hex(vector->address, expected);
+        CHECK(solana_pda_find_token_account(
+            owner, mint, solana_pda_token_program, address, &bump));
+        CHECK(memcmp(address, expected, 32) == 0);
+        CHECK(bump == vector->bump);
+    }
+    tests_pda_keys(0, owner, mint);
+    tests_hex("b6e4fd0a8e7783e9dca895b0076a70374bd6003af102af9aa3fc17b1b1838acf", expected);
+    CHECK(solana_pda_find_token_account(
+        owner, mint, solana_pda_token_2022_program, address, &bump));
+    CHECK(memcmp(address, expected, 32) == 0);
+    CHECK(bump == 255);
+    return true;
+}
+
+// Any number and size of seeds, so the midstate starts anywhere in a block, and the bounds.
+static bool test_pda_seeds(void) {
+    uint8_t data[SOLANA_PDA_MAX_SEEDS + 1][SOLANA_PDA_MAX_SEED_SIZE + 1];
+    const uint8_t* seeds[SOLANA_PDA_MAX_SEEDS + 1];
+    size_t sizes[SOLANA_PDA_MAX_SEEDS + 1];
+    uint8_t expected[32], address[32], bump;
+    for(size_t i = 0; i < sizeof(tests_pda_seeds) / sizeof(tests_pda_seeds[0]); i++) {
+        size_t count = tests_pda_seeds[i].index;
+        for(size_t j = 0; j < count; j++) {
+            sizes[j] = (j * 11 + count) % 33;
+            for(size_t k = 0; k < sizes[j]; k++) {
+                data[j][k] = j + k;
+            }
+            seeds[j] = data[j];
+        }
+        tests_hex(tests_pda_seeds[i].address, expected);
+        CHECK(solana_pda_find(seeds, sizes, count, solana_pda_token_program, address, &bump));
+        CHECK(memcmp(address, expected, 32) == 0);
+        CHECK(bump == tests_pda_seeds[i].bump);
+    }
+    for(size_t j = 0; j <= SOLANA_PDA_MAX_SEEDS; j++) {
+        seeds[j] = data[j];
+        sizes[j] = 1;
+    }
+    CHECK(!solana_pda_find(
+        seeds, sizes, SOLANA_PDA_MAX_SEEDS + 1, solana_pda_token_program, address, &bump));
+    sizes[0] = SOLANA_PDA_MAX_SEED_SIZE + 1;
+    CHECK(!solana_pda_find(seeds, sizes, 1, solana_pda_token_program, address, &bump));
+    return true;
+}
+
+// Streaming JSON
+
+typedef struct {
+    char value[8192]; // Current string, put back together from partial events
+    size_t length;
+    size_t values; // Complete values seen
+    size_t seen[3]; // Complete values seen per selector, the entry the next one belongs to
+    bool ok; // Every value so far was the expected one
+    const uint8_t* account; // Expected account data
+    size_t account_size;
+} TestsJsonResult;
+
+static void tests_json_signatures_callback(const SolanaJsonEvent* event, void* context) {
+    TestsJsonResult* result = context;
+    if(result->length + event->length >= sizeof(result->value)) {
+        result->ok = false;
+        return;
+    }
+    memcpy(result->value + result->length, event->value, event->length);
+    result->length += event->length;
+    result->value[result->length] = '\0';
+    if(event->partial) {
+        return;
+    }
+
+    size_t entry = result->seen[event->selector]++;
+    if(event->selector == 0) {
+        uint8_t signature[64], expected[64];
+        kernel_fixture_bytes(entry, expected, sizeof(expected));
+        result->ok &= event->type == SolanaJsonEventString &&
+                      base58_decode(result->value, signature, sizeof(signature)) &&
+                      memcmp(signature, expected, sizeof(signature)) == 0;
+    } else if(event->selector == 1) {
+        result->ok &= event->type == SolanaJsonEventNumber &&
+                      strtoull(result->value, NULL, 10) == KERNEL_FIXTURE_SLOT + entry;
+    } else {
+        static const char memo[] = "[12] order \"7\" \xc3\xa9t\xc3\xa9";
+        if(event->type == SolanaJsonEventString) {
+            result->ok &= entry % 9 == 2 && result->length == strlen(memo) &&
+                          memcmp(result->value, memo, result->length) == 0;
+        } else {
+            result->ok &= event->type == SolanaJsonEventNull && entry % 9 != 2;
+        }
+    }
+    result->values++;
+    result->length = 0;
+}
+
+static const uint8_t tests_base64[256] = {
+    ['A'] = 0,  ['B'] = 1,  ['C'] = 2,  ['D'] = 3,  ['E'] = 4,  ['F'] = 5,  ['G'] = 6,
+    ['H'] = 7,  ['I'] = 8,  ['J'] = 9,  ['K'] = 10, ['L'] = 11, ['M'] = 12, ['N'] = 13,
+    ['O'] = 14, ['P'] = 15, ['Q'] = 16, ['R'] = 17, ['S'] = 18, ['T'] = 19, ['U'] = 20,
+    ['V'] = 21, ['W'] = 22, ['X'] = 23, ['Y'] = 24, ['Z'] = 25, ['a'] = 26, ['b'] = 27,
+    ['c'] = 28, ['d'] = 29, ['e'] = 30, ['f'] = 31, ['g'] = 32, ['h'] = 33, ['i'] = 34,
+    ['j'] = 35, ['k'] = 36, ['l'] = 37, ['m'] = 38, ['n'] = 39, ['o'] = 40, ['p'] = 41,
+    ['q'] = 42, ['r'] = 43, ['s'] = 44, ['t'] = 45, ['u'] = 46, ['v'] = 47, ['w'] = 48,
+    ['x'] = 49, ['y'] = 50, ['z'] = 51, ['0'] = 52, ['1'] = 53, ['2'] = 54, ['3'] = 55,
+    ['4'] = 56, ['5'] = 57, ['6'] = 58, ['7'] = 59, ['8'] = 60, ['9'] = 61, ['+'] = 62,
+    ['/'] = 63,
+};
+
+// The account data arrives as base64 in pieces of any size; decode it as it comes.
+static void tests_json_account_callback(const SolanaJsonEvent* event, void* context) {
+    TestsJsonResult* result = context;
+    if(event->selector == 0) {
+        result->ok &= event->type == SolanaJsonEventNumber && event->length == 7 &&
+                      memcmp(event->value, "2039280", 7) == 0;
+        result->values++;
+        return;
+    }
+    result->ok &= event->type == SolanaJsonEventString;
+    for(size_t i = 0; i < event->length; i++) {
+        result->value[result->length++] = event->value[i];
+        if(result->length < 4) {
+            continue;
+        }
+        uint8_t bytes[3];
+        uint32_t group = 0;
+        for(size_t j = 0; j < 4; j++) {
+            group = group << 6 | tests_base64[(uint8_t)result->value[j]];
+        }
+        bytes[0] = group >> 16;
+        bytes[1] = group >> 8;
+        bytes[2] = group;
+        size_t count = result->value[3] != '=' ? 3 : result->value[2] != '=' ? 2 : 1;
+        size_t offset = result->values * 3;
+        result->ok &= offset + count <= result->account_size &&
+                      memcmp(bytes, result->account + offset, count) == 0;
+        result->values++;
+        result->length = 0;
+    }
+}
+
+static SolanaJsonStatus tests_json_feed(SolanaJson* json, const char* text, size_t size) {
+    SolanaJsonStatus status = SolanaJsonStatusMore;
+    for(size_t i = 0; i < size && status == SolanaJsonStatusMore;) {
+        size_t chunk = 1 + tests_random() % 600;
+        chunk = chunk < size - i ? chunk : size - i;
+        status = solana_json_feed(json, text + i, chunk);
+        i += chunk;
+    }
+    return status == SolanaJsonStatusMore ? solana_json_finish(json) : status;
+}
+
+// Every selected value of a getSignaturesForAddress answer, from 0 to 1000 entries, comes out
+// right whatever the chunking, and the state is the same fixed struct for any size.
+static bool test_json_signatures(void) {
+    static const char* const selectors[] = {
+        "result.*.signature", "result.*.slot", "result.*.memo"};
+    static char text[256 * 1024];
+    static TestsJsonResult result;
+    const size_t counts[] = {0, 1, 17, 1000};
+    size_t bytes = 0;
+
+    for(size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        size_t size = kernel_fixture_signatures(text, sizeof(text), counts[c]);
+        CHECK(size > 0);
+        for(int pass = 0; pass < 4; pass++) {
+            SolanaJson json;
+            memset(&result, 0, sizeof(result));
+            result.ok = true;
+            solana_json_init(&json, selectors, 3, tests_json_signatures_callback, &result);
+            CHECK(tests_json_feed(&json, text, size) == SolanaJsonStatusDone);
+            CHECK(result.ok);
+            CHECK(result.values == 3 * counts[c]);
+            bytes += size;
+        }
+    }
+    printf("  %zu bytes parsed with a %zu byte state\n", bytes, sizeof(SolanaJson));
+    return true;
+}
+
+// 64 KB of base64 account data comes out in pieces that decode to the original bytes.
+static bool test_json_account(void) {
+    static const char* const selectors[] = {"result.value.lamports", "result.value.data.0"};
+    static uint8_t account[64 * 1024 + 1];
+    static char text[96 * 1024];
+    static TestsJsonResult result;
+
+    for(size_t account_size = sizeof(account) - 2; account_size <= sizeof(account);
+        account_size++) {
+        kernel_fixture_bytes(7, account, account_size);
+        size_t size = kernel_fixture_account(text, sizeof(text), account, account_size);
+        CHECK(size > 0);
+
+        SolanaJson json;
+        memset(&result, 0, sizeof(result));
+        result.ok = true;
+        result.account = account;
+        result.account_size = account_size;
+        solana_json_init(&json, selectors, 2, tests_json_account_callback, &result);
+        CHECK(tests_json_feed(&json, text, size) == SolanaJsonStatusDone);
+        CHECK(result.ok);
+        // One value for the lamports, one per base64 group
+        CHECK(result.values == 1 + (account_size + 2) / 3);
+        CHECK(result.length == 0);
+    }
+    return true;
+}
+
+// A response cut off anywhere is reported as truncated, never as done.
+static bool test_json_truncated(void) {
+    static const char* const selectors[] = {"result.*.signature"};
+    static char text[4096];
+    static TestsJsonResult result;
+    size_t size = kernel_fixture_signatures(text, sizeof(text), 10);
+    CHECK(size > 0);
+
+    for(size_t cut = 0; cut < size; cut++) {
+        SolanaJson json;
+        memset(&result, 0, sizeof(result));
+        result.ok = true;
+        solana_json_init(&json, selectors, 1, tests_json_signatures_callback, &result);
+        CHECK(tests_json_feed(&json, text, cut) == SolanaJsonStatusError);
+        CHECK(solana_json_get_error(&json) == SolanaJsonErrorTruncated);
+        CHECK(result.ok);
+    }
+    return true;
+}
+
+// RPC client over the link, to esp32_link_emulator.py and mock_rpc_server.py
+
+typedef struct {
+    bool done;
+    SolanaRpcStatus status;
+    char result[512];
+} TestsRpcAnswer;
+
+typedef struct {
+    unsigned http, batches, calls;
+} TestsRpcStats;
+
+static void tests_rpc_callback(
+    SolanaRpcStatus status,
+    const char* result,
+    size_t length,
+    void* context) {
+    TestsRpcAnswer* answer = context;
+    answer->status = status;
+    length = MIN(length, sizeof(answer->result) - 1);
+    if(length) {
+        memcpy(answer->result, result, length);
+    }
+    answer->result[length] = '\0';
+    __atomic_store_n(&answer->done, true, __ATOMIC_RELEASE);
+}
+
+// Up to 5s for the answer, which must be a result
+static bool tests_rpc_wait(TestsRpcAnswer* answer) {
+    for(int i = 0; i < 1000 && !__atomic_load_n(&answer->done, __ATOMIC_ACQUIRE); i++) {
+        furi_delay_ms(5);
+    }
+    return __atomic_load_n(&answer->done, __ATOMIC_ACQUIRE) &&
+           answer->status == SolanaRpcStatusOk;
+}
+
+// What the mock node has seen so far, this query included
+static bool tests_rpc_stats(SolanaRpc* rpc, TestsRpcStats* stats) {
+    TestsRpcAnswer answer = {0};
+    return solana_rpc_query(rpc, "getMockStats", NULL, 0, tests_rpc_callback, &answer) ==
+               SolanaRpcQueryPending &&
+           tests_rpc_wait(&answer) &&
+           sscanf(
+               answer.result,
+               "{\"http\":%u,\"batches\":%u,\"calls\":%u}",
+               &stats->http,
+               &stats->batches,
+               &stats->calls) == 3;
+}
+
+// The mock node's balance of an address is the first 4 bytes of its SHA-256, little endian.
+static bool tests_rpc_balance(const TestsRpcAnswer* answer, const char* address) {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256((const uint8_t*)address, strlen(address), digest);
+    uint32_t lamports = digest[0] | digest[1] << 8 | digest[2] << 16 | (uint32_t)digest[3] << 24;
+    const char* value = strstr(answer->result, "\"value\":");
+    return value && strtoul(value + 8, NULL, 10) == lamports;
+}
+
+// Queries in one window go out as one batch, an identical one shares the answer in flight, and
+// results are served from the cache until their method's TTL runs out.  The link, its frames and
+// the RPC client are the app's own code, only the USART is a pty.
+static bool test_rpc_link(void) {
+    static const char* const addresses[] = {
+        "4Nd1mBQtrMJVYVfKf2PJy9NZUZdTAsp7D4xWLs4gDB4T",
+        "Ff4XPFVHdxTe1rgiYs2NqpwZGMbE5ch8tDafBf4bNU4e",
+    };
+    SolanaLink* link = solana_link_alloc(NULL, NULL);
+    SolanaRpc* rpc = solana_rpc_alloc(link);
+    TestsRpcAnswer answers[4] = {0}, cached = {0}, fresh = {0};
+    TestsRpcStats before, after;
+
+    CHECK(tests_rpc_stats(rpc, &before));
+    CHECK(solana_rpc_get_balance(rpc, addresses[0], tests_rpc_callback, &answers[0]) ==
+          SolanaRpcQueryPending);
+    CHECK(solana_rpc_get_balance(rpc, addresses[1], tests_rpc_callback, &answers[1]) ==
+          SolanaRpcQueryPending);
+    CHECK(solana_rpc_get_latest_blockhash(rpc, tests_rpc_callback, &answers[2]) ==
+          SolanaRpcQueryPending);
+    CHECK(solana_rpc_get_balance(rpc, addresses[0], tests_rpc_callback, &answers[3]) ==
+          SolanaRpcQueryPending);
+    for(size_t i = 0; i < COUNT_OF(answers); i++) {
+        CHECK(tests_rpc_wait(&answers[i]));
+    }
+    CHECK(tests_rpc_balance(&answers[0], addresses[0]));
+    CHECK(tests_rpc_balance(&answers[1], addresses[1]));
+    CHECK(strstr(answers[2].result, "\"blockhash\":") != NULL);
+    CHECK(strcmp(answers[3].result, answers[0].result) == 0);
+    // One batch of the three different calls, then the stats query
+    CHECK(tests_rpc_stats(rpc, &after));
+    CHECK(after.http - before.http == 2 && after.batches - before.batches == 1);
+    CHECK(after.calls - before.calls == 4);
+
+    // Balances are kept for 10s and the blockhash for 30s.
+    CHECK(solana_rpc_get_balance(rpc, addresses[0], tests_rpc_callback, &cached) ==
+          SolanaRpcQueryCached);
+    CHECK(cached.done && strcmp(cached.result, answers[0].result) == 0);
+    host_furi_advance_ticks(SOLANA_RPC_TTL_BALANCE);
+    CHECK(solana_rpc_get_latest_blockhash(rpc, tests_rpc_callback, &cached) ==
+          SolanaRpcQueryCached);
+    CHECK(solana_rpc_get_balance(rpc, addresses[0], tests_rpc_callback, &fresh) ==
+          SolanaRpcQueryPending);
+    CHECK(tests_rpc_wait(&fresh) && tests_rpc_balance(&fresh, addresses[0]));
+    CHECK(tests_rpc_stats(rpc, &before));
+    CHECK(before.http - after.http == 2 && before.calls - after.calls == 2);
+
+    // Nothing cached after an invalidate
+    solana_rpc_invalidate(rpc);
+    memset(&fresh, 0, sizeof(fresh));
+    CHECK(solana_rpc_get_latest_blockhash(rpc, tests_rpc_callback, &fresh) ==
+          SolanaRpcQueryPending);
+    CHECK(tests_rpc_wait(&fresh));
+
+    solana_rpc_free(rpc);
+    solana_link_free(link);
+    return true;
+}
+
+// QR encoder
+
+static void tests_qr_text(char* text, size_t length) {
+    static const char* const alphabets[] = {
+        "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz", // base58
+        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:", // alphanumeric mode
+        "abcdefghijklmnopqrstuvwxyz0123456789:/?=&.%~-_", // payment links
+    };
+    const char* alphabet = alphabets[tests_random() % 3];
+    size_t size = strlen(alphabet);
+    for(size_t i = 0; i < length; i++) {
+        text[i] = alphabet[tests_random() % size];
+    }
+    text[length] = '\0';
+}
+
+/**
+ * Every code must render to exactly its modules at each scale.  The codes are also written to
+ * qr_codes.txt in HOST_FURI_ROOT, text in hex then one line per module row, for kernel_bench.py
+ * to read back with the independent decoder in qr_decode.py.
+*/
+static bool test_qr_encode(void) {
+    static QrCode qr;
+    static uint8_t bitmap[QR_CODE_BITMAP_SIZE(2)];
+    char text[128], path[512];
+    const char* root = getenv("HOST_FURI_ROOT");
+    snprintf(path, sizeof(path), "%s/qr_codes.txt", root ? root : ".");
+    FILE* out = fopen(path, "w");
+    CHECK(out);
+
+    size_t encoded = 0;
+    for(int i = 0; i < 400; i++) {
+        if(i < 100) {
+            // Wallet addresses, what the app actually shows
+            uint8_t key[32];
+            tests_random_fill(key, sizeof(key));
+            CHECK(base58_encode(key, sizeof(key), text, sizeof(text)));
+        } else {
+            tests_qr_text(text, tests_random() % 90);
+        }
+        QrCodeEcc ecc = tests_random() % 2 ? QrCodeEccMedium : QrCodeEccLow;
+        if(!qr_code_encode(&qr, text, ecc)) {
+            CHECK(strlen(text) > 42); // Fits version 3-L in byte mode, must encode
+            continue;
+        }
+        CHECK(qr.size == 17 + 4 * qr.version);
+
+        for(uint8_t scale = 1; scale <= 2; scale++) {
+            size_t width = qr_code_render(&qr, scale, bitmap, sizeof(bitmap));
+            size_t stride = (width + 7) / 8;
+            CHECK(width == (size_t)qr.size * scale);
+            for(size_t y = 0; y < width; y++) {
+                for(size_t x = 0; x < width; x++) {
+                    bool dark = bitmap[y * stride + x / 8] >> (x % 8) & 1;
+                    CHECK(dark == qr_code_get_module(&qr, x / scale, y / scale));
+                }
+            }
+        }
+
+        fprintf(out, "text ");
+        for(size_t c = 0; text[c]; c++) {
+            fprintf(out, "%02x", (uint8_t)text[c]);
+        }
+        fprintf(out, "\n");
+        for(uint8_t y = 0; y < qr.size; y++) {
+            for(uint8_t x = 0; x < qr.size; x++) {
+                fputc(qr_code_get_module(&qr, x, y) ? '1' : '0', out);
+            }
+            fputc('\n', out);
+        }
+        encoded++;
+    }
+    fclose(out);
+    CHECK(encoded >= 250);
+    return true;
+}
+
+// Keystore
+
+// Create, lock and unlock the way the unlock thread does, and check the seeds survive a reopen.
+static bool test_keystore(void) {
+    Entropy* entropy = entropy_alloc();
+    SolanaKeystore* keystore = solana_keystore_alloc(entropy);
+    uint8_t seed[ED25519_SEED_SIZE], public_key[ED25519_PUBLIC_KEY_SIZE];
+    size_t index;
+
+    CHECK(solana_keystore_create(keystore, "2468") == SolanaKeystoreOk);
+    CHECK(solana_keystore_generate(keystore, &index) == SolanaKeystoreOk && index == 0);
+    CHECK(solana_keystore_generate(keystore, &index) == SolanaKeystoreOk && index == 1);
+    solana_keystore_lock(keystore);
+    CHECK(!solana_keystore_is_unlocked(keystore));
+    CHECK(solana_keystore_load_seed(keystore, 0, seed) == SolanaKeystoreErrorLocked);
+    solana_keystore_free(keystore);
+
+    keystore = solana_keystore_alloc(entropy);
+    CHECK(solana_keystore_get_state(keystore) == SolanaKeystoreOk);
+    CHECK(solana_keystore_get_count(keystore) == 2);
+    CHECK(solana_keystore_unlock(keystore, "1357") == SolanaKeystoreErrorPin);
+    CHECK(!solana_keystore_is_unlocked(keystore));
+    CHECK(solana_keystore_unlock(keystore, "2468") == SolanaKeystoreOk);
+    for(size_t i = 0; i < 2; i++) {
+        CHECK(solana_keystore_load_seed(keystore, i, seed) == SolanaKeystoreOk);
+        ed25519_public_key(seed, public_key);
+        CHECK(memcmp(public_key, solana_keystore_get_public_key(keystore, i), 32) == 0);
+    }
+    CHECK(solana_keystore_get_public_key(keystore, 2) == NULL);
+
+    // Creating again must not touch the keys on the card.
+    CHECK(solana_keystore_create(keystore, "1111") == SolanaKeystoreErrorExists);
+    CHECK(solana_keystore_get_state(keystore) == SolanaKeystoreOk);
+    CHECK(solana_keystore_get_count(keystore) == 2);
+    CHECK(solana_keystore_unlock(keystore, "2468") == SolanaKeystoreOk);
+
+    solana_keystore_free(keystore);
+    entropy_free(entropy);
+    return true;
+}
+
+// Write size bytes of the keystore file back cut short, or read them with write false.
+static size_t tests_keystore_file(uint8_t* data, size_t size, bool write) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    size_t done = 0;
+    if(storage_file_open(
+           file,
+           APP_DATA_PATH("keystore.bin"),
+           write ? FSAM_WRITE : FSAM_READ,
+           write ? FSOM_CREATE_ALWAYS : FSOM_OPEN_EXISTING)) {
+        done = write ? storage_file_write(file, data, size) : storage_file_read(file, data, size);
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return done;
+}
+
+// A keystore that can't be read must never be replaced by a new one without a wipe.
+static bool test_keystore_corrupt(void) {
+    Entropy* entropy = entropy_alloc();
+    uint8_t original[512], now[512];
+    SolanaKeystore* keystore = solana_keystore_alloc(entropy);
+    if(solana_keystore_get_state(keystore) == SolanaKeystoreErrorMissing) {
+        CHECK(solana_keystore_create(keystore, "2468") == SolanaKeystoreOk);
+        CHECK(solana_keystore_generate(keystore, NULL) == SolanaKeystoreOk);
+    }
+    solana_keystore_free(keystore);
+    size_t size = tests_keystore_file(original, sizeof(original), false);
+    CHECK(size > 100 && size < sizeof(original));
+
+    // Cut inside an entry, inside the header, and a wrong version.
+    const size_t cuts[] = {size - 1, 20, size};
+    for(size_t i = 0; i < COUNT_OF(cuts); i++) {
+        memcpy(now, original, size);
+        now[4] ^= i == 2 ? 0x80 : 0;
+        CHECK(tests_keystore_file(now, cuts[i], true) == cuts[i]);
+        keystore = solana_keystore_alloc(entropy);
+        CHECK(solana_keystore_get_state(keystore) == SolanaKeystoreErrorCorrupt);
+        CHECK(solana_keystore_get_count(keystore) == 0);
+        CHECK(solana_keystore_unlock(keystore, "2468") == SolanaKeystoreErrorCorrupt);
+        CHECK(solana_keystore_create(keystore, "1111") == SolanaKeystoreErrorExists);
+        solana_keystore_free(keystore);
+        CHECK(tests_keystore_file(now, sizeof(now), false) == cuts[i]);
+        CHECK(memcmp(now, original, cuts[i]) == 0 || i == 2);
+    }
+
+    // Fixed on the card: a reload finds the keys again.
+    keystore = solana_keystore_alloc(entropy);
+    CHECK(tests_keystore_file(original, size, true) == size);
+    CHECK(solana_keystore_reload(keystore) == SolanaKeystoreOk);
+    CHECK(solana_keystore_get_count(keystore) > 0);
+
+    // Only an explicit wipe makes room for a new keystore.
+    CHECK(tests_keystore_file(original, 20, true) == 20);
+    CHECK(solana_keystore_reload(keystore) == SolanaKeystoreErrorCorrupt);
+    CHECK(solana_keystore_wipe(keystore) == SolanaKeystoreOk);
+    CHECK(solana_keystore_get_state(keystore) == SolanaKeystoreErrorMissing);
+    CHECK(solana_keystore_create(keystore, "1111") == SolanaKeystoreOk);
+    CHECK(solana_keystore_get_count(keystore) == 0);
+    solana_keystore_free(keystore);
+    entropy_free(entropy);
+    return true;
+}
+
+// The session key is wiped once it times out, even when nothing calls the keystore.
+static bool test_keystore_session_timeout(void) {
+    Entropy* entropy = entropy_alloc();
+    SolanaKeystore* keystore = solana_keystore_alloc(entropy);
+    CHECK(solana_keystore_wipe(keystore) == SolanaKeystoreOk);
+    CHECK(solana_keystore_create(keystore, "2468") == SolanaKeystoreOk);
+    solana_keystore_lock(keystore);
+    CHECK(solana_keystore_unlock(keystore, "2468") == SolanaKeystoreOk);
+
+    // Not before the timeout, though the timer checked every second on the way.
+    host_furi_advance_ticks(SOLANA_KEYSTORE_SESSION_TIMEOUT - 2 * SOLANA_KEYSTORE_SESSION_CHECK);
+    CHECK(solana_keystore_is_unlocked(keystore));
+
+    // Past it, then back to where it started.  Had only the next call checked the session, it
+    // would find it fresh.
+    host_furi_advance_ticks(3 * SOLANA_KEYSTORE_SESSION_CHECK);
+    host_furi_advance_ticks(
+        -(uint32_t)(SOLANA_KEYSTORE_SESSION_TIMEOUT + SOLANA_KEYSTORE_SESSION_CHECK));
+    CHECK(!solana_keystore_is_unlocked(keystore));
+
+    solana_keystore_free(keystore);
+    entropy_free(entropy);
+    return true;
+}
+
+// Entropy service
+
+// Cutoffs for the statistics below are about 5 standard deviations, so a healthy generator
+// fails one of them far less than once in a million runs.  They catch broken output (a stuck or
+// biased generator, a bad bounded sampler), not subtle weaknesses.
+#define TESTS_ENTROPY_SIZE (1024 * 1024)
+
+static bool tests_entropy_statistics(const uint8_t* data, size_t size) {
+    double bits = size * 8.0;
+    size_t ones = 0, runs = 1, counts[256] = {0};
+    int previous = data[0] & 1;
+
+    for(size_t i = 0; i < size; i++) {
+        counts[data[i]]++;
+        for(int b = 0; b < 8; b++) {
+            int bit = (data[i] >> b) & 1;
+            ones += bit;
+            runs += bit != previous;
+            previous = bit;
+        }
+    }
+
+    // Monobit: ones is about bits / 2, with a variance of bits / 4.
+    double deviation = ones - bits / 2;
+    CHECK(deviation * deviation < 25 * bits / 4);
+    // Runs: about bits / 2 runs of equal bits, again with a variance of about bits / 4.
+    deviation = runs - bits / 2;
+    CHECK(deviation * deviation < 25 * bits / 4);
+    // Byte frequencies: chi-square with 255 degrees of freedom, mean 255 and deviation 22.6.
+    double expected = size / 256.0, chi = 0;
+    for(size_t i = 0; i < 256; i++) {
+        chi += (counts[i] - expected) * (counts[i] - expected) / expected;
+    }
+    CHECK(chi > 150 && chi < 400);
+    return true;
+}
+
+// Chi-square of samples from entropy_uniform() in [0, bound), put into count equal buckets.
+static double tests_entropy_uniform(Entropy* entropy, uint32_t bound, size_t buckets) {
+    size_t counts[8] = {0}, samples = 60000;
+    for(size_t i = 0; i < samples; i++) {
+        uint32_t value = entropy_fast_uniform(entropy, bound);
+        if(value >= bound) {
+            return 1e9;
+        }
+        counts[(uint64_t)value * buckets / bound]++;
+    }
+    double expected = (double)samples / buckets, chi = 0;
+    for(size_t i = 0; i < buckets; i++) {
+        chi += (counts[i] - expected) * (counts[i] - expected) / expected;
+    }
+    return chi;
+}
+
+// Smoke test of the output at both qualities and of the bounded sampler.
+static bool test_entropy_statistics(void) {
+    Entropy* entropy = entropy_alloc();
+    uint8_t* data = malloc(TESTS_ENTROPY_SIZE);
+    uint32_t value;
+
+    CHECK(entropy_is_healthy(entropy));
+    // Fast output in odd sized pieces, over several reseeds
+    for(size_t offset = 0; offset < TESTS_ENTROPY_SIZE;) {
+        size_t size = MIN(1 + tests_random() % 1000, TESTS_ENTROPY_SIZE - offset);
+        CHECK(entropy_fill(entropy, EntropyQualityFast, data + offset, size));
+        offset += size;
+    }
+    CHECK(tests_entropy_statistics(data, TESTS_ENTROPY_SIZE));
+    // Crypto output the way keys and nonces ask for it, 32 bytes at a time
+    for(size_t offset = 0; offset < TESTS_ENTROPY_SIZE / 16; offset += 32) {
+        CHECK(entropy_fill(entropy, EntropyQualityCrypto, data + offset, 32));
+    }
+    CHECK(tests_entropy_statistics(data, TESTS_ENTROPY_SIZE / 16));
+
+    // A die (5 degrees of freedom), and a bound of 3 * 2^30, where a plain modulo would give
+    // the lowest third of the range twice the weight (2 degrees of freedom).
+    CHECK(tests_entropy_uniform(entropy, 6, 6) < 40);
+    CHECK(tests_entropy_uniform(entropy, 0xC0000000, 3) < 30);
+    CHECK(entropy_uniform(entropy, EntropyQualityCrypto, 1, &value) && value == 0);
+    CHECK(entropy_uniform(entropy, EntropyQualityCrypto, 0xFFFFFFFF, &value));
+
+    free(data);
+    entropy_free(entropy);
+    return true;
+}
+
+// A stuck hardware RNG must make crypto requests fail, and they must work again once it recovers.
+static bool test_entropy_health(void) {
+    uint8_t data[32], zero[32] = {0};
+    uint32_t value;
+
+    host_furi_random_stuck(0x5A);
+    Entropy* entropy = entropy_alloc();
+    CHECK(!entropy_is_healthy(entropy));
+    memset(data, 0xFF, sizeof(data));
+    CHECK(!entropy_fill(entropy, EntropyQualityCrypto, data, sizeof(data)));
+    CHECK(memcmp(data, zero, sizeof(data)) == 0);
+    CHECK(!entropy_uniform(entropy, EntropyQualityCrypto, 100, &value) && value == 0);
+    CHECK(entropy_fill(entropy, EntropyQualityFast, data, sizeof(data)));
+    CHECK(entropy_fast_uniform(entropy, 100) < 100);
+
+    host_furi_random_stuck(-1);
+    CHECK(entropy_fill(entropy, EntropyQualityCrypto, data, sizeof(data)));
+    CHECK(entropy_is_healthy(entropy));
+
+    // Failing later, after a good start.  The pool may still hold one tested seed.
+    host_furi_random_stuck(0);
+    bool filled = entropy_fill(entropy, EntropyQualityCrypto, data, sizeof(data));
+    CHECK(!filled || !entropy_fill(entropy, EntropyQualityCrypto, data, sizeof(data)));
+    CHECK(!entropy_is_healthy(entropy));
+    host_furi_random_stuck(-1);
+    CHECK(entropy_fill(entropy, EntropyQualityCrypto, data, sizeof(data)));
+    entropy_free(entropy);
+    return true;
+}
+
+// Markdown checklists
+
+#define TESTS_CHECKLIST_SIZE (1024 * 1024)
+
+static bool tests_write_file(const char* path, const void* data, size_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, data, size) == size;
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return written;
+}
+
+// 1MB checklist into an empty list: every different task once, the long one cut whole.
+static bool test_markdown_import(void) {
+    char* checklist = malloc(TESTS_CHECKLIST_SIZE);
+    KernelFixtureChecklist counts;
+    size_t size = kernel_fixture_checklist(checklist, TESTS_CHECKLIST_SIZE, &counts);
+    CHECK(tests_write_file(TODO_MARKDOWN_PATH, checklist, size));
+    free(checklist);
+
+    TodoTasks tasks;
+    TodoMarkdownResult result;
+    todo_tasks_init(&tasks, 1);
+    CHECK(todo_markdown_import(&tasks, TODO_MARKDOWN_PATH, 0, &result) == TodoMarkdownOk);
+    CHECK(result.added == KERNEL_FIXTURE_TASKS && tasks.count == KERNEL_FIXTURE_TASKS);
+    CHECK(result.ticked == counts.ticked);
+    CHECK(result.duplicates == counts.unticked - KERNEL_FIXTURE_TASKS);
+    CHECK(result.truncated == 1 && result.resume == 0);
+
+    const char* long_task = kernel_fixture_tasks[KERNEL_FIXTURE_TASKS - 1];
+    for(size_t i = 0; i < tasks.count; i++) {
+        const char* text = tasks.tasks[i].text;
+        size_t j = 0;
+        while(j < KERNEL_FIXTURE_TASKS - 1 && strcmp(text, kernel_fixture_tasks[j]) != 0) {
+            j++;
+        }
+        if(j == KERNEL_FIXTURE_TASKS - 1) {
+            // 62 bytes: the lead byte of the "è" that didn't fit is dropped too.
+            CHECK(strlen(text) == 62 && strncmp(text, long_task, 62) == 0);
+        }
+    }
+    return true;
+}
+
+// A full list stops at the start of the line that didn't fit, and the next import starts there.
+static bool test_markdown_resume(void) {
+    char* checklist = malloc(TESTS_CHECKLIST_SIZE);
+    KernelFixtureChecklist counts;
+    size_t size = kernel_fixture_checklist(checklist, TESTS_CHECKLIST_SIZE, &counts);
+    CHECK(tests_write_file(TODO_MARKDOWN_PATH, checklist, size));
+
+    TodoTasks tasks;
+    TodoMarkdownResult result;
+    todo_tasks_init(&tasks, 1);
+    CHECK(todo_tasks_add(&tasks, "Something else"));
+    CHECK(todo_markdown_import(&tasks, TODO_MARKDOWN_PATH, 0, &result) == TodoMarkdownFull);
+    CHECK(result.added == KERNEL_FIXTURE_TASKS - 1 && tasks.count == MAX_TASKS);
+    CHECK(result.resume > 0 && result.resume < size && checklist[result.resume - 1] == '\n');
+    // The tenth different task is the first one of week 3's "  * [ ]" line.
+    const char* missing = kernel_fixture_tasks[6];
+    CHECK(strncmp(checklist + result.resume, "  * [ ] ", 8) == 0);
+    CHECK(strncmp(checklist + result.resume + 8, missing, strlen(missing)) == 0);
+
+    todo_tasks_init(&tasks, 1);
+    uint32_t resume = result.resume;
+    CHECK(todo_markdown_import(&tasks, TODO_MARKDOWN_PATH, resume, &result) == TodoMarkdownOk);
+    CHECK(strcmp(tasks.tasks[0].text, missing) == 0);
+    CHECK(result.added == KERNEL_FIXTURE_TASKS && result.resume == 0);
+
+    // Past the end there is nothing left to add
+    todo_tasks_init(&tasks, 1);
+    CHECK(todo_markdown_import(&tasks, TODO_MARKDOWN_PATH, size, &result) == TodoMarkdownOk);
+    CHECK(result.added == 0);
+    free(checklist);
+    return true;
+}
+
+// Export, then import into an empty list: the same tasks in the same order.
+static bool test_markdown_export(void) {
+    TodoTasks tasks, imported;
+    TodoMarkdownResult result;
+    todo_tasks_init(&tasks, 1);
+    for(size_t i = 0; i < KERNEL_FIXTURE_TASKS - 1; i++) {
+        CHECK(todo_tasks_add(&tasks, kernel_fixture_tasks[i]));
+    }
+    // A synced task can hold a newline, which must not split the item.
+    CHECK(todo_tasks_add(&tasks, "Two\nlines"));
+
+    const char* path = APP_DATA_PATH("export.md");
+    CHECK(todo_markdown_export(&tasks, path) == TodoMarkdownOk);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    CHECK(!storage_file_exists(storage, APP_DATA_PATH("export.md.tmp")));
+    furi_record_close(RECORD_STORAGE);
+
+    todo_tasks_init(&imported, 2);
+    CHECK(todo_markdown_import(&imported, path, 0, &result) == TodoMarkdownOk);
+    CHECK(result.added == tasks.count && imported.count == tasks.count);
+    for(size_t i = 0; i < KERNEL_FIXTURE_TASKS - 1; i++) {
+        CHECK(strcmp(imported.tasks[i].text, tasks.tasks[i].text) == 0);
+    }
+    CHECK(strcmp(imported.tasks[KERNEL_FIXTURE_TASKS - 1].text, "Two lines") == 0);
+    return true;
+}
+
+// Desktop sync, against a desktop whose side of the exchange is written out beforehand
+
+#define TESTS_SYNC_BUFFER 8192
+
+typedef struct {
+    uint8_t in[TESTS_SYNC_BUFFER]; // What the desktop sends, read by the flipper
+    size_t in_size;
+    size_t in_read;
+    uint8_t out[TESTS_SYNC_BUFFER]; // What the flipper sent
+    size_t out_size;
+    size_t out_read;
+} TestsSyncDesktop;
+
+static TestsSyncDesktop tests_sync_desktop;
+
+// A few bytes at a time, the way the CLI hands them over.  Nothing left is a timeout.
+static size_t tests_sync_read(void* context, uint8_t* data, size_t size, uint32_t timeout_ms) {
+    UNUSED(timeout_ms);
+    TestsSyncDesktop* desktop = context;
+    size_t count = 1 + tests_random() % 7;
+    count = MIN(MIN(size, desktop->in_size - desktop->in_read), count);
+    memcpy(data, desktop->in + desktop->in_read, count);
+    desktop->in_read += count;
+    return count;
+}
+
+static void tests_sync_write(void* context, const uint8_t* data, size_t size) {
+    TestsSyncDesktop* desktop = context;
+    furi_check(desktop->out_size + size <= TESTS_SYNC_BUFFER);
+    memcpy(desktop->out + desktop->out_size, data, size);
+    desktop->out_size += size;
+}
+
+static uint16_t tests_sync_crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i = 0; i < size; i++) {
+        crc ^= data[i] << 8;
+        for(int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void tests_sync_put_u16(uint8_t* data, uint32_t value) {
+    data[0] = value;
+    data[1] = value >> 8;
+}
+
+static void tests_sync_put_u32(uint8_t* data, uint32_t value) {
+    tests_sync_put_u16(data, value);
+    tests_sync_put_u16(data + 2, value >> 16);
+}
+
+static uint32_t tests_sync_get_u32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Queue a frame for the flipper, compressed when that makes it smaller, as todo_sync.py does.
+static void
+    tests_sync_send(TestsSyncDesktop* desktop, uint8_t type, const uint8_t* data, size_t size) {
+    uint8_t* frame = desktop->in + desktop->in_size;
+    uint8_t flags = 0;
+    size_t length = size;
+    size_t packed = heatshrink_encode(
+        data,
+        size,
+        frame + TODO_SYNC_HEADER_SIZE + 2,
+        size > 3 ? size - 3 : 0,
+        HEATSHRINK_WINDOW_BITS,
+        HEATSHRINK_LOOKAHEAD_BITS);
+    if(packed) {
+        tests_sync_put_u16(frame + TODO_SYNC_HEADER_SIZE, size);
+        flags = TODO_SYNC_FLAG_COMPRESSED;
+        length = packed + 2;
+    } else {
+        memcpy(frame + TODO_SYNC_HEADER_SIZE, data, size);
+    }
+    frame[0] = TODO_SYNC_SOF;
+    frame[1] = type;
+    frame[2] = flags;
+    tests_sync_put_u16(frame + 3, length);
+    uint16_t crc = tests_sync_crc16(frame + 1, TODO_SYNC_HEADER_SIZE - 1 + length);
+    tests_sync_put_u16(frame + TODO_SYNC_HEADER_SIZE + length, crc);
+    desktop->in_size += TODO_SYNC_HEADER_SIZE + length + 2;
+}
+
+static void tests_sync_hello(TestsSyncDesktop* desktop, uint32_t device, uint32_t known) {
+    uint8_t payload[9] = {TODO_SYNC_VERSION};
+    tests_sync_put_u32(payload + 1, device);
+    tests_sync_put_u32(payload + 5, known);
+    tests_sync_send(desktop, TodoSyncFrameHello, payload, sizeof(payload));
+}
+
+// One RECORDS frame and the END that counts it
+static void tests_sync_records(
+    TestsSyncDesktop* desktop,
+    const TodoTask* tasks,
+    const bool* deleted,
+    size_t count) {
+    uint8_t payload[TODO_SYNC_MAX_PAYLOAD];
+    size_t size = 0;
+    for(size_t i = 0; i < count; i++) {
+        size_t text_length = strlen(tasks[i].text);
+        tests_sync_put_u32(payload + size, tasks[i].id);
+        tests_sync_put_u32(payload + size + 4, tasks[i].version[TodoReplicaDevice]);
+        tests_sync_put_u32(payload + size + 8, tasks[i].version[TodoReplicaDesktop]);
+        payload[size + 12] = deleted && deleted[i] ? TODO_SYNC_RECORD_DELETED : 0;
+        payload[size + 13] = text_length;
+        memcpy(payload + size + 14, tasks[i].text, text_length);
+        size += 14 + text_length;
+    }
+    if(count) {
+        tests_sync_send(desktop, TodoSyncFrameRecords, payload, size);
+    }
+    tests_sync_put_u16(payload, count);
+    tests_sync_send(desktop, TodoSyncFrameEnd, payload, 2);
+}
+
+/**
+ * @brief      Take the next frame the flipper sent, unpacked into payload.
+ * @return     false if there is none or it doesn't check out.
+*/
+static bool tests_sync_receive(
+    TestsSyncDesktop* desktop,
+    uint8_t* type,
+    uint8_t* payload,
+    size_t* size) {
+    const uint8_t* frame = desktop->out + desktop->out_read;
+    size_t left = desktop->out_size - desktop->out_read;
+    if(left < TODO_SYNC_HEADER_SIZE + 2 || frame[0] != TODO_SYNC_SOF) {
+        return false;
+    }
+    size_t length = frame[3] | (frame[4] << 8);
+    if(left < TODO_SYNC_HEADER_SIZE + length + 2) {
+        return false;
+    }
+    const uint8_t* crc = frame + TODO_SYNC_HEADER_SIZE + length;
+    uint16_t expected = tests_sync_crc16(frame + 1, TODO_SYNC_HEADER_SIZE - 1 + length);
+    if((crc[0] | (crc[1] << 8)) != expected) {
+        return false;
+    }
+    const uint8_t* data = frame + TODO_SYNC_HEADER_SIZE;
+    if(frame[2] & TODO_SYNC_FLAG_COMPRESSED) {
+        *size = data[0] | (data[1] << 8);
+        if(!heatshrink_decode(
+               data + 2,
+               length - 2,
+               payload,
+               *size,
+               HEATSHRINK_WINDOW_BITS,
+               HEATSHRINK_LOOKAHEAD_BITS)) {
+            return false;
+        }
+    } else {
+        memcpy(payload, data, length);
+        *size = length;
+    }
+    *type = frame[1];
+    desktop->out_read += TODO_SYNC_HEADER_SIZE + length + 2;
+    return true;
+}
+
+typedef struct {
+    uint32_t knowledge[TodoReplicaCount]; // From the flipper's HELLO
+    uint32_t ids[MAX_TASKS]; // Of the records it sent, in order
+    size_t records;
+    uint8_t done; // TodoSyncDoneStatus
+    uint32_t done_knowledge[TodoReplicaCount];
+} TestsSyncSent;
+
+// Check the flipper's whole side of one sync, HELLO to DONE, and collect what it said.
+static bool tests_sync_check_sent(TestsSyncDesktop* desktop, TestsSyncSent* sent) {
+    uint8_t payload[TODO_SYNC_MAX_PAYLOAD];
+    uint8_t type;
+    size_t size;
+    memset(sent, 0, sizeof(TestsSyncSent));
+
+    CHECK(tests_sync_receive(desktop, &type, payload, &size));
+    CHECK(type == TodoSyncFrameHello && size == 17 && payload[0] == TODO_SYNC_VERSION);
+    sent->knowledge[TodoReplicaDevice] = tests_sync_get_u32(payload + 5);
+    sent->knowledge[TodoReplicaDesktop] = tests_sync_get_u32(payload + 9);
+
+    while(true) {
+        CHECK(tests_sync_receive(desktop, &type, payload, &size));
+        if(type == TodoSyncFrameEnd) {
+            break;
+        }
+        CHECK(type == TodoSyncFrameRecords);
+        for(size_t offset = 0; offset < size; offset += 14 + payload[offset + 13]) {
+            CHECK(sent->records < MAX_TASKS && offset + 14 <= size);
+            sent->ids[sent->records++] = tests_sync_get_u32(payload + offset);
+        }
+    }
+    CHECK(size == 2 && (size_t)(payload[0] | (payload[1] << 8)) == sent->records);
+
+    CHECK(tests_sync_receive(desktop, &type, payload, &size));
+    CHECK(type == TodoSyncFrameDone && size == 9);
+    sent->done = payload[0];
+    sent->done_knowledge[TodoReplicaDevice] = tests_sync_get_u32(payload + 1);
+    sent->done_knowledge[TodoReplicaDesktop] = tests_sync_get_u32(payload + 5);
+    CHECK(desktop->out_read == desktop->out_size);
+    return true;
+}
+
+static TodoSyncResult tests_sync_run(
+    TodoTasks* tasks,
+    TestsSyncDesktop* desktop,
+    TodoSyncStats* stats) {
+    const TodoSyncIo io = {
+        .read = tests_sync_read,
+        .write = tests_sync_write,
+        .context = desktop,
+    };
+    return todo_sync_run(tasks, &io, stats);
+}
+
+static TodoTask tests_sync_task(uint32_t id, uint32_t device, uint32_t known, const char* text) {
+    TodoTask task = {.id = id, .version = {device, known}};
+    strncpy(task.text, text, TASK_LENGTH - 1);
+    return task;
+}
+
+// A cold sync both ways, then one where nothing changed, then edits on both sides of one task
+// (the desktop's wins), stale records and deletes.
+static bool test_sync_exchange(void) {
+    TestsSyncDesktop* desktop = &tests_sync_desktop;
+    TestsSyncSent sent;
+    TodoSyncStats stats;
+    TodoTasks tasks;
+    todo_tasks_init(&tasks, 1);
+    CHECK(todo_tasks_add(&tasks, "Water the plants"));
+    CHECK(todo_tasks_add(&tasks, "Call the bank"));
+    CHECK(todo_tasks_add(&tasks, "Return the library books"));
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+
+    // Cold: the desktop has seen nothing from the flipper and has two tasks of its own, long
+    // enough to be compressed.
+    const TodoTask cold[] = {
+        tests_sync_task(TODO_TASK_ID_DESKTOP | 1, 0, 1, "Buy milk, buy bread, buy eggs, buy tea"),
+        tests_sync_task(TODO_TASK_ID_DESKTOP | 2, 0, 2, "Book the dentist for the whole family"),
+    };
+    tests_sync_hello(desktop, 0, 2);
+    tests_sync_records(desktop, cold, NULL, 2);
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncOk);
+    CHECK(desktop->in_read == desktop->in_size);
+    CHECK(tests_sync_check_sent(desktop, &sent));
+    CHECK(sent.knowledge[TodoReplicaDevice] == 3 && sent.knowledge[TodoReplicaDesktop] == 0);
+    CHECK(sent.records == 3 && sent.ids[0] == 1 && sent.ids[1] == 2 && sent.ids[2] == 3);
+    CHECK(sent.done == TodoSyncDoneOk);
+    CHECK(sent.done_knowledge[TodoReplicaDevice] == 3);
+    CHECK(sent.done_knowledge[TodoReplicaDesktop] == 2);
+    CHECK(stats.sent == 3 && stats.received == 2 && stats.rejected == 0);
+    CHECK(tasks.count == 5 && strcmp(tasks.tasks[4].text, cold[1].text) == 0);
+    CHECK(tasks.knowledge[TodoReplicaDesktop] == 2);
+    size_t cold_bytes = desktop->out_size;
+
+    // Nothing changed: no records either way, only HELLO, END and DONE.
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+    tests_sync_hello(desktop, 3, 2);
+    tests_sync_records(desktop, NULL, NULL, 0);
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncOk);
+    CHECK(tests_sync_check_sent(desktop, &sent));
+    CHECK(sent.records == 0 && sent.done == TodoSyncDoneOk);
+    CHECK(stats.sent == 0 && stats.received == 0 && stats.rejected == 0);
+    CHECK(desktop->out_size == (17 + 7) + (2 + 7) + (9 + 7));
+    printf("  cold sync sent %zu bytes, an unchanged one %zu\n", cold_bytes, desktop->out_size);
+
+    // The flipper adds a task, and the desktop sends:
+    //  - task 1 edited there ({1, 3} covers the flipper's {1, 0}): taken, versions merged;
+    //  - task 2 edited there without having seen the flipper's edit ({0, 4} against {2, 0}):
+    //    both changed, the desktop wins and the versions merge to {2, 4};
+    //  - its own task 1 again at the version the flipper has: ignored;
+    //  - task 3 deleted, and a delete for a task the flipper never had: one removal.
+    CHECK(todo_tasks_add(&tasks, "Fix the bike"));
+    const TodoTask edits[] = {
+        tests_sync_task(1, 1, 3, "Water the plants and the lawn"),
+        tests_sync_task(2, 0, 4, "Call the bank before noon"),
+        cold[0],
+        tests_sync_task(3, 3, 5, ""),
+        tests_sync_task(TODO_TASK_ID_DESKTOP | 9, 0, 6, ""),
+    };
+    const bool deleted[] = {false, false, false, true, true};
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+    tests_sync_hello(desktop, 3, 6);
+    tests_sync_records(desktop, edits, deleted, COUNT_OF(edits));
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncOk);
+    CHECK(tests_sync_check_sent(desktop, &sent));
+    CHECK(sent.records == 1 && sent.ids[0] == 4);
+    CHECK(sent.done == TodoSyncDoneOk && sent.done_knowledge[TodoReplicaDesktop] == 6);
+    CHECK(stats.sent == 1 && stats.received == 3 && stats.rejected == 0);
+    CHECK(tasks.count == 5 && todo_tasks_find(&tasks, 3) == NULL);
+    TodoTask* task = todo_tasks_find(&tasks, 1);
+    CHECK(task && strcmp(task->text, edits[0].text) == 0);
+    CHECK(task->version[TodoReplicaDevice] == 1 && task->version[TodoReplicaDesktop] == 3);
+    task = todo_tasks_find(&tasks, 2);
+    CHECK(task && strcmp(task->text, edits[1].text) == 0);
+    CHECK(task->version[TodoReplicaDevice] == 2 && task->version[TodoReplicaDesktop] == 4);
+    task = todo_tasks_find(&tasks, TODO_TASK_ID_DESKTOP | 1);
+    CHECK(task && strcmp(task->text, cold[0].text) == 0);
+    return true;
+}
+
+// New tasks that don't fit are rejected and the flipper keeps its old knowledge of the desktop,
+// so the next sync sends them again.  A desktop that stops answering or sends a bad frame ends
+// the sync with an error and leaves the knowledge alone too.
+static bool test_sync_full(void) {
+    TestsSyncDesktop* desktop = &tests_sync_desktop;
+    TestsSyncSent sent;
+    TodoSyncStats stats;
+    TodoTasks tasks;
+    todo_tasks_init(&tasks, 1);
+    for(size_t i = 0; i < MAX_TASKS - 1; i++) {
+        CHECK(todo_tasks_add(&tasks, kernel_fixture_tasks[i]));
+    }
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+
+    const TodoTask extra[] = {
+        tests_sync_task(TODO_TASK_ID_DESKTOP | 1, 0, 1, "First"),
+        tests_sync_task(TODO_TASK_ID_DESKTOP | 2, 0, 2, "Second"),
+        tests_sync_task(TODO_TASK_ID_DESKTOP | 3, 0, 3, "Third"),
+    };
+    tests_sync_hello(desktop, MAX_TASKS - 1, 3);
+    tests_sync_records(desktop, extra, NULL, 3);
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncOk);
+    CHECK(tests_sync_check_sent(desktop, &sent));
+    CHECK(sent.records == 0 && sent.done == TodoSyncDoneFull);
+    CHECK(sent.done_knowledge[TodoReplicaDesktop] == 0);
+    CHECK(stats.received == 1 && stats.rejected == 2);
+    CHECK(tasks.count == MAX_TASKS && tasks.knowledge[TodoReplicaDesktop] == 0);
+    CHECK(todo_tasks_find(&tasks, TODO_TASK_ID_DESKTOP | 1) != NULL);
+
+    // Once one is deleted on the desktop there's room for another, and the rest comes next time.
+    const TodoTask retry[] = {
+        tests_sync_task(1, 1, 4, ""),
+        extra[0],
+        extra[1],
+        extra[2],
+    };
+    const bool deleted[] = {true, false, false, false};
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+    tests_sync_hello(desktop, MAX_TASKS - 1, 4);
+    tests_sync_records(desktop, retry, deleted, COUNT_OF(retry));
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncOk);
+    CHECK(tests_sync_check_sent(desktop, &sent));
+    CHECK(sent.done == TodoSyncDoneFull && stats.received == 2 && stats.rejected == 1);
+    CHECK(todo_tasks_find(&tasks, 1) == NULL);
+    CHECK(todo_tasks_find(&tasks, TODO_TASK_ID_DESKTOP | 2) != NULL);
+
+    // The desktop goes quiet after its HELLO.
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+    tests_sync_hello(desktop, MAX_TASKS - 1, 5);
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncErrorTimeout);
+    CHECK(tasks.knowledge[TodoReplicaDesktop] == 0);
+
+    // A flipped bit in the records.
+    memset(desktop, 0, sizeof(TestsSyncDesktop));
+    tests_sync_hello(desktop, MAX_TASKS - 1, 5);
+    size_t start = desktop->in_size;
+    tests_sync_records(desktop, extra, NULL, 3);
+    desktop->in[start + TODO_SYNC_HEADER_SIZE + 3] ^= 0x10;
+    CHECK(tests_sync_run(&tasks, desktop, &stats) == TodoSyncErrorFrame);
+    CHECK(tasks.knowledge[TodoReplicaDesktop] == 0 && tasks.count == MAX_TASKS);
+    return true;
+}
+
+// Word completion
+
+#define TESTS_WORDS_VOCABULARY 60
+#define TESTS_WORDS_FLOOD      200
+#define TESTS_WORDS_FLOOD_SIZE 12
+
+typedef char TestsWord[TODO_WORDS_MAX_LENGTH + 1];
+
+static size_t tests_read_file(const char* path, void* data, size_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    size_t read = 0;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        read = storage_file_read(file, data, size);
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return read;
+}
+
+static void tests_random_word(char* word, size_t length, const char* letters) {
+    for(size_t i = 0; i < length; i++) {
+        word[i] = letters[tests_random() % strlen(letters)];
+    }
+    word[length] = '\0';
+}
+
+// Whether the dictionary has word, from the completions of all but its last letter
+static bool tests_words_has(TodoWords* words, const char* word) {
+    TestsWord prefix;
+    TodoWordsSuggestion suggestions[TODO_WORDS_SUGGESTIONS];
+    size_t length = strlen(word) - 1;
+    memcpy(prefix, word, length);
+    prefix[length] = '\0';
+    size_t found = todo_words_complete(words, prefix, suggestions, TODO_WORDS_SUGGESTIONS);
+    for(size_t i = 0; i < found; i++) {
+        if(strcmp(suggestions[i], word) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The completions of every prefix of every word must be the ones a search through all the
+// counts gives: most used first, in alphabetical order on a tie.
+static bool tests_words_match(
+    TodoWords* words,
+    const TestsWord* vocabulary,
+    const uint16_t* counts,
+    size_t* prefixes) {
+    TodoWordsSuggestion suggestions[TODO_WORDS_SUGGESTIONS];
+    for(size_t w = 0; w < TESTS_WORDS_VOCABULARY; w++) {
+        for(size_t p = 1; p <= strlen(vocabulary[w]); p++) {
+            TestsWord prefix;
+            memcpy(prefix, vocabulary[w], p);
+            prefix[p] = '\0';
+            size_t max = 1 + (w + p) % TODO_WORDS_SUGGESTIONS;
+
+            // The best max by count, then alphabetically
+            size_t best[TODO_WORDS_SUGGESTIONS];
+            size_t expected = 0;
+            for(size_t i = 0; i < TESTS_WORDS_VOCABULARY; i++) {
+                if(!counts[i] || strlen(vocabulary[i]) <= p ||
+                   strncmp(vocabulary[i], prefix, p) != 0) {
+                    continue;
+                }
+                size_t slot = expected < max ? expected++ : max;
+                while(slot && (counts[best[slot - 1]] < counts[i] ||
+                               (counts[best[slot - 1]] == counts[i] &&
+                                strcmp(vocabulary[best[slot - 1]], vocabulary[i]) > 0))) {
+                    if(slot < max) {
+                        best[slot] = best[slot - 1];
+                    }
+                    slot--;
+                }
+                if(slot < max) {
+                    best[slot] = i;
+                }
+            }
+
+            if(p % 2) {
+                prefix[0] = prefix[0] >= 'a' ? prefix[0] - 0x20 : prefix[0];
+            }
+            size_t found = todo_words_complete(words, prefix, suggestions, max);
+            CHECK(found == expected);
+            for(size_t i = 0; i < found; i++) {
+                CHECK(strcmp(suggestions[i], vocabulary[best[i]]) == 0);
+            }
+            (*prefixes)++;
+        }
+    }
+    return true;
+}
+
+// 3000 tasks from 60 words that share a lot of prefixes, used unevenly, with capitals, and
+// with words too short or too long to count.  Every 10 tasks all completions are checked, so
+// there are plenty of ties while the counts are low.
+static bool test_words_complete(void) {
+    static const char letters[] = "abcde0";
+    TestsWord vocabulary[TESTS_WORDS_VOCABULARY];
+    uint16_t counts[TESTS_WORDS_VOCABULARY] = {0};
+    size_t nodes = 0;
+    for(size_t i = 0; i < TESTS_WORDS_VOCABULARY; i++) {
+        bool again;
+        do {
+            tests_random_word(vocabulary[i], 3 + tests_random() % 6, letters);
+            again = false;
+            for(size_t j = 0; j < i; j++) {
+                again |= strcmp(vocabulary[i], vocabulary[j]) == 0;
+            }
+        } while(again);
+        // Nodes it adds: its letters past the longest prefix it shares with an earlier word
+        size_t shared = 0;
+        for(size_t j = 0; j < i; j++) {
+            size_t k = 0;
+            while(vocabulary[i][k] && vocabulary[i][k] == vocabulary[j][k]) {
+                k++;
+            }
+            shared = MAX(shared, k);
+        }
+        nodes += strlen(vocabulary[i]) - shared;
+    }
+    // All of them fit, so nothing is dropped and every count is exact.
+    CHECK(nodes < TODO_WORDS_MAX_NODES);
+
+    TodoWords* words = todo_words_alloc();
+    size_t prefixes = 0;
+    for(size_t task = 0; task < 3000; task++) {
+        char text[TASK_LENGTH];
+        size_t length = 0;
+        for(size_t n = 1 + tests_random() % 4; n; n--) {
+            // Skewed towards the first words
+            size_t i = (tests_random() % TESTS_WORDS_VOCABULARY) *
+                       (tests_random() % TESTS_WORDS_VOCABULARY) / TESTS_WORDS_VOCABULARY;
+            counts[i]++;
+            length += snprintf(text + length, sizeof(text) - length, "%s", vocabulary[i]);
+            char* first = &text[length - strlen(vocabulary[i])];
+            if(tests_random() % 4 == 0 && *first >= 'a') {
+                *first -= 0x20;
+            }
+            text[length++] = " ,.-"[tests_random() % 4];
+        }
+        snprintf(text + length, sizeof(text) - length, "to zzzzzzzzzzzzzzzzz");
+        todo_words_learn(words, text);
+        if(task % 10 == 9) {
+            CHECK(tests_words_match(words, vocabulary, counts, &prefixes));
+        }
+    }
+    TodoWordsSuggestion suggestions[TODO_WORDS_SUGGESTIONS];
+    CHECK(todo_words_complete(words, "zz", suggestions, TODO_WORDS_SUGGESTIONS) == 0);
+    CHECK(todo_words_complete(words, "", suggestions, TODO_WORDS_SUGGESTIONS) == 0);
+
+    printf(
+        "  %zu prefixes checked, %d words in %zu nodes\n",
+        prefixes,
+        TESTS_WORDS_VOCABULARY,
+        nodes);
+    todo_words_free(words);
+    return true;
+}
+
+// A word used 5 times, then 200 words of 12 random letters once each, several times what the
+// pool holds.  The favourite must stay, and of the others the oldest must go first, also across
+// a save and reload 20 words before the end, so the ones left are always the newest.  Used once
+// more, an old word must outlast newer ones.
+static bool test_words_evict(void) {
+    static TestsWord flood[TESTS_WORDS_FLOOD];
+    TodoWords* words = todo_words_alloc();
+    for(size_t i = 0; i < 5; i++) {
+        todo_words_learn(words, "Groceries");
+    }
+    for(size_t i = 0; i < TESTS_WORDS_FLOOD; i++) {
+        tests_random_word(flood[i], TESTS_WORDS_FLOOD_SIZE, "abcdefghijklmnopqrstuvwxyz");
+        todo_words_learn(words, flood[i]);
+        CHECK(tests_words_has(words, "groceries") && tests_words_has(words, flood[i]));
+        if(i == TESTS_WORDS_FLOOD - 20) {
+            CHECK(todo_words_save(words, TODO_WORDS_PATH));
+            CHECK(todo_words_load(words, TODO_WORDS_PATH));
+        }
+    }
+
+    size_t first = TESTS_WORDS_FLOOD;
+    for(size_t i = 0; i < TESTS_WORDS_FLOOD; i++) {
+        bool has = tests_words_has(words, flood[i]);
+        if(has && first == TESTS_WORDS_FLOOD) {
+            first = i;
+        }
+        CHECK(has == (i >= first));
+    }
+    size_t kept = TESTS_WORDS_FLOOD - first;
+    // Each takes at most 12 nodes, so once the pool is full about 40 of them fit.
+    CHECK(kept >= (TODO_WORDS_MAX_NODES - 1 - 9) / TESTS_WORDS_FLOOD_SIZE);
+
+    const char* old = flood[first];
+    todo_words_learn(words, old);
+    for(size_t i = 0; i < kept; i++) {
+        TestsWord word;
+        tests_random_word(word, TESTS_WORDS_FLOOD_SIZE, "abcdefghijklmnopqrstuvwxyz");
+        todo_words_learn(words, word);
+    }
+    CHECK(tests_words_has(words, old) && tests_words_has(words, "groceries"));
+    CHECK(!tests_words_has(words, flood[first + 1]));
+    printf("  %zu of %d single use words kept in a full pool\n", kept, TESTS_WORDS_FLOOD);
+    todo_words_free(words);
+    return true;
+}
+
+// A saved dictionary loads back with the same completions.  Cut short anywhere, or with a bad
+// header or a bad word in it, the file must load as an empty dictionary; random damage must not
+// read out of bounds.
+static bool test_words_corrupt(void) {
+    static const char* const tasks[] = {
+        "Buy milk and bread",
+        "Buy batteries",
+        "Book the car service",
+        "Call the bank about the card",
+    };
+    TodoWords* words = todo_words_alloc();
+    for(size_t i = 0; i < COUNT_OF(tasks); i++) {
+        todo_words_learn(words, tasks[i]);
+    }
+    CHECK(todo_words_save(words, TODO_WORDS_PATH));
+    uint8_t saved[512];
+    size_t size = tests_read_file(TODO_WORDS_PATH, saved, sizeof(saved));
+    CHECK(size > 8 && size < sizeof(saved) && memcmp(saved, "TDWD", 4) == 0);
+
+    TodoWords* loaded = todo_words_alloc();
+    TodoWordsSuggestion expected[TODO_WORDS_SUGGESTIONS], suggestions[TODO_WORDS_SUGGESTIONS];
+    static const char* const prefixes[] = {"b", "ba", "c", "the", "m"};
+    CHECK(todo_words_load(loaded, TODO_WORDS_PATH));
+    for(size_t i = 0; i < COUNT_OF(prefixes); i++) {
+        size_t found = todo_words_complete(words, prefixes[i], expected, TODO_WORDS_SUGGESTIONS);
+        CHECK(todo_words_complete(loaded, prefixes[i], suggestions, TODO_WORDS_SUGGESTIONS) ==
+              found);
+        for(size_t j = 0; j < found; j++) {
+            CHECK(strcmp(suggestions[j], expected[j]) == 0);
+        }
+    }
+
+    uint8_t damaged[sizeof(saved)];
+    for(size_t cut = 0; cut < size; cut++) {
+        CHECK(tests_write_file(TODO_WORDS_PATH, saved, cut));
+        CHECK(!todo_words_load(loaded, TODO_WORDS_PATH));
+        CHECK(todo_words_complete(loaded, "b", suggestions, TODO_WORDS_SUGGESTIONS) == 0);
+    }
+    // Magic, version, the first word's length (too short, too long) and a letter that a word
+    // can't hold
+    static const struct {
+        size_t offset;
+        uint8_t value;
+    } changes[] = {
+        {0, 'X'},
+        {4, 2},
+        {12, 2},
+        {12, TODO_WORDS_MAX_LENGTH + 1},
+        {13, 'B'},
+        {14, ' '},
+    };
+    for(size_t i = 0; i < COUNT_OF(changes); i++) {
+        memcpy(damaged, saved, size);
+        damaged[changes[i].offset] = changes[i].value;
+        CHECK(tests_write_file(TODO_WORDS_PATH, damaged, size));
+        CHECK(!todo_words_load(loaded, TODO_WORDS_PATH));
+        CHECK(todo_words_complete(loaded, "b", suggestions, TODO_WORDS_SUGGESTIONS) == 0);
+    }
+
+    // Bigger than any dictionary can be
+    size_t largest = 8 + TODO_WORDS_MAX_NODES * (5 + TODO_WORDS_MAX_LENGTH);
+    uint8_t* huge = calloc(1, largest + 1);
+    memcpy(huge, saved, size);
+    CHECK(tests_write_file(TODO_WORDS_PATH, huge, largest + 1));
+    free(huge);
+    CHECK(!todo_words_load(loaded, TODO_WORDS_PATH));
+
+    for(size_t i = 0; i < 2000; i++) {
+        memcpy(damaged, saved, size);
+        for(size_t n = 1 + tests_random() % 3; n; n--) {
+            damaged[tests_random() % size] = tests_random();
+        }
+        CHECK(tests_write_file(TODO_WORDS_PATH, damaged, size));
+        if(!todo_words_load(loaded, TODO_WORDS_PATH)) {
+            CHECK(todo_words_complete(loaded, "b", suggestions, TODO_WORDS_SUGGESTIONS) == 0);
+        }
+        // Whatever loaded must still take new words.
+        todo_words_learn(loaded, tasks[i % COUNT_OF(tasks)]);
+        CHECK(tests_words_has(loaded, "buy") || tests_words_has(loaded, "book") ||
+              tests_words_has(loaded, "call"));
+    }
+    todo_words_free(loaded);
+    todo_words_free(words);
+    return true;
+}
+
+// Energy profiler
+
+// Skeleton's dim times for the views the session below goes through
+static const EnergyView tests_energy_views[] = {
+    {1, "Menu", 10000},
+    {4, "Play", 30000},
+    {5, "About", 20000},
+};
+
+typedef struct {
+    unsigned long ms, frames, full_ms, dim_ms, uah;
+} TestsEnergyView;
+
+#define TESTS_ENERGY_LOG 4096
+
+static void tests_energy_press(void) {
+    FuriPubSub* input = furi_record_open(RECORD_INPUT_EVENTS);
+    InputEvent event = {.key = InputKeyOk, .type = InputTypePress};
+    furi_pubsub_publish(input, &event);
+    furi_record_close(RECORD_INPUT_EVENTS);
+}
+
+// 8 minutes: a minute on the menu, five on Play redrawing every 200ms, then two on About, with a
+// key press to open each.  Fills views from the report and returns the total in uAh.
+static unsigned long tests_energy_session(EnergyBacklight backlight, TestsEnergyView* views) {
+    EnergyConfig config = {
+        .views = tests_energy_views,
+        .view_count = COUNT_OF(tests_energy_views),
+        .backlight = backlight,
+        .dim_level = ENERGY_DIM_LEVEL,
+    };
+    char* log = calloc(1, TESTS_ENERGY_LOG);
+    host_furi_log_capture(log, TESTS_ENERGY_LOG);
+    Energy* energy = energy_alloc(&config);
+
+    energy_view_enter(energy, 1);
+    host_gui_commit();
+    host_furi_advance_ticks(60000);
+    tests_energy_press();
+    energy_view_enter(energy, 4);
+    for(size_t i = 0; i < 1500; i++) {
+        host_gui_commit();
+        host_furi_advance_ticks(200);
+    }
+    tests_energy_press();
+    energy_view_enter(energy, 5);
+    host_gui_commit();
+    host_furi_advance_ticks(120000);
+
+    energy_free(energy);
+    host_furi_log_capture(NULL, 0);
+
+    unsigned long total = 0;
+    size_t found = 0;
+    for(char* line = strstr(log, "[Energy] "); line; line = strstr(line + 1, "[Energy] ")) {
+        char name[16];
+        TestsEnergyView view;
+        unsigned long cpu_ms, speaker_ms;
+        if(sscanf(
+               line + 9,
+               "%15[^:]: %lu ms, %lu frames, CPU %lu ms, backlight full %lu ms dim %lu ms, "
+               "speaker %lu ms, %lu uAh",
+               name,
+               &view.ms,
+               &view.frames,
+               &cpu_ms,
+               &view.full_ms,
+               &view.dim_ms,
+               &speaker_ms,
+               &view.uah) == 8) {
+            for(size_t i = 0; i < COUNT_OF(tests_energy_views); i++) {
+                if(strcmp(name, tests_energy_views[i].name) == 0) {
+                    views[i] = view;
+                    found++;
+                }
+            }
+        } else {
+            sscanf(line + 9, "Total: %*u ms, %*u frames, %lu uAh", &total);
+        }
+    }
+    free(log);
+    return found == COUNT_OF(tests_energy_views) ? total : 0;
+}
+
+// The host ticks also follow the real clock, which moves a little while the session runs.
+static bool tests_energy_near(unsigned long value, unsigned long expected, unsigned long slack) {
+    return value + slack >= expected && value <= expected + slack;
+}
+
+static bool tests_energy_check(
+    const TestsEnergyView* view,
+    unsigned long ms,
+    unsigned long frames,
+    unsigned long full_ms,
+    unsigned long dim_ms,
+    unsigned long uah) {
+    return tests_energy_near(view->ms, ms, 250) && view->frames == frames &&
+           tests_energy_near(view->full_ms, full_ms, 250) &&
+           tests_energy_near(view->dim_ms, dim_ms, 250) && tests_energy_near(view->uah, uah, 1);
+}
+
+// The session with each backlight policy, against figures worked out by hand from the default
+// currents.  The dimmed one must also have sent the dims and wake ups in order.
+static bool test_energy_session(void) {
+    TestsEnergyView views[COUNT_OF(tests_energy_views)];
+    NotificationMessage played[32];
+
+    host_notification_played(played, COUNT_OF(played));
+    unsigned long dim = tests_energy_session(EnergyBacklightDim, views);
+    CHECK(tests_energy_check(&views[0], 60000, 1, 10000, 50000, 93));
+    CHECK(tests_energy_check(&views[1], 300000, 1500, 30000, 270000, 412));
+    CHECK(tests_energy_check(&views[2], 120000, 1, 20000, 100000, 187));
+    CHECK(tests_energy_near(dim, 693, 2));
+    static const NotificationMessageType types[] = {
+        NotificationMessageTypeLedDisplayBacklightEnforceOn,
+        NotificationMessageTypeLedDisplayBacklight,
+        NotificationMessageTypeLedDisplayBacklight,
+        NotificationMessageTypeLedDisplayBacklight,
+        NotificationMessageTypeLedDisplayBacklight,
+        NotificationMessageTypeLedDisplayBacklight,
+        NotificationMessageTypeLedDisplayBacklight,
+        NotificationMessageTypeLedDisplayBacklightEnforceAuto,
+    };
+    CHECK(host_notification_played(played, COUNT_OF(played)) == COUNT_OF(types));
+    for(size_t i = 0; i < COUNT_OF(types); i++) {
+        CHECK(played[i].type == types[i]);
+        if(i && i < COUNT_OF(types) - 1) {
+            // Dimmed once each view went idle, and back on for the next key
+            CHECK(played[i].data.led.value == (i % 2 ? ENERGY_DIM_LEVEL : 0xFF));
+        }
+    }
+
+    unsigned long on = tests_energy_session(EnergyBacklightOn, views);
+    CHECK(tests_energy_check(&views[0], 60000, 1, 60000, 0, 250));
+    CHECK(tests_energy_check(&views[1], 300000, 1500, 300000, 0, 1255));
+    CHECK(tests_energy_check(&views[2], 120000, 1, 120000, 0, 500));
+    CHECK(tests_energy_near(on, 2005, 2));
+    CHECK(host_notification_played(played, COUNT_OF(played)) == 2);
+
+    // The firmware's 30s after each key, and nothing sent
+    unsigned long automatic = tests_energy_session(EnergyBacklightAuto, views);
+    CHECK(tests_energy_check(&views[0], 60000, 1, 30000, 0, 150));
+    CHECK(tests_energy_check(&views[1], 300000, 1500, 30000, 0, 355));
+    CHECK(tests_energy_check(&views[2], 120000, 1, 30000, 0, 200));
+    CHECK(tests_energy_near(automatic, 705, 2));
+    CHECK(host_notification_played(played, COUNT_OF(played)) == 0);
+
+    printf(
+        "  8 minute session: %lu uAh backlight on, %lu uAh dimmed, %lu uAh auto\n",
+        on,
+        dim,
+        automatic);
+    return true;
+}
+
+// Freed right after the idle timer dimmed the backlight, while the dim is still queued.  The dim
+// message lives in the profiler, so AddressSanitizer catches it being played after the free.
+static bool test_energy_free_while_dimming(void) {
+    EnergyConfig config = {
+        .views = tests_energy_views,
+        .view_count = COUNT_OF(tests_energy_views),
+        .backlight = EnergyBacklightDim,
+        .dim_level = ENERGY_DIM_LEVEL,
+    };
+    NotificationMessage played[8];
+
+    host_notification_played(played, COUNT_OF(played));
+    for(size_t i = 0; i < 20; i++) {
+        Energy* energy = energy_alloc(&config);
+        energy_view_enter(energy, 1);
+        host_furi_advance_ticks(tests_energy_views[0].dim_after_ms);
+        energy_free(energy);
+
+        CHECK(host_notification_played(played, COUNT_OF(played)) == 4);
+        CHECK(played[1].type == NotificationMessageTypeLedDisplayBacklight);
+        CHECK(played[1].data.led.value == ENERGY_DIM_LEVEL);
+        CHECK(played[2].data.led.value == 0xFF);
+        CHECK(played[3].type == NotificationMessageTypeLedDisplayBacklightEnforceAuto);
+    }
+    return true;
+}
+
+typedef struct {
+    const char* name;
+    bool (*run)(void);
+} KernelTest;
+
+static const KernelTest kernel_tests[] = {
+    {"solana.tx_valid", test_tx_valid},
+    {"solana.tx_malformed", test_tx_malformed},
+    {"solana.tx_fuzz", test_tx_fuzz},
+    {"solana.json_signatures", test_json_signatures},
+    {"solana.json_account", test_json_account},
+    {"solana.json_truncated", test_json_truncated},
+    {"solana.rpc_link", test_rpc_link},
+    {"solana.qr_encode", test_qr_encode},
+    {"solana.keystore", test_keystore},
+    {"solana.keystore_corrupt", test_keystore_corrupt},
+    {"solana.keystore_session_timeout", test_keystore_session_timeout},
+    {"solana.ed25519_vectors", test_ed25519_vectors},
+    {"solana.ed25519_stream", test_ed25519_stream},
+    {"solana.ed25519_stream_mismatch", test_ed25519_stream_mismatch},
+    {"solana.ed25519_batch", test_ed25519_batch},
+    {"solana.pda_token_account", test_pda_token_account},
+    {"solana.pda_seeds", test_pda_seeds},
+    {"todo.markdown_import", test_markdown_import},
+    {"todo.markdown_resume", test_markdown_resume},
+    {"todo.markdown_export", test_markdown_export},
+    {"todo.sync_exchange", test_sync_exchange},
+    {"todo.sync_full", test_sync_full},
+    {"todo.words_complete", test_words_complete},
+    {"todo.words_evict", test_words_evict},
+    {"todo.words_corrupt", test_words_corrupt},
+    {"common.entropy_statistics", test_entropy_statistics},
+    {"common.entropy_health", test_entropy_health},
+    {"common.energy_session", test_energy_session},
+    {"common.energy_free_while_dimming", test_energy_free_while_dimming},
+};
+
+int main(int argc, char** argv) {
+    const char* only = argc > 1 ? argv[1] : NULL;
+    int failed = 0;
+
+    for(size_t i = 0; i < sizeof(kernel_tests) / sizeof(kernel_tests[0]); i++) {
+        const KernelTest* test = &kernel_tests[i];
+        if(only && !strstr(test->name, only)) {
+            continue;
+        }
+        tests_random_state = 1;
+        double start = tests_now();
+        if(test->run()) {
+            printf("ok   %s (%.2fs)\n", test->name, tests_now() - start);
+        } else {
+            printf("FAIL %s\n", test->name);
+            failed++;
+        }
+        fflush(stdout);
+    }
+    return failed;
+}
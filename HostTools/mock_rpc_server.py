@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Local Solana JSON-RPC stand-in for trying the Solana Wallet RPC client without a real node.
+
+Answers getBalance, getLatestBlockhash, getAccountInfo and getSlot with made up but well formed
+results, single or batched, and counts HTTP requests and calls so the effect of the wallet's
+cache and batching is easy to see.  getMockStats answers with those counts so far, itself
+included, for tests.  --port 0 picks a free port, the URL printed first says which:
+
+    python3 mock_rpc_server.py --port 8899
+    python3 esp32_link_emulator.py serve --rpc-url http://127.0.0.1:8899
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import base64
+import collections
+import hashlib
+import http.server
+import json
+import sys
+import threading
+import time
+
+BASE58_ALPHABET = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz"
+SLOTS_PER_SECOND = 2.5
+BLOCKHASH_LIFETIME = 150  # Slots a blockhash stays valid for
+
+
+def base58(data):
+    number = int.from_bytes(data, "big")
+    text = ""
+    while number:
+        number, digit = divmod(number, 58)
+        text = BASE58_ALPHABET[digit] + text
+    return "1" * (len(data) - len(data.lstrip(b"\0"))) + text
+
+
+class Chain:
+    """Made up chain state: the slot advances with wall time and balances derive from the key."""
+
+    def __init__(self):
+        self.start = time.monotonic()
+
+    def slot(self):
+        return 1000 + int((time.monotonic() - self.start) * SLOTS_PER_SECOND)
+
+    def context(self):
+        return {"apiVersion": "mock", "slot": self.slot()}
+
+    def call(self, method, params):
+        """Return (result, error) for one call."""
+        if method == "getSlot":
+            return self.slot(), None
+        if method == "getLatestBlockhash":
+            # A new blockhash every 4 slots, like a busy cluster.
+            epoch = self.slot() // 4
+            blockhash = base58(hashlib.sha256(f"blockhash{epoch}".encode()).digest())
+            height = epoch * 4 + BLOCKHASH_LIFETIME
+            value = {"blockhash": blockhash, "lastValidBlockHeight": height}
+            return {"context": self.context(), "value": value}, None
+        if method not in ("getBalance", "getAccountInfo"):
+            return None, {"code": -32601, "message": "Method not found"}
+        if not params or not isinstance(params[0], str):
+            return None, {"code": -32602, "message": "Invalid params"}
+        digest = hashlib.sha256(params[0].encode()).digest()
+        if method == "getBalance":
+            lamports = int.from_bytes(digest[:4], "little")
+            return {"context": self.context(), "value": lamports}, None
+        value = {
+            "data": [base64.b64encode(digest).decode(), "base64"],
+            "executable": False,
+            "lamports": int.from_bytes(digest[:4], "little"),
+            "owner": "11111111111111111111111111111111",
+            "rentEpoch": 0,
+            "space": len(digest),
+        }
+        return {"context": self.context(), "value": value}, None
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    def do_POST(self):
+        server = self.server
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        try:
+            request = json.loads(body)
+        except ValueError:
+            error = {"code": -32700, "message": "Parse error"}
+            self.reply({"jsonrpc": "2.0", "id": None, "error": error})
+            return
+
+        calls = request if isinstance(request, list) else [request]
+        replies = []
+        with server.lock:
+            server.stats["http"] += 1
+            server.stats["batches"] += isinstance(request, list)
+            for call in calls:
+                method = call.get("method")
+                server.stats["calls"] += 1
+                server.methods[method] += 1
+                if method == "getMockStats":
+                    result, error = dict(server.stats), None
+                else:
+                    result, error = server.chain.call(method, call.get("params"))
+                reply = {"jsonrpc": "2.0", "id": call.get("id")}
+                reply.update({"error": error} if error else {"result": result})
+                replies.append(reply)
+
+        time.sleep(server.latency / 1000)
+        self.reply(replies if isinstance(request, list) else replies[0])
+
+    def reply(self, message):
+        data = json.dumps(message, separators=(",", ":")).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def log_message(self, fmt, *args):
+        if self.server.verbose:
+            sys.stderr.write("[mock-rpc] " + fmt % args + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8899)
+    parser.add_argument("--latency", type=float, default=50, help="added per HTTP request, ms")
+    parser.add_argument("--verbose", action="store_true", help="log every HTTP request")
+    args = parser.parse_args()
+
+    server = http.server.ThreadingHTTPServer((args.host, args.port), Handler)
+    server.chain = Chain()
+    server.latency = args.latency
+    server.verbose = args.verbose
+    server.lock = threading.Lock()
+    server.stats = {"http": 0, "batches": 0, "calls": 0}
+    server.methods = collections.Counter()
+
+    print(f"mock RPC on http://{args.host}:{server.server_address[1]}", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    stats = server.stats
+    print(f"\n{stats['http']} HTTP requests, {stats['batches']} batches, {stats['calls']} calls")
+    for method, count in server.methods.most_common():
+        print(f"  {method}: {count}")
+
+
+if __name__ == "__main__":
+    main()
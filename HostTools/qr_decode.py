@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+"""Decode QR code module matrices, as a reference to check the Solana Wallet's QR encoder against.
+
+Written from ISO/IEC 18004 without looking at SolanaWallet/qr_code.c, so a mistake in one is
+unlikely to be repeated in the other.  It reads the format information (either copy, correcting
+up to 3 bit errors), removes the mask, reads the codewords in zigzag order, corrects errors with
+Reed-Solomon and parses the numeric, alphanumeric and byte segments.  Versions 1 to 6 with error
+correction level L or M, which use a single block, are supported; that covers everything the
+encoder makes.
+
+    python3 qr_decode.py matrix.txt
+    python3 qr_decode.py --damage 3 matrix.txt
+
+A matrix file has one line per module row, "1" or "#" for dark and "0" or "." or a space for
+light, with no quiet zone.  --damage flips that many random data modules before decoding, to
+see the error correction at work.  "kernel_bench.py test" uses decode() on every code its
+encoder test makes.  Only the Python standard library is used.
+"""
+
+import argparse
+import random
+import sys
+
+
+class QrError(Exception):
+    pass
+
+
+# Error correction level from the 2 format bits, and the codewords per version (single block)
+LEVELS = {1: "L", 0: "M", 3: "Q", 2: "H"}
+TOTAL_CODEWORDS = {1: 26, 2: 44, 3: 70, 4: 100, 5: 134, 6: 172}
+EC_CODEWORDS = {
+    "L": {1: 7, 2: 10, 3: 15, 4: 20, 5: 26, 6: 18},
+    "M": {1: 10, 2: 16, 3: 26, 4: 18, 5: 24, 6: 16},
+}
+# Versions where the level still uses one block
+SINGLE_BLOCK = {"L": (1, 2, 3, 4, 5), "M": (1, 2, 3)}
+ALIGNMENT = {1: [], 2: [6, 18], 3: [6, 22], 4: [6, 26], 5: [6, 30], 6: [6, 34]}
+ALPHANUMERIC = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:"
+
+MASKS = [
+    lambda row, column: (row + column) % 2 == 0,
+    lambda row, column: row % 2 == 0,
+    lambda row, column: column % 3 == 0,
+    lambda row, column: (row + column) % 3 == 0,
+    lambda row, column: (row // 2 + column // 3) % 2 == 0,
+    lambda row, column: (row * column) % 2 + (row * column) % 3 == 0,
+    lambda row, column: ((row * column) % 2 + (row * column) % 3) % 2 == 0,
+    lambda row, column: ((row + column) % 2 + (row * column) % 3) % 2 == 0,
+]
+
+
+# GF(256) with the QR polynomial x^8 + x^4 + x^3 + x^2 + 1
+EXP = [0] * 512
+LOG = [0] * 256
+_value = 1
+for _power in range(255):
+    EXP[_power] = _value
+    LOG[_value] = _power
+    _value <<= 1
+    if _value & 0x100:
+        _value ^= 0x11D
+for _power in range(255, 512):
+    EXP[_power] = EXP[_power - 255]
+
+
+def gf_multiply(a, b):
+    return 0 if a == 0 or b == 0 else EXP[LOG[a] + LOG[b]]
+
+
+def gf_divide(a, b):
+    if b == 0:
+        raise ZeroDivisionError
+    return 0 if a == 0 else EXP[LOG[a] - LOG[b] + 255]
+
+
+def poly_evaluate(poly, x):
+    """poly has the highest power first."""
+    result = 0
+    for coefficient in poly:
+        result = gf_multiply(result, x) ^ coefficient
+    return result
+
+
+def rs_correct(codewords, ec_count):
+    """Correct up to ec_count // 2 wrong codewords in place, return how many were fixed."""
+    syndromes = [poly_evaluate(codewords, EXP[i]) for i in range(ec_count)]
+    if not any(syndromes):
+        return 0
+
+    # Berlekamp-Massey for the error locator, lowest power first
+    locator, previous = [1], [1]
+    length, shift, previous_delta = 0, 1, 1
+    for step in range(ec_count):
+        delta = syndromes[step]
+        for i in range(1, length + 1):
+            if i < len(locator):
+                delta ^= gf_multiply(locator[i], syndromes[step - i])
+        if delta == 0:
+            shift += 1
+            continue
+        scale = gf_divide(delta, previous_delta)
+        updated = locator + [0] * max(0, len(previous) + shift - len(locator))
+        for i, coefficient in enumerate(previous):
+            updated[i + shift] ^= gf_multiply(scale, coefficient)
+        if 2 * length <= step:
+            previous, previous_delta = locator, delta
+            length = step + 1 - length
+            shift = 1
+        else:
+            shift += 1
+        locator = updated
+    locator = locator[: length + 1]
+    errors = len(locator) - 1
+    if 2 * errors > ec_count:
+        raise QrError("too many errors")
+
+    # Chien search: position p (counted from the end) is wrong if locator(alpha^-p) == 0
+    count = len(codewords)
+    positions = [
+        p for p in range(count) if poly_evaluate(locator[::-1], EXP[(255 - p) % 255]) == 0
+    ]
+    if len(positions) != errors:
+        raise QrError("uncorrectable")
+
+    # Forney: evaluator = syndromes * locator mod x^ec_count, lowest power first
+    evaluator = [0] * ec_count
+    for i, syndrome in enumerate(syndromes):
+        for j, coefficient in enumerate(locator):
+            if i + j < ec_count:
+                evaluator[i + j] ^= gf_multiply(syndrome, coefficient)
+    derivative = [locator[i] if i % 2 else 0 for i in range(1, len(locator))]
+    for p in positions:
+        x_inverse = EXP[(255 - p) % 255]
+        numerator = poly_evaluate(evaluator[::-1], x_inverse)
+        denominator = poly_evaluate(derivative[::-1], x_inverse)
+        codewords[count - 1 - p] ^= gf_multiply(EXP[p], gf_divide(numerator, denominator))
+
+    if any(poly_evaluate(codewords, EXP[i]) for i in range(ec_count)):
+        raise QrError("uncorrectable")
+    return errors
+
+
+def format_codeword(data):
+    """The 15 bit BCH(15,5) format word for 5 data bits, before the 0x5412 mask."""
+    remainder = data << 10
+    for bit in range(14, 9, -1):
+        if remainder >> bit & 1:
+            remainder ^= 0x537 << (bit - 10)
+    return data << 10 | remainder
+
+
+def function_modules(version):
+    """Set of (row, column) positions that are not data."""
+    size = 17 + 4 * version
+    taken = set()
+    for row0, column0 in ((0, 0), (0, size - 8), (size - 8, 0)):
+        for row in range(row0, row0 + 8):
+            for column in range(column0, column0 + 8):
+                taken.add((row, column))
+    for i in range(size):
+        taken.add((6, i))
+        taken.add((i, 6))
+    # Format information next to the finders, and the dark module
+    for i in range(9):
+        taken.add((8, i))
+        taken.add((i, 8))
+    for i in range(8):
+        taken.add((8, size - 1 - i))
+        taken.add((size - 1 - i, 8))
+    centres = ALIGNMENT[version]
+    for row in centres:
+        for column in centres:
+            if (row, column) in ((6, 6), (6, size - 7), (size - 7, 6)):
+                continue
+            for r in range(row - 2, row + 3):
+                for c in range(column - 2, column + 3):
+                    taken.add((r, c))
+    return taken
+
+
+def data_positions(version):
+    """Data module positions in the order the bits are placed."""
+    size = 17 + 4 * version
+    taken = function_modules(version)
+    positions = []
+    upward = True
+    right = size - 1
+    while right > 0:
+        if right == 6:
+            right -= 1
+        rows = range(size - 1, -1, -1) if upward else range(size)
+        for row in rows:
+            for column in (right, right - 1):
+                if (row, column) not in taken:
+                    positions.append((row, column))
+        upward = not upward
+        right -= 2
+    return positions
+
+
+def read_format(matrix):
+    size = len(matrix)
+    first = [matrix[8][i] for i in (0, 1, 2, 3, 4, 5, 7, 8)] + [matrix[i][8] for i in (7,)]
+    first += [matrix[i][8] for i in (5, 4, 3, 2, 1, 0)]
+    second = [matrix[size - 1 - i][8] for i in range(7)]
+    second += [matrix[8][size - 8 + i] for i in range(8)]
+    candidates = []
+    for bits in (first, second):
+        # Bit 14 is read first.
+        value = 0
+        for bit in bits:
+            value = value << 1 | bit
+        candidates.append(value)
+    best = None
+    for data in range(32):
+        word = format_codeword(data) ^ 0x5412
+        distance = min(bin(word ^ value).count("1") for value in candidates)
+        if best is None or distance < best[0]:
+            best = (distance, data)
+    if best[0] > 3:
+        raise QrError("unreadable format information")
+    return LEVELS[best[1] >> 3], best[1] & 7
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.position = 0
+
+    def left(self):
+        return len(self.data) * 8 - self.position
+
+    def read(self, count):
+        if count > self.left():
+            raise QrError("segment runs past the data")
+        value = 0
+        for _ in range(count):
+            byte = self.data[self.position >> 3]
+            value = value << 1 | (byte >> (7 - (self.position & 7)) & 1)
+            self.position += 1
+        return value
+
+
+def parse_segments(data):
+    reader = BitReader(data)
+    text = bytearray()
+    while reader.left() >= 4:
+        mode = reader.read(4)
+        if mode == 0:
+            break
+        if mode == 0b0001:
+            count = reader.read(10)
+            digits = ""
+            while count >= 3:
+                digits += "%03d" % reader.read(10)
+                count -= 3
+            if count:
+                digits += "%0*d" % (count, reader.read(4 if count == 1 else 7))
+            text += digits.encode()
+        elif mode == 0b0010:
+            count = reader.read(9)
+            while count >= 2:
+                pair = reader.read(11)
+                text += (ALPHANUMERIC[pair // 45] + ALPHANUMERIC[pair % 45]).encode()
+                count -= 2
+            if count:
+                text += ALPHANUMERIC[reader.read(6)].encode()
+        elif mode == 0b0100:
+            count = reader.read(8)
+            text += bytes(reader.read(8) for _ in range(count))
+        else:
+            raise QrError("unsupported mode %d" % mode)
+    return bytes(text)
+
+
+def decode(rows, details=None):
+    """Decode a matrix given as rows of 0/1 ints or strings.  Returns the payload as bytes.
+
+    details, if given, is a dict that receives version, level, mask and corrected.
+    """
+    matrix = [
+        [1 if cell in (1, True, "1", "#") else 0 for cell in row]
+        for row in (r if not isinstance(r, str) else r.rstrip("\n") for r in rows)
+    ]
+    size = len(matrix)
+    version = (size - 17) // 4
+    if size < 21 or (size - 17) % 4 or any(len(row) != size for row in matrix):
+        raise QrError("not a square QR matrix")
+    if version not in TOTAL_CODEWORDS:
+        raise QrError("version %d is not supported" % version)
+
+    level, mask = read_format(matrix)
+    if level not in SINGLE_BLOCK or version not in SINGLE_BLOCK[level]:
+        raise QrError("version %d-%s uses several blocks, not supported" % (version, level))
+
+    bits = [
+        matrix[row][column] ^ MASKS[mask](row, column)
+        for row, column in data_positions(version)
+    ]
+    total = TOTAL_CODEWORDS[version]
+    codewords = [
+        int("".join(str(bit) for bit in bits[i * 8 : i * 8 + 8]), 2) for i in range(total)
+    ]
+    ec_count = EC_CODEWORDS[level][version]
+    corrected = rs_correct(codewords, ec_count)
+    if details is not None:
+        details.update(version=version, level=level, mask=mask, corrected=corrected)
+    return parse_segments(codewords[: total - ec_count])
+
+
+def damage(rows, count, rng):
+    """Flip count random data modules of a matrix given as strings of 0 and 1."""
+    matrix = [list(row) for row in rows]
+    version = (len(matrix) - 17) // 4
+    for row, column in rng.sample(data_positions(version), count):
+        matrix[row][column] = "0" if matrix[row][column] == "1" else "1"
+    return ["".join(row) for row in matrix]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("matrix", help="text file with one line per module row")
+    parser.add_argument("--damage", type=int, default=0, help="flip this many data modules")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    try:
+        with open(args.matrix) as file:
+            rows = [line.rstrip("\n").replace("#", "1").replace(".", "0").replace(" ", "0")
+                    for line in file if line.strip()]
+        if args.damage:
+            rows = damage(rows, args.damage, random.Random(args.seed))
+        details = {}
+        text = decode(rows, details)
+    except (OSError, QrError) as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+    print(
+        "version %(version)d-%(level)s, mask %(mask)d, %(corrected)d codeword(s) corrected"
+        % details
+    )
+    print(text.decode("utf-8", "replace"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,502 @@
+#!/usr/bin/env python3
+"""Sync the ToDo List app's tasks with this computer over the Flipper's USB serial CLI.
+
+Types "todo_sync" into the CLI and speaks the protocol from ToDoList/todo_sync.h.  Both sides
+keep a version vector per task and a knowledge vector per list, so a sync only carries the tasks
+the other side hasn't seen: with nothing changed it is the two HELLOs, two ENDs and a DONE.
+Changed tasks go in batches of up to 1 KiB, heatshrink compressed when that is smaller.
+
+    python3 todo_sync.py add "Buy milk"
+    python3 todo_sync.py sync --port /dev/ttyACM0
+    python3 todo_sync.py list
+
+    serve   Open a pty that acts like the flipper's CLI with the app running, print its path,
+            and answer syncs until Ctrl+C.  --tasks fills it with that many tasks first.
+    bench   Run the stand-in in-process and report bytes and time for a cold sync, a sync with
+            nothing changed, and syncs after a few edits on each side.
+
+The desktop's tasks live in a JSON file (--store, todo_sync.json by default).  When the flipper
+reports a new epoch it has started a fresh list, so every task here is sent to it again.  Only
+the Python standard library is used.
+"""
+
+import argparse
+import binascii
+import json
+import os
+import select
+import struct
+import sys
+import threading
+import time
+import tty
+
+from asset_pack import PackError, heatshrink, unheatshrink
+
+SOF = 0x7E
+HEADER = struct.Struct("<BBBH")  # sof, type, flags, length
+RECORD = struct.Struct("<IIIBB")  # id, device version, desktop version, flags, text length
+MAX_PAYLOAD = 1024
+TIMEOUT = 2.0
+PROTOCOL_VERSION = 1
+FLAG_COMPRESSED = 0x01
+RECORD_DELETED = 0x01
+TASK_LENGTH = 64
+ID_DESKTOP = 0x80000000
+
+FRAME_HELLO = 0x01
+FRAME_RECORDS = 0x02
+FRAME_END = 0x03
+FRAME_DONE = 0x04
+DONE_FULL = 1
+
+DEVICE, DESKTOP = 0, 1
+
+
+class SyncError(Exception):
+    pass
+
+
+class Link:
+    """Frames over a file descriptor, counting what crosses it."""
+
+    def __init__(self, fd):
+        self.fd = fd
+        self.buffer = bytearray()
+        self.bytes_out = 0
+        self.bytes_in = 0
+        self.frames = 0
+
+    def write(self, data):
+        self.bytes_out += len(data)
+        while data:
+            data = data[os.write(self.fd, data) :]
+
+    def send(self, frame_type, payload):
+        flags, body = 0, payload
+        # Same choice as todo_sync_send(): compress only when it saves at least three bytes.
+        if len(payload) > 32:
+            packed = heatshrink(payload)
+            if len(packed) <= len(payload) - 3:
+                flags, body = FLAG_COMPRESSED, struct.pack("<H", len(payload)) + packed
+        frame = HEADER.pack(SOF, frame_type, flags, len(body)) + body
+        crc = binascii.crc_hqx(frame[1:], 0xFFFF)
+        self.write(frame + struct.pack("<H", crc))
+        self.frames += 1
+
+    def fill(self, deadline):
+        remaining = deadline - time.monotonic()
+        ready, _, _ = select.select([self.fd], [], [], max(remaining, 0))
+        if not ready:
+            raise SyncError("timed out waiting for the other side")
+        data = os.read(self.fd, 4096)
+        if not data:
+            raise SyncError("connection closed")
+        self.bytes_in += len(data)
+        self.buffer += data
+
+    def receive(self):
+        """Return (type, payload) of the next good frame, skipping CLI echo and bad CRCs."""
+        deadline = time.monotonic() + TIMEOUT
+        while True:
+            start = self.buffer.find(SOF)
+            if start < 0:
+                self.buffer.clear()
+            else:
+                del self.buffer[:start]
+                if len(self.buffer) >= HEADER.size:
+                    _, frame_type, flags, length = HEADER.unpack_from(self.buffer)
+                    end = HEADER.size + length + 2
+                    if length > MAX_PAYLOAD:
+                        del self.buffer[:1]
+                        continue
+                    if len(self.buffer) >= end:
+                        frame = bytes(self.buffer[:end])
+                        (crc,) = struct.unpack_from("<H", frame, end - 2)
+                        if crc != binascii.crc_hqx(frame[1 : end - 2], 0xFFFF):
+                            del self.buffer[:1]
+                            continue
+                        del self.buffer[:end]
+                        return frame_type, self.unpack(flags, frame[HEADER.size : end - 2])
+            self.fill(deadline)
+
+    def unpack(self, flags, body):
+        if not flags & FLAG_COMPRESSED:
+            return body
+        if len(body) < 2:
+            raise SyncError("compressed frame without a length")
+        (size,) = struct.unpack_from("<H", body)
+        try:
+            return unheatshrink(body[2:], size)
+        except PackError as error:
+            raise SyncError(f"bad compressed frame: {error}") from error
+
+    def expect(self, frame_type, minimum=0):
+        got, payload = self.receive()
+        if got != frame_type or len(payload) < minimum:
+            raise SyncError(f"expected frame {frame_type}, got {got} ({len(payload)} bytes)")
+        return payload
+
+
+class Replica:
+    """One side's task list: ids, version vectors and what it knows of the other side."""
+
+    def __init__(self, side):
+        self.side = side
+        self.tasks = {}  # id -> {"version": [device, desktop], "text": str, "deleted": bool}
+        self.knowledge = [0, 0]
+        self.next_id = 0
+        self.epoch = 0
+
+    def stamp(self, task):
+        self.knowledge[self.side] += 1
+        task["version"][self.side] = self.knowledge[self.side]
+
+    def add(self, text):
+        task_id = self.next_id | (ID_DESKTOP if self.side == DESKTOP else 0)
+        self.next_id += 1
+        task = {"version": [0, 0], "text": text[: TASK_LENGTH - 1], "deleted": False}
+        self.stamp(task)
+        self.tasks[task_id] = task
+        return task_id
+
+    def edit(self, task_id, text=None, deleted=False):
+        task = self.tasks[task_id]
+        if text is not None:
+            task["text"] = text[: TASK_LENGTH - 1]
+        task["deleted"] = deleted
+        self.stamp(task)
+
+    def live(self):
+        return {task_id: task for task_id, task in self.tasks.items() if not task["deleted"]}
+
+    def unknown_to(self, knowledge):
+        return [
+            (task_id, task)
+            for task_id, task in self.tasks.items()
+            if any(task["version"][side] > knowledge[side] for side in (DEVICE, DESKTOP))
+        ]
+
+    def apply(self, task_id, version, text, deleted, capacity=None):
+        """Merge one record.  Returns "changed", "ignored" or "full" like todo_tasks_apply()."""
+        local = self.tasks.get(task_id)
+        if local is None:
+            if deleted:
+                return "ignored"
+            if capacity is not None and len(self.live()) >= capacity:
+                return "full"
+            self.tasks[task_id] = {"version": list(version), "text": text, "deleted": False}
+            return "changed"
+        if all(version[side] <= local["version"][side] for side in (DEVICE, DESKTOP)):
+            return "ignored"
+        newer = all(version[side] >= local["version"][side] for side in (DEVICE, DESKTOP))
+        # Edited on both sides since the last sync: the desktop's edit wins on both ends.
+        if newer or self.side == DEVICE:
+            local["text"] = text
+            local["deleted"] = deleted
+        local["version"] = [max(a, b) for a, b in zip(version, local["version"])]
+        if self.side == DEVICE and local["deleted"]:
+            del self.tasks[task_id]
+        return "changed"
+
+
+def encode_batches(tasks):
+    """Yield RECORDS payloads of at most MAX_PAYLOAD bytes."""
+    batch = bytearray()
+    for task_id, task in tasks:
+        text = task["text"].encode()[: TASK_LENGTH - 1]
+        flags = RECORD_DELETED if task["deleted"] else 0
+        record = RECORD.pack(task_id, *task["version"], flags, len(text)) + text
+        if len(batch) + len(record) > MAX_PAYLOAD:
+            yield bytes(batch)
+            batch.clear()
+        batch += record
+    if batch:
+        yield bytes(batch)
+
+
+def decode_batch(payload):
+    offset = 0
+    while offset < len(payload):
+        if len(payload) - offset < RECORD.size:
+            raise SyncError("truncated record")
+        task_id, v_device, v_desktop, flags, length = RECORD.unpack_from(payload, offset)
+        offset += RECORD.size
+        if len(payload) - offset < length:
+            raise SyncError("truncated record text")
+        text = payload[offset : offset + length].decode(errors="replace")[: TASK_LENGTH - 1]
+        offset += length
+        yield task_id, [v_device, v_desktop], text, bool(flags & RECORD_DELETED)
+
+
+def send_records(link, tasks):
+    for batch in encode_batches(tasks):
+        link.send(FRAME_RECORDS, batch)
+    link.send(FRAME_END, struct.pack("<H", len(tasks)))
+
+
+def receive_records(link, apply):
+    count = 0
+    while True:
+        frame_type, payload = link.receive()
+        if frame_type == FRAME_END:
+            if len(payload) < 2 or struct.unpack_from("<H", payload)[0] != count:
+                raise SyncError("record count mismatch")
+            return count
+        if frame_type != FRAME_RECORDS:
+            raise SyncError(f"unexpected frame {frame_type}")
+        for record in decode_batch(payload):
+            apply(*record)
+            count += 1
+
+
+def desktop_sync(link, store, command=True):
+    """The desktop's half of a sync.  Returns a dict of what happened."""
+    if command:
+        link.write(b"todo_sync\r")
+    hello = link.expect(FRAME_HELLO, 17)
+    version, epoch, k_device, k_desktop, count, capacity = struct.unpack_from("<BIIIHH", hello)
+    if version != PROTOCOL_VERSION:
+        raise SyncError(f"flipper speaks protocol {version}, this tool {PROTOCOL_VERSION}")
+
+    cold = epoch != store.epoch
+    if cold:
+        # A fresh list on the flipper: its old ids mean nothing now, so everything here becomes
+        # a desktop task again and goes over.
+        tasks = store.live()
+        store.tasks = {}
+        store.knowledge[DEVICE] = 0
+        store.epoch = epoch
+        for task_id, task in tasks.items():
+            if not task_id & ID_DESKTOP:
+                task_id = store.next_id | ID_DESKTOP
+                store.next_id += 1
+            task["version"] = [0, 0]
+            store.stamp(task)
+            store.tasks[task_id] = task
+
+    link.send(FRAME_HELLO, struct.pack("<BII", PROTOCOL_VERSION, *store.knowledge))
+    stats = {"cold": cold, "received": 0, "sent": 0, "flipper_tasks": count}
+
+    def apply(task_id, version, text, deleted):
+        if store.apply(task_id, version, text, deleted) == "changed":
+            stats["received"] += 1
+
+    receive_records(link, apply)
+    outgoing = store.unknown_to([k_device, k_desktop])
+    send_records(link, outgoing)
+    stats["sent"] = len(outgoing)
+
+    done = link.expect(FRAME_DONE, 9)
+    status, k_device_after, k_desktop_after = struct.unpack_from("<BII", done)
+    store.knowledge[DEVICE] = max(store.knowledge[DEVICE], k_device)
+    stats["full"] = status == DONE_FULL
+    stats["flipper_knowledge"] = [k_device_after, k_desktop_after]
+    if stats["full"]:
+        stats["note"] = f"the flipper holds {capacity} tasks, the rest go next sync"
+    return stats
+
+
+def device_sync(link, device, capacity):
+    """The flipper's half, the same steps as todo_sync_exchange()."""
+    live = len(device.live())
+    link.send(
+        FRAME_HELLO,
+        struct.pack("<BIIIHH", PROTOCOL_VERSION, device.epoch, *device.knowledge, live, capacity),
+    )
+    hello = link.expect(FRAME_HELLO, 9)
+    if hello[0] != PROTOCOL_VERSION:
+        raise SyncError("protocol version mismatch")
+    desktop = list(struct.unpack_from("<II", hello, 1))
+    send_records(link, device.unknown_to(desktop))
+
+    rejected = 0
+
+    def apply(task_id, version, text, deleted):
+        nonlocal rejected
+        if device.apply(task_id, version, text, deleted, capacity) == "full":
+            rejected += 1
+
+    receive_records(link, apply)
+    if not rejected:
+        device.knowledge[DESKTOP] = max(device.knowledge[DESKTOP], desktop[DESKTOP])
+    status = DONE_FULL if rejected else 0
+    link.send(FRAME_DONE, struct.pack("<BII", status, *device.knowledge))
+
+
+def load(path):
+    store = Replica(DESKTOP)
+    if os.path.exists(path):
+        with open(path) as file:
+            data = json.load(file)
+        store.tasks = {int(task_id): task for task_id, task in data["tasks"].items()}
+        store.knowledge = data["knowledge"]
+        store.next_id = data["next_id"]
+        store.epoch = data["device_epoch"]
+    return store
+
+
+def save(store, path):
+    data = {
+        "tasks": store.tasks,
+        "knowledge": store.knowledge,
+        "next_id": store.next_id,
+        "device_epoch": store.epoch,
+    }
+    with open(path, "w") as file:
+        json.dump(data, file, indent=1)
+
+
+def open_pty():
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    return master, slave, os.ttyname(slave)
+
+
+def make_device(count, seed_epoch=0x5EED):
+    device = Replica(DEVICE)
+    device.epoch = seed_epoch
+    for index in range(count):
+        device.add(f"Task {index}: pick up parts for the next build")
+    return device
+
+
+def serve_device(fd, device, capacity, stop):
+    """Wait for "todo_sync" on the CLI and answer it, like the app's CLI command."""
+    link = Link(fd)
+    line = bytearray()
+    while not stop.is_set():
+        ready, _, _ = select.select([fd], [], [], 0.1)
+        if not ready:
+            continue
+        try:
+            data = os.read(fd, 4096)
+        except OSError:
+            break
+        for byte in data:
+            if byte in b"\r\n":
+                if line.strip() == b"todo_sync":
+                    try:
+                        device_sync(link, device, capacity)
+                    except SyncError as error:
+                        print(f"[flipper] sync failed: {error}", file=sys.stderr)
+                line.clear()
+            else:
+                line.append(byte)
+
+
+def serve(args):
+    master, _slave, path = open_pty()
+    print(path, flush=True)
+    device = make_device(args.tasks)
+    stop = threading.Event()
+    try:
+        serve_device(master, device, args.capacity, stop)
+    except KeyboardInterrupt:
+        pass
+
+
+def bench(args):
+    master, slave, path = open_pty()
+    device = make_device(args.tasks)
+    stop = threading.Event()
+    thread = threading.Thread(
+        target=serve_device, args=(master, device, args.capacity, stop), daemon=True
+    )
+    thread.start()
+    store = Replica(DESKTOP)
+    print(f"{args.tasks} tasks on the stand-in flipper ({path})\n")
+    print(f"{'sync':<28}{'to flipper':>11}{'from flipper':>13}{'records':>9}{'ms':>9}")
+
+    def run(label):
+        link = Link(slave)
+        started = time.perf_counter()
+        stats = desktop_sync(link, store)
+        elapsed = (time.perf_counter() - started) * 1000
+        records = stats["sent"] + stats["received"]
+        print(f"{label:<28}{link.bytes_out:>11}{link.bytes_in:>13}{records:>9}{elapsed:>9.1f}")
+
+    run("cold")
+    run("nothing changed")
+    ids = sorted(device.live())
+    for index in range(args.changed):
+        device.edit(ids[index * len(ids) // args.changed], text=f"Edited on the flipper {index}")
+    run(f"{args.changed} edited on the flipper")
+    desktop_ids = sorted(store.live())
+    for index in range(args.changed):
+        store.edit(desktop_ids[-1 - index], text=f"Edited on the desktop {index}")
+    run(f"{args.changed} edited on the desktop")
+    run("nothing changed")
+    stop.set()
+    thread.join()
+
+    same = {k: v["text"] for k, v in store.live().items()} == {
+        k: v["text"] for k, v in device.live().items()
+    }
+    print(f"\nBoth sides hold the same {len(device.live())} tasks: {same}")
+    if not same:
+        sys.exit(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--store", default="todo_sync.json", help="the desktop's task file")
+    sub = parser.add_subparsers(dest="mode", required=True)
+    sync_parser = sub.add_parser("sync", help="sync with a flipper")
+    sync_parser.add_argument("--port", required=True, help="e.g. /dev/ttyACM0, or a serve pty")
+    add_parser = sub.add_parser("add", help="add a task on the desktop")
+    add_parser.add_argument("text")
+    delete_parser = sub.add_parser("delete", help="delete a task, on both sides next sync")
+    delete_parser.add_argument("id", type=lambda value: int(value, 0))
+    sub.add_parser("list", help="show the desktop's tasks")
+    serve_parser = sub.add_parser("serve", help="act like a flipper on a new pty")
+    serve_parser.add_argument("--tasks", type=int, default=0)
+    serve_parser.add_argument("--capacity", type=int, default=1000)
+    bench_parser = sub.add_parser("bench", help="measure cold and incremental syncs")
+    bench_parser.add_argument("--tasks", type=int, default=1000)
+    bench_parser.add_argument("--capacity", type=int, default=1000)
+    bench_parser.add_argument("--changed", type=int, default=10)
+    args = parser.parse_args()
+
+    if args.mode == "serve":
+        serve(args)
+        return
+    if args.mode == "bench":
+        bench(args)
+        return
+
+    store = load(args.store)
+    if args.mode == "add":
+        print(f"added {store.add(args.text):#010x}")
+    elif args.mode == "delete":
+        if args.id not in store.live():
+            sys.exit(f"no task {args.id:#010x}")
+        store.edit(args.id, deleted=True)
+    elif args.mode == "list":
+        for task_id, task in store.live().items():
+            print(f"{task_id:#010x}  {task['text']}")
+        return
+    else:
+        fd = os.open(args.port, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(fd)
+        link = Link(fd)
+        started = time.perf_counter()
+        try:
+            stats = desktop_sync(link, store)
+        except SyncError as error:
+            sys.exit(f"sync failed, nothing saved: {error}")
+        finally:
+            os.close(fd)
+        elapsed = (time.perf_counter() - started) * 1000
+        print(
+            f"{'cold' if stats['cold'] else 'incremental'} sync: sent {stats['sent']}, "
+            f"received {stats['received']}, {link.bytes_out} bytes out, {link.bytes_in} in, "
+            f"{elapsed:.0f} ms"
+        )
+        if stats["full"]:
+            print(stats["note"])
+    save(store, args.store)
+
+
+if __name__ == "__main__":
+    main()
@@ -5,20 +5,14 @@
 #include <gui/view_dispatcher.h>
 #include <gui/modules/submenu.h>
 #include <gui/modules/widget.h>
-#include <notification/notification.h>
-#include <notification/notification_messages.h>
+#include "../common/energy.h"
+#include "../common/view_table.h"
 
 #define TAG "Skeleton"
 
-// Change this to BACKLIGHT_AUTO if you don't want the backlight to be continuously on.
-#define BACKLIGHT_ON 1
-
-// Our application menu has 3 items.  You can add more items if you want.
-typedef enum {
-    SkeletonSubmenuIndexConfigure,
-    SkeletonSubmenuIndexGame,
-    SkeletonSubmenuIndexAbout,
-} SkeletonSubmenuIndex;
+// The backlight stays on while the app is used and dims on a screen left idle.  EnergyBacklightOn
+// keeps it at full brightness, EnergyBacklightAuto leaves it to the firmware.
+#define SKELETON_BACKLIGHT EnergyBacklightDim
 
 // Each view is a screen we show the user.
 typedef enum {
@@ -27,48 +21,12 @@ typedef enum {
 } SkeletonView;
 
 typedef struct {
-    ViewDispatcher* view_dispatcher; // Switches between our views
-    NotificationApp* notifications; // Used for controlling the backlight
+    ViewTable* views; // Allocates our views and switches between them
+    Energy* energy; // Backlight policy and the energy report
     Submenu* submenu; // The application menu
     Widget* widget_about; // The about screen
 } SkeletonApp;
 
-/**
- * @brief      Callback for exiting the application.
- * @details    This function is called when user press back button.  We return VIEW_NONE to
- *            indicate that we want to exit the application.
- * @param      _context  The context - unused
- * @return     next view id
-*/
-static uint32_t skeleton_navigation_exit_callback(void* _context) {
-    UNUSED(_context);
-    return VIEW_NONE;
-}
-
-/**
- * @brief      Callback for returning to submenu.
- * @details    This function is called when user press back button.  We return VIEW_NONE to
- *            indicate that we want to navigate to the submenu.
- * @param      _context  The context - unused
- * @return     next view id
-*/
-static uint32_t skeleton_navigation_submenu_callback(void* _context) {
-    UNUSED(_context);
-    return SkeletonViewSubmenu;
-}
-
-/**
- * @brief      Handle submenu item selection.
- * @details    This function is called when user selects an item from the submenu.
- * @param      context  The context - SkeletonApp object.
- * @param      index     The SkeletonSubmenuIndex item that was clicked.
-*/
-static void skeleton_submenu_callback(void* context, uint32_t index) {
-    UNUSED(index);
-    SkeletonApp* app = (SkeletonApp*)context;
-    view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewComingSoon);
-}
-
 /**
  * @brief      Callback for drawing the coming soon screen.
  * @details    This function is called when the screen needs to be redrawn.
@@ -80,6 +38,49 @@ static void skeleton_view_coming_soon_draw_callback(Canvas* canvas, void* model)
     canvas_draw_str(canvas, 10, 10, "Coming Soon");
 }
 
+// Each row allocates one screen and says where the back button goes from it.
+static const ViewTableView skeleton_views[] = {
+    {SkeletonViewSubmenu, ViewTableTypeSubmenu, offsetof(SkeletonApp, submenu), VIEW_NONE},
+    {SkeletonViewComingSoon,
+     ViewTableTypeWidget,
+     offsetof(SkeletonApp, widget_about),
+     SkeletonViewSubmenu},
+};
+
+// Our application menu has 3 items.  You can add more items if you want.
+static const ViewTableMenuItem skeleton_menu[] = {
+    {"Config", SkeletonViewComingSoon, NULL},
+    {"Play", SkeletonViewComingSoon, NULL},
+    {"About", SkeletonViewComingSoon, NULL},
+};
+
+static const EnergyView skeleton_energy_views[] = {
+    {SkeletonViewSubmenu, "Menu", 10000},
+    {SkeletonViewComingSoon, "Coming Soon", 10000},
+};
+
+static const EnergyConfig skeleton_energy_config = {
+    .views = skeleton_energy_views,
+    .view_count = COUNT_OF(skeleton_energy_views),
+    .backlight = SKELETON_BACKLIGHT,
+    .dim_level = ENERGY_DIM_LEVEL,
+};
+
+static void skeleton_view_switched(void* context, uint32_t view) {
+    SkeletonApp* app = (SkeletonApp*)context;
+    energy_view_enter(app->energy, view);
+}
+
+static const ViewTableConfig skeleton_view_config = {
+    .views = skeleton_views,
+    .view_count = COUNT_OF(skeleton_views),
+    .menu_view = SkeletonViewSubmenu,
+    .menu = skeleton_menu,
+    .menu_count = COUNT_OF(skeleton_menu),
+    .start_view = SkeletonViewSubmenu,
+    .switched = skeleton_view_switched,
+};
+
 /**
  * @brief      Allocate the skeleton application.
  * @details    This function allocates the skeleton application resources.
@@ -88,42 +89,15 @@ static void skeleton_view_coming_soon_draw_callback(Canvas* canvas, void* model)
 static SkeletonApp* sample_app_alloc() {
     SkeletonApp* app = (SkeletonApp*)malloc(sizeof(SkeletonApp));
 
-    Gui* gui = furi_record_open(RECORD_GUI);
-
-    app->view_dispatcher = view_dispatcher_alloc();
-    view_dispatcher_enable_queue(app->view_dispatcher);
-    view_dispatcher_attach_to_gui(app->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
-    view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
-
-    app->submenu = submenu_alloc();
-    submenu_add_item(
-        app->submenu, "Config", SkeletonSubmenuIndexConfigure, skeleton_submenu_callback, app);
-    submenu_add_item(
-        app->submenu, "Play", SkeletonSubmenuIndexGame, skeleton_submenu_callback, app);
-    submenu_add_item(
-        app->submenu, "About", SkeletonSubmenuIndexAbout, skeleton_submenu_callback, app);
-    view_set_previous_callback(submenu_get_view(app->submenu), skeleton_navigation_exit_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, SkeletonViewSubmenu, submenu_get_view(app->submenu));
-    view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewSubmenu);
-
-    app->widget_about = widget_alloc();
+    app->energy = energy_alloc(&skeleton_energy_config);
+    app->views = view_table_alloc(&skeleton_view_config, app);
+
     widget_add_text_scroll_element(app->widget_about, 0, 0, 128, 64, "Coming Soon");
-    view_set_previous_callback(
-        widget_get_view(app->widget_about), skeleton_navigation_submenu_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, SkeletonViewComingSoon, widget_get_view(app->widget_about));
 
     // Set the drawing callback for the coming soon view
     view_set_draw_callback(
         widget_get_view(app->widget_about), skeleton_view_coming_soon_draw_callback);
 
-    app->notifications = furi_record_open(RECORD_NOTIFICATION);
-
-#ifdef BACKLIGHT_ON
-    notification_message(app->notifications, &sequence_display_backlight_enforce_on);
-#endif
-
     return app;
 }
 
@@ -133,17 +107,8 @@ static SkeletonApp* sample_app_alloc() {
  * @param      app  The skeleton application object.
 */
 static void sample_app_free(SkeletonApp* app) {
-#ifdef BACKLIGHT_ON
-    notification_message(app->notifications, &sequence_display_backlight_enforce_auto);
-#endif
-    furi_record_close(RECORD_NOTIFICATION);
-
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewComingSoon);
-    widget_free(app->widget_about);
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewSubmenu);
-    submenu_free(app->submenu);
-    view_dispatcher_free(app->view_dispatcher);
-    furi_record_close(RECORD_GUI);
+    view_table_free(app->views);
+    energy_free(app->energy); // Logs the energy report
 
     free(app);
 }
@@ -159,7 +124,7 @@ int32_t main_sample_app(void* _p) {
     UNUSED(_p);
 
     SkeletonApp* app = sample_app_alloc();
-    view_dispatcher_run(app->view_dispatcher);
+    view_dispatcher_run(view_table_get_view_dispatcher(app->views));
 
     sample_app_free(app);
     return 0;
@@ -7,21 +7,17 @@
 #include <gui/modules/text_input.h>
 #include <gui/modules/widget.h>
 #include <gui/modules/variable_item_list.h>
-#include <notification/notification.h>
-#include <notification/notification_messages.h>
 #include "skeleton_app_icons.h"
+#include "../common/energy.h"
+#include "../common/entropy.h"
+#include "../common/view_table.h"
 
 #define TAG "Skeleton"
 
-// Change this to BACKLIGHT_AUTO if you don't want the backlight to be continuously on.
-#define BACKLIGHT_ON 1
-
-// Our application menu has 3 items.  You can add more items if you want.
-typedef enum {
-    SkeletonSubmenuIndexConfigure,
-    SkeletonSubmenuIndexGame,
-    SkeletonSubmenuIndexAbout,
-} SkeletonSubmenuIndex;
+// The backlight stays on while the app is used and dims on a screen left idle (dim_after_ms in
+// skeleton_energy_views).  EnergyBacklightOn keeps it at full brightness, EnergyBacklightAuto
+// leaves it to the firmware.  The log shows what each screen cost when the app closes.
+#define SKELETON_BACKLIGHT EnergyBacklightDim
 
 // Each view is a screen we show the user.
 typedef enum {
@@ -38,8 +34,9 @@ typedef enum {
 } SkeletonEventId;
 
 typedef struct {
-    ViewDispatcher* view_dispatcher; // Switches between our views
-    NotificationApp* notifications; // Used for controlling the backlight
+    ViewTable* views; // Allocates our views and switches between them
+    ViewDispatcher* view_dispatcher; // The dispatcher owned by views, for custom events
+    Energy* energy; // Backlight policy and the energy report
     Submenu* submenu; // The application menu
     TextInput* text_input; // The text input screen
     VariableItemList* variable_item_list_config; // The configuration screen
@@ -51,73 +48,17 @@ typedef struct {
     uint32_t temp_buffer_size; // Size of temporary buffer
 
     FuriTimer* timer; // Timer for redrawing the screen
+    Entropy* entropy; // Shared random number service
 } SkeletonApp;
 
 typedef struct {
     uint32_t setting_1_index; // The team color setting index
     FuriString* setting_2_name; // The name setting
     uint8_t x; // The x coordinate
+    uint8_t random; // Random number shown on the screen, picked on each timer tick
+    Energy* energy; // Counts the time spent drawing (owned by SkeletonApp)
 } SkeletonGameModel;
 
-/**
- * @brief      Callback for exiting the application.
- * @details    This function is called when user press back button.  We return VIEW_NONE to
- *            indicate that we want to exit the application.
- * @param      _context  The context - unused
- * @return     next view id
-*/
-static uint32_t skeleton_navigation_exit_callback(void* _context) {
-    UNUSED(_context);
-    return VIEW_NONE;
-}
-
-/**
- * @brief      Callback for returning to submenu.
- * @details    This function is called when user press back button.  We return VIEW_NONE to
- *            indicate that we want to navigate to the submenu.
- * @param      _context  The context - unused
- * @return     next view id
-*/
-static uint32_t skeleton_navigation_submenu_callback(void* _context) {
-    UNUSED(_context);
-    return SkeletonViewSubmenu;
-}
-
-/**
- * @brief      Callback for returning to configure screen.
- * @details    This function is called when user press back button.  We return VIEW_NONE to
- *            indicate that we want to navigate to the configure screen.
- * @param      _context  The context - unused
- * @return     next view id
-*/
-static uint32_t skeleton_navigation_configure_callback(void* _context) {
-    UNUSED(_context);
-    return SkeletonViewConfigure;
-}
-
-/**
- * @brief      Handle submenu item selection.
- * @details    This function is called when user selects an item from the submenu.
- * @param      context  The context - SkeletonApp object.
- * @param      index     The SkeletonSubmenuIndex item that was clicked.
-*/
-static void skeleton_submenu_callback(void* context, uint32_t index) {
-    SkeletonApp* app = (SkeletonApp*)context;
-    switch(index) {
-    case SkeletonSubmenuIndexConfigure:
-        view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewConfigure);
-        break;
-    case SkeletonSubmenuIndexGame:
-        view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewGame);
-        break;
-    case SkeletonSubmenuIndexAbout:
-        view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewAbout);
-        break;
-    default:
-        break;
-    }
-}
-
 /**
  * Our 1st sample setting is a team color.  We have 3 options: red, green, and blue.
 */
@@ -152,7 +93,7 @@ static void skeleton_setting_2_text_updated(void* context) {
                 app->setting_2_item, furi_string_get_cstr(model->setting_2_name));
         },
         redraw);
-    view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewConfigure);
+    view_table_switch_to(app->views, SkeletonViewConfigure);
 }
 
 /**
@@ -194,12 +135,8 @@ static void skeleton_setting_item_clicked(void* context, uint32_t index) {
             app->temp_buffer_size,
             clear_previous_text);
 
-        // Pressing the BACK button will reload the configure screen.
-        view_set_previous_callback(
-            text_input_get_view(app->text_input), skeleton_navigation_configure_callback);
-
         // Show text input dialog.
-        view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewTextInput);
+        view_table_switch_to(app->views, SkeletonViewTextInput);
     }
 }
 
@@ -211,12 +148,13 @@ static void skeleton_setting_item_clicked(void* context, uint32_t index) {
 */
 static void skeleton_view_game_draw_callback(Canvas* canvas, void* model) {
     SkeletonGameModel* my_model = (SkeletonGameModel*)model;
+    uint32_t start = energy_draw_begin(my_model->energy);
     canvas_draw_icon(canvas, my_model->x, 20, &I_glyph_1_14x40);
     canvas_draw_str(canvas, 1, 10, "LEFT/RIGHT to change x");
     FuriString* xstr = furi_string_alloc();
     furi_string_printf(xstr, "x: %u  OK=play tone", my_model->x);
     canvas_draw_str(canvas, 44, 24, furi_string_get_cstr(xstr));
-    furi_string_printf(xstr, "random: %u", (uint8_t)(furi_hal_random_get() % 256));
+    furi_string_printf(xstr, "random: %u", my_model->random);
     canvas_draw_str(canvas, 44, 36, furi_string_get_cstr(xstr));
     furi_string_printf(
         xstr,
@@ -227,6 +165,7 @@ static void skeleton_view_game_draw_callback(Canvas* canvas, void* model) {
     furi_string_printf(xstr, "name: %s", furi_string_get_cstr(my_model->setting_2_name));
     canvas_draw_str(canvas, 44, 60, furi_string_get_cstr(xstr));
     furi_string_free(xstr);
+    energy_draw_end(my_model->energy, start);
 }
 
 /**
@@ -276,11 +215,15 @@ static bool skeleton_view_game_custom_event_callback(uint32_t event, void* conte
     SkeletonApp* app = (SkeletonApp*)context;
     switch(event) {
     case SkeletonEventIdRedrawScreen:
-        // Redraw screen by passing true to last parameter of with_view_model.
+        // Pick a new random number and redraw screen by passing true to last parameter of
+        // with_view_model.  The draw callback only shows it, so redraws don't use up randomness.
         {
             bool redraw = true;
             with_view_model(
-                app->view_game, SkeletonGameModel * _model, { UNUSED(_model); }, redraw);
+                app->view_game,
+                SkeletonGameModel * model,
+                { model->random = entropy_fast_uniform(app->entropy, 256); },
+                redraw);
             return true;
         }
     case SkeletonEventIdOkPressed:
@@ -294,8 +237,10 @@ static bool skeleton_view_game_custom_event_callback(uint32_t event, void* conte
                 { frequency = model->x * 100 + 100; },
                 redraw);
             furi_hal_speaker_start(frequency, 1.0);
+            energy_speaker(app->energy, true);
             furi_delay_ms(100);
             furi_hal_speaker_stop();
+            energy_speaker(app->energy, false);
             furi_hal_speaker_release();
         }
         return true;
@@ -351,6 +296,63 @@ static bool skeleton_view_game_input_callback(InputEvent* event, void* context)
     return false;
 }
 
+// Each view is allocated from this table, which also says where the BACK button goes from it.
+static const ViewTableView skeleton_views[] = {
+    {SkeletonViewSubmenu, ViewTableTypeSubmenu, offsetof(SkeletonApp, submenu), VIEW_NONE},
+    {SkeletonViewTextInput,
+     ViewTableTypeTextInput,
+     offsetof(SkeletonApp, text_input),
+     SkeletonViewConfigure},
+    {SkeletonViewConfigure,
+     ViewTableTypeVariableItemList,
+     offsetof(SkeletonApp, variable_item_list_config),
+     SkeletonViewSubmenu},
+    {SkeletonViewGame, ViewTableTypeView, offsetof(SkeletonApp, view_game), SkeletonViewSubmenu},
+    {SkeletonViewAbout,
+     ViewTableTypeWidget,
+     offsetof(SkeletonApp, widget_about),
+     SkeletonViewSubmenu},
+};
+
+// Our application menu has 3 items.  You can add more items if you want.
+static const ViewTableMenuItem skeleton_menu[] = {
+    {"Config", SkeletonViewConfigure, NULL},
+    {"Play", SkeletonViewGame, NULL},
+    {"About", SkeletonViewAbout, NULL},
+};
+
+// How long each screen can sit without a key press before the backlight dims.  The game screen
+// keeps changing, so it gets longer.
+static const EnergyView skeleton_energy_views[] = {
+    {SkeletonViewSubmenu, "Menu", 10000},
+    {SkeletonViewTextInput, "Name", 20000},
+    {SkeletonViewConfigure, "Config", 10000},
+    {SkeletonViewGame, "Play", 30000},
+    {SkeletonViewAbout, "About", 20000},
+};
+
+static const EnergyConfig skeleton_energy_config = {
+    .views = skeleton_energy_views,
+    .view_count = COUNT_OF(skeleton_energy_views),
+    .backlight = SKELETON_BACKLIGHT,
+    .dim_level = ENERGY_DIM_LEVEL,
+};
+
+static void skeleton_view_switched(void* context, uint32_t view) {
+    SkeletonApp* app = (SkeletonApp*)context;
+    energy_view_enter(app->energy, view);
+}
+
+static const ViewTableConfig skeleton_view_config = {
+    .views = skeleton_views,
+    .view_count = COUNT_OF(skeleton_views),
+    .menu_view = SkeletonViewSubmenu,
+    .menu = skeleton_menu,
+    .menu_count = COUNT_OF(skeleton_menu),
+    .start_view = SkeletonViewSubmenu,
+    .switched = skeleton_view_switched,
+};
+
 /**
  * @brief      Allocate the skeleton application.
  * @details    This function allocates the skeleton application resources.
@@ -359,32 +361,16 @@ static bool skeleton_view_game_input_callback(InputEvent* event, void* context)
 static SkeletonApp* skeleton_app_alloc() {
     SkeletonApp* app = (SkeletonApp*)malloc(sizeof(SkeletonApp));
 
-    Gui* gui = furi_record_open(RECORD_GUI);
-
-    app->view_dispatcher = view_dispatcher_alloc();
-    view_dispatcher_enable_queue(app->view_dispatcher);
-    view_dispatcher_attach_to_gui(app->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
-    view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
-
-    app->submenu = submenu_alloc();
-    submenu_add_item(
-        app->submenu, "Config", SkeletonSubmenuIndexConfigure, skeleton_submenu_callback, app);
-    submenu_add_item(
-        app->submenu, "Play", SkeletonSubmenuIndexGame, skeleton_submenu_callback, app);
-    submenu_add_item(
-        app->submenu, "About", SkeletonSubmenuIndexAbout, skeleton_submenu_callback, app);
-    view_set_previous_callback(submenu_get_view(app->submenu), skeleton_navigation_exit_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, SkeletonViewSubmenu, submenu_get_view(app->submenu));
-    view_dispatcher_switch_to_view(app->view_dispatcher, SkeletonViewSubmenu);
-
-    app->text_input = text_input_alloc();
-    view_dispatcher_add_view(
-        app->view_dispatcher, SkeletonViewTextInput, text_input_get_view(app->text_input));
+    app->entropy = entropy_alloc();
+    app->energy = energy_alloc(&skeleton_energy_config);
+
+    // Allocates the menu and every screen in skeleton_views.
+    app->views = view_table_alloc(&skeleton_view_config, app);
+    app->view_dispatcher = view_table_get_view_dispatcher(app->views);
+
     app->temp_buffer_size = 32;
     app->temp_buffer = (char*)malloc(app->temp_buffer_size);
 
-    app->variable_item_list_config = variable_item_list_alloc();
     variable_item_list_reset(app->variable_item_list_config);
     VariableItem* item = variable_item_list_add(
         app->variable_item_list_config,
@@ -405,30 +391,19 @@ static SkeletonApp* skeleton_app_alloc() {
     variable_item_list_set_enter_callback(
         app->variable_item_list_config, skeleton_setting_item_clicked, app);
 
-    view_set_previous_callback(
-        variable_item_list_get_view(app->variable_item_list_config),
-        skeleton_navigation_submenu_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher,
-        SkeletonViewConfigure,
-        variable_item_list_get_view(app->variable_item_list_config));
-
-    app->view_game = view_alloc();
     view_set_draw_callback(app->view_game, skeleton_view_game_draw_callback);
     view_set_input_callback(app->view_game, skeleton_view_game_input_callback);
-    view_set_previous_callback(app->view_game, skeleton_navigation_submenu_callback);
     view_set_enter_callback(app->view_game, skeleton_view_game_enter_callback);
     view_set_exit_callback(app->view_game, skeleton_view_game_exit_callback);
-    view_set_context(app->view_game, app);
     view_set_custom_callback(app->view_game, skeleton_view_game_custom_event_callback);
     view_allocate_model(app->view_game, ViewModelTypeLockFree, sizeof(SkeletonGameModel));
     SkeletonGameModel* model = view_get_model(app->view_game);
     model->setting_1_index = setting_1_index;
     model->setting_2_name = setting_2_name;
     model->x = 0;
-    view_dispatcher_add_view(app->view_dispatcher, SkeletonViewGame, app->view_game);
+    model->random = 0;
+    model->energy = app->energy;
 
-    app->widget_about = widget_alloc();
     widget_add_text_scroll_element(
         app->widget_about,
         0,
@@ -436,16 +411,6 @@ static SkeletonApp* skeleton_app_alloc() {
         128,
         64,
         "This is a sample application.\n---\nReplace code and message\nwith your content!\n\nauthor: @codeallnight\nhttps://discord.com/invite/NsjCvqwPAd\nhttps://youtube.com/@MrDerekJamison");
-    view_set_previous_callback(
-        widget_get_view(app->widget_about), skeleton_navigation_submenu_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, SkeletonViewAbout, widget_get_view(app->widget_about));
-
-    app->notifications = furi_record_open(RECORD_NOTIFICATION);
-
-#ifdef BACKLIGHT_ON
-    notification_message(app->notifications, &sequence_display_backlight_enforce_on);
-#endif
 
     return app;
 }
@@ -456,25 +421,12 @@ static SkeletonApp* skeleton_app_alloc() {
  * @param      app  The skeleton application object.
 */
 static void skeleton_app_free(SkeletonApp* app) {
-#ifdef BACKLIGHT_ON
-    notification_message(app->notifications, &sequence_display_backlight_enforce_auto);
-#endif
-    furi_record_close(RECORD_NOTIFICATION);
-
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewTextInput);
-    text_input_free(app->text_input);
+    view_table_free(app->views);
     free(app->temp_buffer);
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewAbout);
-    widget_free(app->widget_about);
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewGame);
-    view_free(app->view_game);
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewConfigure);
-    variable_item_list_free(app->variable_item_list_config);
-    view_dispatcher_remove_view(app->view_dispatcher, SkeletonViewSubmenu);
-    submenu_free(app->submenu);
-    view_dispatcher_free(app->view_dispatcher);
-    furi_record_close(RECORD_GUI);
 
+    // Logs the energy report.
+    energy_free(app->energy);
+    entropy_free(app->entropy);
     free(app);
 }
 
@@ -0,0 +1,239 @@
+#include "aes_gcm.h"
+#include <string.h>
+
+#define AES_BLOCK_SIZE 16
+#define AES_ROUNDS     14
+#define AES_ROUND_KEYS ((AES_ROUNDS + 1) * AES_BLOCK_SIZE)
+
+static const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+typedef struct {
+    uint8_t round_keys[AES_ROUND_KEYS];
+    uint8_t h[AES_BLOCK_SIZE]; // GHASH key, E(K, 0)
+    uint8_t j0[AES_BLOCK_SIZE]; // Pre-counter block
+    uint8_t ghash[AES_BLOCK_SIZE];
+} AesGcmContext;
+
+static uint8_t aes_xtime(uint8_t x) {
+    return (x << 1) ^ ((x >> 7) * 0x1b);
+}
+
+static void
+    aes_expand_key(uint8_t round_keys[AES_ROUND_KEYS], const uint8_t key[AES_GCM_KEY_SIZE]) {
+    uint8_t rcon = 1;
+    memcpy(round_keys, key, AES_GCM_KEY_SIZE);
+
+    for(size_t i = AES_GCM_KEY_SIZE; i < AES_ROUND_KEYS; i += 4) {
+        uint8_t t[4];
+        memcpy(t, round_keys + i - 4, 4);
+        if(i % AES_GCM_KEY_SIZE == 0) {
+            uint8_t first = t[0];
+            t[0] = aes_sbox[t[1]] ^ rcon;
+            t[1] = aes_sbox[t[2]];
+            t[2] = aes_sbox[t[3]];
+            t[3] = aes_sbox[first];
+            rcon = aes_xtime(rcon);
+        } else if(i % AES_GCM_KEY_SIZE == 16) {
+            for(size_t j = 0; j < 4; j++) {
+                t[j] = aes_sbox[t[j]];
+            }
+        }
+        for(size_t j = 0; j < 4; j++) {
+            round_keys[i + j] = round_keys[i + j - AES_GCM_KEY_SIZE] ^ t[j];
+        }
+    }
+}
+
+static void aes_encrypt_block(
+    const uint8_t round_keys[AES_ROUND_KEYS],
+    const uint8_t input[AES_BLOCK_SIZE],
+    uint8_t output[AES_BLOCK_SIZE]) {
+    uint8_t s[AES_BLOCK_SIZE];
+    for(size_t i = 0; i < AES_BLOCK_SIZE; i++) {
+        s[i] = input[i] ^ round_keys[i];
+    }
+
+    for(size_t round = 1; round <= AES_ROUNDS; round++) {
+        uint8_t t[AES_BLOCK_SIZE];
+        // SubBytes and ShiftRows: byte r of column c comes from column c + r.
+        for(size_t c = 0; c < 4; c++) {
+            for(size_t r = 0; r < 4; r++) {
+                t[c * 4 + r] = aes_sbox[s[((c + r) % 4) * 4 + r]];
+            }
+        }
+        if(round < AES_ROUNDS) {
+            for(size_t c = 0; c < 4; c++) {
+                uint8_t* col = t + c * 4;
+                uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3];
+                uint8_t first = col[0];
+                col[0] ^= all ^ aes_xtime(col[0] ^ col[1]);
+                col[1] ^= all ^ aes_xtime(col[1] ^ col[2]);
+                col[2] ^= all ^ aes_xtime(col[2] ^ col[3]);
+                col[3] ^= all ^ aes_xtime(col[3] ^ first);
+            }
+        }
+        for(size_t i = 0; i < AES_BLOCK_SIZE; i++) {
+            s[i] = t[i] ^ round_keys[round * AES_BLOCK_SIZE + i];
+        }
+    }
+
+    memcpy(output, s, AES_BLOCK_SIZE);
+}
+
+/**
+ * @brief      x = x * h in GF(2^128) with the GCM bit order.
+*/
+static void aes_gcm_multiply(uint8_t x[AES_BLOCK_SIZE], const uint8_t h[AES_BLOCK_SIZE]) {
+    uint8_t z[AES_BLOCK_SIZE] = {0};
+    uint8_t v[AES_BLOCK_SIZE];
+    memcpy(v, h, AES_BLOCK_SIZE);
+
+    for(size_t i = 0; i < 128; i++) {
+        // Constant time: mask instead of branching on key dependent bits.
+        uint8_t bit = -((x[i / 8] >> (7 - i % 8)) & 1);
+        for(size_t j = 0; j < AES_BLOCK_SIZE; j++) {
+            z[j] ^= v[j] & bit;
+        }
+        uint8_t carry = -(v[AES_BLOCK_SIZE - 1] & 1);
+        for(size_t j = AES_BLOCK_SIZE - 1; j > 0; j--) {
+            v[j] = (v[j] >> 1) | (v[j - 1] << 7);
+        }
+        v[0] = (v[0] >> 1) ^ (0xe1 & carry);
+    }
+
+    memcpy(x, z, AES_BLOCK_SIZE);
+}
+
+static void aes_gcm_ghash(AesGcmContext* ctx, const uint8_t* data, size_t size) {
+    while(size > 0) {
+        size_t n = size < AES_BLOCK_SIZE ? size : AES_BLOCK_SIZE;
+        for(size_t i = 0; i < n; i++) {
+            ctx->ghash[i] ^= data[i];
+        }
+        aes_gcm_multiply(ctx->ghash, ctx->h);
+        data += n;
+        size -= n;
+    }
+}
+
+static void aes_gcm_setup(
+    AesGcmContext* ctx,
+    const uint8_t key[AES_GCM_KEY_SIZE],
+    const uint8_t nonce[AES_GCM_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aad_size) {
+    memset(ctx, 0, sizeof(AesGcmContext));
+    aes_expand_key(ctx->round_keys, key);
+    aes_encrypt_block(ctx->round_keys, ctx->h, ctx->h);
+    memcpy(ctx->j0, nonce, AES_GCM_NONCE_SIZE);
+    ctx->j0[AES_BLOCK_SIZE - 1] = 1;
+    aes_gcm_ghash(ctx, aad, aad_size);
+}
+
+/**
+ * @brief      CTR mode starting at inc32(J0).
+*/
+static void aes_gcm_ctr(AesGcmContext* ctx, const uint8_t* input, uint8_t* output, size_t size) {
+    uint8_t counter[AES_BLOCK_SIZE];
+    uint8_t stream[AES_BLOCK_SIZE];
+    memcpy(counter, ctx->j0, AES_BLOCK_SIZE);
+
+    while(size > 0) {
+        for(size_t i = AES_BLOCK_SIZE - 1; i >= AES_BLOCK_SIZE - 4; i--) {
+            if(++counter[i]) {
+                break;
+            }
+        }
+        aes_encrypt_block(ctx->round_keys, counter, stream);
+        size_t n = size < AES_BLOCK_SIZE ? size : AES_BLOCK_SIZE;
+        for(size_t i = 0; i < n; i++) {
+            output[i] = input[i] ^ stream[i];
+        }
+        input += n;
+        output += n;
+        size -= n;
+    }
+    memset(stream, 0, sizeof(stream));
+}
+
+static void aes_gcm_tag(
+    AesGcmContext* ctx,
+    size_t aad_size,
+    size_t size,
+    uint8_t tag[AES_GCM_TAG_SIZE]) {
+    uint8_t lengths[AES_BLOCK_SIZE] = {0};
+    uint64_t aad_bits = (uint64_t)aad_size * 8;
+    uint64_t bits = (uint64_t)size * 8;
+    for(size_t i = 0; i < 8; i++) {
+        lengths[7 - i] = aad_bits >> (i * 8);
+        lengths[15 - i] = bits >> (i * 8);
+    }
+    aes_gcm_ghash(ctx, lengths, AES_BLOCK_SIZE);
+
+    aes_encrypt_block(ctx->round_keys, ctx->j0, tag);
+    for(size_t i = 0; i < AES_GCM_TAG_SIZE; i++) {
+        tag[i] ^= ctx->ghash[i];
+    }
+}
+
+void aes_gcm_encrypt(
+    const uint8_t key[AES_GCM_KEY_SIZE],
+    const uint8_t nonce[AES_GCM_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t size,
+    uint8_t tag[AES_GCM_TAG_SIZE]) {
+    AesGcmContext ctx;
+    aes_gcm_setup(&ctx, key, nonce, aad, aad_size);
+    aes_gcm_ctr(&ctx, input, output, size);
+    aes_gcm_ghash(&ctx, output, size);
+    aes_gcm_tag(&ctx, aad_size, size, tag);
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+bool aes_gcm_decrypt(
+    const uint8_t key[AES_GCM_KEY_SIZE],
+    const uint8_t nonce[AES_GCM_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t size,
+    const uint8_t tag[AES_GCM_TAG_SIZE]) {
+    AesGcmContext ctx;
+    uint8_t expected[AES_GCM_TAG_SIZE];
+    aes_gcm_setup(&ctx, key, nonce, aad, aad_size);
+    aes_gcm_ghash(&ctx, input, size);
+    aes_gcm_tag(&ctx, aad_size, size, expected);
+
+    uint8_t diff = 0;
+    for(size_t i = 0; i < AES_GCM_TAG_SIZE; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+    if(diff == 0) {
+        aes_gcm_ctr(&ctx, input, output, size);
+    } else if(size) {
+        memset(output, 0, size);
+    }
+    memset(&ctx, 0, sizeof(ctx));
+    return diff == 0;
+}
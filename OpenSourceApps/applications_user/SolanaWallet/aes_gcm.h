@@ -0,0 +1,40 @@
+#ifndef AES_GCM_H
+#define AES_GCM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Portable AES-256-GCM.  Written for small payloads (keys and seeds), not for throughput: the
+ * S-box is the only table and GHASH multiplies bit by bit.
+ */
+#define AES_GCM_KEY_SIZE   32
+#define AES_GCM_NONCE_SIZE 12
+#define AES_GCM_TAG_SIZE   16
+
+void aes_gcm_encrypt(
+    const uint8_t key[AES_GCM_KEY_SIZE],
+    const uint8_t nonce[AES_GCM_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t size,
+    uint8_t tag[AES_GCM_TAG_SIZE]);
+
+/**
+ * @brief      Check the tag and decrypt.
+ * @return     false if the tag does not match, in which case output is zeroed.
+*/
+bool aes_gcm_decrypt(
+    const uint8_t key[AES_GCM_KEY_SIZE],
+    const uint8_t nonce[AES_GCM_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t size,
+    const uint8_t tag[AES_GCM_TAG_SIZE]);
+
+#endif // AES_GCM_H
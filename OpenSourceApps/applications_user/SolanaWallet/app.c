@@ -4,82 +4,397 @@
 #include <gui/view.h>
 #include <gui/view_dispatcher.h>
 #include <gui/modules/submenu.h>
+#include <gui/modules/text_input.h>
 #include <gui/modules/widget.h>
 #include <notification/notification.h>
 #include <notification/notification_messages.h>
-#include "wifi_manager.h"
-#include "Solana_app_icons.h"
+#include "base58.h"
+#include "qr_code.h"
+#include "solana_keystore.h"
+#include "solana_link.h"
+#include "../common/view_table.h"
 
 #define TAG "SolanaWalletApp"
 
-// Our application menu has 3 items. You can add more items if you want.
-typedef enum {
-    SolanaSubmenuIndexConfig,
-    SolanaSubmenuIndexPlay,
-    SolanaSubmenuIndexAbout,
-} SolanaSubmenuIndex;
+// Network the Wi-Fi board joins when "Config" is selected.
+#define WIFI_SSID "YourSSID"
+#define WIFI_PASS "YourPassword"
+
+// Longest PIN the text input accepts, plus the NUL.
+#define SOLANA_PIN_SIZE 17
+
+// The QR code is centred in the square left of the address text, with at least
+// SOLANA_QR_MARGIN light modules around it as a quiet zone for the camera.  It gets the largest
+// scale that fits, up to SOLANA_QR_SCALE_MAX pixels per module.  An address is a version 3 code
+// (29 modules), which fits at scale 1: 2 pixels per module plus the margin would be 66 pixels.
+#define SOLANA_QR_AREA      64
+#define SOLANA_QR_MARGIN    2
+#define SOLANA_QR_SCALE_MAX 2
+
+// Address characters per line next to the QR code.
+#define SOLANA_ADDRESS_LINE 10
+
+// Stack of the thread that runs the PIN key derivation and makes the first key.
+#define SOLANA_UNLOCK_STACK 4096
 
 // Each view is a screen we show the user.
 typedef enum {
     SolanaViewSubmenu, // The menu when the app starts
     SolanaViewComingSoon, // Coming soon screen
+    SolanaViewPin, // PIN entry to create or unlock the keystore
+    SolanaViewUnlocking, // Shown while the PIN key derivation runs
+    SolanaViewWallet, // Address of the wallet key
+    SolanaViewKeystoreError, // The keystore file can't be read, with the option to wipe it
 } SolanaView;
 
 typedef struct {
-    ViewDispatcher* view_dispatcher; // Switches between our views
+    char address[BASE58_ADDRESS_SIZE]; // Base58 address of the wallet key
+    uint8_t qr_width; // Width and height of qr_bitmap in pixels, 0 if there is no code
+    uint8_t qr_bitmap[QR_CODE_BITMAP_SIZE(SOLANA_QR_SCALE_MAX)]; // Rendered once, only blitted
+} SolanaWalletModel;
+
+typedef enum {
+    SolanaEventIdLinkState, // The link to the Wi-Fi board changed state
+    SolanaEventIdWifiConnected, // The board joined the network
+    SolanaEventIdWifiFailed, // The board could not join, or did not answer
+    SolanaEventIdUnlocked, // The unlock thread is done, see unlock_status
+} SolanaEventId;
+
+typedef struct {
+    ViewTable* views; // Allocates our views and switches between them
+    ViewDispatcher* view_dispatcher; // The dispatcher owned by views, for custom events
     NotificationApp* notifications; // Used for controlling the backlight
     Submenu* submenu; // The application menu
     Widget* widget_about; // The about screen
+    TextInput* text_input; // PIN entry
+    Widget* widget_unlocking; // "Unlocking..." while the PIN is checked
+    Widget* widget_keystore_error; // Why the keystore can't be opened
+    View* view_wallet; // The wallet address and its QR code
+    QrCode qr; // Encoder work space, only used when the address changes
+    SolanaLink* link; // UART link to the Wi-Fi board
+    SolanaKeystore* keystore; // Encrypted keys on the SD card
+    Entropy* entropy; // Random numbers for keys, salts and nonces
+    char pin[SOLANA_PIN_SIZE]; // Text input buffer, wiped as soon as it is used
+    FuriThread* unlock_thread; // Runs the PIN key derivation off the GUI thread
+    SolanaKeystoreStatus unlock_status; // Set by unlock_thread before SolanaEventIdUnlocked
 } SolanaApp;
 
+static void solana_unlock_done(SolanaApp* app);
+
+/**
+ * @brief Callback for link state changes.
+ * @details This function is called from the link worker thread, so we only queue a custom event.
+ * @param state The new link state - unused, read back with solana_link_get_state.
+ * @param context The context - SolanaApp object.
+ */
+static void solana_link_state_callback(SolanaLinkState state, void* context) {
+    UNUSED(state);
+    SolanaApp* app = (SolanaApp*)context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, SolanaEventIdLinkState);
+}
+
 /**
- * @brief Callback for exiting the application.
- * @details This function is called when user press back button. We return VIEW_NONE to
- * indicate that we want to exit the application.
- * @param _context The context - unused
- * @return next view id
+ * @brief Callback for the Wi-Fi connect request.
+ * @details This function is called from the link worker thread when the board answers (or
+ * gives up), so we only queue a custom event.
+ * @param result The SolanaLinkResult of the request.
+ * @param data The response data - unused.
+ * @param size The response size - unused.
+ * @param context The context - SolanaApp object.
  */
-static uint32_t solana_navigation_exit_callback(void* _context) {
-    UNUSED(_context);
-    return VIEW_NONE;
+static void solana_wifi_connect_callback(
+    SolanaLinkResult result,
+    const uint8_t* data,
+    size_t size,
+    void* context) {
+    UNUSED(data);
+    UNUSED(size);
+    SolanaApp* app = (SolanaApp*)context;
+
+    switch(result) {
+    case SolanaLinkResultOk:
+        view_dispatcher_send_custom_event(app->view_dispatcher, SolanaEventIdWifiConnected);
+        break;
+    case SolanaLinkResultFailed:
+    case SolanaLinkResultTimeout:
+    case SolanaLinkResultUnavailable:
+        view_dispatcher_send_custom_event(app->view_dispatcher, SolanaEventIdWifiFailed);
+        break;
+    default:
+        break;
+    }
 }
 
 /**
- * @brief Callback for returning to submenu.
- * @details This function is called when user press back button. We return VIEW_NONE to
- * indicate that we want to navigate to the submenu.
- * @param _context The context - unused
- * @return next view id
+ * @brief Ask the Wi-Fi board to join the configured network.
+ * @details The request is queued on the link and answered later through
+ * solana_wifi_connect_callback, so the UI never waits on the board.
+ * @param app The SolanaApp object.
  */
-static uint32_t solana_navigation_submenu_callback(void* _context) {
-    UNUSED(_context);
-    return SolanaViewSubmenu;
+static void solana_wifi_connect(SolanaApp* app) {
+    static const char credentials[] = WIFI_SSID "\0" WIFI_PASS;
+    uint8_t id = solana_link_request(
+        app->link,
+        SolanaLinkCommandWifiConnect,
+        (const uint8_t*)credentials,
+        sizeof(credentials) - 1,
+        SOLANA_LINK_DEFAULT_TIMEOUT * 5,
+        solana_wifi_connect_callback,
+        app);
+    if(id == 0) {
+        FURI_LOG_W(TAG, "Too many link requests");
+        notification_message(app->notifications, &sequence_error);
+    }
 }
 
 /**
- * @brief Handle submenu item selection.
- * @details This function is called when user selects an item from the submenu.
+ * @brief Callback for custom events.
+ * @details This function is called on the UI thread for events queued by the link callbacks.
  * @param context The context - SolanaApp object.
- * @param index The SolanaSubmenuIndex item that was clicked.
+ * @param event The SolanaEventId value.
+ * @return true if the event was handled, false otherwise.
  */
-static void solana_submenu_callback(void* context, uint32_t index) {
+static bool solana_custom_event_callback(void* context, uint32_t event) {
     SolanaApp* app = (SolanaApp*)context;
 
-    switch(index) {
-    case SolanaSubmenuIndexConfig:
-        // Initialize and connect to Wi-Fi
-        wifi_init_sta();
+    switch(event) {
+    case SolanaEventIdLinkState:
+        FURI_LOG_I(TAG, "Link state %d", solana_link_get_state(app->link));
+        return true;
+    case SolanaEventIdWifiConnected:
         notification_message(app->notifications, &sequence_success);
-        break;
-    case SolanaSubmenuIndexPlay:
-    case SolanaSubmenuIndexAbout:
-        view_dispatcher_switch_to_view(app->view_dispatcher, SolanaViewComingSoon);
-        break;
+        return true;
+    case SolanaEventIdWifiFailed:
+        notification_message(app->notifications, &sequence_error);
+        return true;
+    case SolanaEventIdUnlocked:
+        solana_unlock_done(app);
+        return true;
     default:
-        break;
+        return false;
+    }
+}
+
+/**
+ * @brief Callback for drawing the wallet screen.
+ * @details The QR code was rendered into the model when the address was set, so drawing is one
+ * bitmap blit plus the address text.
+ * @param canvas The canvas to draw on.
+ * @param model The model - SolanaWalletModel object.
+ */
+static void solana_view_wallet_draw_callback(Canvas* canvas, void* model) {
+    SolanaWalletModel* my_model = (SolanaWalletModel*)model;
+    char line[SOLANA_ADDRESS_LINE + 1];
+
+    if(my_model->qr_width) {
+        canvas_draw_xbm(
+            canvas,
+            (SOLANA_QR_AREA - my_model->qr_width) / 2,
+            (SOLANA_QR_AREA - my_model->qr_width) / 2,
+            my_model->qr_width,
+            my_model->qr_width,
+            my_model->qr_bitmap);
+    }
+
+    canvas_set_font(canvas, FontPrimary);
+    canvas_draw_str(canvas, 66, 10, "Receive");
+    canvas_set_font(canvas, FontKeyboard);
+    size_t length = strlen(my_model->address);
+    for(size_t i = 0; i < length; i += SOLANA_ADDRESS_LINE) {
+        strncpy(line, my_model->address + i, SOLANA_ADDRESS_LINE);
+        line[SOLANA_ADDRESS_LINE] = '\0';
+        canvas_draw_str(canvas, 66, 22 + (i / SOLANA_ADDRESS_LINE) * 9, line);
+    }
+}
+
+/**
+ * @brief Show the address of the first wallet key.
+ * @details The QR code is only encoded here when the address changes, never on a redraw.
+ * @param app The SolanaApp object.
+ */
+static void solana_wallet_show(SolanaApp* app) {
+    char address[BASE58_ADDRESS_SIZE];
+    const uint8_t* public_key = solana_keystore_get_public_key(app->keystore, 0);
+    if(!public_key ||
+       !base58_encode(public_key, ED25519_PUBLIC_KEY_SIZE, address, sizeof(address))) {
+        return;
+    }
+
+    bool redraw = true;
+    with_view_model(
+        app->view_wallet,
+        SolanaWalletModel * model,
+        {
+            // Same key as last time, the bitmap is still good.
+            if(strcmp(model->address, address) != 0) {
+                memcpy(model->address, address, sizeof(model->address));
+                model->qr_width = 0;
+                if(qr_code_encode(&app->qr, address, QrCodeEccMedium)) {
+                    uint8_t scale = MIN(
+                        SOLANA_QR_AREA / (app->qr.size + 2 * SOLANA_QR_MARGIN),
+                        SOLANA_QR_SCALE_MAX);
+                    model->qr_width = qr_code_render(
+                        &app->qr, scale, model->qr_bitmap, sizeof(model->qr_bitmap));
+                }
+            }
+        },
+        redraw);
+    view_table_switch_to(app->views, SolanaViewWallet);
+}
+
+static void solana_wallet_open(SolanaApp* app);
+
+/**
+ * @brief Callback for the Wipe button of the keystore error screen.
+ * @details Wiping destroys every sealed seed, so only a long press does it.
+ * @param result The button - only GuiButtonTypeRight exists.
+ * @param type The input type, InputTypeLong wipes.
+ * @param context The context - SolanaApp object.
+ */
+static void solana_keystore_wipe_callback(GuiButtonType result, InputType type, void* context) {
+    SolanaApp* app = (SolanaApp*)context;
+    if(result != GuiButtonTypeRight || type != InputTypeLong) {
+        return;
+    }
+    if(solana_keystore_wipe(app->keystore) != SolanaKeystoreOk) {
+        notification_message(app->notifications, &sequence_error);
+    }
+    solana_wallet_open(app);
+}
+
+/**
+ * @brief Show why the keystore can't be opened.
+ * @details A file that can't be read is never replaced on its own. The user can put the card
+ * back and try again, or wipe a damaged file to start over with a new PIN.
+ * @param app The SolanaApp object.
+ * @param state SolanaKeystoreErrorStorage or SolanaKeystoreErrorCorrupt.
+ */
+static void solana_keystore_error_show(SolanaApp* app, SolanaKeystoreStatus state) {
+    Widget* widget = app->widget_keystore_error;
+    widget_reset(widget);
+    if(state == SolanaKeystoreErrorCorrupt) {
+        widget_add_text_scroll_element(
+            widget,
+            0,
+            0,
+            128,
+            50,
+            "The keystore on the SD card is damaged.\n"
+            "Wiping deletes it and its keys for good. Hold Wipe to do it.");
+        widget_add_button_element(
+            widget, GuiButtonTypeRight, "Wipe", solana_keystore_wipe_callback, app);
+    } else {
+        widget_add_text_scroll_element(
+            widget, 0, 0, 128, 64, "Can't read the keystore from the SD card.\nCheck the card.");
+    }
+    view_table_switch_to(app->views, SolanaViewKeystoreError);
+}
+
+/**
+ * @brief Open the wallet, asking for the PIN if the keystore is locked.
+ * @details The first time there is no keystore yet, so the PIN entered becomes the new PIN.
+ * A keystore that can't be read is read again first, in case the card is back.
+ * @param app The SolanaApp object.
+ */
+static void solana_wallet_open(SolanaApp* app) {
+    if(solana_keystore_is_unlocked(app->keystore)) {
+        solana_wallet_show(app);
+        return;
+    }
+
+    SolanaKeystoreStatus state = solana_keystore_get_state(app->keystore);
+    if(state != SolanaKeystoreOk && state != SolanaKeystoreErrorMissing) {
+        state = solana_keystore_reload(app->keystore);
+    }
+    if(state != SolanaKeystoreOk && state != SolanaKeystoreErrorMissing) {
+        solana_keystore_error_show(app, state);
+        return;
+    }
+
+    text_input_set_header_text(
+        app->text_input, state == SolanaKeystoreOk ? "Enter PIN" : "Choose a new PIN");
+    view_table_switch_to(app->views, SolanaViewPin);
+}
+
+/**
+ * @brief Unlock thread.
+ * @details Creates or unlocks the keystore, then makes the first key if there is none. The PIN
+ * key derivation takes about a second, so it runs here rather than on the GUI thread, which
+ * keeps drawing the "Unlocking..." screen. The result goes back as SolanaEventIdUnlocked.
+ * @param context The context - SolanaApp object.
+ * @return 0.
+ */
+static int32_t solana_unlock_worker(void* context) {
+    SolanaApp* app = (SolanaApp*)context;
+    // create refuses to replace a file that appeared or broke since the PIN screen.
+    SolanaKeystoreStatus status = solana_keystore_get_state(app->keystore) == SolanaKeystoreOk ?
+                                      solana_keystore_unlock(app->keystore, app->pin) :
+                                      solana_keystore_create(app->keystore, app->pin);
+    memset(app->pin, 0, sizeof(app->pin));
+
+    if(status == SolanaKeystoreOk && solana_keystore_get_count(app->keystore) == 0) {
+        status = solana_keystore_generate(app->keystore, NULL);
+    }
+
+    app->unlock_status = status;
+    view_dispatcher_send_custom_event(app->view_dispatcher, SolanaEventIdUnlocked);
+    return 0;
+}
+
+/**
+ * @brief Callback for the PIN text input.
+ * @details Shows "Unlocking..." and starts the unlock thread. The PIN key derivation only runs
+ * there, once per session; signing later reuses the session key.
+ * @param context The context - SolanaApp object.
+ */
+static void solana_pin_callback(void* context) {
+    SolanaApp* app = (SolanaApp*)context;
+    if(app->unlock_thread) {
+        return;
+    }
+
+    view_table_switch_to(app->views, SolanaViewUnlocking);
+    app->unlock_thread = furi_thread_alloc_ex(
+        "SolanaUnlockWorker", SOLANA_UNLOCK_STACK, solana_unlock_worker, app);
+    furi_thread_start(app->unlock_thread);
+}
+
+/**
+ * @brief Finish an unlock on the GUI thread.
+ * @details Called for SolanaEventIdUnlocked. Shows the wallet, or asks for the PIN again.
+ * @param app The SolanaApp object.
+ */
+static void solana_unlock_done(SolanaApp* app) {
+    furi_thread_join(app->unlock_thread);
+    furi_thread_free(app->unlock_thread);
+    app->unlock_thread = NULL;
+
+    if(app->unlock_status == SolanaKeystoreOk) {
+        solana_wallet_show(app);
+    } else {
+        FURI_LOG_W(TAG, "Keystore error %d", app->unlock_status);
+        notification_message(app->notifications, &sequence_error);
+        solana_wallet_open(app);
     }
 }
 
+/**
+ * @brief Menu item "Wallet".
+ * @param context The context - SolanaApp object.
+ */
+static void solana_menu_wallet_callback(void* context) {
+    solana_wallet_open((SolanaApp*)context);
+}
+
+/**
+ * @brief Menu item "Config".
+ * @details Asks the Wi-Fi board to connect, the result arrives as a custom event.
+ * @param context The context - SolanaApp object.
+ */
+static void solana_menu_config_callback(void* context) {
+    solana_wifi_connect((SolanaApp*)context);
+}
+
 /**
  * @brief Callback for drawing the coming soon screen.
  * @details This function is called when the screen needs to be redrawn.
@@ -91,6 +406,44 @@ static void solana_view_coming_soon_draw_callback(Canvas* canvas, void* model) {
     canvas_draw_str(canvas, 10, 10, "Coming Soon");
 }
 
+// Each view is allocated from this table, which also says where the back button goes from it.
+static const ViewTableView solana_views[] = {
+    {SolanaViewSubmenu, ViewTableTypeSubmenu, offsetof(SolanaApp, submenu), VIEW_NONE},
+    {SolanaViewComingSoon,
+     ViewTableTypeWidget,
+     offsetof(SolanaApp, widget_about),
+     SolanaViewSubmenu},
+    {SolanaViewPin, ViewTableTypeTextInput, offsetof(SolanaApp, text_input), SolanaViewSubmenu},
+    // Back goes nowhere until the unlock thread is done with the keystore.
+    {SolanaViewUnlocking,
+     ViewTableTypeWidget,
+     offsetof(SolanaApp, widget_unlocking),
+     SolanaViewUnlocking},
+    {SolanaViewWallet, ViewTableTypeView, offsetof(SolanaApp, view_wallet), SolanaViewSubmenu},
+    {SolanaViewKeystoreError,
+     ViewTableTypeWidget,
+     offsetof(SolanaApp, widget_keystore_error),
+     SolanaViewSubmenu},
+};
+
+// Our application menu has 4 items. You can add more items if you want.
+static const ViewTableMenuItem solana_menu[] = {
+    {"Wallet", SolanaViewWallet, solana_menu_wallet_callback},
+    {"Config", SolanaViewSubmenu, solana_menu_config_callback},
+    {"Play", SolanaViewComingSoon, NULL},
+    {"About", SolanaViewComingSoon, NULL},
+};
+
+static const ViewTableConfig solana_view_config = {
+    .views = solana_views,
+    .view_count = COUNT_OF(solana_views),
+    .menu_view = SolanaViewSubmenu,
+    .menu = solana_menu,
+    .menu_count = COUNT_OF(solana_menu),
+    .start_view = SolanaViewSubmenu,
+    .custom_event = solana_custom_event_callback,
+};
+
 /**
  * @brief Allocate the solana application.
  * @details This function allocates the solana application resources.
@@ -99,36 +452,35 @@ static void solana_view_coming_soon_draw_callback(Canvas* canvas, void* model) {
 static SolanaApp* solana_app_alloc() {
     SolanaApp* app = (SolanaApp*)malloc(sizeof(SolanaApp));
 
-    Gui* gui = furi_record_open(RECORD_GUI);
-
-    app->view_dispatcher = view_dispatcher_alloc();
-    view_dispatcher_enable_queue(app->view_dispatcher);
-    view_dispatcher_attach_to_gui(app->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
-    view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
-
-    app->submenu = submenu_alloc();
-    submenu_add_item(
-        app->submenu, "Config", SolanaSubmenuIndexConfig, solana_submenu_callback, app);
-    submenu_add_item(app->submenu, "Play", SolanaSubmenuIndexPlay, solana_submenu_callback, app);
-    submenu_add_item(app->submenu, "About", SolanaSubmenuIndexAbout, solana_submenu_callback, app);
-    view_set_previous_callback(submenu_get_view(app->submenu), solana_navigation_exit_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, SolanaViewSubmenu, submenu_get_view(app->submenu));
-    view_dispatcher_switch_to_view(app->view_dispatcher, SolanaViewSubmenu);
+    // Allocates the menu and every screen in solana_views.
+    app->views = view_table_alloc(&solana_view_config, app);
+    app->view_dispatcher = view_table_get_view_dispatcher(app->views);
 
-    app->widget_about = widget_alloc();
     widget_add_text_scroll_element(app->widget_about, 0, 0, 128, 64, "Coming Soon");
-    view_set_previous_callback(
-        widget_get_view(app->widget_about), solana_navigation_submenu_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, SolanaViewComingSoon, widget_get_view(app->widget_about));
 
     // Set the drawing callback for the coming soon view
     view_set_draw_callback(
         widget_get_view(app->widget_about), solana_view_coming_soon_draw_callback);
 
+    widget_add_string_element(
+        app->widget_unlocking, 64, 32, AlignCenter, AlignCenter, FontPrimary, "Unlocking...");
+
+    text_input_set_minimum_length(app->text_input, SOLANA_KEYSTORE_PIN_MIN);
+    text_input_set_result_callback(
+        app->text_input, solana_pin_callback, app, app->pin, sizeof(app->pin), true);
+
+    view_set_draw_callback(app->view_wallet, solana_view_wallet_draw_callback);
+    view_allocate_model(app->view_wallet, ViewModelTypeLockFree, sizeof(SolanaWalletModel));
+    SolanaWalletModel* wallet_model = view_get_model(app->view_wallet);
+    memset(wallet_model, 0, sizeof(SolanaWalletModel));
+
+    app->entropy = entropy_alloc();
+    app->keystore = solana_keystore_alloc(app->entropy);
+
     app->notifications = furi_record_open(RECORD_NOTIFICATION);
 
+    app->link = solana_link_alloc(solana_link_state_callback, app);
+
 #ifdef BACKLIGHT_ON
     notification_message(app->notifications, &sequence_display_backlight_enforce_on);
 #endif
@@ -142,17 +494,21 @@ static SolanaApp* solana_app_alloc() {
  * @param app The solana application object.
  */
 static void solana_app_free(SolanaApp* app) {
+    if(app->unlock_thread) {
+        furi_thread_join(app->unlock_thread);
+        furi_thread_free(app->unlock_thread);
+    }
+    solana_link_free(app->link);
+
 #ifdef BACKLIGHT_ON
     notification_message(app->notifications, &sequence_display_backlight_enforce_auto);
 #endif
     furi_record_close(RECORD_NOTIFICATION);
 
-    view_dispatcher_remove_view(app->view_dispatcher, SolanaViewComingSoon);
-    widget_free(app->widget_about);
-    view_dispatcher_remove_view(app->view_dispatcher, SolanaViewSubmenu);
-    submenu_free(app->submenu);
-    view_dispatcher_free(app->view_dispatcher);
-    furi_record_close(RECORD_GUI);
+    solana_keystore_free(app->keystore);
+    entropy_free(app->entropy);
+    view_table_free(app->views);
+    memset(app->pin, 0, sizeof(app->pin));
 
     free(app);
 }
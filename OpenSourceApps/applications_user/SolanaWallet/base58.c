@@ -0,0 +1,76 @@
+#include "base58.h"
+#include <string.h>
+
+#define BASE58_MAX_INPUT 64
+
+static const char base58_alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+bool base58_encode(const uint8_t* data, size_t size, char* out, size_t out_size) {
+    // Base 58 digits, least significant first.  log(256) / log(58) < 1.37
+    uint8_t digits[BASE58_MAX_INPUT * 137 / 100 + 1];
+    size_t digit_count = 0;
+    size_t zeros = 0;
+
+    if(size > BASE58_MAX_INPUT) {
+        return false;
+    }
+    while(zeros < size && data[zeros] == 0) {
+        zeros++;
+    }
+
+    for(size_t i = zeros; i < size; i++) {
+        uint32_t carry = data[i];
+        for(size_t j = 0; j < digit_count; j++) {
+            carry += (uint32_t)digits[j] << 8;
+            digits[j] = carry % 58;
+            carry /= 58;
+        }
+        while(carry) {
+            digits[digit_count++] = carry % 58;
+            carry /= 58;
+        }
+    }
+
+    if(zeros + digit_count + 1 > out_size) {
+        return false;
+    }
+    memset(out, '1', zeros);
+    for(size_t i = 0; i < digit_count; i++) {
+        out[zeros + i] = base58_alphabet[digits[digit_count - 1 - i]];
+    }
+    out[zeros + digit_count] = '\0';
+    return true;
+}
+
+bool base58_decode(const char* text, uint8_t* data, size_t size) {
+    size_t zeros = 0;
+    memset(data, 0, size);
+
+    while(text[zeros] == '1') {
+        zeros++;
+    }
+
+    // Big endian accumulator in data.
+    for(const char* p = text + zeros; *p; p++) {
+        const char* found = strchr(base58_alphabet, *p);
+        if(!found) {
+            return false;
+        }
+        uint32_t carry = found - base58_alphabet;
+        for(size_t i = size; i-- > 0;) {
+            carry += (uint32_t)data[i] * 58;
+            data[i] = carry & 0xff;
+            carry >>= 8;
+        }
+        if(carry) {
+            return false;
+        }
+    }
+
+    // Each leading '1' stands for one zero byte, so a canonical encoding has exactly as many.
+    size_t leading = 0;
+    while(leading < size && data[leading] == 0) {
+        leading++;
+    }
+    return leading == zeros;
+}
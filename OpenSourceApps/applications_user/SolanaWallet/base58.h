@@ -0,0 +1,23 @@
+#ifndef BASE58_H
+#define BASE58_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest text for a 32 byte key or address, plus the NUL.
+#define BASE58_ADDRESS_SIZE 45
+
+/**
+ * @brief      Encode with the Bitcoin alphabet, as Solana uses for keys and signatures.
+ * @return     false if out_size is too small for the text and its NUL.
+*/
+bool base58_encode(const uint8_t* data, size_t size, char* out, size_t out_size);
+
+/**
+ * @brief      Decode into exactly size bytes.
+ * @return     false on a bad character or if the value does not fit in size bytes.
+*/
+bool base58_decode(const char* text, uint8_t* data, size_t size);
+
+#endif // BASE58_H
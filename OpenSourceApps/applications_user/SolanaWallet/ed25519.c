@@ -0,0 +1,943 @@
+#include "ed25519.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Field and group arithmetic follows TweetNaCl (public domain): elements of GF(2^255 - 19) are
+// sixteen signed 16 bit limbs, which is small, constant time and easy to audit.
+typedef int64_t fe25519[16];
+
+static const fe25519 fe25519_zero = {0};
+static const fe25519 fe25519_one = {1};
+static const fe25519 ed25519_d = {
+    0x78a3, 0x1359, 0x4dca, 0x75eb, 0xd8ab, 0x4141, 0x0a4d, 0x0070,
+    0xe898, 0x7779, 0x4079, 0x8cc7, 0xfe73, 0x2b6f, 0x6cee, 0x5203};
+static const fe25519 ed25519_d2 = {
+    0xf159, 0x26b2, 0x9b94, 0xebd6, 0xb156, 0x8283, 0x149a, 0x00e0,
+    0xd130, 0xeef3, 0x80f2, 0x198e, 0xfce7, 0x56df, 0xd9dc, 0x2406};
+static const fe25519 ed25519_sqrt_m1 = {
+    0xa0b0, 0x4a0e, 0x1b27, 0xc4ee, 0xe478, 0xad2f, 0x1806, 0x2f43,
+    0xd7a7, 0x3dfb, 0x0099, 0x2b4d, 0xdf0b, 0x4fc1, 0x2480, 0x2b83};
+static const fe25519 ed25519_base_x = {
+    0xd51a, 0x8f25, 0x2d60, 0xc956, 0xa7b2, 0x9525, 0xc760, 0x692c,
+    0xdc5c, 0xfdd6, 0xe231, 0xc0a4, 0x53fe, 0xcd6e, 0x36d3, 0x2169};
+static const fe25519 ed25519_base_y = {
+    0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+    0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666};
+// 2^128 B, so ed25519_verify_batch() can split S B into two 128 bit scalars
+static const fe25519 ed25519_base128_x = {
+    0xe824, 0x60b7, 0x47ae, 0xfc80, 0x23e5, 0xc2e7, 0x85c9, 0x98e6,
+    0x29a0, 0xe14e, 0x3984, 0x952d, 0xf32c, 0x3c45, 0xafff, 0x4c27};
+static const fe25519 ed25519_base128_y = {
+    0xa66b, 0x4bf5, 0xbd11, 0x5bba, 0xc49e, 0x51a4, 0xbe1e, 0x90d0,
+    0x9c3a, 0x26c2, 0x1eb6, 0x95f1, 0xc87d, 0x526d, 0x99e6, 0x5f2c};
+
+// The group order L = 2^252 + 27742317777372353535851937790883648493.
+static const int64_t ed25519_l[32] = {0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58,
+                                      0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+                                      0,    0,    0,    0,    0,    0,    0,    0,
+                                      0,    0,    0,    0,    0,    0,    0,    0x10};
+
+static void fe25519_copy(fe25519 out, const fe25519 in) {
+    memcpy(out, in, sizeof(fe25519));
+}
+
+static void fe25519_carry(fe25519 o) {
+    for(int i = 0; i < 16; i++) {
+        o[i] += 1 << 16;
+        int64_t c = o[i] >> 16;
+        if(i < 15) {
+            o[i + 1] += c - 1;
+        } else {
+            o[0] += 38 * (c - 1);
+        }
+        o[i] -= c * 65536;
+    }
+}
+
+static void fe25519_select(fe25519 p, fe25519 q, int b) {
+    int64_t mask = ~((int64_t)b - 1);
+    for(int i = 0; i < 16; i++) {
+        int64_t t = mask & (p[i] ^ q[i]);
+        p[i] ^= t;
+        q[i] ^= t;
+    }
+}
+
+static void fe25519_pack(uint8_t out[32], const fe25519 n) {
+    fe25519 m, t;
+    fe25519_copy(t, n);
+    fe25519_carry(t);
+    fe25519_carry(t);
+    fe25519_carry(t);
+    for(int j = 0; j < 2; j++) {
+        m[0] = t[0] - 0xffed;
+        for(int i = 1; i < 15; i++) {
+            m[i] = t[i] - 0xffff - ((m[i - 1] >> 16) & 1);
+            m[i - 1] &= 0xffff;
+        }
+        m[15] = t[15] - 0x7fff - ((m[14] >> 16) & 1);
+        int b = (m[15] >> 16) & 1;
+        m[14] &= 0xffff;
+        fe25519_select(t, m, 1 - b);
+    }
+    for(int i = 0; i < 16; i++) {
+        out[2 * i] = t[i] & 0xff;
+        out[2 * i + 1] = (t[i] >> 8) & 0xff;
+    }
+}
+
+static void fe25519_add(fe25519 o, const fe25519 a, const fe25519 b) {
+    for(int i = 0; i < 16; i++) {
+        o[i] = a[i] + b[i];
+    }
+}
+
+static void fe25519_sub(fe25519 o, const fe25519 a, const fe25519 b) {
+    for(int i = 0; i < 16; i++) {
+        o[i] = a[i] - b[i];
+    }
+}
+
+static void fe25519_mul(fe25519 o, const fe25519 a, const fe25519 b) {
+    int64_t t[31] = {0};
+    for(int i = 0; i < 16; i++) {
+        for(int j = 0; j < 16; j++) {
+            t[i + j] += a[i] * b[j];
+        }
+    }
+    for(int i = 0; i < 15; i++) {
+        t[i] += 38 * t[i + 16];
+    }
+    for(int i = 0; i < 16; i++) {
+        o[i] = t[i];
+    }
+    fe25519_carry(o);
+    fe25519_carry(o);
+}
+
+static void fe25519_square(fe25519 o, const fe25519 a) {
+    fe25519_mul(o, a, a);
+}
+
+static void fe25519_invert(fe25519 o, const fe25519 in) {
+    fe25519 c;
+    fe25519_copy(c, in);
+    for(int a = 253; a >= 0; a--) {
+        fe25519_square(c, c);
+        if(a != 2 && a != 4) {
+            fe25519_mul(c, c, in);
+        }
+    }
+    fe25519_copy(o, c);
+}
+
+static int fe25519_parity(const fe25519 a) {
+    uint8_t d[32];
+    fe25519_pack(d, a);
+    return d[0] & 1;
+}
+
+// Extended twisted Edwards coordinates (X:Y:Z:T).
+typedef fe25519 ge25519[4];
+
+static void ge25519_add(ge25519 p, ge25519 q) {
+    fe25519 a, b, c, d, t, e, f, g, h;
+
+    fe25519_sub(a, p[1], p[0]);
+    fe25519_sub(t, q[1], q[0]);
+    fe25519_mul(a, a, t);
+    fe25519_add(b, p[0], p[1]);
+    fe25519_add(t, q[0], q[1]);
+    fe25519_mul(b, b, t);
+    fe25519_mul(c, p[3], q[3]);
+    fe25519_mul(c, c, ed25519_d2);
+    fe25519_mul(d, p[2], q[2]);
+    fe25519_add(d, d, d);
+    fe25519_sub(e, b, a);
+    fe25519_sub(f, d, c);
+    fe25519_add(g, d, c);
+    fe25519_add(h, b, a);
+
+    fe25519_mul(p[0], e, f);
+    fe25519_mul(p[1], h, g);
+    fe25519_mul(p[2], g, f);
+    fe25519_mul(p[3], e, h);
+}
+
+static void ge25519_swap(ge25519 p, ge25519 q, uint8_t b) {
+    for(int i = 0; i < 4; i++) {
+        fe25519_select(p[i], q[i], b);
+    }
+}
+
+static void ge25519_pack(uint8_t out[32], ge25519 p) {
+    fe25519 tx, ty, zi;
+    fe25519_invert(zi, p[2]);
+    fe25519_mul(tx, p[0], zi);
+    fe25519_mul(ty, p[1], zi);
+    fe25519_pack(out, ty);
+    out[31] ^= fe25519_parity(tx) << 7;
+}
+
+/**
+ * @brief      Constant time p = s * q.  q is clobbered.
+*/
+static void ge25519_scalarmult(ge25519 p, ge25519 q, const uint8_t s[32]) {
+    fe25519_copy(p[0], fe25519_zero);
+    fe25519_copy(p[1], fe25519_one);
+    fe25519_copy(p[2], fe25519_one);
+    fe25519_copy(p[3], fe25519_zero);
+    for(int i = 255; i >= 0; i--) {
+        uint8_t b = (s[i / 8] >> (i & 7)) & 1;
+        ge25519_swap(p, q, b);
+        ge25519_add(q, p);
+        ge25519_add(p, p);
+        ge25519_swap(p, q, b);
+    }
+}
+
+static void ge25519_scalarmult_base(ge25519 p, const uint8_t s[32]) {
+    ge25519 q;
+    fe25519_copy(q[0], ed25519_base_x);
+    fe25519_copy(q[1], ed25519_base_y);
+    fe25519_copy(q[2], fe25519_one);
+    fe25519_mul(q[3], ed25519_base_x, ed25519_base_y);
+    ge25519_scalarmult(p, q, s);
+}
+
+/**
+ * @brief      r = x mod L, where x is a 64 limb little endian number.  x is clobbered.
+*/
+static void sc25519_mod_l(uint8_t r[32], int64_t x[64]) {
+    int64_t carry;
+    int i, j;
+    for(i = 63; i >= 32; i--) {
+        carry = 0;
+        for(j = i - 32; j < i - 12; j++) {
+            x[j] += carry - 16 * x[i] * ed25519_l[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    carry = 0;
+    for(j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * ed25519_l[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for(j = 0; j < 32; j++) {
+        x[j] -= carry * ed25519_l[j];
+    }
+    for(i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = x[i] & 255;
+    }
+}
+
+static void sc25519_reduce(uint8_t r[32], const uint8_t digest[64]) {
+    int64_t x[64];
+    for(int i = 0; i < 64; i++) {
+        x[i] = digest[i];
+    }
+    sc25519_mod_l(r, x);
+}
+
+static void ed25519_expand_seed(
+    const uint8_t seed[ED25519_SEED_SIZE],
+    uint8_t scalar[32],
+    uint8_t prefix[32]) {
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    sha512(seed, ED25519_SEED_SIZE, digest);
+    digest[0] &= 248;
+    digest[31] &= 127;
+    digest[31] |= 64;
+    memcpy(scalar, digest, 32);
+    memcpy(prefix, digest + 32, 32);
+    memset(digest, 0, sizeof(digest));
+}
+
+void ed25519_public_key(
+    const uint8_t seed[ED25519_SEED_SIZE],
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE]) {
+    uint8_t scalar[32], prefix[32];
+    ge25519 p;
+    ed25519_expand_seed(seed, scalar, prefix);
+    ge25519_scalarmult_base(p, scalar);
+    ge25519_pack(public_key, p);
+    memset(scalar, 0, sizeof(scalar));
+    memset(prefix, 0, sizeof(prefix));
+}
+
+void ed25519_sign_stream_init(Ed25519SignStream* stream, const uint8_t seed[ED25519_SEED_SIZE]) {
+    ge25519 p;
+    memset(stream, 0, sizeof(Ed25519SignStream));
+    ed25519_expand_seed(seed, stream->scalar, stream->prefix);
+    ge25519_scalarmult_base(p, stream->scalar);
+    ge25519_pack(stream->public_key, p);
+
+    // Pass 1: r = H(prefix || M)
+    sha512_init(&stream->challenge);
+    sha512_update(&stream->challenge, stream->prefix, sizeof(stream->prefix));
+    stream->pass = 1;
+}
+
+void ed25519_sign_stream_update(Ed25519SignStream* stream, const uint8_t* data, size_t size) {
+    sha512_update(&stream->challenge, data, size);
+    if(stream->pass == 1) {
+        stream->length += size;
+    } else {
+        sha512_update(&stream->check, data, size);
+    }
+}
+
+void ed25519_sign_stream_next_pass(Ed25519SignStream* stream) {
+    ge25519 p;
+
+    sha512_final(&stream->challenge, stream->nonce_digest);
+    sc25519_reduce(stream->nonce, stream->nonce_digest);
+    ge25519_scalarmult_base(p, stream->nonce);
+    ge25519_pack(stream->commitment, p);
+
+    // Pass 2: k = H(R || A || M), and H(prefix || M) again to prove the message is unchanged.
+    sha512_init(&stream->challenge);
+    sha512_update(&stream->challenge, stream->commitment, sizeof(stream->commitment));
+    sha512_update(&stream->challenge, stream->public_key, sizeof(stream->public_key));
+    sha512_init(&stream->check);
+    sha512_update(&stream->check, stream->prefix, sizeof(stream->prefix));
+    stream->pass = 2;
+}
+
+bool ed25519_sign_stream_final(
+    Ed25519SignStream* stream,
+    uint8_t signature[ED25519_SIGNATURE_SIZE]) {
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    uint8_t k[32];
+    int64_t x[64];
+
+    // Compare the nonce hashes without an early exit.
+    sha512_final(&stream->check, digest);
+    uint8_t diff = 0;
+    for(size_t i = 0; i < sizeof(digest); i++) {
+        diff |= digest[i] ^ stream->nonce_digest[i];
+    }
+    if(stream->pass != 2 || diff != 0) {
+        memset(signature, 0, ED25519_SIGNATURE_SIZE);
+        ed25519_sign_stream_abort(stream);
+        return false;
+    }
+
+    sha512_final(&stream->challenge, digest);
+    sc25519_reduce(k, digest);
+
+    // S = (r + k * a) mod L
+    memset(x, 0, sizeof(x));
+    for(int i = 0; i < 32; i++) {
+        x[i] = stream->nonce[i];
+    }
+    for(int i = 0; i < 32; i++) {
+        for(int j = 0; j < 32; j++) {
+            x[i + j] += k[i] * (int64_t)stream->scalar[j];
+        }
+    }
+    memcpy(signature, stream->commitment, 32);
+    sc25519_mod_l(signature + 32, x);
+
+    memset(x, 0, sizeof(x));
+    ed25519_sign_stream_abort(stream);
+    return true;
+}
+
+void ed25519_sign_stream_abort(Ed25519SignStream* stream) {
+    memset(stream, 0, sizeof(Ed25519SignStream));
+}
+
+void ed25519_sign(
+    const uint8_t* message,
+    size_t size,
+    const uint8_t seed[ED25519_SEED_SIZE],
+    uint8_t signature[ED25519_SIGNATURE_SIZE]) {
+    Ed25519SignStream stream;
+    ed25519_sign_stream_init(&stream, seed);
+    ed25519_sign_stream_update(&stream, message, size);
+    ed25519_sign_stream_next_pass(&stream);
+    ed25519_sign_stream_update(&stream, message, size);
+    ed25519_sign_stream_final(&stream, signature);
+}
+
+// Verification only handles public data, so unlike signing it doesn't need to be constant time.
+
+#define ED25519_WINDOW     4 // wNAF digits are odd and at most 2^(ED25519_WINDOW - 1) - 1
+#define ED25519_TABLE_SIZE (1 << (ED25519_WINDOW - 2)) // P, 3P, 5P, 7P
+
+static void fe25519_unpack(fe25519 o, const uint8_t n[32]) {
+    for(int i = 0; i < 16; i++) {
+        o[i] = n[2 * i] + ((int64_t)n[2 * i + 1] << 8);
+    }
+    o[15] &= 0x7fff;
+}
+
+static bool fe25519_is_zero(const fe25519 a) {
+    uint8_t d[32];
+    uint8_t bits = 0;
+    fe25519_pack(d, a);
+    for(int i = 0; i < 32; i++) {
+        bits |= d[i];
+    }
+    return bits == 0;
+}
+
+static bool fe25519_equal(const fe25519 a, const fe25519 b) {
+    fe25519 t;
+    fe25519_sub(t, a, b);
+    return fe25519_is_zero(t);
+}
+
+// o = in^((p - 5) / 8), the square root step of point decoding
+static void fe25519_pow2523(fe25519 o, const fe25519 in) {
+    fe25519 c;
+    fe25519_copy(c, in);
+    for(int a = 250; a >= 0; a--) {
+        fe25519_square(c, c);
+        if(a != 1) {
+            fe25519_mul(c, c, in);
+        }
+    }
+    fe25519_copy(o, c);
+}
+
+/**
+ * @brief      p = 2p, 4 squarings and 4 multiplications against 9 multiplications for
+ *            ge25519_add(p, p).
+*/
+static void ge25519_double(ge25519 p) {
+    fe25519 a, b, c, e, f, g, h;
+
+    fe25519_square(a, p[0]);
+    fe25519_square(b, p[1]);
+    fe25519_square(c, p[2]);
+    fe25519_add(c, c, c);
+    fe25519_add(e, p[0], p[1]);
+    fe25519_square(e, e);
+    fe25519_sub(e, e, a);
+    fe25519_sub(e, e, b);
+    fe25519_sub(g, b, a);
+    fe25519_sub(f, g, c);
+    fe25519_add(h, a, b);
+    fe25519_sub(h, fe25519_zero, h);
+
+    fe25519_mul(p[0], e, f);
+    fe25519_mul(p[1], g, h);
+    fe25519_mul(p[2], f, g);
+    fe25519_mul(p[3], e, h);
+}
+
+static bool ge25519_is_identity(ge25519 p) {
+    return fe25519_is_zero(p[0]) && fe25519_equal(p[1], p[2]);
+}
+
+static bool ge25519_is_small_order(ge25519 p) {
+    ge25519 q;
+    memcpy(q, p, sizeof(ge25519));
+    ge25519_double(q);
+    ge25519_double(q);
+    ge25519_double(q);
+    return ge25519_is_identity(q);
+}
+
+static void ge25519_affine(ge25519 p, const fe25519 x, const fe25519 y) {
+    fe25519_copy(p[0], x);
+    fe25519_copy(p[1], y);
+    fe25519_copy(p[2], fe25519_one);
+    fe25519_mul(p[3], x, y);
+}
+
+/**
+ * @brief      r = -A for the encoded point A.
+ * @return     false unless s is the canonical encoding of a point (y < p, and no sign bit on
+ *            x = 0).
+*/
+static bool ge25519_unpack_negative(ge25519 r, const uint8_t s[32]) {
+    fe25519 t, check, num, den, den2, den4, den6;
+    uint8_t y[32];
+
+    fe25519_copy(r[2], fe25519_one);
+    fe25519_unpack(r[1], s);
+    fe25519_pack(y, r[1]);
+    y[31] |= s[31] & 0x80;
+    if(memcmp(y, s, sizeof(y)) != 0) {
+        return false;
+    }
+
+    // x^2 = (y^2 - 1) / (d y^2 + 1)
+    fe25519_square(num, r[1]);
+    fe25519_mul(den, num, ed25519_d);
+    fe25519_sub(num, num, r[2]);
+    fe25519_add(den, r[2], den);
+
+    fe25519_square(den2, den);
+    fe25519_square(den4, den2);
+    fe25519_mul(den6, den4, den2);
+    fe25519_mul(t, den6, num);
+    fe25519_mul(t, t, den);
+    fe25519_pow2523(t, t);
+    fe25519_mul(t, t, num);
+    fe25519_mul(t, t, den);
+    fe25519_mul(t, t, den);
+    fe25519_mul(r[0], t, den);
+
+    fe25519_square(check, r[0]);
+    fe25519_mul(check, check, den);
+    if(!fe25519_equal(check, num)) {
+        fe25519_mul(r[0], r[0], ed25519_sqrt_m1);
+    }
+    fe25519_square(check, r[0]);
+    fe25519_mul(check, check, den);
+    if(!fe25519_equal(check, num)) {
+        return false;
+    }
+    if((s[31] >> 7) && fe25519_is_zero(r[0])) {
+        return false;
+    }
+    if(fe25519_parity(r[0]) == (s[31] >> 7)) {
+        fe25519_sub(r[0], fe25519_zero, r[0]);
+    }
+    fe25519_mul(r[3], r[0], r[1]);
+    return true;
+}
+
+/**
+ * A point ready to be added: (Y + X, Y - X, 2Z, 2dT), packed to 32 bytes a coordinate so a
+ * batch's tables take a quarter of the RAM.  Subtracting it only swaps the first two.
+ */
+typedef struct {
+    uint8_t y_plus_x[32];
+    uint8_t y_minus_x[32];
+    uint8_t z2[32];
+    uint8_t t2d[32];
+} Ed25519Cached;
+
+static void ge25519_to_cached(Ed25519Cached* c, ge25519 p) {
+    fe25519 t;
+    fe25519_add(t, p[1], p[0]);
+    fe25519_pack(c->y_plus_x, t);
+    fe25519_sub(t, p[1], p[0]);
+    fe25519_pack(c->y_minus_x, t);
+    fe25519_add(t, p[2], p[2]);
+    fe25519_pack(c->z2, t);
+    fe25519_mul(t, p[3], ed25519_d2);
+    fe25519_pack(c->t2d, t);
+}
+
+/**
+ * @brief      p = p + q, or p - q when subtract is set.  The same formula as ge25519_add(), less
+ *            the multiplication by 2d that the cached point already has.
+*/
+static void ge25519_add_cached(ge25519 p, const Ed25519Cached* q, bool subtract) {
+    fe25519 a, b, c, d, e, f, g, h, t;
+
+    fe25519_sub(a, p[1], p[0]);
+    fe25519_unpack(t, subtract ? q->y_plus_x : q->y_minus_x);
+    fe25519_mul(a, a, t);
+    fe25519_add(b, p[0], p[1]);
+    fe25519_unpack(t, subtract ? q->y_minus_x : q->y_plus_x);
+    fe25519_mul(b, b, t);
+    fe25519_unpack(t, q->t2d);
+    fe25519_mul(c, p[3], t);
+    fe25519_unpack(t, q->z2);
+    fe25519_mul(d, p[2], t);
+    fe25519_sub(e, b, a);
+    if(subtract) {
+        fe25519_add(f, d, c);
+        fe25519_sub(g, d, c);
+    } else {
+        fe25519_sub(f, d, c);
+        fe25519_add(g, d, c);
+    }
+    fe25519_add(h, b, a);
+
+    fe25519_mul(p[0], e, f);
+    fe25519_mul(p[1], h, g);
+    fe25519_mul(p[2], g, f);
+    fe25519_mul(p[3], e, h);
+}
+
+static bool sc25519_is_canonical(const uint8_t s[32]) {
+    for(int i = 31; i >= 0; i--) {
+        if(s[i] != ed25519_l[i]) {
+            return s[i] < ed25519_l[i];
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief      Width ED25519_WINDOW non-adjacent form of s < 2^253: odd digits with at least
+ *            ED25519_WINDOW - 1 zeros after each, so a scalar costs about 256 / 5 additions.
+*/
+static void sc25519_wnaf(int8_t naf[256], const uint8_t s[32]) {
+    int carry = 0;
+    memset(naf, 0, 256);
+    for(int bit = 0; bit < 256;) {
+        if(((s[bit / 8] >> (bit % 8)) & 1) == carry) {
+            bit++;
+            continue;
+        }
+        int width = 256 - bit < ED25519_WINDOW ? 256 - bit : ED25519_WINDOW;
+        int word = carry;
+        for(int i = 0; i < width; i++) {
+            word += ((s[(bit + i) / 8] >> ((bit + i) % 8)) & 1) << i;
+        }
+        carry = (word >> (ED25519_WINDOW - 1)) & 1;
+        naf[bit] = word - (carry << ED25519_WINDOW);
+        bit += width;
+    }
+}
+
+// The odd multiples P, 3P, 5P, 7P of a point
+typedef struct {
+    Ed25519Cached odd[ED25519_TABLE_SIZE];
+} Ed25519MsmTable;
+
+// One term of a multi-scalar multiplication: its point's table and its scalar's digits
+typedef struct {
+    const Ed25519MsmTable* table;
+    int8_t naf[256];
+} Ed25519MsmTerm;
+
+static void ed25519_msm_table(Ed25519MsmTable* table, ge25519 p) {
+    ge25519 odd, twice;
+    Ed25519Cached step;
+    memcpy(odd, p, sizeof(ge25519));
+    memcpy(twice, p, sizeof(ge25519));
+    ge25519_double(twice);
+    ge25519_to_cached(&step, twice);
+    for(int i = 0; i < ED25519_TABLE_SIZE; i++) {
+        ge25519_to_cached(&table->odd[i], odd);
+        ge25519_add_cached(odd, &step, false);
+    }
+}
+
+/**
+ * @brief      p = the sum of every term's scalar times its point, by Straus's method: the terms
+ *            of this one sum share its doublings, so each one only adds its own digits.  They
+ *            start at the highest digit, so short scalars need fewer.
+*/
+static void ed25519_msm(ge25519 p, const Ed25519MsmTerm* terms, size_t count) {
+    fe25519_copy(p[0], fe25519_zero);
+    fe25519_copy(p[1], fe25519_one);
+    fe25519_copy(p[2], fe25519_one);
+    fe25519_copy(p[3], fe25519_zero);
+
+    bool started = false;
+    for(int bit = 255; bit >= 0; bit--) {
+        if(started) {
+            ge25519_double(p);
+        }
+        for(size_t i = 0; i < count; i++) {
+            int8_t digit = terms[i].naf[bit];
+            if(digit > 0) {
+                ge25519_add_cached(p, &terms[i].table->odd[digit / 2], false);
+                started = true;
+            } else if(digit < 0) {
+                ge25519_add_cached(p, &terms[i].table->odd[-digit / 2], true);
+                started = true;
+            }
+        }
+    }
+}
+
+// -P for the encoding of a signature's R or a public key A, if it is canonical and not of small
+// order, as Solana's verify_strict requires.
+static bool ed25519_verify_point(ge25519 minus_p, const uint8_t s[32]) {
+    return ge25519_unpack_negative(minus_p, s) && !ge25519_is_small_order(minus_p);
+}
+
+// k = H(R || A || M) mod L
+static void ed25519_challenge(uint8_t k[32], const Ed25519VerifyItem* item) {
+    Sha512Context ctx;
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    sha512_init(&ctx);
+    sha512_update(&ctx, item->signature, 32);
+    sha512_update(&ctx, item->public_key, ED25519_PUBLIC_KEY_SIZE);
+    sha512_update(&ctx, item->message, item->size);
+    sha512_final(&ctx, digest);
+    sc25519_reduce(k, digest);
+}
+
+typedef struct {
+    Ed25519MsmTable tables[2];
+    Ed25519MsmTerm terms[2];
+} Ed25519Verify;
+
+bool ed25519_verify(
+    const uint8_t* message,
+    size_t size,
+    const uint8_t public_key[ED25519_PUBLIC_KEY_SIZE],
+    const uint8_t signature[ED25519_SIGNATURE_SIZE]) {
+    Ed25519VerifyItem item = {message, size, public_key, signature};
+    ge25519 minus_r, minus_a, p;
+    uint8_t k[32], check[32];
+
+    if(!sc25519_is_canonical(signature + 32) || !ed25519_verify_point(minus_r, signature) ||
+       !ed25519_verify_point(minus_a, public_key)) {
+        return false;
+    }
+    ed25519_challenge(k, &item);
+
+    // S B - k A, which must encode to R
+    Ed25519Verify* verify = malloc(sizeof(Ed25519Verify));
+    ge25519_affine(p, ed25519_base_x, ed25519_base_y);
+    ed25519_msm_table(&verify->tables[0], p);
+    ed25519_msm_table(&verify->tables[1], minus_a);
+    verify->terms[0].table = &verify->tables[0];
+    verify->terms[1].table = &verify->tables[1];
+    sc25519_wnaf(verify->terms[0].naf, signature + 32);
+    sc25519_wnaf(verify->terms[1].naf, k);
+    ed25519_msm(p, verify->terms, 2);
+    free(verify);
+
+    ge25519_pack(check, p);
+    return memcmp(check, signature, sizeof(check)) == 0;
+}
+
+typedef struct {
+    Ed25519MsmTable base[2]; // B and 2^128 B
+    Ed25519MsmTable keys[ED25519_BATCH_MAX][2]; // -A and -2^128 A of each different key
+    const uint8_t* public_keys[ED25519_BATCH_MAX];
+    Ed25519MsmTerm terms[4];
+
+    // S B - k A of each signature that got that far, packed together at the end
+    uint8_t x[ED25519_BATCH_MAX][32];
+    uint8_t y[ED25519_BATCH_MAX][32];
+    uint8_t z[ED25519_BATCH_MAX][32];
+    uint8_t products[ED25519_BATCH_MAX][32]; // Running products of z
+    size_t index[ED25519_BATCH_MAX]; // Which item each one is
+} Ed25519Batch;
+
+/**
+ * @brief      The tables of public_key in batch, decoded and built the first time it is seen.
+ * @return     The key's index, or -1 if it isn't canonical or is of small order.
+*/
+static int ed25519_batch_key(Ed25519Batch* batch, size_t* keys, const uint8_t* public_key) {
+    ge25519 minus_a;
+    for(size_t i = 0; i < *keys; i++) {
+        if(memcmp(batch->public_keys[i], public_key, ED25519_PUBLIC_KEY_SIZE) == 0) {
+            return i;
+        }
+    }
+    if(!ed25519_verify_point(minus_a, public_key)) {
+        return -1;
+    }
+    ed25519_msm_table(&batch->keys[*keys][0], minus_a);
+    for(int i = 0; i < 128; i++) {
+        ge25519_double(minus_a);
+    }
+    ed25519_msm_table(&batch->keys[*keys][1], minus_a);
+    batch->public_keys[*keys] = public_key;
+    return (*keys)++;
+}
+
+// Digits of the low and the high 128 bits of s, for P and 2^128 P
+static void sc25519_wnaf_halves(int8_t low[256], int8_t high[256], const uint8_t s[32]) {
+    uint8_t half[32] = {0};
+    memcpy(half, s, 16);
+    sc25519_wnaf(low, half);
+    memcpy(half, s + 16, 16);
+    sc25519_wnaf(high, half);
+}
+
+/**
+ * @brief      Check up to ED25519_BATCH_MAX signatures one by one, exactly the way
+ *            ed25519_verify() does, reusing what repeats.  B's tables are built once, and each
+ *            different key is decoded and its tables built once.  S B - k A is
+ *            S_lo B + S_hi 2^128 B - k_lo A - k_hi 2^128 A with 128 bit halves, which takes half
+ *            the doublings but needs the 2^128 tables, so it is only worth it with them shared.
+ *            R is never decoded, the result is packed and compared with it instead, and all
+ *            results are packed with one shared inversion.
+*/
+static bool ed25519_verify_chunk(
+    Ed25519Batch* batch,
+    const Ed25519VerifyItem* items,
+    size_t count,
+    bool* valid) {
+    ge25519 p;
+    fe25519 product, inverse, z_inverse, x, y;
+    uint8_t k[32], check[32];
+    size_t keys = 0, batched = 0;
+    bool all = true;
+
+    batch->terms[0].table = &batch->base[0];
+    batch->terms[1].table = &batch->base[1];
+    for(size_t i = 0; i < count; i++) {
+        const Ed25519VerifyItem* item = &items[i];
+        int key = -1;
+        valid[i] = false;
+        if(sc25519_is_canonical(item->signature + 32)) {
+            key = ed25519_batch_key(batch, &keys, item->public_key);
+        }
+        if(key < 0) {
+            all = false;
+            continue;
+        }
+
+        ed25519_challenge(k, item);
+        sc25519_wnaf_halves(batch->terms[0].naf, batch->terms[1].naf, item->signature + 32);
+        sc25519_wnaf_halves(batch->terms[2].naf, batch->terms[3].naf, k);
+        batch->terms[2].table = &batch->keys[key][0];
+        batch->terms[3].table = &batch->keys[key][1];
+        ed25519_msm(p, batch->terms, 4);
+
+        // R must encode this point, so R is of small order exactly when it is.
+        if(ge25519_is_small_order(p)) {
+            all = false;
+            continue;
+        }
+        fe25519_pack(batch->x[batched], p[0]);
+        fe25519_pack(batch->y[batched], p[1]);
+        fe25519_pack(batch->z[batched], p[2]);
+        batch->index[batched++] = i;
+    }
+    if(!batched) {
+        return all;
+    }
+
+    // Montgomery's trick: invert the product of every z, then take one z off it at a time.
+    fe25519_copy(product, fe25519_one);
+    for(size_t n = 0; n < batched; n++) {
+        fe25519_unpack(x, batch->z[n]);
+        fe25519_mul(product, product, x);
+        fe25519_pack(batch->products[n], product);
+    }
+    fe25519_invert(inverse, product);
+    for(size_t n = batched; n-- > 0;) {
+        if(n) {
+            fe25519_unpack(x, batch->products[n - 1]);
+            fe25519_mul(z_inverse, inverse, x);
+        } else {
+            fe25519_copy(z_inverse, inverse);
+        }
+        fe25519_unpack(x, batch->z[n]);
+        fe25519_mul(inverse, inverse, x);
+
+        fe25519_unpack(x, batch->x[n]);
+        fe25519_mul(x, x, z_inverse);
+        fe25519_unpack(y, batch->y[n]);
+        fe25519_mul(y, y, z_inverse);
+        fe25519_pack(check, y);
+        check[31] ^= fe25519_parity(x) << 7;
+
+        size_t i = batch->index[n];
+        valid[i] = memcmp(check, items[i].signature, sizeof(check)) == 0;
+        all = valid[i] && all;
+    }
+    return all;
+}
+
+bool ed25519_verify_batch(const Ed25519VerifyItem* items, size_t count, bool* valid) {
+    Ed25519Batch* batch = malloc(sizeof(Ed25519Batch));
+    ge25519 p;
+    bool all = true;
+
+    ge25519_affine(p, ed25519_base_x, ed25519_base_y);
+    ed25519_msm_table(&batch->base[0], p);
+    ge25519_affine(p, ed25519_base128_x, ed25519_base128_y);
+    ed25519_msm_table(&batch->base[1], p);
+    for(size_t start = 0; start < count; start += ED25519_BATCH_MAX) {
+        size_t chunk = count - start < ED25519_BATCH_MAX ? count - start : ED25519_BATCH_MAX;
+        all = ed25519_verify_chunk(batch, items + start, chunk, valid + start) && all;
+    }
+    free(batch);
+    return all;
+}
+
+// p = 2^255 - 19 as little endian 32 bit words
+static const uint32_t ed25519_p32[8] = {
+    0xffffffed, 0xffffffff, 0xffffffff, 0xffffffff,
+    0xffffffff, 0xffffffff, 0xffffffff, 0x7fffffff,
+};
+
+/**
+ * @brief      Whether a, a canonical non zero field element, is a square mod p.
+ * @details    The binary Jacobi symbol algorithm only shifts and subtracts 256 bit integers, a
+ *            few hundred cheap steps where Euler's criterion would take 254 field squarings.
+*/
+static bool fe25519_is_square(const uint8_t bytes[32]) {
+    uint32_t a[8], n[8];
+    bool negative = false;
+    for(int i = 0; i < 8; i++) {
+        a[i] = bytes[4 * i] | ((uint32_t)bytes[4 * i + 1] << 8) |
+               ((uint32_t)bytes[4 * i + 2] << 16) | ((uint32_t)bytes[4 * i + 3] << 24);
+    }
+    memcpy(n, ed25519_p32, sizeof(n));
+
+    while(true) {
+        // a = a / 2^shift, each factor 2 flips the sign when n = 3 or 5 mod 8
+        int shift = 0;
+        while(!a[0]) {
+            memmove(a, a + 1, sizeof(uint32_t) * 7);
+            a[7] = 0;
+            shift += 32;
+        }
+        int bits = __builtin_ctz(a[0]);
+        if(bits) {
+            for(int i = 0; i < 7; i++) {
+                a[i] = (a[i] >> bits) | (a[i + 1] << (32 - bits));
+            }
+            a[7] >>= bits;
+        }
+        shift += bits;
+        if((shift & 1) && ((n[0] & 7) == 3 || (n[0] & 7) == 5)) {
+            negative = !negative;
+        }
+
+        // Both odd now.  Keep a >= n, swapping by quadratic reciprocity.
+        int compare = 0;
+        for(int i = 7; i >= 0 && !compare; i--) {
+            compare = a[i] < n[i] ? -1 : a[i] > n[i];
+        }
+        if(compare == 0) {
+            return !negative; // a = n = 1, as p is prime and a isn't 0
+        }
+        if(compare < 0) {
+            uint32_t t[8];
+            memcpy(t, a, sizeof(t));
+            memcpy(a, n, sizeof(a));
+            memcpy(n, t, sizeof(n));
+            if((a[0] & 3) == 3 && (n[0] & 3) == 3) {
+                negative = !negative;
+            }
+        }
+        if(n[0] == 1 && !(n[1] | n[2] | n[3] | n[4] | n[5] | n[6] | n[7])) {
+            return !negative;
+        }
+
+        uint64_t borrow = 0;
+        for(int i = 0; i < 8; i++) {
+            uint64_t d = (uint64_t)a[i] - n[i] - borrow;
+            a[i] = (uint32_t)d;
+            borrow = (d >> 32) & 1;
+        }
+    }
+}
+
+bool ed25519_is_on_curve(const uint8_t point[32]) {
+    fe25519 y, u, v;
+    uint8_t w[32];
+    uint8_t bits = 0;
+
+    // x^2 = u / v with u = y^2 - 1 and v = d y^2 + 1 (never 0), which has a root exactly when
+    // u v is a square.
+    fe25519_unpack(y, point);
+    fe25519_square(u, y);
+    fe25519_mul(v, u, ed25519_d);
+    fe25519_sub(u, u, fe25519_one);
+    fe25519_add(v, v, fe25519_one);
+    fe25519_mul(u, u, v);
+    fe25519_pack(w, u);
+    for(int i = 0; i < 32; i++) {
+        bits |= w[i];
+    }
+    return !bits || fe25519_is_square(w);
+}
@@ -0,0 +1,130 @@
+#ifndef ED25519_H
+#define ED25519_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sha512.h"
+
+#define ED25519_SEED_SIZE       32
+#define ED25519_PUBLIC_KEY_SIZE 32
+#define ED25519_SIGNATURE_SIZE  64
+
+// Signatures that share public key tables in ed25519_verify_batch(), longer lists are split.
+// The work area is about 21KB, allocated for the call.
+#define ED25519_BATCH_MAX 16
+
+/**
+ * Signing state for messages that are never held in memory as a whole.
+ * @details Ed25519 hashes the message twice: once with the secret prefix to derive the nonce r,
+ *          then with R and the public key to derive the challenge.  The caller streams the
+ *          message through ed25519_sign_stream_update() once, calls
+ *          ed25519_sign_stream_next_pass(), then streams the identical message again.
+ *
+ *          The second pass also re-derives the nonce hash.  If the two passes did not see the
+ *          same bytes, no signature is released: two signatures sharing r over different
+ *          challenges would reveal the private key.
+ */
+typedef struct {
+    Sha512Context challenge; // Nonce hash in pass 1, challenge hash in pass 2
+    Sha512Context check; // Nonce hash recomputed in pass 2
+    uint8_t scalar[32]; // Clamped secret scalar
+    uint8_t prefix[32]; // Second half of the expanded seed
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE]; // Derived from the seed, never taken from callers
+    uint8_t nonce_digest[SHA512_DIGEST_SIZE]; // Pass 1 nonce hash, before reduction
+    uint8_t nonce[32]; // r
+    uint8_t commitment[32]; // R = rB
+    uint64_t length; // Message bytes seen in pass 1
+    uint8_t pass;
+} Ed25519SignStream;
+
+/**
+ * @brief      Derive the public key for a 32 byte seed (the Solana secret key format).
+*/
+void ed25519_public_key(
+    const uint8_t seed[ED25519_SEED_SIZE],
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE]);
+
+/**
+ * @brief      Sign a message that is fully in memory.
+*/
+void ed25519_sign(
+    const uint8_t* message,
+    size_t size,
+    const uint8_t seed[ED25519_SEED_SIZE],
+    uint8_t signature[ED25519_SIGNATURE_SIZE]);
+
+/**
+ * @brief      Start signing with seed.
+ * @details    The public key that goes into the challenge is derived from the seed here.  Taking
+ *            it from the caller would let a wrong key (say a stale keystore index) sign the same
+ *            message, so the same r, under two different challenges, which gives away the seed.
+*/
+void ed25519_sign_stream_init(Ed25519SignStream* stream, const uint8_t seed[ED25519_SEED_SIZE]);
+
+/**
+ * @brief      Hash the next chunk of the message in the current pass.
+*/
+void ed25519_sign_stream_update(Ed25519SignStream* stream, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Finish the first pass.  The message must now be streamed again from the start.
+*/
+void ed25519_sign_stream_next_pass(Ed25519SignStream* stream);
+
+/**
+ * @brief      Finish the second pass and wipe the secret state.
+ * @return     false if the second pass did not match the first; signature is zeroed.
+*/
+bool ed25519_sign_stream_final(
+    Ed25519SignStream* stream,
+    uint8_t signature[ED25519_SIGNATURE_SIZE]);
+
+/**
+ * @brief      Wipe the secret state without producing a signature.
+*/
+void ed25519_sign_stream_abort(Ed25519SignStream* stream);
+
+typedef struct {
+    const uint8_t* message;
+    size_t size;
+    const uint8_t* public_key; // ED25519_PUBLIC_KEY_SIZE bytes
+    const uint8_t* signature; // ED25519_SIGNATURE_SIZE bytes
+} Ed25519VerifyItem;
+
+/**
+ * @brief      Check one signature the way Solana's verify_strict does: S must be below L, A and
+ *            R canonical and not of small order, and S B - k A must encode to R exactly.
+*/
+bool ed25519_verify(
+    const uint8_t* message,
+    size_t size,
+    const uint8_t public_key[ED25519_PUBLIC_KEY_SIZE],
+    const uint8_t signature[ED25519_SIGNATURE_SIZE]);
+
+/**
+ * @brief      Check many signatures, for the signatures already on a transaction or a queue of
+ *            them.
+ * @details    Every signature gets exactly the answer ed25519_verify() would give it, so a
+ *            signature the cluster rejects is never shown as valid.  That rules out batch
+ *            verification proper, one random linear combination of all the signature equations:
+ *            it only tests them up to small order points, so it can pass a signature whose R has
+ *            a small order part added on purpose, and no check cheap enough to keep its gain
+ *            finds those.
+ *
+ *            So each signature still costs its own multi-scalar multiplication.  What is shared
+ *            is the decoding and the precomputed multiples of each different public key, B's
+ *            tables and the last field inversion.  That pays off when the same keys signed many
+ *            of the signatures, and barely otherwise.
+ * @param      valid   count results, true for a good signature.
+ * @return     true if every signature is valid.
+*/
+bool ed25519_verify_batch(const Ed25519VerifyItem* items, size_t count, bool* valid);
+
+/**
+ * @brief      Whether the 32 bytes decode to a point, the way the cluster decides if a program
+ *            derived address is off the curve: the sign bit is ignored and y is taken mod p.
+*/
+bool ed25519_is_on_curve(const uint8_t point[32]);
+
+#endif // ED25519_H
@@ -0,0 +1,415 @@
+#include "qr_code.h"
+#include <string.h>
+
+#define QR_CODE_MASKS        8
+#define QR_CODE_ECC_MAX      26 // Error correction codewords of version 3-M
+#define QR_CODE_MODE_ALNUM   0x2
+#define QR_CODE_MODE_BYTE    0x4
+#define QR_CODE_FORMAT_MASK  0x5412
+#define QR_CODE_FORMAT_POLY  0x537
+#define QR_CODE_PENALTY_N2   3
+#define QR_CODE_PENALTY_N3   40
+#define QR_CODE_PENALTY_N4   10
+#define QR_CODE_DARK         0xFF // Dark under every mask
+
+static const char qr_code_alphanumeric[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+// Codewords for versions 1-3, indexed by QrCodeEcc.  They are all a single block.
+static const uint8_t qr_code_data_codewords[2][QR_CODE_VERSION_MAX] = {{19, 34, 55}, {16, 28, 44}};
+static const uint8_t qr_code_ecc_codewords[2][QR_CODE_VERSION_MAX] = {{7, 10, 15}, {10, 16, 26}};
+
+// The format information calls the levels L=1, M=0.
+static const uint8_t qr_code_ecc_format[2] = {1, 0};
+
+typedef struct {
+    uint8_t* data;
+    size_t bit;
+} QrCodeBits;
+
+static void qr_code_put_bits(QrCodeBits* bits, uint32_t value, uint8_t count) {
+    while(count--) {
+        if((value >> count) & 1) {
+            bits->data[bits->bit >> 3] |= 0x80 >> (bits->bit & 7);
+        }
+        bits->bit++;
+    }
+}
+
+static int qr_code_alphanumeric_index(char c) {
+    const char* found = c ? strchr(qr_code_alphanumeric, c) : NULL;
+    return found ? (int)(found - qr_code_alphanumeric) : -1;
+}
+
+static uint8_t qr_code_gf_multiply(uint8_t a, uint8_t b) {
+    unsigned product = 0;
+    for(int i = 7; i >= 0; i--) {
+        product = (product << 1) ^ ((product >> 7) * 0x11D);
+        product ^= ((b >> i) & 1) * a;
+    }
+    return (uint8_t)product;
+}
+
+/**
+ * @brief      Append count Reed-Solomon codewords for data, GF(256) modulo x^8+x^4+x^3+x^2+1.
+*/
+static void qr_code_reed_solomon(const uint8_t* data, size_t size, uint8_t* ecc, uint8_t count) {
+    uint8_t generator[QR_CODE_ECC_MAX] = {0};
+    uint8_t root = 1;
+
+    // Product of (x - 2^i) for i < count, highest coefficient dropped.
+    generator[count - 1] = 1;
+    for(uint8_t i = 0; i < count; i++) {
+        for(uint8_t j = 0; j < count; j++) {
+            generator[j] = qr_code_gf_multiply(generator[j], root);
+            if(j + 1 < count) {
+                generator[j] ^= generator[j + 1];
+            }
+        }
+        root = qr_code_gf_multiply(root, 0x02);
+    }
+
+    memset(ecc, 0, count);
+    for(size_t i = 0; i < size; i++) {
+        uint8_t factor = data[i] ^ ecc[0];
+        memmove(ecc, ecc + 1, count - 1);
+        ecc[count - 1] = 0;
+        for(uint8_t j = 0; j < count; j++) {
+            ecc[j] ^= qr_code_gf_multiply(generator[j], factor);
+        }
+    }
+}
+
+static void qr_code_set_function(QrCode* qr, int x, int y, uint8_t lanes) {
+    qr->modules[y][x] = lanes;
+    qr->function[y][x >> 3] |= 1 << (x & 7);
+}
+
+static bool qr_code_is_function(const QrCode* qr, int x, int y) {
+    return qr->function[y][x >> 3] & (1 << (x & 7));
+}
+
+static int qr_code_distance(int dx, int dy) {
+    dx = dx < 0 ? -dx : dx;
+    dy = dy < 0 ? -dy : dy;
+    return dx > dy ? dx : dy;
+}
+
+// Finder with its light separator, clipped at the edges of the symbol.
+static void qr_code_draw_finder(QrCode* qr, int cx, int cy) {
+    for(int dy = -4; dy <= 4; dy++) {
+        for(int dx = -4; dx <= 4; dx++) {
+            int x = cx + dx;
+            int y = cy + dy;
+            int distance = qr_code_distance(dx, dy);
+            if(x >= 0 && x < qr->size && y >= 0 && y < qr->size) {
+                qr_code_set_function(
+                    qr, x, y, (distance != 2 && distance != 4) ? QR_CODE_DARK : 0);
+            }
+        }
+    }
+}
+
+static void qr_code_draw_alignment(QrCode* qr, int cx, int cy) {
+    for(int dy = -2; dy <= 2; dy++) {
+        for(int dx = -2; dx <= 2; dx++) {
+            qr_code_set_function(
+                qr, cx + dx, cy + dy, qr_code_distance(dx, dy) != 1 ? QR_CODE_DARK : 0);
+        }
+    }
+}
+
+/**
+ * @brief      Place both copies of the format information.
+ * @details    The 15 bits depend on the mask, so every format module holds the bit of each mask
+ *            in its own lane.  That way the mask scoring sees the real format modules.
+*/
+static void qr_code_draw_format(QrCode* qr) {
+    uint16_t format[QR_CODE_MASKS];
+    uint8_t lanes[15] = {0};
+    int size = qr->size;
+
+    for(uint8_t mask = 0; mask < QR_CODE_MASKS; mask++) {
+        uint16_t data = (qr_code_ecc_format[qr->ecc] << 3) | mask;
+        uint16_t remainder = data;
+        for(int i = 0; i < 10; i++) {
+            remainder = (remainder << 1) ^ ((remainder >> 9) * QR_CODE_FORMAT_POLY);
+        }
+        format[mask] = ((data << 10) | remainder) ^ QR_CODE_FORMAT_MASK;
+        for(int bit = 0; bit < 15; bit++) {
+            lanes[bit] |= ((format[mask] >> bit) & 1) << mask;
+        }
+    }
+
+    for(int i = 0; i <= 5; i++) {
+        qr_code_set_function(qr, 8, i, lanes[i]);
+    }
+    qr_code_set_function(qr, 8, 7, lanes[6]);
+    qr_code_set_function(qr, 8, 8, lanes[7]);
+    qr_code_set_function(qr, 7, 8, lanes[8]);
+    for(int i = 9; i < 15; i++) {
+        qr_code_set_function(qr, 14 - i, 8, lanes[i]);
+    }
+
+    for(int i = 0; i < 8; i++) {
+        qr_code_set_function(qr, size - 1 - i, 8, lanes[i]);
+    }
+    for(int i = 8; i < 15; i++) {
+        qr_code_set_function(qr, 8, size - 15 + i, lanes[i]);
+    }
+    qr_code_set_function(qr, 8, size - 8, QR_CODE_DARK);
+}
+
+static void qr_code_draw_function_patterns(QrCode* qr) {
+    int size = qr->size;
+
+    for(int i = 0; i < size; i++) {
+        qr_code_set_function(qr, 6, i, (i % 2) ? 0 : QR_CODE_DARK);
+        qr_code_set_function(qr, i, 6, (i % 2) ? 0 : QR_CODE_DARK);
+    }
+    qr_code_draw_finder(qr, 3, 3);
+    qr_code_draw_finder(qr, size - 4, 3);
+    qr_code_draw_finder(qr, 3, size - 4);
+    // Versions 2 and 3 have one alignment pattern, the other positions overlap the finders.
+    if(qr->version > 1) {
+        qr_code_draw_alignment(qr, size - 7, size - 7);
+    }
+    qr_code_draw_format(qr);
+}
+
+/**
+ * @brief      Bit m set if mask pattern m flips the module at column x, row y.
+*/
+static uint8_t qr_code_mask_lanes(int x, int y) {
+    uint8_t lanes = 0;
+    lanes |= ((x + y) % 2 == 0) << 0;
+    lanes |= (y % 2 == 0) << 1;
+    lanes |= (x % 3 == 0) << 2;
+    lanes |= ((x + y) % 3 == 0) << 3;
+    lanes |= ((x / 3 + y / 2) % 2 == 0) << 4;
+    lanes |= (x * y % 2 + x * y % 3 == 0) << 5;
+    lanes |= ((x * y % 2 + x * y % 3) % 2 == 0) << 6;
+    lanes |= (((x + y) % 2 + x * y % 3) % 2 == 0) << 7;
+    return lanes;
+}
+
+/**
+ * @brief      Lay the codewords out in the two column zigzag, already XORed with all 8 masks.
+*/
+static void qr_code_draw_codewords(QrCode* qr, size_t count) {
+    int size = qr->size;
+    size_t bit = 0;
+
+    for(int right = size - 1; right >= 1; right -= 2) {
+        if(right == 6) {
+            right = 5; // Skip the vertical timing pattern
+        }
+        bool upward = ((right + 1) & 2) == 0;
+        for(int vertical = 0; vertical < size; vertical++) {
+            int y = upward ? size - 1 - vertical : vertical;
+            for(int j = 0; j < 2; j++) {
+                int x = right - j;
+                if(qr_code_is_function(qr, x, y)) {
+                    continue;
+                }
+                // Remainder bits past the last codeword are light before masking.
+                bool dark = bit < count * 8 &&
+                            ((qr->codewords[bit >> 3] >> (7 - (bit & 7))) & 1);
+                qr->modules[y][x] = (dark ? QR_CODE_DARK : 0) ^ qr_code_mask_lanes(x, y);
+                bit++;
+            }
+        }
+    }
+}
+
+static void qr_code_add_lanes(uint32_t penalty[QR_CODE_MASKS], uint8_t lanes, uint32_t points) {
+    while(lanes) {
+        penalty[__builtin_ctz(lanes)] += points;
+        lanes &= lanes - 1;
+    }
+}
+
+/**
+ * @brief      Score runs (N1) and finder-like patterns (N3) along one row or column, for all 8
+ *            masks at once.
+ * @details    A run is only closed in the lanes whose colour changes, so long same-coloured
+ *            stretches cost nothing.  The 1:1:3:1:1 pattern with 4 light modules on one side is
+ *            matched with plain AND/NOT over the lane bytes, one window for all masks.
+*/
+static void qr_code_penalty_line(
+    const uint8_t* line,
+    size_t stride,
+    int size,
+    uint32_t penalty[QR_CODE_MASKS]) {
+    uint8_t run_start[QR_CODE_MASKS] = {0};
+
+    for(int i = 1; i <= size; i++) {
+        uint8_t changed = (i < size) ? line[i * stride] ^ line[(i - 1) * stride] : 0xFF;
+        while(changed) {
+            int mask = __builtin_ctz(changed);
+            int length = i - run_start[mask];
+            if(length >= 5) {
+                penalty[mask] += length - 2;
+            }
+            run_start[mask] = i;
+            changed &= changed - 1;
+        }
+    }
+
+#define QR_CODE_AT(n) (window[(n) * stride])
+    for(int i = 0; i + 11 <= size; i++) {
+        const uint8_t* window = line + i * stride;
+        uint8_t core = ~QR_CODE_AT(1) & QR_CODE_AT(4) & ~QR_CODE_AT(5) & QR_CODE_AT(6) &
+                       ~QR_CODE_AT(9);
+        uint8_t light_after = QR_CODE_AT(0) & QR_CODE_AT(2) & QR_CODE_AT(3) & ~QR_CODE_AT(7) &
+                              ~QR_CODE_AT(8) & ~QR_CODE_AT(10);
+        uint8_t light_before = ~QR_CODE_AT(0) & ~QR_CODE_AT(2) & ~QR_CODE_AT(3) &
+                               QR_CODE_AT(7) & QR_CODE_AT(8) & QR_CODE_AT(10);
+        qr_code_add_lanes(penalty, core & (light_after | light_before), QR_CODE_PENALTY_N3);
+    }
+#undef QR_CODE_AT
+}
+
+/**
+ * @brief      Pick the mask with the lowest penalty in a single pass over the symbol.
+ * @details    Instead of applying each mask and scoring the whole symbol 8 times, every module
+ *            already holds its colour under all 8 masks (one bit per mask), so each rule is
+ *            evaluated once per module with byte-wide logic.
+*/
+static uint8_t qr_code_choose_mask(const QrCode* qr) {
+    uint32_t penalty[QR_CODE_MASKS] = {0};
+    uint16_t dark[QR_CODE_MASKS] = {0};
+    int size = qr->size;
+
+    for(int y = 0; y < size; y++) {
+        const uint8_t* row = qr->modules[y];
+        qr_code_penalty_line(row, 1, size, penalty);
+        qr_code_penalty_line(&qr->modules[0][y], QR_CODE_SIZE_MAX, size, penalty);
+
+        for(int x = 0; x < size; x++) {
+            for(uint8_t mask = 0; mask < QR_CODE_MASKS; mask++) {
+                dark[mask] += (row[x] >> mask) & 1;
+            }
+            if(y + 1 < size && x + 1 < size) {
+                const uint8_t* below = qr->modules[y + 1];
+                uint8_t same = ~(row[x] ^ row[x + 1]) & ~(row[x] ^ below[x]) &
+                               ~(row[x] ^ below[x + 1]);
+                qr_code_add_lanes(penalty, same, QR_CODE_PENALTY_N2);
+            }
+        }
+    }
+
+    uint8_t best = 0;
+    int total = size * size;
+    for(uint8_t mask = 0; mask < QR_CODE_MASKS; mask++) {
+        // N4: 10 points for every 5% the dark share is away from 50%.
+        int deviation = dark[mask] * 20 - total * 10;
+        penalty[mask] += (deviation < 0 ? -deviation : deviation) / total * QR_CODE_PENALTY_N4;
+        if(penalty[mask] < penalty[best]) {
+            best = mask;
+        }
+    }
+    return best;
+}
+
+bool qr_code_encode(QrCode* qr, const char* text, QrCodeEcc ecc) {
+    size_t length = strlen(text);
+    bool alphanumeric = true;
+    for(size_t i = 0; i < length && alphanumeric; i++) {
+        alphanumeric = qr_code_alphanumeric_index(text[i]) >= 0;
+    }
+    size_t bit_count = alphanumeric ? 4 + 9 + 11 * (length / 2) + 6 * (length % 2) :
+                                      4 + 8 + 8 * length;
+
+    uint8_t version = 0;
+    while(true) {
+        for(uint8_t v = 1; v <= QR_CODE_VERSION_MAX && !version; v++) {
+            if(bit_count <= qr_code_data_codewords[ecc][v - 1] * 8u) {
+                version = v;
+            }
+        }
+        if(version || ecc == QrCodeEccLow) {
+            break;
+        }
+        ecc = QrCodeEccLow;
+    }
+    if(!version) {
+        return false;
+    }
+
+    memset(qr, 0, sizeof(QrCode));
+    qr->version = version;
+    qr->size = 17 + 4 * version;
+    qr->ecc = ecc;
+    size_t data_count = qr_code_data_codewords[ecc][version - 1];
+    size_t capacity = data_count * 8;
+
+    QrCodeBits bits = {.data = qr->codewords, .bit = 0};
+    if(alphanumeric) {
+        qr_code_put_bits(&bits, QR_CODE_MODE_ALNUM, 4);
+        qr_code_put_bits(&bits, length, 9);
+        for(size_t i = 0; i + 1 < length; i += 2) {
+            qr_code_put_bits(
+                &bits,
+                qr_code_alphanumeric_index(text[i]) * 45 +
+                    qr_code_alphanumeric_index(text[i + 1]),
+                11);
+        }
+        if(length % 2) {
+            qr_code_put_bits(&bits, qr_code_alphanumeric_index(text[length - 1]), 6);
+        }
+    } else {
+        qr_code_put_bits(&bits, QR_CODE_MODE_BYTE, 4);
+        qr_code_put_bits(&bits, length, 8);
+        for(size_t i = 0; i < length; i++) {
+            qr_code_put_bits(&bits, (uint8_t)text[i], 8);
+        }
+    }
+
+    // Terminator, then zeros up to a byte boundary (the buffer is already zero).
+    bits.bit += (capacity - bits.bit < 4) ? capacity - bits.bit : 4;
+    bits.bit = (bits.bit + 7) & ~(size_t)7;
+    for(uint8_t pad = 0xEC; bits.bit < capacity; pad ^= 0xEC ^ 0x11) {
+        qr_code_put_bits(&bits, pad, 8);
+    }
+
+    uint8_t ecc_count = qr_code_ecc_codewords[ecc][version - 1];
+    qr_code_reed_solomon(qr->codewords, data_count, qr->codewords + data_count, ecc_count);
+
+    qr_code_draw_function_patterns(qr);
+    qr_code_draw_codewords(qr, data_count + ecc_count);
+
+    qr->mask = qr_code_choose_mask(qr);
+    for(int y = 0; y < qr->size; y++) {
+        for(int x = 0; x < qr->size; x++) {
+            qr->modules[y][x] = (qr->modules[y][x] >> qr->mask) & 1;
+        }
+    }
+    return true;
+}
+
+bool qr_code_get_module(const QrCode* qr, uint8_t x, uint8_t y) {
+    return x < qr->size && y < qr->size && qr->modules[y][x];
+}
+
+size_t qr_code_render(const QrCode* qr, uint8_t scale, uint8_t* bitmap, size_t bitmap_size) {
+    size_t width = (size_t)qr->size * scale;
+    size_t stride = (width + 7) / 8;
+    if(!scale || stride * width > bitmap_size) {
+        return 0;
+    }
+
+    memset(bitmap, 0, stride * width);
+    for(size_t y = 0; y < qr->size; y++) {
+        uint8_t* line = bitmap + y * scale * stride;
+        for(size_t x = 0; x < width; x++) {
+            if(qr->modules[y][x / scale]) {
+                line[x >> 3] |= 1 << (x & 7);
+            }
+        }
+        // The other scale - 1 pixel rows of this module row are the same.
+        for(uint8_t i = 1; i < scale; i++) {
+            memcpy(line + i * stride, line, stride);
+        }
+    }
+    return width;
+}
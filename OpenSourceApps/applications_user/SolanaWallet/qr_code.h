@@ -0,0 +1,54 @@
+#ifndef QR_CODE_H
+#define QR_CODE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Small QR code encoder for addresses and payment links.  Versions 1 to 3 only, which all use a
+ * single error correction block, so everything fits in the fixed buffers below.
+ */
+#define QR_CODE_VERSION_MAX   3
+#define QR_CODE_SIZE_MAX      (17 + 4 * QR_CODE_VERSION_MAX) // 29 modules per side
+#define QR_CODE_CODEWORDS_MAX 70 // Data plus error correction codewords of version 3
+
+// Bytes for a bitmap from qr_code_render() at the given scale.
+#define QR_CODE_BITMAP_SIZE(scale) \
+    (((QR_CODE_SIZE_MAX * (scale) + 7) / 8) * QR_CODE_SIZE_MAX * (scale))
+
+typedef enum {
+    QrCodeEccLow, // Recovers ~7% damage
+    QrCodeEccMedium, // Recovers ~15% damage
+} QrCodeEcc;
+
+typedef struct {
+    uint8_t version;
+    uint8_t size; // Modules per side
+    uint8_t mask; // Mask pattern 0-7 picked by the penalty rules
+    QrCodeEcc ecc;
+    // While encoding bit m holds the module under mask m, afterwards just 0 (light) or 1 (dark).
+    uint8_t modules[QR_CODE_SIZE_MAX][QR_CODE_SIZE_MAX];
+    uint8_t function[QR_CODE_SIZE_MAX][(QR_CODE_SIZE_MAX + 7) / 8]; // Finder, timing, format...
+    uint8_t codewords[QR_CODE_CODEWORDS_MAX];
+} QrCode;
+
+/**
+ * @brief      Encode text in the smallest version that fits.
+ * @details    Alphanumeric mode is used when the text only has upper case letters, digits and
+ *            " $%*+-./:", byte mode otherwise.  If the text does not fit at ecc it is tried again
+ *            with QrCodeEccLow.
+ * @return     false if the text is too long for version 3.
+*/
+bool qr_code_encode(QrCode* qr, const char* text, QrCodeEcc ecc);
+
+bool qr_code_get_module(const QrCode* qr, uint8_t x, uint8_t y);
+
+/**
+ * @brief      Draw the code as an XBM bitmap (rows padded to whole bytes, LSB first) with every
+ *            module scale pixels wide, ready for canvas_draw_xbm().  No quiet zone is added.
+ * @return     width and height of the bitmap in pixels, or 0 if bitmap_size is too small.
+*/
+size_t qr_code_render(const QrCode* qr, uint8_t scale, uint8_t* bitmap, size_t bitmap_size);
+
+#endif // QR_CODE_H
@@ -0,0 +1,213 @@
+#include "sha256.h"
+#include <string.h>
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t sha256_rotr(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t sha256_load32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void sha256_store32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+/**
+ * @brief      Run rounds first..last - 1 on the working variables a..h.
+ * @param      w     The block's words, expanded in place as a 16 word rolling schedule.
+*/
+static void sha256_rounds(uint32_t work[8], uint32_t w[16], int first, int last) {
+    uint32_t a = work[0], b = work[1], c = work[2], d = work[3];
+    uint32_t e = work[4], f = work[5], g = work[6], h = work[7];
+
+    for(int i = first; i < last; i++) {
+        if(i >= 16) {
+            uint32_t w15 = w[(i - 15) & 15];
+            uint32_t w2 = w[(i - 2) & 15];
+            uint32_t s0 = sha256_rotr(w15, 7) ^ sha256_rotr(w15, 18) ^ (w15 >> 3);
+            uint32_t s1 = sha256_rotr(w2, 17) ^ sha256_rotr(w2, 19) ^ (w2 >> 10);
+            w[i & 15] += s0 + w[(i - 7) & 15] + s1;
+        }
+
+        uint32_t s1 = sha256_rotr(e, 6) ^ sha256_rotr(e, 11) ^ sha256_rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i & 15];
+        uint32_t s0 = sha256_rotr(a, 2) ^ sha256_rotr(a, 13) ^ sha256_rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    work[0] = a;
+    work[1] = b;
+    work[2] = c;
+    work[3] = d;
+    work[4] = e;
+    work[5] = f;
+    work[6] = g;
+    work[7] = h;
+}
+
+/**
+ * @brief      Compress block into state, starting from round first with the working variables
+ *            in start (state itself when first is 0).
+*/
+static void sha256_compress_from(
+    uint32_t state[8],
+    const uint32_t start[8],
+    int first,
+    const uint8_t block[SHA256_BLOCK_SIZE]) {
+    uint32_t w[16];
+    uint32_t work[8];
+    for(int i = 0; i < 16; i++) {
+        w[i] = sha256_load32(block + i * 4);
+    }
+    memcpy(work, start, sizeof(work));
+    sha256_rounds(work, w, first, 64);
+    for(int i = 0; i < 8; i++) {
+        state[i] += work[i];
+    }
+}
+
+static void sha256_compress(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE]) {
+    sha256_compress_from(state, state, 0, block);
+}
+
+void sha256_init(Sha256Context* ctx) {
+    ctx->state[0] = 0x6a09e667;
+    ctx->state[1] = 0xbb67ae85;
+    ctx->state[2] = 0x3c6ef372;
+    ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f;
+    ctx->state[5] = 0x9b05688c;
+    ctx->state[6] = 0x1f83d9ab;
+    ctx->state[7] = 0x5be0cd19;
+    ctx->length = 0;
+}
+
+void sha256_update(Sha256Context* ctx, const uint8_t* data, size_t size) {
+    size_t used = ctx->length % SHA256_BLOCK_SIZE;
+    ctx->length += size;
+
+    if(used) {
+        size_t fill = SHA256_BLOCK_SIZE - used;
+        if(size < fill) {
+            memcpy(ctx->buffer + used, data, size);
+            return;
+        }
+        memcpy(ctx->buffer + used, data, fill);
+        sha256_compress(ctx->state, ctx->buffer);
+        data += fill;
+        size -= fill;
+    }
+
+    // Whole blocks are hashed straight from the caller's buffer.
+    while(size >= SHA256_BLOCK_SIZE) {
+        sha256_compress(ctx->state, data);
+        data += SHA256_BLOCK_SIZE;
+        size -= SHA256_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer, data, size);
+}
+
+/**
+ * @brief      Pad and write the digest.  The first block compressed starts from start at round
+ *            first, see sha256_midstate_final().
+*/
+static void sha256_finish(
+    Sha256Context* ctx,
+    const uint32_t start[8],
+    int first,
+    uint8_t digest[SHA256_DIGEST_SIZE]) {
+    size_t used = ctx->length % SHA256_BLOCK_SIZE;
+    uint64_t bits = ctx->length << 3;
+
+    ctx->buffer[used++] = 0x80;
+    if(used > SHA256_BLOCK_SIZE - 8) {
+        memset(ctx->buffer + used, 0, SHA256_BLOCK_SIZE - used);
+        sha256_compress_from(ctx->state, start, first, ctx->buffer);
+        start = ctx->state;
+        first = 0;
+        used = 0;
+    }
+    memset(ctx->buffer + used, 0, SHA256_BLOCK_SIZE - 8 - used);
+    sha256_store32(ctx->buffer + SHA256_BLOCK_SIZE - 8, bits >> 32);
+    sha256_store32(ctx->buffer + SHA256_BLOCK_SIZE - 4, bits);
+    sha256_compress_from(ctx->state, start, first, ctx->buffer);
+
+    for(int i = 0; i < 8; i++) {
+        sha256_store32(digest + i * 4, ctx->state[i]);
+    }
+    memset(ctx, 0, sizeof(Sha256Context));
+}
+
+void sha256_final(Sha256Context* ctx, uint8_t digest[SHA256_DIGEST_SIZE]) {
+    sha256_finish(ctx, ctx->state, 0, digest);
+}
+
+void sha256(const uint8_t* data, size_t size, uint8_t digest[SHA256_DIGEST_SIZE]) {
+    Sha256Context ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, size);
+    sha256_final(&ctx, digest);
+}
+
+void sha256_midstate_init(Sha256Midstate* mid, const Sha256Context* ctx) {
+    uint32_t w[16];
+    mid->ctx = *ctx;
+
+    // Round i only reads word i of the block, so the rounds over whole prefix words are the same
+    // for every suffix.
+    mid->rounds = (mid->ctx.length % SHA256_BLOCK_SIZE) / 4;
+    for(int i = 0; i < mid->rounds; i++) {
+        w[i] = sha256_load32(mid->ctx.buffer + i * 4);
+    }
+    memcpy(mid->work, mid->ctx.state, sizeof(mid->work));
+    sha256_rounds(mid->work, w, 0, mid->rounds);
+}
+
+void sha256_midstate_final(
+    const Sha256Midstate* mid,
+    const uint8_t* suffix,
+    size_t size,
+    uint8_t digest[SHA256_DIGEST_SIZE]) {
+    Sha256Context ctx = mid->ctx;
+    size_t used = ctx.length % SHA256_BLOCK_SIZE;
+    size_t fill = SHA256_BLOCK_SIZE - used;
+
+    if(size < fill) {
+        memcpy(ctx.buffer + used, suffix, size);
+        ctx.length += size;
+        sha256_finish(&ctx, mid->work, mid->rounds, digest);
+        return;
+    }
+    memcpy(ctx.buffer + used, suffix, fill);
+    sha256_compress_from(ctx.state, mid->work, mid->rounds, ctx.buffer);
+    ctx.length += fill;
+    sha256_update(&ctx, suffix + fill, size - fill);
+    sha256_final(&ctx, digest);
+}
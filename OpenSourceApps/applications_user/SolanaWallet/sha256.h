@@ -0,0 +1,52 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_BLOCK_SIZE  64
+#define SHA256_DIGEST_SIZE 32
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length; // Bytes hashed so far
+    uint8_t buffer[SHA256_BLOCK_SIZE];
+} Sha256Context;
+
+void sha256_init(Sha256Context* ctx);
+
+void sha256_update(Sha256Context* ctx, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Write the digest and wipe the context.
+*/
+void sha256_final(Sha256Context* ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+void sha256(const uint8_t* data, size_t size, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+/**
+ * State after a fixed prefix, for hashing many messages that only differ after it.  Besides the
+ * whole blocks of the prefix, the rounds of the next block that only read prefix words are run
+ * ahead too, so after a 96 byte prefix each message costs 72 fewer rounds.
+ */
+typedef struct {
+    Sha256Context ctx;
+    uint32_t work[8]; // a..h after the first rounds of the partial block
+    uint8_t rounds;
+} Sha256Midstate;
+
+/**
+ * @brief      Take the midstate of ctx, which has hashed the prefix.
+*/
+void sha256_midstate_init(Sha256Midstate* mid, const Sha256Context* ctx);
+
+/**
+ * @brief      Digest of the prefix followed by suffix.  mid is left as it was, to use again.
+*/
+void sha256_midstate_final(
+    const Sha256Midstate* mid,
+    const uint8_t* suffix,
+    size_t size,
+    uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#endif // SHA256_H
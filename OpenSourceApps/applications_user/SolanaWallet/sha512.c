@@ -0,0 +1,232 @@
+#include "sha512.h"
+#include <string.h>
+
+static const uint64_t sha512_k[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static inline uint64_t sha512_rotr(uint64_t x, unsigned n) {
+    return (x >> n) | (x << (64 - n));
+}
+
+static inline uint64_t sha512_load64(const uint8_t* p) {
+    uint64_t v = 0;
+    for(int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void sha512_store64(uint8_t* p, uint64_t v) {
+    for(int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static void sha512_compress(uint64_t state[8], const uint8_t block[SHA512_BLOCK_SIZE]) {
+    // A 16 word rolling schedule keeps the stack small on the device.
+    uint64_t w[16];
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for(int i = 0; i < 80; i++) {
+        uint64_t wi;
+        if(i < 16) {
+            wi = w[i] = sha512_load64(block + i * 8);
+        } else {
+            uint64_t w15 = w[(i - 15) & 15];
+            uint64_t w2 = w[(i - 2) & 15];
+            uint64_t s0 = sha512_rotr(w15, 1) ^ sha512_rotr(w15, 8) ^ (w15 >> 7);
+            uint64_t s1 = sha512_rotr(w2, 19) ^ sha512_rotr(w2, 61) ^ (w2 >> 6);
+            wi = w[i & 15] += s0 + w[(i - 7) & 15] + s1;
+        }
+
+        uint64_t s1 = sha512_rotr(e, 14) ^ sha512_rotr(e, 18) ^ sha512_rotr(e, 41);
+        uint64_t ch = (e & f) ^ (~e & g);
+        uint64_t t1 = h + s1 + ch + sha512_k[i] + wi;
+        uint64_t s0 = sha512_rotr(a, 28) ^ sha512_rotr(a, 34) ^ sha512_rotr(a, 39);
+        uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint64_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void sha512_init(Sha512Context* ctx) {
+    ctx->state[0] = 0x6a09e667f3bcc908ULL;
+    ctx->state[1] = 0xbb67ae8584caa73bULL;
+    ctx->state[2] = 0x3c6ef372fe94f82bULL;
+    ctx->state[3] = 0xa54ff53a5f1d36f1ULL;
+    ctx->state[4] = 0x510e527fade682d1ULL;
+    ctx->state[5] = 0x9b05688c2b3e6c1fULL;
+    ctx->state[6] = 0x1f83d9abfb41bd6bULL;
+    ctx->state[7] = 0x5be0cd19137e2179ULL;
+    ctx->length = 0;
+}
+
+void sha512_update(Sha512Context* ctx, const uint8_t* data, size_t size) {
+    size_t used = ctx->length % SHA512_BLOCK_SIZE;
+    ctx->length += size;
+
+    if(used) {
+        size_t fill = SHA512_BLOCK_SIZE - used;
+        if(size < fill) {
+            memcpy(ctx->buffer + used, data, size);
+            return;
+        }
+        memcpy(ctx->buffer + used, data, fill);
+        sha512_compress(ctx->state, ctx->buffer);
+        data += fill;
+        size -= fill;
+    }
+
+    // Whole blocks are hashed straight from the caller's buffer.
+    while(size >= SHA512_BLOCK_SIZE) {
+        sha512_compress(ctx->state, data);
+        data += SHA512_BLOCK_SIZE;
+        size -= SHA512_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer, data, size);
+}
+
+void sha512_final(Sha512Context* ctx, uint8_t digest[SHA512_DIGEST_SIZE]) {
+    size_t used = ctx->length % SHA512_BLOCK_SIZE;
+    uint64_t bits = ctx->length << 3;
+
+    ctx->buffer[used++] = 0x80;
+    if(used > SHA512_BLOCK_SIZE - 16) {
+        memset(ctx->buffer + used, 0, SHA512_BLOCK_SIZE - used);
+        sha512_compress(ctx->state, ctx->buffer);
+        used = 0;
+    }
+    memset(ctx->buffer + used, 0, SHA512_BLOCK_SIZE - 8 - used);
+    sha512_store64(ctx->buffer + SHA512_BLOCK_SIZE - 8, bits);
+    sha512_compress(ctx->state, ctx->buffer);
+
+    for(int i = 0; i < 8; i++) {
+        sha512_store64(digest + i * 8, ctx->state[i]);
+    }
+    memset(ctx, 0, sizeof(Sha512Context));
+}
+
+void sha512(const uint8_t* data, size_t size, uint8_t digest[SHA512_DIGEST_SIZE]) {
+    Sha512Context ctx;
+    sha512_init(&ctx);
+    sha512_update(&ctx, data, size);
+    sha512_final(&ctx, digest);
+}
+
+void hmac_sha512_init(HmacSha512Context* ctx, const uint8_t* key, size_t key_size) {
+    uint8_t pad[SHA512_BLOCK_SIZE] = {0};
+    if(key_size > SHA512_BLOCK_SIZE) {
+        sha512(key, key_size, pad);
+    } else if(key_size) {
+        memcpy(pad, key, key_size);
+    }
+
+    for(size_t i = 0; i < SHA512_BLOCK_SIZE; i++) {
+        pad[i] ^= 0x36;
+    }
+    sha512_init(&ctx->inner);
+    sha512_update(&ctx->inner, pad, SHA512_BLOCK_SIZE);
+
+    for(size_t i = 0; i < SHA512_BLOCK_SIZE; i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+    sha512_init(&ctx->outer);
+    sha512_update(&ctx->outer, pad, SHA512_BLOCK_SIZE);
+
+    memset(pad, 0, sizeof(pad));
+}
+
+void hmac_sha512_update(HmacSha512Context* ctx, const uint8_t* data, size_t size) {
+    sha512_update(&ctx->inner, data, size);
+}
+
+void hmac_sha512_final(HmacSha512Context* ctx, uint8_t mac[SHA512_DIGEST_SIZE]) {
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    sha512_final(&ctx->inner, digest);
+    sha512_update(&ctx->outer, digest, SHA512_DIGEST_SIZE);
+    sha512_final(&ctx->outer, mac);
+    memset(digest, 0, sizeof(digest));
+}
+
+void pbkdf2_hmac_sha512(
+    const uint8_t* password,
+    size_t password_size,
+    const uint8_t* salt,
+    size_t salt_size,
+    uint32_t iterations,
+    uint8_t* output,
+    size_t output_size) {
+    HmacSha512Context keyed;
+    HmacSha512Context ctx;
+    uint8_t u[SHA512_DIGEST_SIZE];
+    uint8_t t[SHA512_DIGEST_SIZE];
+
+    hmac_sha512_init(&keyed, password, password_size);
+
+    for(uint32_t block = 1; output_size > 0; block++) {
+        uint8_t counter[4] = {block >> 24, block >> 16, block >> 8, block};
+        ctx = keyed;
+        hmac_sha512_update(&ctx, salt, salt_size);
+        hmac_sha512_update(&ctx, counter, sizeof(counter));
+        hmac_sha512_final(&ctx, u);
+        memcpy(t, u, SHA512_DIGEST_SIZE);
+
+        for(uint32_t i = 1; i < iterations; i++) {
+            ctx = keyed;
+            hmac_sha512_update(&ctx, u, SHA512_DIGEST_SIZE);
+            hmac_sha512_final(&ctx, u);
+            for(size_t j = 0; j < SHA512_DIGEST_SIZE; j++) {
+                t[j] ^= u[j];
+            }
+        }
+
+        size_t size = output_size < SHA512_DIGEST_SIZE ? output_size : SHA512_DIGEST_SIZE;
+        memcpy(output, t, size);
+        output += size;
+        output_size -= size;
+    }
+
+    memset(&keyed, 0, sizeof(keyed));
+    memset(u, 0, sizeof(u));
+    memset(t, 0, sizeof(t));
+}
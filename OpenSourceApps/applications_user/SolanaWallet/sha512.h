@@ -0,0 +1,55 @@
+#ifndef SHA512_H
+#define SHA512_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA512_BLOCK_SIZE  128
+#define SHA512_DIGEST_SIZE 64
+
+typedef struct {
+    uint64_t state[8];
+    uint64_t length; // Bytes hashed so far
+    uint8_t buffer[SHA512_BLOCK_SIZE];
+} Sha512Context;
+
+void sha512_init(Sha512Context* ctx);
+
+void sha512_update(Sha512Context* ctx, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Write the digest and wipe the context.
+*/
+void sha512_final(Sha512Context* ctx, uint8_t digest[SHA512_DIGEST_SIZE]);
+
+void sha512(const uint8_t* data, size_t size, uint8_t digest[SHA512_DIGEST_SIZE]);
+
+typedef struct {
+    Sha512Context inner;
+    Sha512Context outer;
+} HmacSha512Context;
+
+void hmac_sha512_init(HmacSha512Context* ctx, const uint8_t* key, size_t key_size);
+
+void hmac_sha512_update(HmacSha512Context* ctx, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Write the MAC and wipe the context.
+*/
+void hmac_sha512_final(HmacSha512Context* ctx, uint8_t mac[SHA512_DIGEST_SIZE]);
+
+/**
+ * @brief      PBKDF2 with HMAC-SHA512 (RFC 8018).
+ * @details    The keyed inner and outer states are computed once, so each iteration costs two
+ *            SHA-512 compressions.
+*/
+void pbkdf2_hmac_sha512(
+    const uint8_t* password,
+    size_t password_size,
+    const uint8_t* salt,
+    size_t salt_size,
+    uint32_t iterations,
+    uint8_t* output,
+    size_t output_size);
+
+#endif // SHA512_H
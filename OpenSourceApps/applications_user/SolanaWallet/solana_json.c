@@ -0,0 +1,502 @@
+#include "solana_json.h"
+#include <string.h>
+
+typedef enum {
+    SolanaJsonStateValue, // Before a value
+    SolanaJsonStateValueOrEnd, // Right after '['
+    SolanaJsonStateKey, // After ',' in an object
+    SolanaJsonStateKeyOrEnd, // Right after '{'
+    SolanaJsonStateColon,
+    SolanaJsonStateAfterValue, // Expecting ',' or the end of the container
+    SolanaJsonStateString,
+    SolanaJsonStateEscape,
+    SolanaJsonStateUnicode,
+    SolanaJsonStateLiteral, // Number, true, false or null
+    SolanaJsonStateDone,
+    SolanaJsonStateError,
+} SolanaJsonState;
+
+static bool solana_json_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool solana_json_is_literal(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' ||
+           c == '.' || c == 'E';
+}
+
+static SolanaJsonStatus solana_json_fail(SolanaJson* json, SolanaJsonError error) {
+    json->state = SolanaJsonStateError;
+    json->error = error;
+    return SolanaJsonStatusError;
+}
+
+/**
+ * @brief      Find segment number n of a selector.
+ * @return     false if the selector has fewer segments.
+*/
+static bool solana_json_segment(const char* path, size_t n, const char** segment, size_t* length) {
+    if(!*path) {
+        return false;
+    }
+    for(; n > 0; n--) {
+        path = strchr(path, '.');
+        if(!path) {
+            return false;
+        }
+        path++;
+    }
+    const char* end = strchr(path, '.');
+    *segment = path;
+    *length = end ? (size_t)(end - path) : strlen(path);
+    return true;
+}
+
+static bool solana_json_index_matches(const char* segment, size_t length, uint16_t index) {
+    if(length == 1 && segment[0] == '*') {
+        return true;
+    }
+    uint32_t value = 0;
+    for(size_t i = 0; i < length; i++) {
+        if(segment[i] < '0' || segment[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (segment[i] - '0');
+        if(value > UINT16_MAX) {
+            return false;
+        }
+    }
+    return length > 0 && value == index;
+}
+
+static void solana_json_emit(
+    SolanaJson* json,
+    uint8_t selected,
+    SolanaJsonEventType type,
+    bool partial,
+    const char* value,
+    size_t length) {
+    SolanaJsonEvent event = {
+        .type = type,
+        .partial = partial,
+        .index = json->index,
+        .value = value,
+        .length = length,
+    };
+    for(uint8_t i = 0; selected; i++, selected >>= 1) {
+        if(selected & 1) {
+            event.selector = i;
+            json->callback(&event, json->context);
+        }
+    }
+}
+
+/**
+ * @brief      Work out which selectors a value that is about to start matches, from the key
+ *            or array index that leads to it.
+ * @return     selectors that may match inside it if it turns out to be a container.
+*/
+static uint8_t solana_json_begin_value(SolanaJson* json) {
+    uint8_t candidates;
+    json->index = 0;
+
+    if(json->depth == 0) {
+        candidates = (1u << json->selector_count) - 1;
+    } else {
+        SolanaJsonLevel* parent = &json->levels[json->depth - 1];
+        candidates = 0;
+        if(!parent->object) {
+            json->index = parent->index;
+        }
+        for(uint8_t i = 0; i < json->selector_count; i++) {
+            const char* segment;
+            size_t length;
+            if(!(parent->mask & (1u << i)) ||
+               !solana_json_segment(json->selectors[i], json->depth - 1, &segment, &length)) {
+                continue;
+            }
+            bool match = parent->object ?
+                             json->key_length == length && length <= SOLANA_JSON_KEY_SIZE &&
+                                 memcmp(json->key, segment, length) == 0 :
+                             solana_json_index_matches(segment, length, parent->index);
+            if(match) {
+                candidates |= 1u << i;
+            }
+        }
+    }
+
+    json->selected = 0;
+    uint8_t deeper = 0;
+    for(uint8_t i = 0; i < json->selector_count; i++) {
+        if(!(candidates & (1u << i))) {
+            continue;
+        }
+        if(json->segment_count[i] == json->depth) {
+            json->selected |= 1u << i;
+        } else {
+            deeper |= 1u << i;
+        }
+    }
+    return deeper;
+}
+
+static void solana_json_end_value(SolanaJson* json) {
+    if(json->depth == 0) {
+        json->state = SolanaJsonStateDone;
+        return;
+    }
+    SolanaJsonLevel* parent = &json->levels[json->depth - 1];
+    if(!parent->object) {
+        parent->index++;
+    }
+    json->state = SolanaJsonStateAfterValue;
+}
+
+static void solana_json_flush_string(SolanaJson* json, bool partial) {
+    solana_json_emit(
+        json, json->selected, SolanaJsonEventString, partial, json->token, json->token_length);
+    json->token_length = 0;
+}
+
+/**
+ * @brief      Append one decoded byte to the key or the selected string being read.
+*/
+static void solana_json_put(SolanaJson* json, char c) {
+    if(json->in_key) {
+        if(json->key_length < SOLANA_JSON_KEY_SIZE) {
+            json->key[json->key_length++] = c;
+        } else {
+            json->key_length = SOLANA_JSON_KEY_SIZE + 1;
+        }
+    } else if(json->selected) {
+        if(json->token_length == SOLANA_JSON_TOKEN_SIZE) {
+            solana_json_flush_string(json, true);
+        }
+        json->token[json->token_length++] = c;
+    }
+}
+
+static void solana_json_put_code_point(SolanaJson* json, uint32_t code) {
+    if(code < 0x80) {
+        solana_json_put(json, code);
+    } else if(code < 0x800) {
+        solana_json_put(json, 0xC0 | (code >> 6));
+        solana_json_put(json, 0x80 | (code & 0x3F));
+    } else if(code < 0x10000) {
+        solana_json_put(json, 0xE0 | (code >> 12));
+        solana_json_put(json, 0x80 | ((code >> 6) & 0x3F));
+        solana_json_put(json, 0x80 | (code & 0x3F));
+    } else {
+        solana_json_put(json, 0xF0 | (code >> 18));
+        solana_json_put(json, 0x80 | ((code >> 12) & 0x3F));
+        solana_json_put(json, 0x80 | ((code >> 6) & 0x3F));
+        solana_json_put(json, 0x80 | (code & 0x3F));
+    }
+}
+
+/**
+ * @brief      Handle the 4 hex digits of a \u escape, pairing up UTF-16 surrogates.
+*/
+static void solana_json_put_unicode(SolanaJson* json) {
+    uint16_t unit = json->unicode;
+    if(json->high_surrogate) {
+        uint16_t high = json->high_surrogate;
+        json->high_surrogate = 0;
+        if(unit >= 0xDC00 && unit <= 0xDFFF) {
+            solana_json_put_code_point(
+                json, 0x10000 + (((uint32_t)high - 0xD800) << 10) + (unit - 0xDC00));
+            return;
+        }
+        solana_json_put_code_point(json, 0xFFFD);
+    }
+    if(unit >= 0xD800 && unit <= 0xDBFF) {
+        json->high_surrogate = unit;
+    } else if(unit >= 0xDC00 && unit <= 0xDFFF) {
+        solana_json_put_code_point(json, 0xFFFD);
+    } else {
+        solana_json_put_code_point(json, unit);
+    }
+}
+
+/**
+ * @brief      Replace a high surrogate that was not followed by a low one.
+*/
+static void solana_json_drop_surrogate(SolanaJson* json) {
+    if(json->high_surrogate) {
+        json->high_surrogate = 0;
+        solana_json_put_code_point(json, 0xFFFD);
+    }
+}
+
+static void solana_json_end_string(SolanaJson* json) {
+    solana_json_drop_surrogate(json);
+    if(json->in_key) {
+        json->in_key = false;
+        json->state = SolanaJsonStateColon;
+        return;
+    }
+    if(json->selected) {
+        solana_json_flush_string(json, false);
+    }
+    solana_json_end_value(json);
+}
+
+static bool solana_json_end_literal(SolanaJson* json) {
+    const char* token = json->token;
+    size_t length = json->token_length;
+    SolanaJsonEventType type;
+
+    if((length == 4 && memcmp(token, "true", 4) == 0) ||
+       (length == 5 && memcmp(token, "false", 5) == 0)) {
+        type = SolanaJsonEventBool;
+    } else if(length == 4 && memcmp(token, "null", 4) == 0) {
+        type = SolanaJsonEventNull;
+    } else if(token[0] == '-' || (token[0] >= '0' && token[0] <= '9')) {
+        type = SolanaJsonEventNumber;
+    } else {
+        return false;
+    }
+
+    solana_json_emit(json, json->selected, type, false, token, length);
+    json->token_length = 0;
+    solana_json_end_value(json);
+    return true;
+}
+
+static bool solana_json_open(SolanaJson* json, bool object, uint8_t deeper) {
+    if(json->depth == SOLANA_JSON_MAX_DEPTH) {
+        return false;
+    }
+    solana_json_emit(
+        json,
+        json->selected,
+        object ? SolanaJsonEventObjectStart : SolanaJsonEventArrayStart,
+        false,
+        NULL,
+        0);
+
+    SolanaJsonLevel* level = &json->levels[json->depth++];
+    level->object = object;
+    level->index = 0;
+    level->mask = deeper;
+    level->selected = json->selected;
+    json->state = object ? SolanaJsonStateKeyOrEnd : SolanaJsonStateValueOrEnd;
+    return true;
+}
+
+static bool solana_json_close(SolanaJson* json, char c) {
+    SolanaJsonLevel* level = &json->levels[json->depth - 1];
+    if(level->object != (c == '}')) {
+        return false;
+    }
+    json->depth--;
+
+    // Restore the index the container itself had in its parent for the end event.
+    json->index = 0;
+    if(json->depth > 0 && !json->levels[json->depth - 1].object) {
+        json->index = json->levels[json->depth - 1].index;
+    }
+    solana_json_emit(
+        json,
+        level->selected,
+        level->object ? SolanaJsonEventObjectEnd : SolanaJsonEventArrayEnd,
+        false,
+        NULL,
+        0);
+    solana_json_end_value(json);
+    return true;
+}
+
+void solana_json_init(
+    SolanaJson* json,
+    const char* const* selectors,
+    size_t selector_count,
+    SolanaJsonCallback callback,
+    void* context) {
+    memset(json, 0, sizeof(SolanaJson));
+    json->selectors = selectors;
+    json->selector_count = selector_count < SOLANA_JSON_MAX_SELECTORS ? selector_count :
+                                                                        SOLANA_JSON_MAX_SELECTORS;
+    json->callback = callback;
+    json->context = context;
+
+    for(uint8_t i = 0; i < json->selector_count; i++) {
+        const char* path = selectors[i];
+        uint8_t count = *path ? 1 : 0;
+        for(; *path; path++) {
+            count += *path == '.';
+        }
+        json->segment_count[i] = count;
+    }
+    solana_json_reset(json);
+}
+
+void solana_json_reset(SolanaJson* json) {
+    json->state = SolanaJsonStateValue;
+    json->error = SolanaJsonErrorNone;
+    json->depth = 0;
+    json->selected = 0;
+    json->in_key = false;
+    json->high_surrogate = 0;
+    json->key_length = 0;
+    json->token_length = 0;
+}
+
+SolanaJsonStatus solana_json_feed(SolanaJson* json, const char* data, size_t size) {
+    size_t i = 0;
+    while(i < size) {
+        char c = data[i];
+
+        switch(json->state) {
+        case SolanaJsonStateString:
+            if(c == '"') {
+                solana_json_end_string(json);
+            } else if(c == '\\') {
+                json->state = SolanaJsonStateEscape;
+            } else if((uint8_t)c < 0x20) {
+                return solana_json_fail(json, SolanaJsonErrorSyntax);
+            } else {
+                solana_json_drop_surrogate(json);
+                solana_json_put(json, c);
+            }
+            break;
+
+        case SolanaJsonStateEscape: {
+            const char* escapes = "\"\"\\\\//b\bf\fn\nr\rt\t";
+            const char* found = c ? strchr(escapes, c) : NULL;
+            json->state = SolanaJsonStateString;
+            if(c == 'u') {
+                json->state = SolanaJsonStateUnicode;
+                json->unicode = 0;
+                json->unicode_digits = 0;
+            } else if(found && (found - escapes) % 2 == 0) {
+                solana_json_drop_surrogate(json);
+                solana_json_put(json, found[1]);
+            } else {
+                return solana_json_fail(json, SolanaJsonErrorSyntax);
+            }
+            break;
+        }
+
+        case SolanaJsonStateUnicode: {
+            uint8_t digit;
+            if(c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                digit = (c | 0x20) - 'a' + 10;
+            } else {
+                return solana_json_fail(json, SolanaJsonErrorSyntax);
+            }
+            json->unicode = (json->unicode << 4) | digit;
+            if(++json->unicode_digits == 4) {
+                solana_json_put_unicode(json);
+                json->state = SolanaJsonStateString;
+            }
+            break;
+        }
+
+        case SolanaJsonStateLiteral:
+            if(solana_json_is_literal(c)) {
+                if(json->token_length == SOLANA_JSON_TOKEN_SIZE) {
+                    return solana_json_fail(json, SolanaJsonErrorTooLong);
+                }
+                json->token[json->token_length++] = c;
+                break;
+            }
+            if(!solana_json_end_literal(json)) {
+                return solana_json_fail(json, SolanaJsonErrorSyntax);
+            }
+            // The terminating character belongs to the next state.
+            continue;
+
+        default:
+            if(solana_json_is_space(c)) {
+                break;
+            }
+
+            switch(json->state) {
+            case SolanaJsonStateKeyOrEnd:
+            case SolanaJsonStateKey:
+                if(c == '}' && json->state == SolanaJsonStateKeyOrEnd) {
+                    solana_json_close(json, c);
+                } else if(c == '"') {
+                    json->in_key = true;
+                    json->key_length = 0;
+                    json->state = SolanaJsonStateString;
+                } else {
+                    return solana_json_fail(json, SolanaJsonErrorSyntax);
+                }
+                break;
+
+            case SolanaJsonStateColon:
+                if(c != ':') {
+                    return solana_json_fail(json, SolanaJsonErrorSyntax);
+                }
+                json->state = SolanaJsonStateValue;
+                break;
+
+            case SolanaJsonStateValueOrEnd:
+                if(c == ']') {
+                    solana_json_close(json, c);
+                    break;
+                }
+                // fall through
+            case SolanaJsonStateValue: {
+                uint8_t deeper = solana_json_begin_value(json);
+                if(c == '{' || c == '[') {
+                    if(!solana_json_open(json, c == '{', deeper)) {
+                        return solana_json_fail(json, SolanaJsonErrorDepth);
+                    }
+                } else if(c == '"') {
+                    json->token_length = 0;
+                    json->state = SolanaJsonStateString;
+                } else if(solana_json_is_literal(c)) {
+                    json->token[0] = c;
+                    json->token_length = 1;
+                    json->state = SolanaJsonStateLiteral;
+                } else {
+                    return solana_json_fail(json, SolanaJsonErrorSyntax);
+                }
+                break;
+            }
+
+            case SolanaJsonStateAfterValue:
+                if(c == ',') {
+                    json->state = json->levels[json->depth - 1].object ? SolanaJsonStateKey :
+                                                                          SolanaJsonStateValue;
+                } else if((c != '}' && c != ']') || !solana_json_close(json, c)) {
+                    return solana_json_fail(json, SolanaJsonErrorSyntax);
+                }
+                break;
+
+            case SolanaJsonStateDone:
+                return solana_json_fail(json, SolanaJsonErrorTrailingData);
+
+            default:
+                return SolanaJsonStatusError;
+            }
+            break;
+        }
+        i++;
+    }
+
+    return json->state == SolanaJsonStateDone ? SolanaJsonStatusDone : SolanaJsonStatusMore;
+}
+
+SolanaJsonStatus solana_json_finish(SolanaJson* json) {
+    if(json->state == SolanaJsonStateLiteral && json->depth == 0 &&
+       !solana_json_end_literal(json)) {
+        return solana_json_fail(json, SolanaJsonErrorSyntax);
+    }
+    if(json->state == SolanaJsonStateError) {
+        return SolanaJsonStatusError;
+    }
+    if(json->state != SolanaJsonStateDone) {
+        return solana_json_fail(json, SolanaJsonErrorTruncated);
+    }
+    return SolanaJsonStatusDone;
+}
+
+SolanaJsonError solana_json_get_error(SolanaJson* json) {
+    return json->error;
+}
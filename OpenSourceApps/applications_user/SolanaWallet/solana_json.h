@@ -0,0 +1,119 @@
+#ifndef SOLANA_JSON_H
+#define SOLANA_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SOLANA_JSON_MAX_DEPTH     16
+#define SOLANA_JSON_MAX_SELECTORS 8
+#define SOLANA_JSON_KEY_SIZE      32 // Longer keys never match a selector
+#define SOLANA_JSON_TOKEN_SIZE    64 // Longer strings arrive in several events
+
+/**
+ * Resumable SAX style JSON tokenizer.  Feed it the response in chunks of any size and it calls
+ * back only for the values picked by the selectors, so the memory used is sizeof(SolanaJson) no
+ * matter how large the document is.
+ *
+ * A selector is a dot separated path from the root, for example "result.value.lamports".
+ * Inside arrays a segment is either an index ("result.0.signature") or "*" for every element
+ * ("result.*.signature").  The empty string selects the root value.  A selected object or array
+ * is reported as a start and an end event with any selected values inside in between.
+ */
+
+typedef enum {
+    SolanaJsonEventString, // value is the decoded text (or the next part of it, see partial)
+    SolanaJsonEventNumber, // value is the number as written
+    SolanaJsonEventBool, // value is "true" or "false"
+    SolanaJsonEventNull,
+    SolanaJsonEventObjectStart,
+    SolanaJsonEventObjectEnd,
+    SolanaJsonEventArrayStart,
+    SolanaJsonEventArrayEnd,
+} SolanaJsonEventType;
+
+typedef struct {
+    SolanaJsonEventType type;
+    uint8_t selector; // Index of the selector that matched
+    bool partial; // The string continues in the next event
+    uint16_t index; // Position of the value in its parent array, 0 otherwise
+    const char* value; // Not NUL terminated, only valid during the callback
+    size_t length;
+} SolanaJsonEvent;
+
+typedef void (*SolanaJsonCallback)(const SolanaJsonEvent* event, void* context);
+
+typedef enum {
+    SolanaJsonStatusMore, // Waiting for more input
+    SolanaJsonStatusDone, // The root value is complete
+    SolanaJsonStatusError,
+} SolanaJsonStatus;
+
+typedef enum {
+    SolanaJsonErrorNone,
+    SolanaJsonErrorSyntax,
+    SolanaJsonErrorDepth, // Nested deeper than SOLANA_JSON_MAX_DEPTH
+    SolanaJsonErrorTooLong, // Number or literal longer than SOLANA_JSON_TOKEN_SIZE
+    SolanaJsonErrorTruncated, // Input ended inside the document
+    SolanaJsonErrorTrailingData,
+} SolanaJsonError;
+
+typedef struct {
+    bool object;
+    uint16_t index; // Elements seen so far in an array
+    uint8_t mask; // Selectors that can still match something inside
+    uint8_t selected; // Selectors that matched the container itself
+} SolanaJsonLevel;
+
+typedef struct {
+    const char* const* selectors;
+    uint8_t selector_count;
+    uint8_t segment_count[SOLANA_JSON_MAX_SELECTORS];
+    SolanaJsonCallback callback;
+    void* context;
+
+    uint8_t state;
+    SolanaJsonError error;
+    uint8_t depth;
+    SolanaJsonLevel levels[SOLANA_JSON_MAX_DEPTH];
+
+    uint8_t selected; // Selectors that matched the value being read
+    uint16_t index; // Array index of the value being read
+    bool in_key;
+    uint8_t unicode_digits;
+    uint16_t unicode;
+    uint16_t high_surrogate;
+
+    uint8_t key_length; // SOLANA_JSON_KEY_SIZE + 1 once the key overflowed
+    char key[SOLANA_JSON_KEY_SIZE];
+    uint8_t token_length;
+    char token[SOLANA_JSON_TOKEN_SIZE];
+} SolanaJson;
+
+/**
+ * @brief      Prepare to read a document.
+ * @details    selectors must stay valid until the document is done.  At most
+ *            SOLANA_JSON_MAX_SELECTORS are used.
+*/
+void solana_json_init(
+    SolanaJson* json,
+    const char* const* selectors,
+    size_t selector_count,
+    SolanaJsonCallback callback,
+    void* context);
+
+/**
+ * @brief      Start over with the same selectors, for example when a response is resent.
+*/
+void solana_json_reset(SolanaJson* json);
+
+SolanaJsonStatus solana_json_feed(SolanaJson* json, const char* data, size_t size);
+
+/**
+ * @brief      Signal the end of input.  Needed to complete a document that is a bare number.
+*/
+SolanaJsonStatus solana_json_finish(SolanaJson* json);
+
+SolanaJsonError solana_json_get_error(SolanaJson* json);
+
+#endif // SOLANA_JSON_H
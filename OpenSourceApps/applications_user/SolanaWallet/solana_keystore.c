@@ -0,0 +1,485 @@
+#include "solana_keystore.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include "aes_gcm.h"
+#include "sha512.h"
+
+#define TAG "SolanaKeystore"
+
+#define SOLANA_KEYSTORE_PATH     APP_DATA_PATH("keystore.bin")
+#define SOLANA_KEYSTORE_TMP_PATH APP_DATA_PATH("keystore.tmp")
+#define SOLANA_KEYSTORE_MAGIC    "SOLK"
+#define SOLANA_KEYSTORE_VERSION  1
+#define SOLANA_KEYSTORE_SALT     16
+
+// The file was sealed with a key bound to this Flipper's enclave unique key.
+#define SOLANA_KEYSTORE_FLAG_DEVICE_BOUND 0x01
+
+/**
+ * File layout, integers little endian:
+ *
+ *   header: magic[4] version flags count reserved iterations(u32) salt[16]
+ *           check_nonce[12] check_tag[16]
+ *   count entries: public_key[32] nonce[12] sealed_seed[32] tag[16]
+ *
+ * The check tag seals an empty message so a wrong PIN is caught even with no keys.  Every tag
+ * also authenticates magic..salt (and the entry's public key), so tampering with the KDF
+ * parameters or swapping public keys fails authentication.
+ */
+#define SOLANA_KEYSTORE_AAD_SIZE    (4 + 1 + 1 + 4 + SOLANA_KEYSTORE_SALT)
+#define SOLANA_KEYSTORE_HEADER_SIZE \
+    (4 + 4 + 4 + SOLANA_KEYSTORE_SALT + AES_GCM_NONCE_SIZE + AES_GCM_TAG_SIZE)
+#define SOLANA_KEYSTORE_ENTRY_SIZE \
+    (ED25519_PUBLIC_KEY_SIZE + AES_GCM_NONCE_SIZE + ED25519_SEED_SIZE + AES_GCM_TAG_SIZE)
+
+typedef struct {
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE];
+    uint8_t nonce[AES_GCM_NONCE_SIZE];
+    uint8_t sealed[ED25519_SEED_SIZE];
+    uint8_t tag[AES_GCM_TAG_SIZE];
+} SolanaKeystoreEntry;
+
+struct SolanaKeystore {
+    Storage* storage;
+    Entropy* entropy;
+    SolanaKeystoreStatus state; // See solana_keystore_get_state()
+    uint8_t flags;
+    uint32_t iterations;
+    uint8_t salt[SOLANA_KEYSTORE_SALT];
+    uint8_t check_nonce[AES_GCM_NONCE_SIZE];
+    uint8_t check_tag[AES_GCM_TAG_SIZE];
+    uint8_t count;
+    SolanaKeystoreEntry entries[SOLANA_KEYSTORE_MAX_KEYS];
+
+    // Session slot.  Only the derived key is kept, never the PIN or a seed.
+    FuriMutex* mutex;
+    FuriTimer* session_timer; // Runs while unlocked, wipes the key once it times out
+    bool unlocked;
+    uint32_t last_used; // Tick
+    uint8_t session_key[AES_GCM_KEY_SIZE];
+};
+
+static void solana_keystore_put32(uint8_t* p, uint32_t value) {
+    for(size_t i = 0; i < 4; i++) {
+        p[i] = value >> (i * 8);
+    }
+}
+
+static uint32_t solana_keystore_get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief      Build the associated data every tag covers, optionally followed by a public key.
+ * @return     size of the associated data.
+*/
+static size_t solana_keystore_aad(
+    SolanaKeystore* keystore,
+    const uint8_t* public_key,
+    uint8_t aad[SOLANA_KEYSTORE_AAD_SIZE + ED25519_PUBLIC_KEY_SIZE]) {
+    memcpy(aad, SOLANA_KEYSTORE_MAGIC, 4);
+    aad[4] = SOLANA_KEYSTORE_VERSION;
+    aad[5] = keystore->flags;
+    solana_keystore_put32(aad + 6, keystore->iterations);
+    memcpy(aad + 10, keystore->salt, SOLANA_KEYSTORE_SALT);
+    if(!public_key) {
+        return SOLANA_KEYSTORE_AAD_SIZE;
+    }
+    memcpy(aad + SOLANA_KEYSTORE_AAD_SIZE, public_key, ED25519_PUBLIC_KEY_SIZE);
+    return SOLANA_KEYSTORE_AAD_SIZE + ED25519_PUBLIC_KEY_SIZE;
+}
+
+/**
+ * @brief      Read the file into keystore, or leave it empty.
+ * @return     the state for solana_keystore_get_state().  Anything but SolanaKeystoreErrorMissing
+ *            means there is a file that must not be replaced.
+*/
+static SolanaKeystoreStatus solana_keystore_load(SolanaKeystore* keystore) {
+    uint8_t buffer[SOLANA_KEYSTORE_HEADER_SIZE];
+    FileInfo info;
+
+    keystore->count = 0;
+    FS_Error error = storage_common_stat(keystore->storage, SOLANA_KEYSTORE_PATH, &info);
+    if(error == FSE_NOT_EXIST) {
+        return SolanaKeystoreErrorMissing;
+    }
+    if(error != FSE_OK) {
+        FURI_LOG_E(TAG, "Can't stat keystore: %d", error);
+        return SolanaKeystoreErrorStorage;
+    }
+
+    File* file = storage_file_alloc(keystore->storage);
+    SolanaKeystoreStatus status = SolanaKeystoreErrorCorrupt;
+    do {
+        if(!storage_file_open(file, SOLANA_KEYSTORE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+            FURI_LOG_E(TAG, "Can't open keystore");
+            status = SolanaKeystoreErrorStorage;
+            break;
+        }
+        if(storage_file_read(file, buffer, sizeof(buffer)) != sizeof(buffer) ||
+           memcmp(buffer, SOLANA_KEYSTORE_MAGIC, 4) != 0 ||
+           buffer[4] != SOLANA_KEYSTORE_VERSION || buffer[6] > SOLANA_KEYSTORE_MAX_KEYS) {
+            FURI_LOG_E(TAG, "Unknown keystore format");
+            break;
+        }
+
+        keystore->flags = buffer[5];
+        keystore->iterations = solana_keystore_get32(buffer + 8);
+        memcpy(keystore->salt, buffer + 12, SOLANA_KEYSTORE_SALT);
+        memcpy(keystore->check_nonce, buffer + 28, AES_GCM_NONCE_SIZE);
+        memcpy(keystore->check_tag, buffer + 40, AES_GCM_TAG_SIZE);
+
+        size_t count = 0;
+        while(count < buffer[6] &&
+              storage_file_read(file, &keystore->entries[count], SOLANA_KEYSTORE_ENTRY_SIZE) ==
+                  SOLANA_KEYSTORE_ENTRY_SIZE) {
+            count++;
+        }
+        if(count < buffer[6]) {
+            FURI_LOG_E(TAG, "Keystore is cut short");
+            break;
+        }
+        keystore->count = count;
+        status = SolanaKeystoreOk;
+    } while(false);
+
+    storage_file_close(file);
+    storage_file_free(file);
+    return status;
+}
+
+/**
+ * @brief      Write the keystore to a temporary file, then move it into place, so a failed
+ *            write never leaves a half written keystore behind.
+*/
+static bool solana_keystore_save(SolanaKeystore* keystore) {
+    uint8_t buffer[SOLANA_KEYSTORE_HEADER_SIZE] = {0};
+    memcpy(buffer, SOLANA_KEYSTORE_MAGIC, 4);
+    buffer[4] = SOLANA_KEYSTORE_VERSION;
+    buffer[5] = keystore->flags;
+    buffer[6] = keystore->count;
+    solana_keystore_put32(buffer + 8, keystore->iterations);
+    memcpy(buffer + 12, keystore->salt, SOLANA_KEYSTORE_SALT);
+    memcpy(buffer + 28, keystore->check_nonce, AES_GCM_NONCE_SIZE);
+    memcpy(buffer + 40, keystore->check_tag, AES_GCM_TAG_SIZE);
+
+    File* file = storage_file_alloc(keystore->storage);
+    bool ok = storage_file_open(file, SOLANA_KEYSTORE_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, buffer, sizeof(buffer)) == sizeof(buffer);
+    for(size_t i = 0; i < keystore->count && ok; i++) {
+        ok = storage_file_write(file, &keystore->entries[i], SOLANA_KEYSTORE_ENTRY_SIZE) ==
+             SOLANA_KEYSTORE_ENTRY_SIZE;
+    }
+    ok = storage_file_sync(file) && ok;
+    storage_file_close(file);
+    storage_file_free(file);
+
+    if(ok) {
+        storage_simply_remove(keystore->storage, SOLANA_KEYSTORE_PATH);
+        ok = storage_common_rename(
+                 keystore->storage, SOLANA_KEYSTORE_TMP_PATH, SOLANA_KEYSTORE_PATH) == FSE_OK;
+    }
+    if(!ok) {
+        FURI_LOG_E(TAG, "Failed to save keystore");
+        storage_simply_remove(keystore->storage, SOLANA_KEYSTORE_TMP_PATH);
+    }
+    return ok;
+}
+
+/**
+ * @brief      Turn the PIN into the session key.
+ * @details    PBKDF2 stretches the PIN, then the result is run through AES with the enclave's
+ *            unique key, which never leaves the secure core.  A copy of the SD card is
+ *            therefore useless for offline PIN guessing without the Flipper it came from.
+*/
+static SolanaKeystoreStatus solana_keystore_derive(
+    SolanaKeystore* keystore,
+    const char* pin,
+    uint8_t key[AES_GCM_KEY_SIZE]) {
+    uint8_t stretched[AES_GCM_KEY_SIZE];
+    uint32_t start = furi_get_tick();
+    pbkdf2_hmac_sha512(
+        (const uint8_t*)pin,
+        strlen(pin),
+        keystore->salt,
+        SOLANA_KEYSTORE_SALT,
+        keystore->iterations,
+        stretched,
+        sizeof(stretched));
+    FURI_LOG_D(TAG, "KDF took %lu ms", furi_get_tick() - start);
+
+    SolanaKeystoreStatus status = SolanaKeystoreErrorEnclave;
+    const uint8_t slot = FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT;
+    if(furi_hal_crypto_enclave_ensure_key(slot) &&
+       furi_hal_crypto_enclave_load_key(slot, keystore->salt)) {
+        if(furi_hal_crypto_encrypt(stretched, key, AES_GCM_KEY_SIZE)) {
+            status = SolanaKeystoreOk;
+        }
+        furi_hal_crypto_enclave_unload_key(slot);
+    }
+
+    memset(stretched, 0, sizeof(stretched));
+    if(status != SolanaKeystoreOk) {
+        FURI_LOG_E(TAG, "Enclave key unavailable");
+        memset(key, 0, AES_GCM_KEY_SIZE);
+    }
+    return status;
+}
+
+static void solana_keystore_set_session(SolanaKeystore* keystore, const uint8_t* key) {
+    furi_mutex_acquire(keystore->mutex, FuriWaitForever);
+    if(key) {
+        memcpy(keystore->session_key, key, AES_GCM_KEY_SIZE);
+        keystore->last_used = furi_get_tick();
+    } else {
+        memset(keystore->session_key, 0, AES_GCM_KEY_SIZE);
+    }
+    keystore->unlocked = key != NULL;
+    furi_mutex_release(keystore->mutex);
+
+    // Outside the mutex, which the timer callback takes.
+    if(key) {
+        furi_timer_start(keystore->session_timer, furi_ms_to_ticks(SOLANA_KEYSTORE_SESSION_CHECK));
+    } else {
+        furi_timer_stop(keystore->session_timer);
+    }
+}
+
+/**
+ * @brief      Wipe the session key if it sat unused for too long.  Call with the mutex held.
+ * @return     true if the session is still unlocked.
+*/
+static bool solana_keystore_check_session(SolanaKeystore* keystore) {
+    if(keystore->unlocked && furi_get_tick() - keystore->last_used >=
+                                 furi_ms_to_ticks(SOLANA_KEYSTORE_SESSION_TIMEOUT)) {
+        FURI_LOG_I(TAG, "Session timed out");
+        memset(keystore->session_key, 0, AES_GCM_KEY_SIZE);
+        keystore->unlocked = false;
+    }
+    return keystore->unlocked;
+}
+
+/**
+ * @brief      Take the session key for one operation, which restarts the idle timeout.
+ *            Call with the mutex held.
+*/
+static bool solana_keystore_touch_session(SolanaKeystore* keystore) {
+    if(!solana_keystore_check_session(keystore)) {
+        return false;
+    }
+    keystore->last_used = furi_get_tick();
+    return true;
+}
+
+/**
+ * @brief      Timer callback, on the timer thread: the session may time out with nobody calling.
+*/
+static void solana_keystore_session_timer_callback(void* context) {
+    SolanaKeystore* keystore = context;
+    furi_mutex_acquire(keystore->mutex, FuriWaitForever);
+    solana_keystore_check_session(keystore);
+    furi_mutex_release(keystore->mutex);
+}
+
+SolanaKeystore* solana_keystore_alloc(Entropy* entropy) {
+    SolanaKeystore* keystore = malloc(sizeof(SolanaKeystore));
+    memset(keystore, 0, sizeof(SolanaKeystore));
+    keystore->entropy = entropy;
+    keystore->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    keystore->session_timer = furi_timer_alloc(
+        solana_keystore_session_timer_callback, FuriTimerTypePeriodic, keystore);
+    keystore->storage = furi_record_open(RECORD_STORAGE);
+    keystore->state = solana_keystore_load(keystore);
+    return keystore;
+}
+
+void solana_keystore_free(SolanaKeystore* keystore) {
+    // Waits for a running callback, so nothing touches the keystore after this.
+    furi_timer_free(keystore->session_timer);
+    furi_record_close(RECORD_STORAGE);
+    furi_mutex_free(keystore->mutex);
+    memset(keystore, 0, sizeof(SolanaKeystore));
+    free(keystore);
+}
+
+SolanaKeystoreStatus solana_keystore_get_state(SolanaKeystore* keystore) {
+    return keystore->state;
+}
+
+SolanaKeystoreStatus solana_keystore_reload(SolanaKeystore* keystore) {
+    solana_keystore_set_session(keystore, NULL);
+    keystore->state = solana_keystore_load(keystore);
+    return keystore->state;
+}
+
+SolanaKeystoreStatus solana_keystore_create(SolanaKeystore* keystore, const char* pin) {
+    uint8_t key[AES_GCM_KEY_SIZE];
+    uint8_t aad[SOLANA_KEYSTORE_AAD_SIZE + ED25519_PUBLIC_KEY_SIZE];
+
+    // Look at the card now, not at what was there when the app started.
+    if(solana_keystore_reload(keystore) != SolanaKeystoreErrorMissing) {
+        FURI_LOG_W(TAG, "Not replacing the keystore on the card");
+        return SolanaKeystoreErrorExists;
+    }
+    keystore->flags = SOLANA_KEYSTORE_FLAG_DEVICE_BOUND;
+    keystore->iterations = SOLANA_KEYSTORE_ITERATIONS;
+    keystore->count = 0;
+
+    SolanaKeystoreStatus status = SolanaKeystoreErrorEntropy;
+    if(entropy_fill(
+           keystore->entropy, EntropyQualityCrypto, keystore->salt, SOLANA_KEYSTORE_SALT) &&
+       entropy_fill(
+           keystore->entropy,
+           EntropyQualityCrypto,
+           keystore->check_nonce,
+           AES_GCM_NONCE_SIZE)) {
+        status = solana_keystore_derive(keystore, pin, key);
+    }
+    if(status == SolanaKeystoreOk) {
+        size_t aad_size = solana_keystore_aad(keystore, NULL, aad);
+        aes_gcm_encrypt(
+            key, keystore->check_nonce, aad, aad_size, NULL, NULL, 0, keystore->check_tag);
+        if(solana_keystore_save(keystore)) {
+            keystore->state = SolanaKeystoreOk;
+            solana_keystore_set_session(keystore, key);
+        } else {
+            status = SolanaKeystoreErrorStorage;
+        }
+    }
+
+    memset(key, 0, sizeof(key));
+    return status;
+}
+
+SolanaKeystoreStatus solana_keystore_unlock(SolanaKeystore* keystore, const char* pin) {
+    uint8_t key[AES_GCM_KEY_SIZE];
+    uint8_t aad[SOLANA_KEYSTORE_AAD_SIZE + ED25519_PUBLIC_KEY_SIZE];
+
+    if(keystore->state != SolanaKeystoreOk) {
+        return keystore->state;
+    }
+
+    SolanaKeystoreStatus status = solana_keystore_derive(keystore, pin, key);
+    if(status == SolanaKeystoreOk) {
+        size_t aad_size = solana_keystore_aad(keystore, NULL, aad);
+        if(aes_gcm_decrypt(
+               key, keystore->check_nonce, aad, aad_size, NULL, NULL, 0, keystore->check_tag)) {
+            solana_keystore_set_session(keystore, key);
+        } else {
+            status = SolanaKeystoreErrorPin;
+        }
+    }
+
+    memset(key, 0, sizeof(key));
+    return status;
+}
+
+SolanaKeystoreStatus solana_keystore_wipe(SolanaKeystore* keystore) {
+    solana_keystore_set_session(keystore, NULL);
+    if(!storage_simply_remove(keystore->storage, SOLANA_KEYSTORE_PATH)) {
+        FURI_LOG_E(TAG, "Failed to wipe keystore");
+        return SolanaKeystoreErrorStorage;
+    }
+    FURI_LOG_W(TAG, "Keystore wiped");
+    return solana_keystore_reload(keystore) == SolanaKeystoreErrorMissing ?
+               SolanaKeystoreOk :
+               SolanaKeystoreErrorStorage;
+}
+
+void solana_keystore_lock(SolanaKeystore* keystore) {
+    solana_keystore_set_session(keystore, NULL);
+}
+
+bool solana_keystore_is_unlocked(SolanaKeystore* keystore) {
+    furi_mutex_acquire(keystore->mutex, FuriWaitForever);
+    bool unlocked = solana_keystore_check_session(keystore);
+    furi_mutex_release(keystore->mutex);
+    return unlocked;
+}
+
+SolanaKeystoreStatus solana_keystore_generate(SolanaKeystore* keystore, size_t* index) {
+    uint8_t seed[ED25519_SEED_SIZE];
+    uint8_t aad[SOLANA_KEYSTORE_AAD_SIZE + ED25519_PUBLIC_KEY_SIZE];
+
+    if(keystore->count == SOLANA_KEYSTORE_MAX_KEYS) {
+        return SolanaKeystoreErrorFull;
+    }
+
+    SolanaKeystoreEntry* entry = &keystore->entries[keystore->count];
+    if(!entropy_fill(keystore->entropy, EntropyQualityCrypto, seed, sizeof(seed)) ||
+       !entropy_fill(keystore->entropy, EntropyQualityCrypto, entry->nonce, AES_GCM_NONCE_SIZE)) {
+        memset(seed, 0, sizeof(seed));
+        return SolanaKeystoreErrorEntropy;
+    }
+    ed25519_public_key(seed, entry->public_key);
+    size_t aad_size = solana_keystore_aad(keystore, entry->public_key, aad);
+
+    furi_mutex_acquire(keystore->mutex, FuriWaitForever);
+    bool unlocked = solana_keystore_touch_session(keystore);
+    if(unlocked) {
+        aes_gcm_encrypt(
+            keystore->session_key,
+            entry->nonce,
+            aad,
+            aad_size,
+            seed,
+            entry->sealed,
+            ED25519_SEED_SIZE,
+            entry->tag);
+    }
+    furi_mutex_release(keystore->mutex);
+    memset(seed, 0, sizeof(seed));
+
+    if(!unlocked) {
+        return SolanaKeystoreErrorLocked;
+    }
+    keystore->count++;
+    if(!solana_keystore_save(keystore)) {
+        keystore->count--;
+        return SolanaKeystoreErrorStorage;
+    }
+    if(index) {
+        *index = keystore->count - 1;
+    }
+    return SolanaKeystoreOk;
+}
+
+size_t solana_keystore_get_count(SolanaKeystore* keystore) {
+    return keystore->count;
+}
+
+const uint8_t* solana_keystore_get_public_key(SolanaKeystore* keystore, size_t index) {
+    return index < keystore->count ? keystore->entries[index].public_key : NULL;
+}
+
+SolanaKeystoreStatus solana_keystore_load_seed(
+    SolanaKeystore* keystore,
+    size_t index,
+    uint8_t seed[ED25519_SEED_SIZE]) {
+    uint8_t aad[SOLANA_KEYSTORE_AAD_SIZE + ED25519_PUBLIC_KEY_SIZE];
+
+    if(index >= keystore->count) {
+        return SolanaKeystoreErrorMissing;
+    }
+    SolanaKeystoreEntry* entry = &keystore->entries[index];
+    size_t aad_size = solana_keystore_aad(keystore, entry->public_key, aad);
+
+    SolanaKeystoreStatus status = SolanaKeystoreErrorLocked;
+    furi_mutex_acquire(keystore->mutex, FuriWaitForever);
+    if(solana_keystore_touch_session(keystore)) {
+        status = aes_gcm_decrypt(
+                     keystore->session_key,
+                     entry->nonce,
+                     aad,
+                     aad_size,
+                     entry->sealed,
+                     seed,
+                     ED25519_SEED_SIZE,
+                     entry->tag) ?
+                     SolanaKeystoreOk :
+                     SolanaKeystoreErrorCorrupt;
+    }
+    furi_mutex_release(keystore->mutex);
+    return status;
+}
@@ -0,0 +1,110 @@
+#ifndef SOLANA_KEYSTORE_H
+#define SOLANA_KEYSTORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ed25519.h"
+#include "../common/entropy.h"
+
+#define SOLANA_KEYSTORE_MAX_KEYS        4
+#define SOLANA_KEYSTORE_PIN_MIN         4
+#define SOLANA_KEYSTORE_ITERATIONS      10000 // PBKDF2-HMAC-SHA512 rounds for new keystores
+#define SOLANA_KEYSTORE_SESSION_TIMEOUT (10 * 60 * 1000) // ms without use before locking again
+#define SOLANA_KEYSTORE_SESSION_CHECK   1000 // ms between checks for a timed out session
+
+typedef enum {
+    SolanaKeystoreOk,
+    SolanaKeystoreErrorMissing, // No keystore on the SD card yet
+    SolanaKeystoreErrorExists, // There is a keystore file already, even if it can't be read
+    SolanaKeystoreErrorStorage, // The SD card failed
+    SolanaKeystoreErrorCorrupt, // Unknown format or a key failed authentication
+    SolanaKeystoreErrorPin, // Wrong PIN, or the file comes from another Flipper
+    SolanaKeystoreErrorLocked, // Unlock first
+    SolanaKeystoreErrorFull,
+    SolanaKeystoreErrorEnclave, // The secure enclave refused the device key
+    SolanaKeystoreErrorEntropy, // The hardware RNG failed its health tests
+} SolanaKeystoreStatus;
+
+typedef struct SolanaKeystore SolanaKeystore;
+
+/**
+ * @brief      Open the keystore on the SD card.
+ * @details    Only public keys are read.  Seeds stay encrypted until solana_keystore_load_seed().
+ *            See solana_keystore_get_state() for what was found.
+ * @param      entropy  Source of seeds, salts and nonces, shared with the rest of the app.
+*/
+SolanaKeystore* solana_keystore_alloc(Entropy* entropy);
+
+/**
+ * @brief      Free the keystore, wiping the session key.
+*/
+void solana_keystore_free(SolanaKeystore* keystore);
+
+/**
+ * @brief      What the keystore file looked like when it was last read.
+ * @return     SolanaKeystoreOk, SolanaKeystoreErrorMissing if there is no file yet,
+ *            SolanaKeystoreErrorStorage if the card couldn't be read or
+ *            SolanaKeystoreErrorCorrupt if the file is short or in an unknown format.  Only a
+ *            missing file lets solana_keystore_create() make a new one.
+*/
+SolanaKeystoreStatus solana_keystore_get_state(SolanaKeystore* keystore);
+
+/**
+ * @brief      Lock and read the file again, for example after the card was put back.
+ * @return     the new solana_keystore_get_state().
+*/
+SolanaKeystoreStatus solana_keystore_reload(SolanaKeystore* keystore);
+
+/**
+ * @brief      Create an empty keystore protected by pin and leave it unlocked.
+ * @details    An existing file is never replaced, even one that can't be read: that returns
+ *            SolanaKeystoreErrorExists, and only solana_keystore_wipe() removes it.
+*/
+SolanaKeystoreStatus solana_keystore_create(SolanaKeystore* keystore, const char* pin);
+
+/**
+ * @brief      Delete the keystore file and with it every sealed seed, for good.
+ * @details    Only call this after the user confirmed it.  A new keystore can then be created.
+*/
+SolanaKeystoreStatus solana_keystore_wipe(SolanaKeystore* keystore);
+
+/**
+ * @brief      Run the PIN key derivation and keep the result for this session.
+ * @details    This is the deliberately slow step, it is what makes guessing PINs expensive.
+ *            Later calls to solana_keystore_load_seed() only pay for AES-GCM until the session
+ *            times out or solana_keystore_lock() is called.
+*/
+SolanaKeystoreStatus solana_keystore_unlock(SolanaKeystore* keystore, const char* pin);
+
+void solana_keystore_lock(SolanaKeystore* keystore);
+
+/**
+ * @brief      Check the session, locking it if it sat unused for SOLANA_KEYSTORE_SESSION_TIMEOUT.
+ * @details    A timer also checks every SOLANA_KEYSTORE_SESSION_CHECK, so an idle session is
+ *            wiped on time without anyone calling in.
+*/
+bool solana_keystore_is_unlocked(SolanaKeystore* keystore);
+
+/**
+ * @brief      Make a new random key, seal it and save the keystore.
+ * @param      index    Set to the position of the new key.
+*/
+SolanaKeystoreStatus solana_keystore_generate(SolanaKeystore* keystore, size_t* index);
+
+size_t solana_keystore_get_count(SolanaKeystore* keystore);
+
+/**
+ * @return     the public key at index, or NULL if there is none.
+*/
+const uint8_t* solana_keystore_get_public_key(SolanaKeystore* keystore, size_t index);
+
+/**
+ * @brief      Decrypt the seed at index with the session key.  Wipe it after use.
+*/
+SolanaKeystoreStatus solana_keystore_load_seed(
+    SolanaKeystore* keystore,
+    size_t index,
+    uint8_t seed[ED25519_SEED_SIZE]);
+
+#endif // SOLANA_KEYSTORE_H
@@ -0,0 +1,526 @@
+#include "solana_link.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <expansion/expansion.h>
+
+#define TAG "SolanaLink"
+
+#define SOLANA_LINK_RX_STREAM_SIZE 1024
+#define SOLANA_LINK_PING_TIMEOUT   500
+#define SOLANA_LINK_PING_INTERVAL  3000 // ms between pings while the board is not answering
+#define SOLANA_LINK_WORKER_STACK   2048
+
+typedef enum {
+    SolanaLinkWorkerEventStop = (1 << 0),
+    SolanaLinkWorkerEventRx = (1 << 1),
+    SolanaLinkWorkerEventTx = (1 << 2),
+} SolanaLinkWorkerEvent;
+
+#define SOLANA_LINK_WORKER_EVENTS \
+    (SolanaLinkWorkerEventStop | SolanaLinkWorkerEventRx | SolanaLinkWorkerEventTx)
+
+typedef enum {
+    SolanaLinkSlotFree,
+    SolanaLinkSlotQueued, // Frame built, waiting for the worker to send it
+    SolanaLinkSlotWaiting, // Sent, waiting for the answer
+} SolanaLinkSlotState;
+
+typedef struct {
+    SolanaLinkSlotState state;
+    uint8_t id; // Handed to the caller, stays the same across retries
+    uint8_t seq; // Sequence number of the current attempt
+    uint8_t retries; // Attempts left after the current one
+    bool cancelled;
+    uint32_t timeout; // Ticks per attempt
+    uint32_t deadline; // Tick at which the current attempt times out
+    SolanaLinkResponseCallback callback;
+    void* context;
+    uint16_t frame_size;
+    uint8_t frame[SOLANA_LINK_MAX_FRAME]; // Kept so a retry resends the same bytes
+} SolanaLinkSlot;
+
+typedef struct {
+    SolanaLinkResponseCallback callback;
+    void* context;
+    SolanaLinkResult result;
+} SolanaLinkNotice;
+
+struct SolanaLink {
+    FuriHalSerialHandle* serial;
+    Expansion* expansion;
+    FuriThread* thread;
+    FuriStreamBuffer* rx_stream;
+    FuriMutex* mutex; // Guards slots, next_id and next_seq
+
+    SolanaLinkDecoder decoder;
+    SolanaLinkSlot slots[SOLANA_LINK_MAX_IN_FLIGHT];
+    uint8_t next_id;
+    uint8_t next_seq;
+
+    // Only touched by the worker thread once it is running.  serial is NULL while closed.
+    uint8_t tx_buffer[SOLANA_LINK_MAX_FRAME];
+    SolanaLinkState state;
+    uint8_t ping_id;
+    uint32_t next_ping;
+    SolanaLinkStateCallback state_callback;
+    void* state_context;
+};
+
+static inline bool solana_link_tick_reached(uint32_t now, uint32_t tick) {
+    return (int32_t)(now - tick) >= 0;
+}
+
+static void solana_link_set_state(SolanaLink* link, SolanaLinkState state) {
+    if(link->state == state) {
+        return;
+    }
+    FURI_LOG_D(TAG, "State %d -> %d", link->state, state);
+    link->state = state;
+    if(link->state_callback) {
+        link->state_callback(state, link->state_context);
+    }
+}
+
+static void solana_link_wake(SolanaLink* link, SolanaLinkWorkerEvent event) {
+    furi_thread_flags_set(furi_thread_get_id(link->thread), event);
+}
+
+static void
+    solana_link_on_rx(FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* context) {
+    SolanaLink* link = (SolanaLink*)context;
+    if(event == FuriHalSerialRxEventData) {
+        uint8_t data = furi_hal_serial_async_rx(handle);
+        furi_stream_buffer_send(link->rx_stream, &data, 1, 0);
+        solana_link_wake(link, SolanaLinkWorkerEventRx);
+    }
+}
+
+static SolanaLinkSlot* solana_link_find_slot(SolanaLink* link, uint8_t seq) {
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        if(link->slots[i].state != SolanaLinkSlotFree && link->slots[i].seq == seq) {
+            return &link->slots[i];
+        }
+    }
+    return NULL;
+}
+
+static SolanaLinkSlot* solana_link_find_id(SolanaLink* link, uint8_t id) {
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        if(link->slots[i].state != SolanaLinkSlotFree && link->slots[i].id == id) {
+            return &link->slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief      Pick a sequence number no outstanding attempt uses.  Call with the lock held.
+ * @details    Sequence 0 is reserved for board events.
+*/
+static uint8_t solana_link_take_seq(SolanaLink* link) {
+    uint8_t seq;
+    do {
+        seq = link->next_seq++;
+    } while(seq == 0 || solana_link_find_slot(link, seq));
+    return seq;
+}
+
+static void solana_link_on_frame(const SolanaLinkFrame* frame, void* context) {
+    SolanaLink* link = (SolanaLink*)context;
+
+    if(frame->type == SolanaLinkFrameEvent) {
+        FURI_LOG_I(TAG, "Board event, %u bytes", frame->length);
+        return;
+    }
+    if(frame->type != SolanaLinkFrameResponse || frame->length < 1) {
+        return;
+    }
+
+    // Any well formed answer means the board is alive.
+    solana_link_set_state(link, SolanaLinkStateReady);
+
+    SolanaLinkResult result = SolanaLinkResultOk;
+    SolanaLinkResponseCallback callback = NULL;
+    void* callback_context = NULL;
+
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    SolanaLinkSlot* slot = solana_link_find_slot(link, frame->seq);
+    if(slot && slot->state == SolanaLinkSlotWaiting && !slot->cancelled) {
+        callback = slot->callback;
+        callback_context = slot->context;
+        if(frame->payload[0] != SolanaLinkStatusOk) {
+            result = SolanaLinkResultFailed;
+            slot->state = SolanaLinkSlotFree;
+        } else if(frame->flags & SOLANA_LINK_FLAG_MORE) {
+            result = SolanaLinkResultChunk;
+            slot->deadline = furi_get_tick() + slot->timeout;
+        } else {
+            result = SolanaLinkResultOk;
+            slot->state = SolanaLinkSlotFree;
+        }
+    }
+    furi_mutex_release(link->mutex);
+
+    // Late answers to requests that already timed out are dropped here.
+    if(callback) {
+        callback(result, frame->payload + 1, frame->length - 1, callback_context);
+    }
+}
+
+static void solana_link_ping_callback(
+    SolanaLinkResult result,
+    const uint8_t* data,
+    size_t size,
+    void* context) {
+    UNUSED(data);
+    UNUSED(size);
+    SolanaLink* link = (SolanaLink*)context;
+
+    if(result == SolanaLinkResultChunk || result == SolanaLinkResultRetry) {
+        return;
+    }
+    link->ping_id = 0;
+    if(result == SolanaLinkResultTimeout) {
+        solana_link_set_state(link, SolanaLinkStateLost);
+        link->next_ping = furi_get_tick() + furi_ms_to_ticks(SOLANA_LINK_PING_INTERVAL);
+    }
+}
+
+/**
+ * @brief      Send the next queued frame, if any.
+ * @details    The frame is copied out so the UART write happens without holding the lock and
+ *            solana_link_request() never waits on a transmission.
+ * @return     true if a frame was sent.
+*/
+static bool solana_link_send_next(SolanaLink* link) {
+    size_t size = 0;
+
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        SolanaLinkSlot* slot = &link->slots[i];
+        if(slot->state == SolanaLinkSlotQueued && !slot->cancelled) {
+            size = slot->frame_size;
+            memcpy(link->tx_buffer, slot->frame, size);
+            slot->state = SolanaLinkSlotWaiting;
+            slot->deadline = furi_get_tick() + slot->timeout;
+            break;
+        }
+    }
+    furi_mutex_release(link->mutex);
+
+    if(size) {
+        furi_hal_serial_tx(link->serial, link->tx_buffer, size);
+    }
+    return size > 0;
+}
+
+/**
+ * @brief      Whether a request other than our own ping still needs the USART.  Call with the
+ *            lock held.
+*/
+static bool solana_link_has_requests(SolanaLink* link) {
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        SolanaLinkSlot* slot = &link->slots[i];
+        if(slot->state != SolanaLinkSlotFree && !slot->cancelled &&
+           slot->callback != solana_link_ping_callback) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief      Take the USART for the outstanding requests.
+ * @details    The expansion module protocol also listens on this USART, so it is switched off
+ *            for as long as the link is open.
+ * @return     false if the USART is held by something else.
+*/
+static bool solana_link_open(SolanaLink* link) {
+    expansion_disable(link->expansion);
+    link->serial = furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
+    if(!link->serial) {
+        FURI_LOG_E(TAG, "USART is busy");
+        expansion_enable(link->expansion);
+        return false;
+    }
+
+    furi_hal_serial_init(link->serial, SOLANA_LINK_BAUDRATE);
+    furi_stream_buffer_reset(link->rx_stream);
+    solana_link_decoder_reset(&link->decoder);
+    link->next_ping = furi_get_tick();
+    solana_link_set_state(link, SolanaLinkStateConnecting);
+    furi_hal_serial_async_rx_start(link->serial, solana_link_on_rx, link, false);
+    return true;
+}
+
+/**
+ * @brief      Give the USART back once nothing is outstanding.  A ping in flight is dropped.
+*/
+static void solana_link_close(SolanaLink* link) {
+    furi_hal_serial_async_rx_stop(link->serial);
+    furi_hal_serial_deinit(link->serial);
+    furi_hal_serial_control_release(link->serial);
+    link->serial = NULL;
+    expansion_enable(link->expansion);
+
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    SolanaLinkSlot* slot = link->ping_id ? solana_link_find_id(link, link->ping_id) : NULL;
+    if(slot) {
+        slot->state = SolanaLinkSlotFree;
+    }
+    furi_mutex_release(link->mutex);
+    link->ping_id = 0;
+
+    solana_link_set_state(link, SolanaLinkStateClosed);
+}
+
+/**
+ * @brief      Ticks until the earliest attempt deadline or ping, FuriWaitForever if none.
+*/
+static uint32_t solana_link_next_wake(SolanaLink* link) {
+    uint32_t now = furi_get_tick();
+    uint32_t wait = FuriWaitForever;
+
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        SolanaLinkSlot* slot = &link->slots[i];
+        if(slot->state == SolanaLinkSlotWaiting) {
+            int32_t left = (int32_t)(slot->deadline - now);
+            wait = MIN(wait, (uint32_t)MAX(left, 0));
+        }
+    }
+    furi_mutex_release(link->mutex);
+
+    if(link->serial && link->state != SolanaLinkStateReady && link->ping_id == 0) {
+        int32_t left = (int32_t)(link->next_ping - now);
+        wait = MIN(wait, (uint32_t)MAX(left, 0));
+    }
+    return wait;
+}
+
+/**
+ * @brief      Open or close the USART as needed, expire attempts that ran out of time, then
+ *            send queued frames.
+ * @details    Runs on the worker thread.  Callbacks are collected under the lock and called
+ *            after it is released so they are free to queue new requests.
+ * @return     ticks the worker may sleep before it has to run this again.
+*/
+static uint32_t solana_link_service(SolanaLink* link) {
+    SolanaLinkNotice notices[SOLANA_LINK_MAX_IN_FLIGHT];
+    size_t notice_count = 0;
+    bool timed_out = false;
+
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    bool pending = solana_link_has_requests(link);
+    furi_mutex_release(link->mutex);
+    bool unavailable = pending && !link->serial && !solana_link_open(link);
+
+    uint32_t now = furi_get_tick();
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        SolanaLinkSlot* slot = &link->slots[i];
+        SolanaLinkNotice* notice = &notices[notice_count];
+
+        if(slot->state == SolanaLinkSlotFree) {
+            continue;
+        } else if(slot->cancelled) {
+            notice->result = SolanaLinkResultCancelled;
+        } else if(unavailable) {
+            notice->result = SolanaLinkResultUnavailable;
+        } else if(slot->state == SolanaLinkSlotQueued) {
+            continue;
+        } else if(!solana_link_tick_reached(now, slot->deadline)) {
+            continue;
+        } else if(slot->retries > 0) {
+            // A new sequence number, so a late answer to this attempt is dropped.
+            slot->retries--;
+            slot->seq = solana_link_take_seq(link);
+            solana_link_frame_seal(
+                slot->frame,
+                SolanaLinkFrameRequest,
+                slot->seq,
+                0,
+                slot->frame_size - SOLANA_LINK_FRAME_OVERHEAD);
+            notice->result = SolanaLinkResultRetry;
+            FURI_LOG_W(TAG, "Retrying request %u as seq %u", slot->id, slot->seq);
+        } else {
+            notice->result = SolanaLinkResultTimeout;
+            timed_out = slot->callback != solana_link_ping_callback;
+        }
+
+        notice->callback = slot->callback;
+        notice->context = slot->context;
+        notice_count++;
+        slot->state = notice->result == SolanaLinkResultRetry ? SolanaLinkSlotQueued :
+                                                                SolanaLinkSlotFree;
+    }
+    furi_mutex_release(link->mutex);
+
+    for(size_t i = 0; i < notice_count; i++) {
+        notices[i].callback(notices[i].result, NULL, 0, notices[i].context);
+    }
+
+    if(timed_out && link->state == SolanaLinkStateReady) {
+        solana_link_set_state(link, SolanaLinkStateLost);
+        link->next_ping = now;
+    }
+
+    if(link->serial && link->state != SolanaLinkStateReady && link->ping_id == 0 &&
+       solana_link_tick_reached(now, link->next_ping)) {
+        link->ping_id = solana_link_request(
+            link,
+            SolanaLinkCommandPing,
+            NULL,
+            0,
+            SOLANA_LINK_PING_TIMEOUT,
+            solana_link_ping_callback,
+            link);
+    }
+
+    while(link->serial && solana_link_send_next(link)) {
+    }
+
+    // Callbacks may have queued new requests, so look again before letting go of the USART.
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    pending = solana_link_has_requests(link);
+    furi_mutex_release(link->mutex);
+    if(link->serial && !pending) {
+        solana_link_close(link);
+    }
+
+    return solana_link_next_wake(link);
+}
+
+/**
+ * @brief      Link worker.  Sleeps until a byte arrives, a request is queued or cancelled, or
+ *            the next deadline; with nothing outstanding it sleeps until woken.
+*/
+static int32_t solana_link_worker(void* context) {
+    SolanaLink* link = (SolanaLink*)context;
+    uint8_t buffer[64];
+    uint32_t wait = FuriWaitForever;
+
+    while(true) {
+        uint32_t events =
+            furi_thread_flags_wait(SOLANA_LINK_WORKER_EVENTS, FuriFlagWaitAny, wait);
+        if(!(events & FuriFlagError) && (events & SolanaLinkWorkerEventStop)) {
+            break;
+        }
+
+        size_t size;
+        while((size = furi_stream_buffer_receive(link->rx_stream, buffer, sizeof(buffer), 0)) >
+              0) {
+            solana_link_decoder_feed(&link->decoder, buffer, size, solana_link_on_frame, link);
+        }
+
+        wait = solana_link_service(link);
+    }
+
+    return 0;
+}
+
+SolanaLink* solana_link_alloc(SolanaLinkStateCallback state_callback, void* context) {
+    SolanaLink* link = (SolanaLink*)malloc(sizeof(SolanaLink));
+    memset(link, 0, sizeof(SolanaLink));
+    link->state_callback = state_callback;
+    link->state_context = context;
+    link->next_id = 1;
+    link->next_seq = 1;
+    link->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    link->rx_stream = furi_stream_buffer_alloc(SOLANA_LINK_RX_STREAM_SIZE, 1);
+    link->expansion = furi_record_open(RECORD_EXPANSION);
+    link->state = SolanaLinkStateClosed;
+
+    link->thread = furi_thread_alloc_ex(
+        "SolanaLinkWorker", SOLANA_LINK_WORKER_STACK, solana_link_worker, link);
+    furi_thread_start(link->thread);
+
+    return link;
+}
+
+void solana_link_free(SolanaLink* link) {
+    solana_link_wake(link, SolanaLinkWorkerEventStop);
+    furi_thread_join(link->thread);
+    furi_thread_free(link->thread);
+
+    if(link->serial) {
+        solana_link_close(link);
+    }
+    furi_record_close(RECORD_EXPANSION);
+
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        SolanaLinkSlot* slot = &link->slots[i];
+        if(slot->state != SolanaLinkSlotFree && slot->callback != solana_link_ping_callback) {
+            slot->callback(SolanaLinkResultCancelled, NULL, 0, slot->context);
+        }
+    }
+
+    furi_stream_buffer_free(link->rx_stream);
+    furi_mutex_free(link->mutex);
+    free(link);
+}
+
+SolanaLinkState solana_link_get_state(SolanaLink* link) {
+    return link->state;
+}
+
+uint8_t solana_link_request(
+    SolanaLink* link,
+    SolanaLinkCommand command,
+    const uint8_t* payload,
+    size_t size,
+    uint32_t timeout_ms,
+    SolanaLinkResponseCallback callback,
+    void* context) {
+    furi_assert(callback);
+    if(size + 1 > SOLANA_LINK_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    uint8_t id = 0;
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    for(size_t i = 0; i < SOLANA_LINK_MAX_IN_FLIGHT; i++) {
+        SolanaLinkSlot* slot = &link->slots[i];
+        if(slot->state != SolanaLinkSlotFree) {
+            continue;
+        }
+
+        do {
+            id = link->next_id++;
+        } while(id == 0 || solana_link_find_id(link, id));
+
+        slot->id = id;
+        slot->seq = solana_link_take_seq(link);
+        slot->retries = SOLANA_LINK_MAX_RETRIES;
+        slot->cancelled = false;
+        slot->timeout = furi_ms_to_ticks(timeout_ms);
+        slot->callback = callback;
+        slot->context = context;
+        slot->frame[SOLANA_LINK_HEADER_SIZE] = command;
+        if(size) {
+            memcpy(slot->frame + SOLANA_LINK_HEADER_SIZE + 1, payload, size);
+        }
+        slot->frame_size =
+            solana_link_frame_seal(slot->frame, SolanaLinkFrameRequest, slot->seq, 0, size + 1);
+        slot->state = SolanaLinkSlotQueued;
+        break;
+    }
+    furi_mutex_release(link->mutex);
+
+    if(id) {
+        solana_link_wake(link, SolanaLinkWorkerEventTx);
+    }
+    return id;
+}
+
+void solana_link_cancel(SolanaLink* link, uint8_t id) {
+    furi_mutex_acquire(link->mutex, FuriWaitForever);
+    SolanaLinkSlot* slot = solana_link_find_id(link, id);
+    if(slot) {
+        slot->cancelled = true;
+    }
+    furi_mutex_release(link->mutex);
+
+    // The worker reports the cancellation so callbacks always run on the same thread.
+    solana_link_wake(link, SolanaLinkWorkerEventTx);
+}
@@ -0,0 +1,99 @@
+#ifndef SOLANA_LINK_H
+#define SOLANA_LINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "solana_link_frame.h"
+
+#define SOLANA_LINK_BAUDRATE        115200
+#define SOLANA_LINK_MAX_IN_FLIGHT   4
+#define SOLANA_LINK_MAX_RETRIES     2
+#define SOLANA_LINK_DEFAULT_TIMEOUT 2000 // ms per attempt
+
+// First payload byte of a request frame.
+typedef enum {
+    SolanaLinkCommandPing = 0x00,
+    SolanaLinkCommandWifiConnect = 0x01, // Payload: ssid '\0' password
+    SolanaLinkCommandWifiStatus = 0x02,
+    SolanaLinkCommandRpc = 0x10, // Payload: JSON-RPC request body
+} SolanaLinkCommand;
+
+// First payload byte of a response frame.
+typedef enum {
+    SolanaLinkStatusOk = 0x00,
+    SolanaLinkStatusFailed = 0x01,
+    SolanaLinkStatusUnknownCommand = 0x02,
+} SolanaLinkStatus;
+
+typedef enum {
+    SolanaLinkStateClosed, // UART released, nothing to send
+    SolanaLinkStateConnecting, // Waiting for the board to answer a ping
+    SolanaLinkStateReady, // Board answered
+    SolanaLinkStateLost, // Board stopped answering, pinging again in the background
+} SolanaLinkState;
+
+typedef enum {
+    SolanaLinkResultChunk, // Part of the response, more follows
+    SolanaLinkResultOk, // Last (or only) part of the response
+    SolanaLinkResultFailed, // Board answered with a non-zero status
+    SolanaLinkResultRetry, // Request is being resent; drop any chunks received so far
+    SolanaLinkResultTimeout, // No answer after all retries
+    SolanaLinkResultCancelled, // Link stopped or request cancelled
+    SolanaLinkResultUnavailable, // USART held by something else, nothing was sent
+} SolanaLinkResult;
+
+/**
+ * Called from the link worker thread.  Keep it short and post anything UI related to the
+ * view dispatcher with view_dispatcher_send_custom_event().
+ * data points at the response bytes after the status byte and is only valid during the call.
+ */
+typedef void (*SolanaLinkResponseCallback)(
+    SolanaLinkResult result,
+    const uint8_t* data,
+    size_t size,
+    void* context);
+
+typedef void (*SolanaLinkStateCallback)(SolanaLinkState state, void* context);
+
+typedef struct SolanaLink SolanaLink;
+
+/**
+ * @brief      Start the link worker.
+ * @details    The USART is only taken, and expansion modules only disabled, while requests are
+ *            outstanding.  If the USART is held by something else when a request comes in, the
+ *            request fails with SolanaLinkResultUnavailable.
+*/
+SolanaLink* solana_link_alloc(SolanaLinkStateCallback state_callback, void* context);
+
+/**
+ * @brief      Stop the worker, cancel outstanding requests and release the USART.
+*/
+void solana_link_free(SolanaLink* link);
+
+SolanaLinkState solana_link_get_state(SolanaLink* link);
+
+/**
+ * @brief      Queue a request without blocking.
+ * @details    Up to SOLANA_LINK_MAX_IN_FLIGHT requests can be outstanding at once.  Each attempt
+ *            waits timeout_ms for the first byte of the answer (and between answer frames).
+ *            A retry goes out under a new sequence number, so a late answer to an earlier
+ *            attempt can't be taken for the answer to this one.
+ * @return     request id for solana_link_cancel(), or 0 if the table is full or the payload
+ *            does not fit in a frame.
+*/
+uint8_t solana_link_request(
+    SolanaLink* link,
+    SolanaLinkCommand command,
+    const uint8_t* payload,
+    size_t size,
+    uint32_t timeout_ms,
+    SolanaLinkResponseCallback callback,
+    void* context);
+
+/**
+ * @brief      Drop an outstanding request.  Its callback gets SolanaLinkResultCancelled.
+*/
+void solana_link_cancel(SolanaLink* link, uint8_t id);
+
+#endif // SOLANA_LINK_H
@@ -0,0 +1,145 @@
+#include "solana_link_frame.h"
+#include <string.h>
+
+typedef enum {
+    SolanaLinkDecodeSof,
+    SolanaLinkDecodeHeader,
+    SolanaLinkDecodePayload,
+    SolanaLinkDecodeCrc,
+} SolanaLinkDecodeState;
+
+// Nibble table for polynomial 0x1021: 32 bytes of flash instead of 512.
+static const uint16_t solana_link_crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+
+uint16_t solana_link_crc16(uint16_t crc, const uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        crc = (crc << 4) ^ solana_link_crc_table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ solana_link_crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+size_t solana_link_frame_seal(
+    uint8_t* out,
+    uint8_t type,
+    uint8_t seq,
+    uint8_t flags,
+    size_t length) {
+    out[0] = SOLANA_LINK_SOF;
+    out[1] = type;
+    out[2] = seq;
+    out[3] = flags;
+    out[4] = length & 0xFF;
+    out[5] = length >> 8;
+
+    uint16_t crc = solana_link_crc16(0xFFFF, out + 1, SOLANA_LINK_HEADER_SIZE - 1 + length);
+    out[SOLANA_LINK_HEADER_SIZE + length] = crc & 0xFF;
+    out[SOLANA_LINK_HEADER_SIZE + length + 1] = crc >> 8;
+
+    return length + SOLANA_LINK_FRAME_OVERHEAD;
+}
+
+size_t solana_link_frame_encode(
+    uint8_t* out,
+    size_t out_size,
+    uint8_t type,
+    uint8_t seq,
+    uint8_t flags,
+    const uint8_t* payload,
+    size_t length) {
+    if(length > SOLANA_LINK_MAX_PAYLOAD || out_size < length + SOLANA_LINK_FRAME_OVERHEAD) {
+        return 0;
+    }
+    if(length) {
+        memcpy(out + SOLANA_LINK_HEADER_SIZE, payload, length);
+    }
+    return solana_link_frame_seal(out, type, seq, flags, length);
+}
+
+static void solana_link_decoder_restart(SolanaLinkDecoder* decoder) {
+    decoder->state = SolanaLinkDecodeSof;
+    decoder->received = 0;
+    decoder->length = 0;
+    decoder->crc = 0;
+}
+
+void solana_link_decoder_reset(SolanaLinkDecoder* decoder) {
+    solana_link_decoder_restart(decoder);
+    decoder->crc_errors = 0;
+}
+
+void solana_link_decoder_feed(
+    SolanaLinkDecoder* decoder,
+    const uint8_t* data,
+    size_t size,
+    SolanaLinkFrameCallback callback,
+    void* context) {
+    for(size_t i = 0; i < size; i++) {
+        uint8_t byte = data[i];
+
+        switch(decoder->state) {
+        case SolanaLinkDecodeSof:
+            if(byte == SOLANA_LINK_SOF) {
+                decoder->state = SolanaLinkDecodeHeader;
+                decoder->received = 0;
+            }
+            break;
+
+        case SolanaLinkDecodeHeader:
+            decoder->header[decoder->received++] = byte;
+            if(decoder->received < sizeof(decoder->header)) {
+                break;
+            }
+            decoder->length = decoder->header[3] | (decoder->header[4] << 8);
+            if(decoder->length > SOLANA_LINK_MAX_PAYLOAD) {
+                decoder->crc_errors++;
+                solana_link_decoder_restart(decoder);
+                break;
+            }
+            decoder->received = 0;
+            decoder->state = decoder->length ? SolanaLinkDecodePayload : SolanaLinkDecodeCrc;
+            break;
+
+        case SolanaLinkDecodePayload: {
+            // Copy as much of the payload as this chunk holds in one go.
+            size_t take = decoder->length - decoder->received;
+            if(take > size - i) {
+                take = size - i;
+            }
+            memcpy(decoder->payload + decoder->received, data + i, take);
+            decoder->received += take;
+            i += take - 1;
+            if(decoder->received == decoder->length) {
+                decoder->received = 0;
+                decoder->state = SolanaLinkDecodeCrc;
+            }
+            break;
+        }
+
+        case SolanaLinkDecodeCrc:
+            decoder->crc |= (uint16_t)byte << (8 * decoder->received);
+            if(++decoder->received < SOLANA_LINK_CRC_SIZE) {
+                break;
+            }
+
+            uint16_t crc = solana_link_crc16(0xFFFF, decoder->header, sizeof(decoder->header));
+            crc = solana_link_crc16(crc, decoder->payload, decoder->length);
+            if(crc == decoder->crc) {
+                SolanaLinkFrame frame = {
+                    .type = decoder->header[0],
+                    .seq = decoder->header[1],
+                    .flags = decoder->header[2],
+                    .length = decoder->length,
+                    .payload = decoder->payload,
+                };
+                callback(&frame, context);
+            } else {
+                decoder->crc_errors++;
+            }
+            solana_link_decoder_restart(decoder);
+            break;
+        }
+    }
+}
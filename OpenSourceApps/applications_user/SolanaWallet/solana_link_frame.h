@@ -0,0 +1,92 @@
+#ifndef SOLANA_LINK_FRAME_H
+#define SOLANA_LINK_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Wire format shared with the Wi-Fi board (and HostTools/esp32_link_emulator.py):
+ *
+ *   0x7E | type | seq | flags | length (u16 LE) | payload | crc16 (u16 LE)
+ *
+ * The CRC is CRC-16/CCITT-FALSE over type..payload.  A receiver that sees a bad CRC or an
+ * impossible length drops the frame and hunts for the next 0x7E.
+ */
+#define SOLANA_LINK_SOF            0x7E
+#define SOLANA_LINK_HEADER_SIZE    6
+#define SOLANA_LINK_CRC_SIZE       2
+#define SOLANA_LINK_MAX_PAYLOAD    512
+#define SOLANA_LINK_FRAME_OVERHEAD (SOLANA_LINK_HEADER_SIZE + SOLANA_LINK_CRC_SIZE)
+#define SOLANA_LINK_MAX_FRAME      (SOLANA_LINK_MAX_PAYLOAD + SOLANA_LINK_FRAME_OVERHEAD)
+
+typedef enum {
+    SolanaLinkFrameRequest = 0x01, // Flipper -> board, payload starts with a SolanaLinkCommand
+    SolanaLinkFrameResponse = 0x02, // Board -> Flipper, payload starts with a status byte
+    SolanaLinkFrameEvent = 0x03, // Board -> Flipper, unsolicited, seq is 0
+} SolanaLinkFrameType;
+
+// More response frames follow for the same seq.
+#define SOLANA_LINK_FLAG_MORE 0x01
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t flags;
+    uint16_t length;
+    const uint8_t* payload;
+} SolanaLinkFrame;
+
+typedef void (*SolanaLinkFrameCallback)(const SolanaLinkFrame* frame, void* context);
+
+typedef struct {
+    uint8_t state;
+    uint8_t header[SOLANA_LINK_HEADER_SIZE - 1];
+    uint16_t received;
+    uint16_t length;
+    uint16_t crc;
+    uint32_t crc_errors; // Frames dropped because of a bad CRC or length
+    uint8_t payload[SOLANA_LINK_MAX_PAYLOAD];
+} SolanaLinkDecoder;
+
+uint16_t solana_link_crc16(uint16_t crc, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Build a frame.
+ * @return     frame size, or 0 if it does not fit in out_size or the payload is too long.
+*/
+size_t solana_link_frame_encode(
+    uint8_t* out,
+    size_t out_size,
+    uint8_t type,
+    uint8_t seq,
+    uint8_t flags,
+    const uint8_t* payload,
+    size_t length);
+
+/**
+ * @brief      Fill in the header and CRC of a frame whose payload is already at
+ *            out + SOLANA_LINK_HEADER_SIZE.
+ * @return     frame size.
+*/
+size_t solana_link_frame_seal(
+    uint8_t* out,
+    uint8_t type,
+    uint8_t seq,
+    uint8_t flags,
+    size_t length);
+
+void solana_link_decoder_reset(SolanaLinkDecoder* decoder);
+
+/**
+ * @brief      Feed received bytes.  callback runs once per valid frame; its payload pointer is
+ *            only valid during the call.
+*/
+void solana_link_decoder_feed(
+    SolanaLinkDecoder* decoder,
+    const uint8_t* data,
+    size_t size,
+    SolanaLinkFrameCallback callback,
+    void* context);
+
+#endif // SOLANA_LINK_FRAME_H
@@ -0,0 +1,107 @@
+#include "solana_pda.h"
+#include <string.h>
+#include "ed25519.h"
+#include "sha256.h"
+
+#define SOLANA_PDA_MARKER      "ProgramDerivedAddress"
+#define SOLANA_PDA_MARKER_SIZE (sizeof(SOLANA_PDA_MARKER) - 1)
+
+// TokenkegQfeZyiNwAJbNbGKPFXCWuBvf9Ss623VQ5DA
+const uint8_t solana_pda_token_program[SOLANA_PDA_ADDRESS_SIZE] = {
+    0x06, 0xdd, 0xf6, 0xe1, 0xd7, 0x65, 0xa1, 0x93, 0xd9, 0xcb, 0xe1, 0x46, 0xce, 0xeb, 0x79, 0xac,
+    0x1c, 0xb4, 0x85, 0xed, 0x5f, 0x5b, 0x37, 0x91, 0x3a, 0x8c, 0xf5, 0x85, 0x7e, 0xff, 0x00, 0xa9,
+};
+
+// TokenzQdBNbLqP5VEhdkAS6EPFLC1PHnBqCXEpPxuEb
+const uint8_t solana_pda_token_2022_program[SOLANA_PDA_ADDRESS_SIZE] = {
+    0x06, 0xdd, 0xf6, 0xe1, 0xee, 0x75, 0x8f, 0xde, 0x18, 0x42, 0x5d, 0xbc, 0xe4, 0x6c, 0xcd, 0xda,
+    0xb6, 0x1a, 0xfc, 0x4d, 0x83, 0xb9, 0x0d, 0x27, 0xfe, 0xbd, 0xf9, 0x28, 0xd8, 0xa1, 0x8b, 0xfc,
+};
+
+// ATokenGPvbdGVxr1b2hvZbsiqW5xWH25efTNsLJA8knL
+const uint8_t solana_pda_associated_token_program[SOLANA_PDA_ADDRESS_SIZE] = {
+    0x8c, 0x97, 0x25, 0x8f, 0x4e, 0x24, 0x89, 0xf1, 0xbb, 0x3d, 0x10, 0x29, 0x14, 0x8e, 0x0d, 0x83,
+    0x0b, 0x5a, 0x13, 0x99, 0xda, 0xff, 0x10, 0x84, 0x04, 0x8e, 0x7b, 0xd8, 0xdb, 0xe9, 0xf8, 0x59,
+};
+
+/**
+ * @brief      The address for one bump: SHA-256 of mid's seeds, the bump and the program.
+ * @param      suffix  bump, program id and marker, with the bump filled in.
+*/
+static void solana_pda_hash(
+    const Sha256Midstate* mid,
+    const uint8_t* suffix,
+    uint8_t address[SOLANA_PDA_ADDRESS_SIZE]) {
+    sha256_midstate_final(
+        mid, suffix, 1 + SOLANA_PDA_ADDRESS_SIZE + SOLANA_PDA_MARKER_SIZE, address);
+}
+
+static void solana_pda_suffix(uint8_t* suffix, const uint8_t program_id[SOLANA_PDA_ADDRESS_SIZE]) {
+    memcpy(suffix + 1, program_id, SOLANA_PDA_ADDRESS_SIZE);
+    memcpy(suffix + 1 + SOLANA_PDA_ADDRESS_SIZE, SOLANA_PDA_MARKER, SOLANA_PDA_MARKER_SIZE);
+}
+
+/**
+ * @brief      Hash the seeds once, the start of every try.
+*/
+static bool solana_pda_midstate(
+    Sha256Midstate* mid,
+    const uint8_t* const* seeds,
+    const size_t* seed_sizes,
+    size_t seed_count) {
+    Sha256Context ctx;
+    if(seed_count > SOLANA_PDA_MAX_SEEDS) {
+        return false;
+    }
+    sha256_init(&ctx);
+    for(size_t i = 0; i < seed_count; i++) {
+        if(seed_sizes[i] > SOLANA_PDA_MAX_SEED_SIZE) {
+            return false;
+        }
+        sha256_update(&ctx, seeds[i], seed_sizes[i]);
+    }
+    sha256_midstate_init(mid, &ctx);
+    return true;
+}
+
+bool solana_pda_find(
+    const uint8_t* const* seeds,
+    const size_t* seed_sizes,
+    size_t seed_count,
+    const uint8_t program_id[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t address[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t* bump) {
+    Sha256Midstate mid;
+    uint8_t suffix[1 + SOLANA_PDA_ADDRESS_SIZE + SOLANA_PDA_MARKER_SIZE];
+
+    memset(address, 0, SOLANA_PDA_ADDRESS_SIZE);
+    if(!solana_pda_midstate(&mid, seeds, seed_sizes, seed_count)) {
+        return false;
+    }
+    solana_pda_suffix(suffix, program_id);
+
+    // About half of all hashes are curve points, so this usually ends after a try or two.
+    for(int candidate = 255; candidate >= 0; candidate--) {
+        suffix[0] = candidate;
+        solana_pda_hash(&mid, suffix, address);
+        if(!ed25519_is_on_curve(address)) {
+            *bump = candidate;
+            return true;
+        }
+    }
+    memset(address, 0, SOLANA_PDA_ADDRESS_SIZE);
+    return false;
+}
+
+bool solana_pda_find_token_account(
+    const uint8_t owner[SOLANA_PDA_ADDRESS_SIZE],
+    const uint8_t mint[SOLANA_PDA_ADDRESS_SIZE],
+    const uint8_t token_program[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t address[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t* bump) {
+    const uint8_t* seeds[] = {owner, token_program, mint};
+    const size_t seed_sizes[] = {
+        SOLANA_PDA_ADDRESS_SIZE, SOLANA_PDA_ADDRESS_SIZE, SOLANA_PDA_ADDRESS_SIZE};
+    return solana_pda_find(
+        seeds, seed_sizes, 3, solana_pda_associated_token_program, address, bump);
+}
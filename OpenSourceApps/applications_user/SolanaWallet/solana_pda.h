@@ -0,0 +1,52 @@
+#ifndef SOLANA_PDA_H
+#define SOLANA_PDA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Program derived addresses, as find_program_address makes them: for bump = 255, 254, ... the
+ * address is SHA-256(seeds || bump || program id || "ProgramDerivedAddress"), and the first one
+ * that is not a curve point wins.
+ *
+ * Everything before the bump is the same for every try, so it is hashed once into a midstate,
+ * and the curve test is a Jacobi symbol instead of a square root.  Deriving an address then
+ * costs about as much as reading a saved one back from the SD card, and a saved bump can't be
+ * trusted without redoing every try above it, so nothing is cached.
+ */
+
+#define SOLANA_PDA_ADDRESS_SIZE  32
+#define SOLANA_PDA_MAX_SEEDS     15 // 16 with the bump
+#define SOLANA_PDA_MAX_SEED_SIZE 32
+
+extern const uint8_t solana_pda_token_program[SOLANA_PDA_ADDRESS_SIZE];
+extern const uint8_t solana_pda_token_2022_program[SOLANA_PDA_ADDRESS_SIZE];
+extern const uint8_t solana_pda_associated_token_program[SOLANA_PDA_ADDRESS_SIZE];
+
+/**
+ * @brief      find_program_address().
+ * @param      seeds       seed_count seeds of up to SOLANA_PDA_MAX_SEED_SIZE bytes each.
+ * @return     false if the seeds are out of bounds or no bump gives an address off the curve.
+*/
+bool solana_pda_find(
+    const uint8_t* const* seeds,
+    const size_t* seed_sizes,
+    size_t seed_count,
+    const uint8_t program_id[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t address[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t* bump);
+
+/**
+ * @brief      Address of owner's associated token account for mint.
+ * @param      token_program  solana_pda_token_program, or solana_pda_token_2022_program for a
+ *                           mint that belongs to Token-2022.
+*/
+bool solana_pda_find_token_account(
+    const uint8_t owner[SOLANA_PDA_ADDRESS_SIZE],
+    const uint8_t mint[SOLANA_PDA_ADDRESS_SIZE],
+    const uint8_t token_program[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t address[SOLANA_PDA_ADDRESS_SIZE],
+    uint8_t* bump);
+
+#endif // SOLANA_PDA_H
@@ -0,0 +1,762 @@
+#include "solana_rpc.h"
+#include <furi.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "SolanaRpc"
+
+// Cache key is method, a unit separator, then params.
+#define SOLANA_RPC_KEY_SIZE (SOLANA_RPC_METHOD_SIZE + SOLANA_RPC_PARAMS_SIZE)
+
+typedef struct {
+    bool used;
+    uint32_t hash;
+    uint32_t expires; // Tick
+    char key[SOLANA_RPC_KEY_SIZE];
+    uint16_t length;
+    char value[SOLANA_RPC_VALUE_SIZE];
+} SolanaRpcCacheEntry;
+
+typedef enum {
+    SolanaRpcCallFree,
+    SolanaRpcCallQueued, // Waiting for the batch window to close
+    SolanaRpcCallSent, // Part of the batch in batches[batch]
+} SolanaRpcCallState;
+
+typedef struct {
+    SolanaRpcCallback callback;
+    void* context;
+} SolanaRpcWaiter;
+
+typedef struct {
+    SolanaRpcCallState state;
+    uint16_t id; // JSON-RPC id, unique among outstanding calls
+    uint8_t batch;
+    uint32_t hash;
+    uint32_t ttl; // Ticks
+    char key[SOLANA_RPC_KEY_SIZE];
+    uint8_t waiter_count;
+    SolanaRpcWaiter waiters[SOLANA_RPC_MAX_WAITERS];
+} SolanaRpcCall;
+
+typedef struct {
+    SolanaRpc* rpc;
+    bool used;
+    bool overflow; // Response did not fit, every call in the batch fails
+    uint8_t link_id;
+    uint16_t length;
+    // Holds the request body while it is handed to the link, then the response.
+    char buffer[SOLANA_RPC_RESPONSE_SIZE];
+} SolanaRpcBatch;
+
+typedef struct {
+    SolanaRpc* rpc;
+    bool used;
+    bool failed; // Parse error, the rest of the response is ignored
+    uint8_t link_id;
+    SolanaRpcStreamCallback callback;
+    void* context;
+    SolanaJson json;
+} SolanaRpcStream;
+
+struct SolanaRpc {
+    SolanaLink* link;
+    FuriMutex* mutex; // Guards everything below
+    FuriTimer* timer; // Closes the batch window
+    uint16_t next_id;
+    uint32_t balance_ttl; // ms
+    SolanaRpcCacheEntry cache[SOLANA_RPC_CACHE_SIZE];
+    SolanaRpcCall calls[SOLANA_RPC_MAX_CALLS];
+    SolanaRpcBatch batches[SOLANA_RPC_MAX_BATCHES];
+    SolanaRpcStream streams[SOLANA_RPC_MAX_STREAMS];
+};
+
+static void solana_rpc_flush(SolanaRpc* rpc);
+
+/**
+ * @brief      FNV-1a, only used to skip most key comparisons.
+*/
+static uint32_t solana_rpc_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    while(*key) {
+        hash = (hash ^ (uint8_t)*key++) * 16777619u;
+    }
+    return hash;
+}
+
+static bool solana_rpc_tick_reached(uint32_t now, uint32_t tick) {
+    return (int32_t)(now - tick) >= 0;
+}
+
+static SolanaRpcCacheEntry* solana_rpc_cache_find(SolanaRpc* rpc, uint32_t hash, const char* key) {
+    uint32_t now = furi_get_tick();
+    for(size_t i = 0; i < SOLANA_RPC_CACHE_SIZE; i++) {
+        SolanaRpcCacheEntry* entry = &rpc->cache[i];
+        if(!entry->used || entry->hash != hash || strcmp(entry->key, key) != 0) {
+            continue;
+        }
+        if(solana_rpc_tick_reached(now, entry->expires)) {
+            entry->used = false;
+            return NULL;
+        }
+        return entry;
+    }
+    return NULL;
+}
+
+/**
+ * @brief      Store a result, replacing the same key, a free or expired entry, or else the entry
+ *            closest to expiring.
+*/
+static void solana_rpc_cache_store(
+    SolanaRpc* rpc,
+    const SolanaRpcCall* call,
+    const char* value,
+    size_t length) {
+    if(call->ttl == 0 || length > SOLANA_RPC_VALUE_SIZE) {
+        return;
+    }
+
+    uint32_t now = furi_get_tick();
+    SolanaRpcCacheEntry* victim = NULL;
+    for(size_t i = 0; i < SOLANA_RPC_CACHE_SIZE; i++) {
+        SolanaRpcCacheEntry* entry = &rpc->cache[i];
+        if(entry->used && entry->hash == call->hash && strcmp(entry->key, call->key) == 0) {
+            victim = entry;
+            break;
+        }
+        if(!entry->used || solana_rpc_tick_reached(now, entry->expires)) {
+            if(!victim || victim->used) {
+                victim = entry;
+            }
+        } else if(!victim || (victim->used && (int32_t)(entry->expires - victim->expires) < 0)) {
+            victim = entry;
+        }
+    }
+
+    victim->used = true;
+    victim->hash = call->hash;
+    victim->expires = now + call->ttl;
+    strcpy(victim->key, call->key);
+    victim->length = length;
+    memcpy(victim->value, value, length);
+}
+
+static size_t solana_rpc_json_skip_space(const char* json, size_t index, size_t length) {
+    while(index < length && (json[index] == ' ' || json[index] == '\t' || json[index] == '\r' ||
+                             json[index] == '\n')) {
+        index++;
+    }
+    return index;
+}
+
+/**
+ * @brief      Skip one JSON value starting at index.
+ * @details    Only checks enough structure to find where the value ends; the value itself is
+ *            handed to the caller as text.
+ * @return     index just past the value, or SIZE_MAX if it runs past length.
+*/
+static size_t solana_rpc_json_skip_value(const char* json, size_t index, size_t length) {
+    size_t depth = 0;
+    bool in_string = false;
+
+    if(index >= length) {
+        return SIZE_MAX;
+    }
+    if(json[index] != '"' && json[index] != '{' && json[index] != '[') {
+        while(index < length && !strchr(",}] \t\r\n", json[index])) {
+            index++;
+        }
+        return index;
+    }
+
+    for(; index < length; index++) {
+        char c = json[index];
+        if(in_string) {
+            if(c == '\\') {
+                index++;
+            } else if(c == '"') {
+                in_string = false;
+                if(depth == 0) {
+                    return index + 1;
+                }
+            }
+        } else if(c == '"') {
+            in_string = true;
+        } else if(c == '{' || c == '[') {
+            depth++;
+        } else if(c == '}' || c == ']') {
+            if(--depth == 0) {
+                return index + 1;
+            }
+        }
+    }
+    return SIZE_MAX;
+}
+
+typedef struct {
+    uint32_t id;
+    bool error;
+    const char* value; // "result" or "error" member, NULL if neither was present
+    size_t length;
+} SolanaRpcReply;
+
+/**
+ * @brief      Parse one response object starting at index.
+ * @return     index just past the object, or SIZE_MAX if it is malformed.
+*/
+static size_t solana_rpc_json_parse_reply(
+    const char* json,
+    size_t index,
+    size_t length,
+    SolanaRpcReply* reply) {
+    memset(reply, 0, sizeof(SolanaRpcReply));
+    reply->id = UINT32_MAX;
+
+    index = solana_rpc_json_skip_space(json, index, length);
+    if(index >= length || json[index++] != '{') {
+        return SIZE_MAX;
+    }
+
+    while(true) {
+        index = solana_rpc_json_skip_space(json, index, length);
+        if(index < length && json[index] == '}') {
+            return index + 1;
+        }
+
+        size_t key = index;
+        index = solana_rpc_json_skip_value(json, index, length);
+        if(index == SIZE_MAX || json[key] != '"') {
+            return SIZE_MAX;
+        }
+        size_t key_length = index - key;
+
+        index = solana_rpc_json_skip_space(json, index, length);
+        if(index >= length || json[index++] != ':') {
+            return SIZE_MAX;
+        }
+        index = solana_rpc_json_skip_space(json, index, length);
+        size_t value = index;
+        index = solana_rpc_json_skip_value(json, index, length);
+        if(index == SIZE_MAX) {
+            return SIZE_MAX;
+        }
+
+        if(key_length == 4 && memcmp(json + key, "\"id\"", 4) == 0) {
+            reply->id = 0;
+            for(size_t i = value; i < index && json[i] >= '0' && json[i] <= '9'; i++) {
+                reply->id = reply->id * 10 + (json[i] - '0');
+            }
+        } else if(
+            (key_length == 8 && memcmp(json + key, "\"result\"", 8) == 0) ||
+            (key_length == 7 && memcmp(json + key, "\"error\"", 7) == 0)) {
+            reply->error = json[key + 1] == 'e';
+            reply->value = json + value;
+            reply->length = index - value;
+        }
+
+        index = solana_rpc_json_skip_space(json, index, length);
+        if(index < length && json[index] == ',') {
+            index++;
+        } else if(index >= length || json[index] != '}') {
+            return SIZE_MAX;
+        }
+    }
+}
+
+/**
+ * @brief      Find the reply for id in a single response object or a batch array.
+*/
+static bool solana_rpc_json_find_reply(
+    const char* json,
+    size_t length,
+    uint32_t id,
+    SolanaRpcReply* reply) {
+    size_t index = solana_rpc_json_skip_space(json, 0, length);
+    if(index < length && json[index] == '{') {
+        index = solana_rpc_json_parse_reply(json, index, length, reply);
+        return index != SIZE_MAX && reply->id == id && reply->value;
+    }
+    if(index >= length || json[index++] != '[') {
+        return false;
+    }
+
+    while(true) {
+        index = solana_rpc_json_parse_reply(json, index, length, reply);
+        if(index == SIZE_MAX) {
+            return false;
+        }
+        if(reply->id == id) {
+            return reply->value != NULL;
+        }
+        index = solana_rpc_json_skip_space(json, index, length);
+        if(index >= length || json[index++] != ',') {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief      Hand every call of a finished batch its result, then release the batch.
+ * @details    Runs on the link worker thread.  One call is taken off the table at a time and
+ *            its waiters run without the lock held, so they may start new queries.
+*/
+static void solana_rpc_batch_complete(SolanaRpcBatch* batch, bool ok) {
+    SolanaRpc* rpc = batch->rpc;
+    uint8_t batch_index = batch - rpc->batches;
+
+    if(ok && batch->overflow) {
+        FURI_LOG_E(TAG, "Response longer than %u bytes", SOLANA_RPC_RESPONSE_SIZE);
+        ok = false;
+    }
+
+    while(true) {
+        SolanaRpcWaiter waiters[SOLANA_RPC_MAX_WAITERS];
+        uint8_t waiter_count = 0;
+        SolanaRpcStatus status = SolanaRpcStatusFailed;
+        SolanaRpcReply reply = {0};
+
+        furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+        for(size_t i = 0; i < SOLANA_RPC_MAX_CALLS; i++) {
+            SolanaRpcCall* call = &rpc->calls[i];
+            if(call->state != SolanaRpcCallSent || call->batch != batch_index) {
+                continue;
+            }
+
+            if(ok && solana_rpc_json_find_reply(batch->buffer, batch->length, call->id, &reply)) {
+                status = reply.error ? SolanaRpcStatusError : SolanaRpcStatusOk;
+                if(status == SolanaRpcStatusOk) {
+                    solana_rpc_cache_store(rpc, call, reply.value, reply.length);
+                }
+            } else if(ok) {
+                FURI_LOG_W(TAG, "No reply for id %u", call->id);
+            }
+
+            waiter_count = call->waiter_count;
+            memcpy(waiters, call->waiters, waiter_count * sizeof(SolanaRpcWaiter));
+            call->state = SolanaRpcCallFree;
+            break;
+        }
+        if(!waiter_count) {
+            batch->used = false;
+        }
+        furi_mutex_release(rpc->mutex);
+
+        if(!waiter_count) {
+            break;
+        }
+        for(size_t i = 0; i < waiter_count; i++) {
+            waiters[i].callback(
+                status,
+                status == SolanaRpcStatusFailed ? NULL : reply.value,
+                status == SolanaRpcStatusFailed ? 0 : reply.length,
+                waiters[i].context);
+        }
+    }
+
+    // Queries that found no free batch are still waiting.
+    solana_rpc_flush(rpc);
+}
+
+static void solana_rpc_link_callback(
+    SolanaLinkResult result,
+    const uint8_t* data,
+    size_t size,
+    void* context) {
+    SolanaRpcBatch* batch = context;
+
+    switch(result) {
+    case SolanaLinkResultChunk:
+    case SolanaLinkResultOk:
+        if(batch->length + size > SOLANA_RPC_RESPONSE_SIZE) {
+            batch->overflow = true;
+        } else {
+            memcpy(batch->buffer + batch->length, data, size);
+            batch->length += size;
+        }
+        if(result == SolanaLinkResultOk) {
+            solana_rpc_batch_complete(batch, true);
+        }
+        break;
+    case SolanaLinkResultRetry:
+        batch->length = 0;
+        batch->overflow = false;
+        break;
+    default:
+        FURI_LOG_W(TAG, "Batch failed: %d", result);
+        solana_rpc_batch_complete(batch, false);
+        break;
+    }
+}
+
+/**
+ * @brief      Pack queued calls into batches and hand them to the link.
+ * @details    A batch of one goes out as a plain request object.  Calls that do not fit in a
+ *            frame, or find every batch busy, stay queued for the next flush.
+*/
+static void solana_rpc_flush(SolanaRpc* rpc) {
+    bool retry = false;
+
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+    for(size_t b = 0; b < SOLANA_RPC_MAX_BATCHES; b++) {
+        SolanaRpcBatch* batch = &rpc->batches[b];
+        if(batch->used) {
+            continue;
+        }
+
+        // Leave room for the command byte and the closing bracket.
+        const size_t limit = SOLANA_LINK_MAX_PAYLOAD - 2;
+        size_t length = 1;
+        size_t count = 0;
+        size_t first = 0;
+        batch->buffer[0] = '[';
+        for(size_t i = 0; i < SOLANA_RPC_MAX_CALLS; i++) {
+            SolanaRpcCall* call = &rpc->calls[i];
+            if(call->state != SolanaRpcCallQueued) {
+                continue;
+            }
+
+            const char* params = strchr(call->key, '\x1f') + 1;
+            int written = snprintf(
+                batch->buffer + length,
+                limit - length,
+                "%s{\"jsonrpc\":\"2.0\",\"id\":%u,\"method\":\"%.*s\"%s%s}",
+                count ? "," : "",
+                call->id,
+                (int)(params - 1 - call->key),
+                call->key,
+                *params ? ",\"params\":" : "",
+                params);
+            if(written < 0 || (size_t)written >= limit - length) {
+                continue;
+            }
+            if(!count) {
+                first = length;
+            }
+            length += written;
+            count++;
+            call->state = SolanaRpcCallSent;
+            call->batch = b;
+        }
+        if(!count) {
+            break;
+        }
+
+        const char* body = batch->buffer;
+        if(count == 1) {
+            body += first;
+            length -= first;
+        } else {
+            batch->buffer[length++] = ']';
+        }
+
+        batch->used = true;
+        batch->overflow = false;
+        batch->length = 0;
+        batch->link_id = solana_link_request(
+            rpc->link,
+            SolanaLinkCommandRpc,
+            (const uint8_t*)body,
+            length,
+            SOLANA_RPC_TIMEOUT,
+            solana_rpc_link_callback,
+            batch);
+        if(batch->link_id) {
+            FURI_LOG_D(TAG, "Sent batch of %zu", count);
+            continue;
+        }
+
+        // Every link slot is taken, put the calls back and try again after the window.
+        batch->used = false;
+        for(size_t i = 0; i < SOLANA_RPC_MAX_CALLS; i++) {
+            SolanaRpcCall* call = &rpc->calls[i];
+            if(call->state == SolanaRpcCallSent && call->batch == b) {
+                call->state = SolanaRpcCallQueued;
+            }
+        }
+        retry = true;
+        break;
+    }
+    furi_mutex_release(rpc->mutex);
+
+    if(retry) {
+        furi_timer_start(rpc->timer, furi_ms_to_ticks(SOLANA_RPC_BATCH_WINDOW));
+    }
+}
+
+static void solana_rpc_stream_json_callback(const SolanaJsonEvent* event, void* context) {
+    SolanaRpcStream* stream = context;
+    stream->callback(SolanaRpcStreamEvent, event, stream->context);
+}
+
+static void solana_rpc_stream_end(SolanaRpcStream* stream, SolanaRpcStreamStatus status) {
+    stream->callback(status, NULL, stream->context);
+    furi_mutex_acquire(stream->rpc->mutex, FuriWaitForever);
+    stream->used = false;
+    furi_mutex_release(stream->rpc->mutex);
+}
+
+static void solana_rpc_stream_link_callback(
+    SolanaLinkResult result,
+    const uint8_t* data,
+    size_t size,
+    void* context) {
+    SolanaRpcStream* stream = context;
+
+    switch(result) {
+    case SolanaLinkResultChunk:
+    case SolanaLinkResultOk:
+        if(!stream->failed &&
+           solana_json_feed(&stream->json, (const char*)data, size) == SolanaJsonStatusError) {
+            FURI_LOG_E(TAG, "Bad response: %d", solana_json_get_error(&stream->json));
+            stream->failed = true;
+        }
+        if(result == SolanaLinkResultOk) {
+            bool done = !stream->failed &&
+                        solana_json_finish(&stream->json) == SolanaJsonStatusDone;
+            solana_rpc_stream_end(stream, done ? SolanaRpcStreamDone : SolanaRpcStreamFailed);
+        }
+        break;
+    case SolanaLinkResultRetry:
+        solana_json_reset(&stream->json);
+        stream->failed = false;
+        stream->callback(SolanaRpcStreamRestart, NULL, stream->context);
+        break;
+    default:
+        FURI_LOG_W(TAG, "Stream failed: %d", result);
+        solana_rpc_stream_end(stream, SolanaRpcStreamFailed);
+        break;
+    }
+}
+
+static void solana_rpc_timer_callback(void* context) {
+    solana_rpc_flush(context);
+}
+
+SolanaRpc* solana_rpc_alloc(SolanaLink* link) {
+    SolanaRpc* rpc = malloc(sizeof(SolanaRpc));
+    memset(rpc, 0, sizeof(SolanaRpc));
+    rpc->link = link;
+    rpc->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    rpc->timer = furi_timer_alloc(solana_rpc_timer_callback, FuriTimerTypeOnce, rpc);
+    rpc->next_id = 1;
+    rpc->balance_ttl = SOLANA_RPC_TTL_BALANCE;
+    for(size_t i = 0; i < SOLANA_RPC_MAX_BATCHES; i++) {
+        rpc->batches[i].rpc = rpc;
+    }
+    for(size_t i = 0; i < SOLANA_RPC_MAX_STREAMS; i++) {
+        rpc->streams[i].rpc = rpc;
+    }
+    return rpc;
+}
+
+void solana_rpc_free(SolanaRpc* rpc) {
+    furi_timer_stop(rpc->timer);
+    furi_timer_free(rpc->timer);
+
+    // Batches and streams on the link finish through their callbacks on the worker thread.
+    while(true) {
+        bool busy = false;
+        furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+        for(size_t i = 0; i < SOLANA_RPC_MAX_BATCHES; i++) {
+            if(rpc->batches[i].used) {
+                solana_link_cancel(rpc->link, rpc->batches[i].link_id);
+                busy = true;
+            }
+        }
+        for(size_t i = 0; i < SOLANA_RPC_MAX_STREAMS; i++) {
+            if(rpc->streams[i].used) {
+                solana_link_cancel(rpc->link, rpc->streams[i].link_id);
+                busy = true;
+            }
+        }
+        furi_mutex_release(rpc->mutex);
+        if(!busy) {
+            break;
+        }
+        furi_delay_ms(5);
+    }
+
+    for(size_t i = 0; i < SOLANA_RPC_MAX_CALLS; i++) {
+        SolanaRpcCall* call = &rpc->calls[i];
+        for(size_t w = 0; call->state != SolanaRpcCallFree && w < call->waiter_count; w++) {
+            call->waiters[w].callback(SolanaRpcStatusFailed, NULL, 0, call->waiters[w].context);
+        }
+    }
+
+    furi_mutex_free(rpc->mutex);
+    free(rpc);
+}
+
+SolanaRpcQuery solana_rpc_query(
+    SolanaRpc* rpc,
+    const char* method,
+    const char* params,
+    uint32_t ttl_ms,
+    SolanaRpcCallback callback,
+    void* context) {
+    furi_assert(callback);
+    char key[SOLANA_RPC_KEY_SIZE];
+    if(!params) {
+        params = "";
+    }
+    if(strlen(method) >= SOLANA_RPC_METHOD_SIZE ||
+       snprintf(key, sizeof(key), "%s\x1f%s", method, params) >= (int)sizeof(key)) {
+        FURI_LOG_E(TAG, "Query too long: %s", method);
+        return SolanaRpcQueryBusy;
+    }
+    uint32_t hash = solana_rpc_hash(key);
+
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+
+    SolanaRpcCacheEntry* entry = solana_rpc_cache_find(rpc, hash, key);
+    if(entry) {
+        // Copy out so the callback can run without the lock.
+        char value[SOLANA_RPC_VALUE_SIZE];
+        size_t length = entry->length;
+        memcpy(value, entry->value, length);
+        furi_mutex_release(rpc->mutex);
+        callback(SolanaRpcStatusOk, value, length, context);
+        return SolanaRpcQueryCached;
+    }
+
+    SolanaRpcCall* call = NULL;
+    SolanaRpcCall* free_call = NULL;
+    for(size_t i = 0; i < SOLANA_RPC_MAX_CALLS; i++) {
+        SolanaRpcCall* candidate = &rpc->calls[i];
+        if(candidate->state == SolanaRpcCallFree) {
+            free_call = free_call ? free_call : candidate;
+        } else if(candidate->hash == hash && strcmp(candidate->key, key) == 0) {
+            call = candidate;
+            break;
+        }
+    }
+
+    SolanaRpcQuery query = SolanaRpcQueryPending;
+    bool start_window = false;
+    if(call) {
+        // Same query already outstanding, share its answer.
+        if(call->waiter_count < SOLANA_RPC_MAX_WAITERS) {
+            call->waiters[call->waiter_count++] = (SolanaRpcWaiter){callback, context};
+            call->ttl = MAX(call->ttl, furi_ms_to_ticks(ttl_ms));
+        } else {
+            query = SolanaRpcQueryBusy;
+        }
+    } else if(free_call) {
+        call = free_call;
+        call->state = SolanaRpcCallQueued;
+        call->id = rpc->next_id++;
+        if(rpc->next_id == 0) {
+            rpc->next_id = 1;
+        }
+        call->hash = hash;
+        call->ttl = furi_ms_to_ticks(ttl_ms);
+        strcpy(call->key, key);
+        call->waiter_count = 1;
+        call->waiters[0] = (SolanaRpcWaiter){callback, context};
+        start_window = !furi_timer_is_running(rpc->timer);
+    } else {
+        query = SolanaRpcQueryBusy;
+    }
+
+    furi_mutex_release(rpc->mutex);
+
+    if(start_window) {
+        furi_timer_start(rpc->timer, furi_ms_to_ticks(SOLANA_RPC_BATCH_WINDOW));
+    }
+    return query;
+}
+
+SolanaRpcQuery solana_rpc_stream(
+    SolanaRpc* rpc,
+    const char* method,
+    const char* params,
+    const char* const* selectors,
+    size_t selector_count,
+    SolanaRpcStreamCallback callback,
+    void* context) {
+    furi_assert(callback);
+    char body[SOLANA_RPC_METHOD_SIZE + SOLANA_RPC_PARAMS_SIZE + 64];
+    int length = snprintf(
+        body,
+        sizeof(body),
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"%s\"%s%s}",
+        method,
+        params ? ",\"params\":" : "",
+        params ? params : "");
+    if(length < 0 || (size_t)length >= sizeof(body)) {
+        FURI_LOG_E(TAG, "Query too long: %s", method);
+        return SolanaRpcQueryBusy;
+    }
+
+    SolanaRpcStream* stream = NULL;
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+    for(size_t i = 0; i < SOLANA_RPC_MAX_STREAMS; i++) {
+        if(!rpc->streams[i].used) {
+            stream = &rpc->streams[i];
+            break;
+        }
+    }
+    if(stream) {
+        stream->used = true;
+        stream->failed = false;
+        stream->callback = callback;
+        stream->context = context;
+        solana_json_init(
+            &stream->json, selectors, selector_count, solana_rpc_stream_json_callback, stream);
+        stream->link_id = solana_link_request(
+            rpc->link,
+            SolanaLinkCommandRpc,
+            (const uint8_t*)body,
+            length,
+            SOLANA_RPC_TIMEOUT,
+            solana_rpc_stream_link_callback,
+            stream);
+        if(!stream->link_id) {
+            stream->used = false;
+            stream = NULL;
+        }
+    }
+    furi_mutex_release(rpc->mutex);
+
+    return stream ? SolanaRpcQueryPending : SolanaRpcQueryBusy;
+}
+
+void solana_rpc_invalidate(SolanaRpc* rpc) {
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+    for(size_t i = 0; i < SOLANA_RPC_CACHE_SIZE; i++) {
+        rpc->cache[i].used = false;
+    }
+    furi_mutex_release(rpc->mutex);
+}
+
+void solana_rpc_set_balance_ttl(SolanaRpc* rpc, uint32_t ttl_ms) {
+    rpc->balance_ttl = ttl_ms;
+}
+
+SolanaRpcQuery solana_rpc_get_balance(
+    SolanaRpc* rpc,
+    const char* address,
+    SolanaRpcCallback callback,
+    void* context) {
+    char params[SOLANA_RPC_PARAMS_SIZE];
+    snprintf(params, sizeof(params), "[\"%s\"]", address);
+    return solana_rpc_query(rpc, "getBalance", params, rpc->balance_ttl, callback, context);
+}
+
+SolanaRpcQuery
+    solana_rpc_get_latest_blockhash(SolanaRpc* rpc, SolanaRpcCallback callback, void* context) {
+    return solana_rpc_query(
+        rpc, "getLatestBlockhash", NULL, SOLANA_RPC_TTL_BLOCKHASH, callback, context);
+}
+
+SolanaRpcQuery solana_rpc_get_account_info(
+    SolanaRpc* rpc,
+    const char* address,
+    SolanaRpcCallback callback,
+    void* context) {
+    char params[SOLANA_RPC_PARAMS_SIZE];
+    snprintf(params, sizeof(params), "[\"%s\",{\"encoding\":\"base64\"}]", address);
+    return solana_rpc_query(
+        rpc, "getAccountInfo", params, SOLANA_RPC_TTL_ACCOUNT, callback, context);
+}
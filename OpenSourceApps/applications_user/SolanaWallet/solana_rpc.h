@@ -0,0 +1,125 @@
+#ifndef SOLANA_RPC_H
+#define SOLANA_RPC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "solana_json.h"
+#include "solana_link.h"
+
+#define SOLANA_RPC_CACHE_SIZE      8 // Cached results
+#define SOLANA_RPC_MAX_CALLS       8 // Distinct queries queued or in flight
+#define SOLANA_RPC_MAX_WAITERS     4 // Callers sharing one in flight query
+#define SOLANA_RPC_MAX_BATCHES     2 // JSON-RPC batches in flight on the link
+#define SOLANA_RPC_MAX_STREAMS     1 // Streamed queries in flight on the link
+#define SOLANA_RPC_METHOD_SIZE     32
+#define SOLANA_RPC_PARAMS_SIZE     96
+#define SOLANA_RPC_VALUE_SIZE      192 // Larger results are delivered but not cached
+#define SOLANA_RPC_RESPONSE_SIZE   1536
+#define SOLANA_RPC_BATCH_WINDOW    20 // ms to wait for more queries before sending a batch
+#define SOLANA_RPC_TIMEOUT         3000 // ms per link attempt
+#define SOLANA_RPC_TTL_BLOCKHASH   30000
+#define SOLANA_RPC_TTL_BALANCE     10000 // Default, see solana_rpc_set_balance_ttl()
+#define SOLANA_RPC_TTL_ACCOUNT     5000
+
+typedef enum {
+    SolanaRpcStatusOk, // result holds the JSON text of the "result" member
+    SolanaRpcStatusError, // result holds the JSON text of the "error" member
+    SolanaRpcStatusFailed, // No usable answer: link failure, timeout or malformed response
+} SolanaRpcStatus;
+
+typedef enum {
+    SolanaRpcQueryCached, // Answered from the cache, the callback already ran
+    SolanaRpcQueryPending, // Queued or joined an identical query in flight
+    SolanaRpcQueryBusy, // No room for another query, try again later
+} SolanaRpcQuery;
+
+/**
+ * Called with the result of a query.  result is not NUL terminated and is only valid during
+ * the call.  Fresh results arrive on the link worker thread, cached ones on the caller's thread.
+ */
+typedef void (*SolanaRpcCallback)(
+    SolanaRpcStatus status,
+    const char* result,
+    size_t length,
+    void* context);
+
+typedef enum {
+    SolanaRpcStreamEvent, // event holds a selected value
+    SolanaRpcStreamRestart, // The response is being resent, forget the events so far
+    SolanaRpcStreamDone, // Last call for this query
+    SolanaRpcStreamFailed, // Last call for this query
+} SolanaRpcStreamStatus;
+
+/**
+ * Called on the link worker thread for each selected value of a streamed response.  event is
+ * NULL unless status is SolanaRpcStreamEvent.
+ */
+typedef void (*SolanaRpcStreamCallback)(
+    SolanaRpcStreamStatus status,
+    const SolanaJsonEvent* event,
+    void* context);
+
+typedef struct SolanaRpc SolanaRpc;
+
+SolanaRpc* solana_rpc_alloc(SolanaLink* link);
+
+/**
+ * @brief      Free the client.  Outstanding queries get SolanaRpcStatusFailed.
+*/
+void solana_rpc_free(SolanaRpc* rpc);
+
+/**
+ * @brief      Run a JSON-RPC query through the cache.
+ * @details    method and params (a JSON array, or NULL for none) together form the cache key.
+ *            Queries made within SOLANA_RPC_BATCH_WINDOW of each other go out as one batch.
+ * @param      ttl_ms   How long the result may be served from the cache, 0 to not cache it.
+*/
+SolanaRpcQuery solana_rpc_query(
+    SolanaRpc* rpc,
+    const char* method,
+    const char* params,
+    uint32_t ttl_ms,
+    SolanaRpcCallback callback,
+    void* context);
+
+/**
+ * @brief      Run a query whose response is too large to hold, such as getAccountInfo with data
+ *            or getSignaturesForAddress.
+ * @details    The response is parsed as it arrives and only the values picked by selectors
+ *            (see solana_json.h, paths start at the response root, e.g. "result.value.lamports"
+ *            and "error.message") are passed on.  Streamed queries are never cached or batched.
+ *            selectors must stay valid until the final callback.
+*/
+SolanaRpcQuery solana_rpc_stream(
+    SolanaRpc* rpc,
+    const char* method,
+    const char* params,
+    const char* const* selectors,
+    size_t selector_count,
+    SolanaRpcStreamCallback callback,
+    void* context);
+
+/**
+ * @brief      Drop every cached result, for example after sending a transaction.
+*/
+void solana_rpc_invalidate(SolanaRpc* rpc);
+
+void solana_rpc_set_balance_ttl(SolanaRpc* rpc, uint32_t ttl_ms);
+
+SolanaRpcQuery solana_rpc_get_balance(
+    SolanaRpc* rpc,
+    const char* address,
+    SolanaRpcCallback callback,
+    void* context);
+
+SolanaRpcQuery
+    solana_rpc_get_latest_blockhash(SolanaRpc* rpc, SolanaRpcCallback callback, void* context);
+
+SolanaRpcQuery solana_rpc_get_account_info(
+    SolanaRpc* rpc,
+    const char* address,
+    SolanaRpcCallback callback,
+    void* context);
+
+#endif // SOLANA_RPC_H
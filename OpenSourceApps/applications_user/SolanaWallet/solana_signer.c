@@ -0,0 +1,159 @@
+#include "solana_signer.h"
+#include <furi.h>
+#include <storage/storage.h>
+
+#define TAG "SolanaSigner"
+
+#define SOLANA_SIGNER_SPILL_PATH APP_DATA_PATH("sign_spill.bin")
+
+struct SolanaSigner {
+    Ed25519SignStream stream;
+    SolanaSignerReplay replay;
+    SolanaSignerStatus status;
+    uint8_t signature[ED25519_SIGNATURE_SIZE];
+
+    Storage* storage; // Only opened in spill mode
+    File* spill;
+};
+
+SolanaSigner*
+    solana_signer_alloc(const uint8_t seed[ED25519_SEED_SIZE], SolanaSignerReplay replay) {
+    SolanaSigner* signer = (SolanaSigner*)malloc(sizeof(SolanaSigner));
+    memset(signer, 0, sizeof(SolanaSigner));
+    signer->replay = replay;
+    signer->status = SolanaSignerStatusFirstPass;
+    ed25519_sign_stream_init(&signer->stream, seed);
+
+    if(replay == SolanaSignerReplaySpill) {
+        signer->storage = furi_record_open(RECORD_STORAGE);
+        signer->spill = storage_file_alloc(signer->storage);
+        if(!storage_file_open(
+               signer->spill, SOLANA_SIGNER_SPILL_PATH, FSAM_READ_WRITE, FSOM_CREATE_ALWAYS)) {
+            FURI_LOG_E(TAG, "Failed to open spill file");
+            signer->status = SolanaSignerStatusError;
+        }
+    }
+
+    return signer;
+}
+
+static void solana_signer_close_spill(SolanaSigner* signer) {
+    if(!signer->storage) {
+        return;
+    }
+    storage_file_close(signer->spill);
+    storage_file_free(signer->spill);
+    storage_simply_remove(signer->storage, SOLANA_SIGNER_SPILL_PATH);
+    furi_record_close(RECORD_STORAGE);
+    signer->spill = NULL;
+    signer->storage = NULL;
+}
+
+void solana_signer_free(SolanaSigner* signer) {
+    solana_signer_close_spill(signer);
+    ed25519_sign_stream_abort(&signer->stream);
+    memset(signer, 0, sizeof(SolanaSigner));
+    free(signer);
+}
+
+static void solana_signer_fail(SolanaSigner* signer) {
+    ed25519_sign_stream_abort(&signer->stream);
+    solana_signer_close_spill(signer);
+    signer->status = SolanaSignerStatusError;
+}
+
+bool solana_signer_write(SolanaSigner* signer, const uint8_t* data, size_t size) {
+    if(signer->status != SolanaSignerStatusFirstPass &&
+       signer->status != SolanaSignerStatusSecondPass) {
+        return false;
+    }
+
+    if(signer->status == SolanaSignerStatusFirstPass && signer->spill) {
+        if(storage_file_write(signer->spill, data, size) != size) {
+            FURI_LOG_E(TAG, "Spill write failed");
+            solana_signer_fail(signer);
+            return false;
+        }
+    }
+
+    ed25519_sign_stream_update(&signer->stream, data, size);
+    return true;
+}
+
+/**
+ * @brief      Stream the spilled message back through the second pass.
+*/
+static bool solana_signer_replay_spill(SolanaSigner* signer) {
+    if(!storage_file_seek(signer->spill, 0, true)) {
+        return false;
+    }
+
+    uint8_t* chunk = malloc(SOLANA_SIGNER_SPILL_CHUNK);
+    bool ok = true;
+    uint64_t remaining = signer->stream.length;
+    while(remaining > 0) {
+        size_t want = SOLANA_SIGNER_SPILL_CHUNK;
+        if(remaining < want) {
+            want = remaining;
+        }
+        size_t read = storage_file_read(signer->spill, chunk, want);
+        if(read == 0) {
+            ok = false;
+            break;
+        }
+        ed25519_sign_stream_update(&signer->stream, chunk, read);
+        remaining -= read;
+    }
+    memset(chunk, 0, SOLANA_SIGNER_SPILL_CHUNK);
+    free(chunk);
+
+    return ok;
+}
+
+static SolanaSignerStatus solana_signer_finish(SolanaSigner* signer) {
+    if(ed25519_sign_stream_final(&signer->stream, signer->signature)) {
+        signer->status = SolanaSignerStatusDone;
+    } else {
+        FURI_LOG_W(TAG, "Second pass did not match the first");
+        signer->status = SolanaSignerStatusError;
+    }
+    solana_signer_close_spill(signer);
+    return signer->status;
+}
+
+SolanaSignerStatus solana_signer_end_pass(SolanaSigner* signer) {
+    if(signer->status == SolanaSignerStatusSecondPass) {
+        return solana_signer_finish(signer);
+    }
+    if(signer->status != SolanaSignerStatusFirstPass) {
+        return signer->status;
+    }
+
+    ed25519_sign_stream_next_pass(&signer->stream);
+    if(signer->replay == SolanaSignerReplayHost) {
+        // The next bytes written belong to the repeated message.
+        signer->status = SolanaSignerStatusSecondPass;
+        return SolanaSignerStatusNeedSecondPass;
+    }
+
+    if(!solana_signer_replay_spill(signer)) {
+        FURI_LOG_E(TAG, "Spill replay failed");
+        solana_signer_fail(signer);
+        return signer->status;
+    }
+    return solana_signer_finish(signer);
+}
+
+SolanaSignerStatus solana_signer_get_status(const SolanaSigner* signer) {
+    return signer->status;
+}
+
+bool solana_signer_get_signature(
+    const SolanaSigner* signer,
+    uint8_t signature[ED25519_SIGNATURE_SIZE]) {
+    if(signer->status != SolanaSignerStatusDone) {
+        return false;
+    }
+    memcpy(signature, signer->signature, ED25519_SIGNATURE_SIZE);
+    return true;
+}
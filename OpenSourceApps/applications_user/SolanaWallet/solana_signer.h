@@ -0,0 +1,64 @@
+#ifndef SOLANA_SIGNER_H
+#define SOLANA_SIGNER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ed25519.h"
+
+// Bytes read back from the SD card per step when replaying a spilled message.
+#define SOLANA_SIGNER_SPILL_CHUNK 256
+
+typedef enum {
+    SolanaSignerReplayHost, // The host sends the message again for the second pass
+    SolanaSignerReplaySpill, // The first pass is spilled to SD and replayed from there
+} SolanaSignerReplay;
+
+typedef enum {
+    SolanaSignerStatusFirstPass, // Waiting for message bytes
+    SolanaSignerStatusNeedSecondPass, // Returned by end_pass: ask the host to send it again
+    SolanaSignerStatusSecondPass, // Waiting for the repeated message bytes
+    SolanaSignerStatusDone, // Signature is ready
+    SolanaSignerStatusError, // Storage failed or the passes did not match
+} SolanaSignerStatus;
+
+typedef struct SolanaSigner SolanaSigner;
+
+/**
+ * @brief      Allocate a signer for one message.
+ * @details    Peak RAM is the Ed25519 stream state plus, in spill mode, one
+ *            SOLANA_SIGNER_SPILL_CHUNK buffer, no matter how long the message is.
+*/
+SolanaSigner*
+    solana_signer_alloc(const uint8_t seed[ED25519_SEED_SIZE], SolanaSignerReplay replay);
+
+/**
+ * @brief      Free the signer, wiping key material and removing any spill file.
+*/
+void solana_signer_free(SolanaSigner* signer);
+
+/**
+ * @brief      Feed the next chunk of the message in the current pass.
+ * @return     false if the signer is not accepting bytes or the spill write failed.
+*/
+bool solana_signer_write(SolanaSigner* signer, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Mark the end of the message for the current pass.
+ * @details    In spill mode the end of the first pass replays the message from SD and
+ *            finishes the signature straight away.
+ * @return     the new status.
+*/
+SolanaSignerStatus solana_signer_end_pass(SolanaSigner* signer);
+
+SolanaSignerStatus solana_signer_get_status(const SolanaSigner* signer);
+
+/**
+ * @brief      Copy out the signature.
+ * @return     false unless the status is SolanaSignerStatusDone.
+*/
+bool solana_signer_get_signature(
+    const SolanaSigner* signer,
+    uint8_t signature[ED25519_SIGNATURE_SIZE]);
+
+#endif // SOLANA_SIGNER_H
@@ -0,0 +1,510 @@
+#include "solana_tx.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Account indexes are a single byte on the wire.
+#define SOLANA_TX_MAX_ACCOUNTS 256
+
+typedef enum {
+    SolanaTxStateSignatureCount,
+    SolanaTxStateSignature,
+    SolanaTxStateMessagePrefix,
+    SolanaTxStateHeader,
+    SolanaTxStateAccountKeyCount,
+    SolanaTxStateAccountKey,
+    SolanaTxStateBlockhash,
+    SolanaTxStateInstructionCount,
+    SolanaTxStateInstructionProgram,
+    SolanaTxStateInstructionAccountCount,
+    SolanaTxStateInstructionAccounts,
+    SolanaTxStateInstructionDataLength,
+    SolanaTxStateInstructionData,
+    SolanaTxStateLookupCount,
+    SolanaTxStateLookupTable,
+    SolanaTxStateLookupWritableCount,
+    SolanaTxStateLookupWritable,
+    SolanaTxStateLookupReadonlyCount,
+    SolanaTxStateLookupReadonly,
+    SolanaTxStateDone,
+    SolanaTxStateError,
+} SolanaTxState;
+
+typedef enum {
+    SolanaTxReadNeedMore,
+    SolanaTxReadOk,
+    SolanaTxReadBad,
+} SolanaTxRead;
+
+struct SolanaTxParser {
+    uint8_t* ring;
+    uint32_t mask;
+    uint32_t head; // Stream offset of the next byte to be written
+    uint32_t tail; // Stream offset of the next byte to be parsed
+    uint32_t released; // Bytes before this offset are no longer referenced by a view
+    bool finished;
+
+    SolanaTxState state;
+    SolanaTxError error;
+    SolanaTxHeader header;
+
+    uint16_t num_signatures;
+    uint16_t num_lookups;
+    uint16_t num_lookup_indexes; // Accounts loaded through lookup tables (v0 only)
+    uint16_t max_account_index; // Highest account index used by an instruction, plus one
+
+    uint16_t item; // Number of the signature, key, instruction or lookup being parsed
+    uint16_t remaining; // Bytes left in the variable length field being parsed
+    uint16_t total; // Full length of that field
+
+    uint32_t compact_value;
+    uint8_t compact_shift;
+};
+
+SolanaTxParser* solana_tx_parser_alloc(uint8_t* ring, size_t ring_size) {
+    if(ring_size < SOLANA_TX_RING_MIN_SIZE || (ring_size & (ring_size - 1)) != 0) {
+        return NULL;
+    }
+
+    SolanaTxParser* parser = (SolanaTxParser*)malloc(sizeof(SolanaTxParser));
+    parser->ring = ring;
+    parser->mask = ring_size - 1;
+    solana_tx_parser_reset(parser);
+    return parser;
+}
+
+void solana_tx_parser_free(SolanaTxParser* parser) {
+    free(parser);
+}
+
+void solana_tx_parser_reset(SolanaTxParser* parser) {
+    uint8_t* ring = parser->ring;
+    uint32_t mask = parser->mask;
+    memset(parser, 0, sizeof(SolanaTxParser));
+    parser->ring = ring;
+    parser->mask = mask;
+    parser->state = SolanaTxStateSignatureCount;
+}
+
+static void solana_tx_parser_fail(SolanaTxParser* parser, SolanaTxError error) {
+    if(parser->state != SolanaTxStateError) {
+        parser->error = error;
+        parser->state = SolanaTxStateError;
+    }
+}
+
+size_t solana_tx_parser_write(SolanaTxParser* parser, const uint8_t* data, size_t size) {
+    if(parser->finished || parser->state == SolanaTxStateError) {
+        return 0;
+    }
+
+    if(parser->head + size > SOLANA_TX_MAX_SIZE) {
+        // Nothing valid can follow, so swallow the input and report it on the next poll.
+        solana_tx_parser_fail(parser, SolanaTxErrorTooLarge);
+        return size;
+    }
+
+    size_t space = (parser->mask + 1) - (parser->head - parser->released);
+    if(size > space) {
+        size = space;
+    }
+
+    for(size_t i = 0; i < size;) {
+        uint32_t at = (parser->head + i) & parser->mask;
+        size_t chunk = parser->mask + 1 - at;
+        if(chunk > size - i) {
+            chunk = size - i;
+        }
+        memcpy(parser->ring + at, data + i, chunk);
+        i += chunk;
+    }
+    parser->head += size;
+
+    return size;
+}
+
+void solana_tx_parser_finish(SolanaTxParser* parser) {
+    parser->finished = true;
+}
+
+const SolanaTxHeader* solana_tx_parser_get_header(const SolanaTxParser* parser) {
+    return &parser->header;
+}
+
+SolanaTxError solana_tx_parser_get_error(const SolanaTxParser* parser) {
+    return parser->error;
+}
+
+const uint8_t*
+    solana_tx_parser_view_ptr(const SolanaTxParser* parser, SolanaTxView view, size_t* contiguous) {
+    uint32_t at = view.offset & parser->mask;
+    size_t first = parser->mask + 1 - at;
+    if(contiguous) {
+        *contiguous = view.length < first ? view.length : first;
+    }
+    return parser->ring + at;
+}
+
+void solana_tx_parser_view_copy(const SolanaTxParser* parser, SolanaTxView view, uint8_t* out) {
+    size_t first;
+    const uint8_t* data = solana_tx_parser_view_ptr(parser, view, &first);
+    memcpy(out, data, first);
+    memcpy(out + first, parser->ring, view.length - first);
+}
+
+static inline uint32_t solana_tx_parser_available(const SolanaTxParser* parser) {
+    return parser->head - parser->tail;
+}
+
+static inline uint8_t solana_tx_parser_byte(const SolanaTxParser* parser, uint32_t offset) {
+    return parser->ring[offset & parser->mask];
+}
+
+/**
+ * @brief      Read a compact-u16 one byte at a time.
+ * @details    Rejects encodings longer than three bytes, values over 0xFFFF and encodings with
+ *            redundant trailing zero bytes, so every value has exactly one valid encoding.
+*/
+static SolanaTxRead solana_tx_parser_compact_u16(SolanaTxParser* parser, uint16_t* value) {
+    while(solana_tx_parser_available(parser) > 0) {
+        uint8_t byte = solana_tx_parser_byte(parser, parser->tail++);
+        uint8_t shift = parser->compact_shift;
+
+        if(shift == 14 && byte > 0x03) {
+            return SolanaTxReadBad;
+        }
+        if(shift > 0 && byte == 0) {
+            return SolanaTxReadBad;
+        }
+
+        parser->compact_value |= (uint32_t)(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0) {
+            *value = (uint16_t)parser->compact_value;
+            parser->compact_value = 0;
+            parser->compact_shift = 0;
+            return SolanaTxReadOk;
+        }
+        parser->compact_shift += 7;
+    }
+
+    return SolanaTxReadNeedMore;
+}
+
+static void solana_tx_parser_emit(
+    SolanaTxParser* parser,
+    SolanaTxEvent* event,
+    SolanaTxEventType type,
+    uint16_t length) {
+    event->type = type;
+    event->index = parser->item;
+    event->view.offset = (uint16_t)parser->tail;
+    event->view.length = length;
+    parser->tail += length;
+}
+
+/**
+ * @brief      Emit the next piece of a variable length byte field.
+ * @return     false if no bytes are available yet.
+*/
+static bool solana_tx_parser_fragment(
+    SolanaTxParser* parser,
+    SolanaTxEvent* event,
+    SolanaTxEventType type,
+    bool account_indexes) {
+    uint32_t length = solana_tx_parser_available(parser);
+    if(length == 0) {
+        return false;
+    }
+    if(length > parser->remaining) {
+        length = parser->remaining;
+    }
+
+    if(account_indexes) {
+        for(uint32_t i = 0; i < length; i++) {
+            uint16_t index = solana_tx_parser_byte(parser, parser->tail + i);
+            if(index + 1 > parser->max_account_index) {
+                parser->max_account_index = index + 1;
+            }
+        }
+    }
+
+    solana_tx_parser_emit(parser, event, type, (uint16_t)length);
+    event->value = parser->total;
+    parser->remaining -= length;
+    return true;
+}
+
+static void solana_tx_parser_next_instruction(SolanaTxParser* parser) {
+    parser->item++;
+    if(parser->item < parser->header.num_instructions) {
+        parser->state = SolanaTxStateInstructionProgram;
+    } else if(parser->header.versioned) {
+        parser->state = SolanaTxStateLookupCount;
+    } else {
+        parser->state = SolanaTxStateDone;
+    }
+}
+
+static void solana_tx_parser_next_lookup(SolanaTxParser* parser) {
+    parser->item++;
+    parser->state = parser->item < parser->num_lookups ? SolanaTxStateLookupTable :
+                                                         SolanaTxStateDone;
+}
+
+/**
+ * @brief      Check that every instruction account index resolves to an account.
+ * @details    Legacy messages can be checked as soon as an index is read.  Versioned messages can
+ *            also index into lookup tables that come after the instructions, so the check waits
+ *            until the end.
+*/
+static bool solana_tx_parser_indexes_valid(const SolanaTxParser* parser) {
+    uint32_t accounts = parser->header.num_account_keys;
+    if(parser->header.versioned && parser->state == SolanaTxStateDone) {
+        accounts += parser->num_lookup_indexes;
+    } else if(parser->header.versioned) {
+        accounts = SOLANA_TX_MAX_ACCOUNTS;
+    }
+    return parser->max_account_index <= accounts;
+}
+
+bool solana_tx_parser_poll(SolanaTxParser* parser, SolanaTxEvent* event) {
+    uint16_t value = 0;
+    SolanaTxRead read;
+
+    memset(event, 0, sizeof(SolanaTxEvent));
+    parser->released = parser->tail;
+
+    for(;;) {
+        read = SolanaTxReadNeedMore;
+        switch(parser->state) {
+        case SolanaTxStateSignatureCount:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            if(value == 0 || value > UINT8_MAX) {
+                solana_tx_parser_fail(parser, SolanaTxErrorHeader);
+                continue;
+            }
+            parser->num_signatures = value;
+            parser->item = 0;
+            parser->state = SolanaTxStateSignature;
+            continue;
+
+        case SolanaTxStateSignature:
+            if(solana_tx_parser_available(parser) < SOLANA_TX_SIGNATURE_SIZE) break;
+            solana_tx_parser_emit(parser, event, SolanaTxEventSignature, SOLANA_TX_SIGNATURE_SIZE);
+            if(++parser->item == parser->num_signatures) {
+                parser->state = SolanaTxStateMessagePrefix;
+            }
+            return true;
+
+        case SolanaTxStateMessagePrefix: {
+            if(solana_tx_parser_available(parser) < 1) break;
+            uint8_t prefix = solana_tx_parser_byte(parser, parser->tail);
+            parser->header.message_offset = (uint16_t)parser->tail;
+            if(prefix & 0x80) {
+                parser->header.versioned = true;
+                parser->header.version = prefix & 0x7F;
+                if(parser->header.version != 0) {
+                    solana_tx_parser_fail(parser, SolanaTxErrorVersion);
+                    continue;
+                }
+                parser->tail++;
+            }
+            parser->state = SolanaTxStateHeader;
+            continue;
+        }
+
+        case SolanaTxStateHeader:
+            if(solana_tx_parser_available(parser) < 3) break;
+            parser->header.num_required_signatures = solana_tx_parser_byte(parser, parser->tail);
+            parser->header.num_readonly_signed = solana_tx_parser_byte(parser, parser->tail + 1);
+            parser->header.num_readonly_unsigned = solana_tx_parser_byte(parser, parser->tail + 2);
+            parser->tail += 3;
+            // The fee payer is the first signer and must be writable.
+            if(parser->header.num_required_signatures != parser->num_signatures ||
+               parser->header.num_readonly_signed >= parser->header.num_required_signatures) {
+                solana_tx_parser_fail(parser, SolanaTxErrorHeader);
+                continue;
+            }
+            parser->state = SolanaTxStateAccountKeyCount;
+            continue;
+
+        case SolanaTxStateAccountKeyCount:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            if(value > SOLANA_TX_MAX_ACCOUNTS ||
+               value < (uint32_t)parser->header.num_required_signatures +
+                           parser->header.num_readonly_unsigned) {
+                solana_tx_parser_fail(parser, SolanaTxErrorHeader);
+                continue;
+            }
+            parser->header.num_account_keys = value;
+            parser->item = 0;
+            parser->state = SolanaTxStateAccountKey;
+            event->type = SolanaTxEventHeader;
+            return true;
+
+        case SolanaTxStateAccountKey:
+            if(solana_tx_parser_available(parser) < SOLANA_TX_PUBKEY_SIZE) break;
+            solana_tx_parser_emit(parser, event, SolanaTxEventAccountKey, SOLANA_TX_PUBKEY_SIZE);
+            if(++parser->item == parser->header.num_account_keys) {
+                parser->state = SolanaTxStateBlockhash;
+            }
+            return true;
+
+        case SolanaTxStateBlockhash:
+            if(solana_tx_parser_available(parser) < SOLANA_TX_HASH_SIZE) break;
+            solana_tx_parser_emit(parser, event, SolanaTxEventBlockhash, SOLANA_TX_HASH_SIZE);
+            parser->state = SolanaTxStateInstructionCount;
+            return true;
+
+        case SolanaTxStateInstructionCount:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            parser->header.num_instructions = value;
+            parser->item = UINT16_MAX;
+            solana_tx_parser_next_instruction(parser);
+            continue;
+
+        case SolanaTxStateInstructionProgram: {
+            if(solana_tx_parser_available(parser) < 1) break;
+            uint8_t program = solana_tx_parser_byte(parser, parser->tail++);
+            if(program + 1 > parser->max_account_index) {
+                parser->max_account_index = program + 1;
+            }
+            if(!solana_tx_parser_indexes_valid(parser)) {
+                solana_tx_parser_fail(parser, SolanaTxErrorIndex);
+                continue;
+            }
+            event->type = SolanaTxEventInstruction;
+            event->index = parser->item;
+            event->value = program;
+            parser->state = SolanaTxStateInstructionAccountCount;
+            return true;
+        }
+
+        case SolanaTxStateInstructionAccountCount:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            parser->remaining = parser->total = value;
+            parser->state = value ? SolanaTxStateInstructionAccounts :
+                                    SolanaTxStateInstructionDataLength;
+            continue;
+
+        case SolanaTxStateInstructionAccounts:
+            if(!solana_tx_parser_fragment(
+                   parser, event, SolanaTxEventInstructionAccounts, true)) {
+                break;
+            }
+            if(!solana_tx_parser_indexes_valid(parser)) {
+                solana_tx_parser_fail(parser, SolanaTxErrorIndex);
+                continue;
+            }
+            if(parser->remaining == 0) {
+                parser->state = SolanaTxStateInstructionDataLength;
+            }
+            return true;
+
+        case SolanaTxStateInstructionDataLength:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            parser->remaining = parser->total = value;
+            if(value) {
+                parser->state = SolanaTxStateInstructionData;
+            } else {
+                solana_tx_parser_next_instruction(parser);
+            }
+            continue;
+
+        case SolanaTxStateInstructionData:
+            if(!solana_tx_parser_fragment(parser, event, SolanaTxEventInstructionData, false)) {
+                break;
+            }
+            if(parser->remaining == 0) {
+                solana_tx_parser_next_instruction(parser);
+            }
+            return true;
+
+        case SolanaTxStateLookupCount:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            parser->num_lookups = value;
+            parser->item = UINT16_MAX;
+            solana_tx_parser_next_lookup(parser);
+            continue;
+
+        case SolanaTxStateLookupTable:
+            if(solana_tx_parser_available(parser) < SOLANA_TX_PUBKEY_SIZE) break;
+            solana_tx_parser_emit(parser, event, SolanaTxEventLookupTable, SOLANA_TX_PUBKEY_SIZE);
+            parser->state = SolanaTxStateLookupWritableCount;
+            return true;
+
+        case SolanaTxStateLookupWritableCount:
+        case SolanaTxStateLookupReadonlyCount:
+            read = solana_tx_parser_compact_u16(parser, &value);
+            if(read != SolanaTxReadOk) break;
+            if((uint32_t)parser->header.num_account_keys + parser->num_lookup_indexes + value >
+               SOLANA_TX_MAX_ACCOUNTS) {
+                solana_tx_parser_fail(parser, SolanaTxErrorIndex);
+                continue;
+            }
+            parser->num_lookup_indexes += value;
+            parser->remaining = parser->total = value;
+            if(parser->state == SolanaTxStateLookupWritableCount) {
+                parser->state = value ? SolanaTxStateLookupWritable :
+                                        SolanaTxStateLookupReadonlyCount;
+            } else if(value) {
+                parser->state = SolanaTxStateLookupReadonly;
+            } else {
+                solana_tx_parser_next_lookup(parser);
+            }
+            continue;
+
+        case SolanaTxStateLookupWritable:
+            if(!solana_tx_parser_fragment(parser, event, SolanaTxEventLookupWritable, false)) {
+                break;
+            }
+            if(parser->remaining == 0) {
+                parser->state = SolanaTxStateLookupReadonlyCount;
+            }
+            return true;
+
+        case SolanaTxStateLookupReadonly:
+            if(!solana_tx_parser_fragment(parser, event, SolanaTxEventLookupReadonly, false)) {
+                break;
+            }
+            if(parser->remaining == 0) {
+                solana_tx_parser_next_lookup(parser);
+            }
+            return true;
+
+        case SolanaTxStateDone:
+            if(!solana_tx_parser_indexes_valid(parser)) {
+                solana_tx_parser_fail(parser, SolanaTxErrorIndex);
+                continue;
+            }
+            if(solana_tx_parser_available(parser) > 0) {
+                solana_tx_parser_fail(parser, SolanaTxErrorTrailingData);
+                continue;
+            }
+            parser->header.message_length =
+                (uint16_t)(parser->tail - parser->header.message_offset);
+            event->type = SolanaTxEventDone;
+            return true;
+
+        case SolanaTxStateError:
+            event->type = SolanaTxEventError;
+            return true;
+        }
+
+        // Only reached when the current state is waiting for more bytes.
+        if(read == SolanaTxReadBad) {
+            solana_tx_parser_fail(parser, SolanaTxErrorCompactU16);
+            continue;
+        }
+        if(parser->finished) {
+            solana_tx_parser_fail(parser, SolanaTxErrorTruncated);
+            continue;
+        }
+        return false;
+    }
+}
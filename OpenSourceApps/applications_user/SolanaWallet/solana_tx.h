@@ -0,0 +1,132 @@
+#ifndef SOLANA_TX_H
+#define SOLANA_TX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest serialized transaction the cluster accepts (PACKET_DATA_SIZE).
+#define SOLANA_TX_MAX_SIZE 1232
+
+// Smallest ring we can work with: one signature must fit in it.
+#define SOLANA_TX_RING_MIN_SIZE 64
+
+#define SOLANA_TX_SIGNATURE_SIZE 64
+#define SOLANA_TX_PUBKEY_SIZE    32
+#define SOLANA_TX_HASH_SIZE      32
+
+/**
+ * A window into the parser ring buffer.
+ * @details offset is the absolute position in the transaction byte stream. Use
+ *          solana_tx_parser_view_ptr() or solana_tx_parser_view_copy() to reach the bytes.
+ */
+typedef struct {
+    uint16_t offset;
+    uint16_t length;
+} SolanaTxView;
+
+typedef enum {
+    SolanaTxEventNone, // Nothing to report yet, write more bytes
+    SolanaTxEventSignature, // view = 64 byte signature, index = signature number
+    SolanaTxEventHeader, // Message header parsed, see solana_tx_parser_get_header()
+    SolanaTxEventAccountKey, // view = 32 byte key, index = key number
+    SolanaTxEventBlockhash, // view = 32 byte recent blockhash
+    SolanaTxEventInstruction, // index = instruction number, value = program id index
+    SolanaTxEventInstructionAccounts, // view = fragment of account indexes
+    SolanaTxEventInstructionData, // view = fragment of data, value = total data length
+    SolanaTxEventLookupTable, // view = 32 byte table key, index = lookup number
+    SolanaTxEventLookupWritable, // view = fragment of writable indexes
+    SolanaTxEventLookupReadonly, // view = fragment of readonly indexes
+    SolanaTxEventDone, // Whole transaction parsed
+    SolanaTxEventError, // Malformed input, see solana_tx_parser_get_error()
+} SolanaTxEventType;
+
+typedef struct {
+    SolanaTxEventType type;
+    uint16_t index;
+    uint16_t value;
+    SolanaTxView view;
+} SolanaTxEvent;
+
+typedef enum {
+    SolanaTxErrorNone,
+    SolanaTxErrorTruncated, // Input ended in the middle of the transaction
+    SolanaTxErrorTooLarge, // More than SOLANA_TX_MAX_SIZE bytes
+    SolanaTxErrorCompactU16, // Overlong or non-canonical compact-u16
+    SolanaTxErrorVersion, // Message version we do not understand
+    SolanaTxErrorHeader, // Header counts do not agree with signatures or keys
+    SolanaTxErrorIndex, // Instruction refers to an account that does not exist
+    SolanaTxErrorTrailingData, // Bytes after the end of the transaction
+} SolanaTxError;
+
+typedef struct {
+    bool versioned; // false for legacy messages
+    uint8_t version; // Only meaningful when versioned is true
+    uint8_t num_required_signatures;
+    uint8_t num_readonly_signed;
+    uint8_t num_readonly_unsigned;
+    uint16_t num_account_keys;
+    uint16_t num_instructions;
+    uint16_t message_offset; // Stream offset of the first message byte
+    uint16_t message_length; // Valid once SolanaTxEventDone is returned
+} SolanaTxHeader;
+
+typedef struct SolanaTxParser SolanaTxParser;
+
+/**
+ * @brief      Allocate a transaction parser.
+ * @param      ring       Buffer the parser stores incoming bytes in.
+ * @param      ring_size  Size of ring, a power of two no smaller than SOLANA_TX_RING_MIN_SIZE.
+ * @return     SolanaTxParser object.
+*/
+SolanaTxParser* solana_tx_parser_alloc(uint8_t* ring, size_t ring_size);
+
+/**
+ * @brief      Free a transaction parser.  The ring buffer stays owned by the caller.
+*/
+void solana_tx_parser_free(SolanaTxParser* parser);
+
+/**
+ * @brief      Forget everything parsed so far and start on a new transaction.
+*/
+void solana_tx_parser_reset(SolanaTxParser* parser);
+
+/**
+ * @brief      Append received bytes to the ring.
+ * @details    Only as many bytes as fit in the free part of the ring are taken.  Call
+ *            solana_tx_parser_poll() until it returns SolanaTxEventNone to make room.
+ * @return     number of bytes accepted.
+*/
+size_t solana_tx_parser_write(SolanaTxParser* parser, const uint8_t* data, size_t size);
+
+/**
+ * @brief      Tell the parser no more bytes will be written.
+*/
+void solana_tx_parser_finish(SolanaTxParser* parser);
+
+/**
+ * @brief      Parse up to the next event.
+ * @details    The view in the returned event stays valid until the next call.  Each call does a
+ *            bounded amount of work, so this is safe to run from a UI or worker loop.
+ * @return     true if event holds something other than SolanaTxEventNone.
+*/
+bool solana_tx_parser_poll(SolanaTxParser* parser, SolanaTxEvent* event);
+
+const SolanaTxHeader* solana_tx_parser_get_header(const SolanaTxParser* parser);
+
+SolanaTxError solana_tx_parser_get_error(const SolanaTxParser* parser);
+
+/**
+ * @brief      Get a pointer to the bytes of a view.
+ * @details    A view can wrap around the end of the ring.  contiguous receives the number of
+ *            bytes readable from the returned pointer; the remainder starts at the ring start.
+*/
+const uint8_t*
+    solana_tx_parser_view_ptr(const SolanaTxParser* parser, SolanaTxView view, size_t* contiguous);
+
+/**
+ * @brief      Copy the bytes of a view out of the ring.
+*/
+void solana_tx_parser_view_copy(const SolanaTxParser* parser, SolanaTxView view, uint8_t* out);
+
+#endif // SOLANA_TX_H
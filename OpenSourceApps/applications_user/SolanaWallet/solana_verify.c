@@ -0,0 +1,137 @@
+#include "solana_verify.h"
+#include <furi.h>
+#include "ed25519.h"
+
+#define TAG "SolanaVerify"
+
+// The parser only has to hold one signature or key at a time, the bytes are read from the
+// caller's copy of the transaction.
+#define SOLANA_VERIFY_RING_SIZE 128
+
+typedef struct {
+    uint16_t signatures[SOLANA_VERIFY_MAX_SIGNATURES]; // Offsets into the transaction
+    uint16_t signers[SOLANA_VERIFY_MAX_SIGNATURES]; // Offsets of the first account keys
+    uint16_t message_offset;
+    uint16_t message_length;
+} SolanaVerifyLayout;
+
+/**
+ * @brief      Find where the signatures, their keys and the signed message are in transaction.
+*/
+static SolanaTxError solana_verify_parse(
+    SolanaTxParser* parser,
+    SolanaVerifyTransaction* transaction,
+    SolanaVerifyLayout* layout) {
+    SolanaTxEvent event;
+    size_t written = 0;
+    bool finished = false;
+
+    solana_tx_parser_reset(parser);
+    while(true) {
+        if(!finished) {
+            written += solana_tx_parser_write(
+                parser, transaction->data + written, transaction->size - written);
+            if(written == transaction->size) {
+                solana_tx_parser_finish(parser);
+                finished = true;
+            }
+        }
+        if(!solana_tx_parser_poll(parser, &event)) {
+            if(finished) {
+                return SolanaTxErrorTruncated;
+            }
+            continue;
+        }
+
+        switch(event.type) {
+        case SolanaTxEventSignature:
+            layout->signatures[event.index] = event.view.offset;
+            transaction->signature_count = event.index + 1;
+            break;
+        case SolanaTxEventAccountKey:
+            // The header made sure the first signature_count keys are the signers.
+            if(event.index < transaction->signature_count) {
+                layout->signers[event.index] = event.view.offset;
+            }
+            break;
+        case SolanaTxEventDone:
+            layout->message_offset = solana_tx_parser_get_header(parser)->message_offset;
+            layout->message_length = solana_tx_parser_get_header(parser)->message_length;
+            return SolanaTxErrorNone;
+        case SolanaTxEventError:
+            return solana_tx_parser_get_error(parser);
+        default:
+            break;
+        }
+    }
+}
+
+static bool solana_verify_is_unsigned(const uint8_t* signature) {
+    uint8_t bits = 0;
+    for(size_t i = 0; i < SOLANA_TX_SIGNATURE_SIZE; i++) {
+        bits |= signature[i];
+    }
+    return !bits;
+}
+
+bool solana_verify_transactions(SolanaVerifyTransaction* transactions, size_t count) {
+    uint8_t* ring = malloc(SOLANA_VERIFY_RING_SIZE);
+    SolanaTxParser* parser = solana_tx_parser_alloc(ring, SOLANA_VERIFY_RING_SIZE);
+    SolanaVerifyLayout* layout = malloc(sizeof(SolanaVerifyLayout));
+    Ed25519VerifyItem* items =
+        malloc(sizeof(Ed25519VerifyItem) * count * SOLANA_VERIFY_MAX_SIGNATURES);
+    size_t item_count = 0;
+    bool all = true;
+
+    for(size_t i = 0; i < count; i++) {
+        SolanaVerifyTransaction* transaction = &transactions[i];
+        transaction->signature_count = 0;
+        transaction->error = solana_verify_parse(parser, transaction, layout);
+        if(transaction->error != SolanaTxErrorNone) {
+            FURI_LOG_W(TAG, "Transaction %zu: parse error %d", i, transaction->error);
+            transaction->signature_count = 0;
+            all = false;
+            continue;
+        }
+
+        for(size_t n = 0; n < transaction->signature_count; n++) {
+            const uint8_t* signature = transaction->data + layout->signatures[n];
+            if(solana_verify_is_unsigned(signature)) {
+                transaction->results[n] = SolanaVerifyUnsigned;
+                continue;
+            }
+            transaction->results[n] = SolanaVerifyInvalid; // Until the check says otherwise
+            items[item_count++] = (Ed25519VerifyItem){
+                .message = transaction->data + layout->message_offset,
+                .size = layout->message_length,
+                .public_key = transaction->data + layout->signers[n],
+                .signature = signature,
+            };
+        }
+    }
+
+    if(item_count) {
+        bool* valid = malloc(sizeof(bool) * item_count);
+        all = ed25519_verify_batch(items, item_count, valid) && all;
+
+        // Hand the results back in the order the items were made.
+        size_t item = 0;
+        for(size_t i = 0; i < count; i++) {
+            SolanaVerifyTransaction* transaction = &transactions[i];
+            for(size_t n = 0; n < transaction->signature_count; n++) {
+                if(transaction->results[n] != SolanaVerifyUnsigned) {
+                    transaction->results[n] = valid[item++] ? SolanaVerifyValid :
+                                                              SolanaVerifyInvalid;
+                }
+            }
+        }
+        free(valid);
+    }
+    FURI_LOG_I(TAG, "%zu transactions, %zu signatures checked, valid %d", count, item_count, all);
+
+    free(items);
+    free(layout);
+    solana_tx_parser_free(parser);
+    free(ring);
+    return all;
+}
@@ -0,0 +1,43 @@
+#ifndef SOLANA_VERIFY_H
+#define SOLANA_VERIFY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "solana_tx.h"
+
+/**
+ * Checks the signatures already on serialized transactions, for showing a partially signed
+ * transaction or a queue of them before the user approves.  Every signature of every transaction
+ * goes through one ed25519_verify_batch(), which gives the same answers as checking them one by
+ * one and costs less when the same key signed many of them.  Signatures that are still all zero
+ * haven't been made yet and are reported as unsigned, not invalid.
+ */
+
+// Most signatures a transaction can carry and still fit in SOLANA_TX_MAX_SIZE bytes
+#define SOLANA_VERIFY_MAX_SIGNATURES (SOLANA_TX_MAX_SIZE / SOLANA_TX_SIGNATURE_SIZE)
+
+typedef enum {
+    SolanaVerifyUnsigned, // All zero, waiting for its signer
+    SolanaVerifyValid,
+    SolanaVerifyInvalid,
+} SolanaVerifyResult;
+
+typedef struct {
+    const uint8_t* data; // Serialized transaction, kept by the caller
+    size_t size;
+
+    // Filled in by solana_verify_transactions()
+    SolanaTxError error; // Anything but SolanaTxErrorNone and the signatures weren't checked
+    uint8_t signature_count;
+    SolanaVerifyResult results[SOLANA_VERIFY_MAX_SIGNATURES]; // In the transaction's order
+} SolanaVerifyTransaction;
+
+/**
+ * @brief      Check every signature on count transactions.
+ * @return     true if every transaction parsed and no signature is invalid.  Unsigned ones don't
+ *            count against it, check signature_count and results to see if any are missing.
+*/
+bool solana_verify_transactions(SolanaVerifyTransaction* transactions, size_t count);
+
+#endif // SOLANA_VERIFY_H
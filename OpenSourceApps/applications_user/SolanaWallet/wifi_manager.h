@@ -1,6 +0,0 @@
-#ifndef WIFI_MANAGER_H
-#define WIFI_MANAGER_H
-
-void wifi_init_sta(void);
-
-#endif // WIFI_MANAGER_H
@@ -6,23 +6,24 @@
 #include <gui/modules/submenu.h>
 #include <gui/modules/widget.h>
 #include <notification/notification_messages.h>
-#include <gui/modules/text_input.h>
+#include <cli/cli.h>
+#include <stdatomic.h>
+#include "../common/view_table.h"
+#include "todo_tasks.h"
+#include "todo_sync.h"
+#include "todo_input.h"
+#include "todo_words.h"
+#include "todo_markdown.h"
 
-#define TAG         "ToDoList"
-#define MAX_TASKS   10
-#define TASK_LENGTH 64
-
-typedef enum {
-    TodoSubmenuIndexAddTask,
-    TodoSubmenuIndexViewTasks,
-    TodoSubmenuIndexAbout,
-} TodoSubmenuIndex;
+#define TAG           "ToDoList"
+#define TODO_SYNC_CLI "todo_sync"
 
 typedef enum {
     TodoViewSubmenu, // The menu when the app starts
     TodoViewAddTask, // View for adding a task
     TodoViewViewTasks, // View for viewing tasks
     TodoViewAbout, // View for the about page
+    TodoViewMarkdown, // What an import or export did
 } TodoView;
 
 typedef struct {
@@ -30,52 +31,21 @@ typedef struct {
 } TaskInputModel;
 
 typedef struct {
-    ViewDispatcher* view_dispatcher; // Switches between our views
+    ViewTable* views; // Allocates our views and switches between them
     Submenu* submenu; // The application menu
     Widget* widget_about; // The about screen
-    TextInput* text_input; // Text input for adding a task
+    Widget* widget_markdown; // Result of an import or export
+    View* input_view; // Keyboard for adding a task
+    TodoInput* input; // Runs input_view and offers word completions
+    TodoWords* words; // Words from earlier tasks, for the completions
     View* list_view; // Custom list view for displaying tasks
     TaskInputModel task_input_model; // Task input model
-    char tasks[MAX_TASKS][TASK_LENGTH]; // Array to store tasks
-    size_t task_count; // Number of tasks stored
+    TodoTasks tasks; // The tasks, with their versions for the desktop sync
+    FuriMutex* tasks_mutex; // Held by the CLI thread while a sync runs
+    Cli* cli; // For the sync command
+    uint32_t import_resume; // Where the next import picks up, 0 to start from the top
 } TodoApp;
 
-// Callback to exit the app
-static uint32_t todo_navigation_exit_callback(void* _context) {
-    UNUSED(_context);
-    FURI_LOG_I(TAG, "Exiting ToDo App.");
-    return VIEW_NONE;
-}
-
-// Callback to return to the submenu
-static uint32_t todo_navigation_submenu_callback(void* _context) {
-    UNUSED(_context);
-    FURI_LOG_I(TAG, "Returning to submenu.");
-    return TodoViewSubmenu;
-}
-
-// Handle submenu item selection
-static void todo_submenu_callback(void* context, uint32_t index) {
-    TodoApp* app = (TodoApp*)context;
-    FURI_LOG_I(TAG, "Switching to submenu index: %lu", (unsigned long)index);
-    switch(index) {
-    case TodoSubmenuIndexAddTask:
-        FURI_LOG_I(TAG, "Switching to Add Task view.");
-        view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewAddTask);
-        break;
-    case TodoSubmenuIndexViewTasks:
-        FURI_LOG_I(TAG, "Switching to View Tasks view.");
-        view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewViewTasks);
-        break;
-    case TodoSubmenuIndexAbout:
-        FURI_LOG_I(TAG, "Switching to About view.");
-        view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewAbout);
-        break;
-    default:
-        break;
-    }
-}
-
 // Callback for handling task input
 static void todo_view_add_task_result_callback(void* context) {
     TodoApp* app = (TodoApp*)context;
@@ -83,41 +53,178 @@ static void todo_view_add_task_result_callback(void* context) {
     FURI_LOG_I(TAG, "Entered task: %s", app->task_input_model.task);
 
     if(strlen(app->task_input_model.task) > 0) {
-        if(app->task_count < MAX_TASKS) {
-            FURI_LOG_I(TAG, "Adding task to list. Task count: %zu", app->task_count);
-            strncpy(app->tasks[app->task_count], app->task_input_model.task, TASK_LENGTH);
-            app->tasks[app->task_count][TASK_LENGTH - 1] = '\0'; // Ensure null termination
-            app->task_count++;
-            FURI_LOG_I(TAG, "Task added successfully. New task count: %zu", app->task_count);
+        furi_mutex_acquire(app->tasks_mutex, FuriWaitForever);
+        bool added = todo_tasks_add(&app->tasks, app->task_input_model.task);
+        size_t task_count = app->tasks.count;
+        furi_mutex_release(app->tasks_mutex);
+
+        if(added) {
+            FURI_LOG_I(TAG, "Task added successfully. New task count: %zu", task_count);
 
             // After adding the task, go back to the submenu
-            view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewSubmenu);
+            view_table_switch_to(app->views, TodoViewSubmenu);
         } else {
             FURI_LOG_W(TAG, "Task list full.");
-            view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewSubmenu);
+            view_table_switch_to(app->views, TodoViewSubmenu);
         }
     } else {
         FURI_LOG_W(TAG, "No task entered.");
-        view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewSubmenu);
+        view_table_switch_to(app->views, TodoViewSubmenu);
     }
 }
 
 // Draw view tasks screen
 static void todo_view_view_tasks_draw_callback(Canvas* canvas, void* context) {
     TodoApp* app = (TodoApp*)context;
-    if(app && app->task_count > 0) {
-        FURI_LOG_I(TAG, "Drawing tasks. Task count: %zu", app->task_count);
+    // Don't hold up the GUI thread behind a sync, just say so.
+    if(app && furi_mutex_acquire(app->tasks_mutex, 0) != FuriStatusOk) {
+        canvas_draw_str(canvas, 10, 10, "Syncing...");
+        return;
+    }
+    if(app && app->tasks.count > 0) {
+        FURI_LOG_I(TAG, "Drawing tasks. Task count: %zu", app->tasks.count);
         canvas_draw_str(canvas, 10, 10, "Tasks:");
-        for(size_t i = 0; i < app->task_count; i++) {
-            FURI_LOG_I(TAG, "Task %zu: %s", i, app->tasks[i]);
-            canvas_draw_str(canvas, 10, 20 + (i * 10), app->tasks[i]);
+        for(size_t i = 0; i < app->tasks.count; i++) {
+            FURI_LOG_I(TAG, "Task %zu: %s", i, app->tasks.tasks[i].text);
+            canvas_draw_str(canvas, 10, 20 + (i * 10), app->tasks.tasks[i].text);
         }
     } else {
         FURI_LOG_W(TAG, "No tasks recorded.");
         canvas_draw_str(canvas, 10, 10, "No tasks recorded.");
     }
+    if(app) {
+        furi_mutex_release(app->tasks_mutex);
+    }
+}
+
+// The CLI finds a command under its lock but runs it without, so a sync can start or still be
+// running after cli_delete_command() returns.  The command therefore reaches the app through
+// these, which don't go away with it: todo_app_free() clears the app and then waits until no
+// sync is running.
+static TodoApp* _Atomic todo_sync_app;
+static atomic_uint todo_sync_running;
+
+static size_t todo_sync_cli_read(void* context, uint8_t* data, size_t size, uint32_t timeout_ms) {
+    return cli_read_timeout(context, data, size, timeout_ms);
+}
+
+static void todo_sync_cli_write(void* context, const uint8_t* data, size_t size) {
+    cli_write(context, data, size);
+}
+
+// Runs on the CLI thread when HostTools/todo_sync.py types "todo_sync"
+static void todo_sync_cli_callback(Cli* cli, FuriString* args, void* context) {
+    UNUSED(args);
+    UNUSED(context);
+    TodoSyncIo io = {
+        .read = todo_sync_cli_read,
+        .write = todo_sync_cli_write,
+        .context = cli,
+    };
+    TodoSyncStats stats;
+
+    // Counted before looking, so either todo_app_free() waits for this sync or it finds no app.
+    atomic_fetch_add(&todo_sync_running, 1);
+    TodoApp* app = atomic_load(&todo_sync_app);
+    if(app) {
+        furi_mutex_acquire(app->tasks_mutex, FuriWaitForever);
+        TodoSyncResult result = todo_sync_run(&app->tasks, &io, &stats);
+        furi_mutex_release(app->tasks_mutex);
+
+        FURI_LOG_I(
+            TAG,
+            "Sync %d: sent %zu, received %zu, rejected %zu",
+            result,
+            stats.sent,
+            stats.received,
+            stats.rejected);
+    } else {
+        FURI_LOG_W(TAG, "Sync asked for while the app is closing.");
+    }
+    atomic_fetch_sub(&todo_sync_running, 1);
+}
+
+static void todo_markdown_show(TodoApp* app, const char* text) {
+    widget_reset(app->widget_markdown);
+    widget_add_text_scroll_element(app->widget_markdown, 0, 0, 128, 64, text);
+    view_table_switch_to(app->views, TodoViewMarkdown);
+}
+
+// Menu: add the "- [ ]" lines of todo.md, carrying on where the last import stopped
+static void todo_menu_import_callback(void* context) {
+    TodoApp* app = (TodoApp*)context;
+    TodoMarkdownResult result;
+    char text[128];
+
+    furi_mutex_acquire(app->tasks_mutex, FuriWaitForever);
+    TodoMarkdownStatus status =
+        todo_markdown_import(&app->tasks, TODO_MARKDOWN_PATH, app->import_resume, &result);
+    furi_mutex_release(app->tasks_mutex);
+
+    if(status == TodoMarkdownErrorOpen) {
+        app->import_resume = 0;
+        snprintf(text, sizeof(text), "Can't open\n%s", TODO_MARKDOWN_PATH);
+    } else {
+        app->import_resume = result.resume;
+        snprintf(
+            text,
+            sizeof(text),
+            "Added %zu, %zu already here, %zu done, %zu cut short.\n%s",
+            result.added,
+            result.duplicates,
+            result.ticked,
+            result.truncated,
+            status == TodoMarkdownOk   ? "Whole file imported." :
+            status == TodoMarkdownFull ? "List full, import again for the rest." :
+                                         "Read error, import again to carry on.");
+    }
+    todo_markdown_show(app, text);
 }
 
+// Menu: write the list to todo.md
+static void todo_menu_export_callback(void* context) {
+    TodoApp* app = (TodoApp*)context;
+    char text[128];
+
+    furi_mutex_acquire(app->tasks_mutex, FuriWaitForever);
+    TodoMarkdownStatus status = todo_markdown_export(&app->tasks, TODO_MARKDOWN_PATH);
+    size_t count = app->tasks.count;
+    furi_mutex_release(app->tasks_mutex);
+
+    if(status == TodoMarkdownOk) {
+        snprintf(text, sizeof(text), "Saved %zu tasks to\n%s", count, TODO_MARKDOWN_PATH);
+    } else {
+        snprintf(text, sizeof(text), "Can't write\n%s", TODO_MARKDOWN_PATH);
+    }
+    todo_markdown_show(app, text);
+}
+
+// Screens and where the back button goes from each of them
+static const ViewTableView todo_views[] = {
+    {TodoViewSubmenu, ViewTableTypeSubmenu, offsetof(TodoApp, submenu), VIEW_NONE},
+    {TodoViewAbout, ViewTableTypeWidget, offsetof(TodoApp, widget_about), TodoViewSubmenu},
+    {TodoViewAddTask, ViewTableTypeView, offsetof(TodoApp, input_view), TodoViewSubmenu},
+    {TodoViewViewTasks, ViewTableTypeView, offsetof(TodoApp, list_view), TodoViewSubmenu},
+    {TodoViewMarkdown, ViewTableTypeWidget, offsetof(TodoApp, widget_markdown), TodoViewSubmenu},
+};
+
+static const ViewTableMenuItem todo_menu[] = {
+    {"Add Task", TodoViewAddTask, NULL},
+    {"View Tasks", TodoViewViewTasks, NULL},
+    {"Import Markdown", TodoViewMarkdown, todo_menu_import_callback},
+    {"Export Markdown", TodoViewMarkdown, todo_menu_export_callback},
+    {"About", TodoViewAbout, NULL},
+};
+
+static const ViewTableConfig todo_view_config = {
+    .views = todo_views,
+    .view_count = COUNT_OF(todo_views),
+    .menu_view = TodoViewSubmenu,
+    .menu = todo_menu,
+    .menu_count = COUNT_OF(todo_menu),
+    .start_view = TodoViewSubmenu,
+};
+
 // Allocate the ToDo app
 static TodoApp* todo_app_alloc() {
     FURI_LOG_I(TAG, "Allocating memory for ToDo App.");
@@ -127,64 +234,38 @@ static TodoApp* todo_app_alloc() {
         return NULL;
     }
 
-    Gui* gui = furi_record_open(RECORD_GUI);
-    if(!gui) {
-        FURI_LOG_E(TAG, "Failed to open GUI record.");
-        free(app);
-        return NULL;
-    }
-
-    app->view_dispatcher = view_dispatcher_alloc();
-    view_dispatcher_attach_to_gui(app->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
-    view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
-
-    // Submenu setup
-    app->submenu = submenu_alloc();
-    submenu_add_item(
-        app->submenu, "Add Task", TodoSubmenuIndexAddTask, todo_submenu_callback, app);
-    submenu_add_item(
-        app->submenu, "View Tasks", TodoSubmenuIndexViewTasks, todo_submenu_callback, app);
-    submenu_add_item(app->submenu, "About", TodoSubmenuIndexAbout, todo_submenu_callback, app);
-    view_set_previous_callback(submenu_get_view(app->submenu), todo_navigation_exit_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, TodoViewSubmenu, submenu_get_view(app->submenu));
-    view_dispatcher_switch_to_view(app->view_dispatcher, TodoViewSubmenu);
+    // Allocates the submenu and all the screens below, and fills in the menu
+    app->views = view_table_alloc(&todo_view_config, app);
 
     // About screen
-    app->widget_about = widget_alloc();
     widget_add_text_scroll_element(
         app->widget_about, 0, 0, 128, 64, "This is a simple ToDo list app.");
-    view_set_previous_callback(
-        widget_get_view(app->widget_about), todo_navigation_submenu_callback);
-    view_dispatcher_add_view(
-        app->view_dispatcher, TodoViewAbout, widget_get_view(app->widget_about));
-
-    // Text input for adding tasks
-    app->text_input = text_input_alloc();
-    text_input_set_header_text(app->text_input, "Enter Task");
-
-    // Corrected function call with the necessary arguments
-    text_input_set_result_callback(
-        app->text_input,
+
+    // Keyboard for adding tasks, with completions learned from the tasks added before
+    app->words = todo_words_alloc();
+    todo_words_load(app->words, TODO_WORDS_PATH);
+    app->input = todo_input_alloc(app->input_view, app->words);
+    todo_input_set_result_callback(
+        app->input,
         todo_view_add_task_result_callback,
         app,
         app->task_input_model.task,
-        TASK_LENGTH,
-        true // Set to true if you want to clear default text after the task is added
-    );
-    view_dispatcher_add_view(
-        app->view_dispatcher, TodoViewAddTask, text_input_get_view(app->text_input));
-
-    // List view for tasks
-    app->list_view = view_alloc();
-    view_set_context(app->list_view, app); // Set the context to the app
+        TASK_LENGTH);
+
+    // List view for tasks, its context is already the app
     view_set_draw_callback(app->list_view, todo_view_view_tasks_draw_callback);
-    view_set_previous_callback(app->list_view, todo_navigation_submenu_callback);
-    view_dispatcher_add_view(app->view_dispatcher, TodoViewViewTasks, app->list_view);
 
-    // Initialize tasks
+    // Initialize tasks, a new epoch tells the desktop this is a fresh list
     app->task_input_model.task[0] = '\0';
-    app->task_count = 0;
+    todo_tasks_init(&app->tasks, furi_hal_random_get());
+    app->import_resume = 0;
+    app->tasks_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+
+    // Desktop sync over the USB serial CLI
+    atomic_store(&todo_sync_app, app);
+    app->cli = furi_record_open(RECORD_CLI);
+    cli_add_command(
+        app->cli, TODO_SYNC_CLI, CliCommandFlagParallelSafe, todo_sync_cli_callback, NULL);
 
     FURI_LOG_I(TAG, "ToDo App allocated successfully.");
 
@@ -194,12 +275,18 @@ static TodoApp* todo_app_alloc() {
 // Free the ToDo app
 static void todo_app_free(TodoApp* app) {
     FURI_LOG_I(TAG, "Freeing ToDo App.");
-    text_input_free(app->text_input);
-    view_free(app->list_view);
-    widget_free(app->widget_about);
-    submenu_free(app->submenu);
-    view_dispatcher_free(app->view_dispatcher);
-    furi_record_close(RECORD_GUI);
+    // The CLI won't start another sync after this, but doesn't wait for one already running.
+    atomic_store(&todo_sync_app, NULL);
+    cli_delete_command(app->cli, TODO_SYNC_CLI);
+    furi_record_close(RECORD_CLI);
+    while(atomic_load(&todo_sync_running)) {
+        furi_delay_ms(10);
+    }
+    furi_mutex_free(app->tasks_mutex);
+    view_table_free(app->views);
+    todo_input_free(app->input);
+    todo_words_save(app->words, TODO_WORDS_PATH);
+    todo_words_free(app->words);
     free(app);
 }
 
@@ -210,7 +297,7 @@ int32_t main_todolist_app(void* _p) {
     TodoApp* app = todo_app_alloc();
     if(!app) return -1;
 
-    view_dispatcher_run(app->view_dispatcher);
+    view_dispatcher_run(view_table_get_view_dispatcher(app->views));
     todo_app_free(app);
 
     return 0;
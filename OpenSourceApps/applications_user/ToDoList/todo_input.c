@@ -0,0 +1,264 @@
+#include "todo_input.h"
+#include <furi.h>
+
+#define TODO_INPUT_KEY_BACKSPACE '\b'
+#define TODO_INPUT_KEY_ENTER     '\r'
+#define TODO_INPUT_ROW_COUNT     4
+#define TODO_INPUT_SUGGESTIONS   -1 // The row above the keys
+#define TODO_INPUT_KEY_WIDTH     12
+#define TODO_INPUT_KEY_HEIGHT    11
+
+static const char* const todo_input_rows[TODO_INPUT_ROW_COUNT] = {
+    "1234567890",
+    "qwertyuiop",
+    "asdfghjkl\b",
+    "zxcvbnm \r",
+};
+
+typedef struct {
+    char text[TODO_INPUT_MAX_LENGTH];
+    size_t size; // Longest text plus one, from the result buffer
+    int8_t row;
+    uint8_t column;
+    TodoWordsSuggestion suggestions[TODO_WORDS_SUGGESTIONS];
+    uint8_t suggestion_count;
+    uint8_t suggestion;
+} TodoInputModel;
+
+struct TodoInput {
+    View* view;
+    TodoWords* words;
+    TodoInputCallback callback;
+    void* context;
+    char* result;
+    size_t result_size;
+};
+
+static bool todo_input_is_word(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+// Start of the word the cursor is in, the text is always typed at the end
+static size_t todo_input_word_start(const char* text) {
+    size_t start = strlen(text);
+    while(start && todo_input_is_word(text[start - 1])) {
+        start--;
+    }
+    return start;
+}
+
+static void todo_input_suggest(TodoInput* input, TodoInputModel* model) {
+    const char* prefix = model->text + todo_input_word_start(model->text);
+    model->suggestion_count =
+        todo_words_complete(input->words, prefix, model->suggestions, TODO_WORDS_SUGGESTIONS);
+    model->suggestion = 0;
+    if(!model->suggestion_count && model->row == TODO_INPUT_SUGGESTIONS) {
+        model->row = 1;
+    }
+}
+
+static void todo_input_draw_key(Canvas* canvas, int32_t x, int32_t y, char key, bool selected) {
+    char label[2] = {key, '\0'};
+    if(key == TODO_INPUT_KEY_BACKSPACE) {
+        label[0] = '<';
+    } else if(key == ' ') {
+        label[0] = '_';
+    }
+    if(selected) {
+        canvas_draw_box(canvas, x - 1, y - 8, TODO_INPUT_KEY_WIDTH - 1, TODO_INPUT_KEY_HEIGHT - 1);
+        canvas_set_color(canvas, ColorWhite);
+    }
+    canvas_draw_str(canvas, x + 2, y, key == TODO_INPUT_KEY_ENTER ? "OK" : label);
+    canvas_set_color(canvas, ColorBlack);
+}
+
+static void todo_input_draw_callback(Canvas* canvas, void* model_void) {
+    TodoInputModel* model = model_void;
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontSecondary);
+
+    // The end of the text, as much of it as fits
+    const char* text = model->text;
+    while(*text && canvas_string_width(canvas, text) > 120) {
+        text++;
+    }
+    if(*text) {
+        canvas_draw_str(canvas, 2, 8, text);
+    } else {
+        canvas_draw_str(canvas, 2, 8, "Enter task");
+    }
+    int32_t cursor = *text ? 3 + canvas_string_width(canvas, text) : 2;
+    canvas_draw_line(canvas, cursor, 1, cursor, 9);
+
+    for(uint8_t i = 0; i < model->suggestion_count; i++) {
+        int32_t x = 1 + i * 42;
+        if(model->row == TODO_INPUT_SUGGESTIONS && model->suggestion == i) {
+            canvas_draw_box(canvas, x - 1, 11, 42, 10);
+            canvas_set_color(canvas, ColorWhite);
+        }
+        canvas_draw_str(canvas, x + 1, 19, model->suggestions[i]);
+        canvas_set_color(canvas, ColorBlack);
+    }
+    canvas_draw_line(canvas, 0, 21, 127, 21);
+
+    canvas_set_font(canvas, FontKeyboard);
+    for(int8_t row = 0; row < TODO_INPUT_ROW_COUNT; row++) {
+        const char* keys = todo_input_rows[row];
+        for(uint8_t column = 0; keys[column]; column++) {
+            bool selected = model->row == row && model->column == column;
+            todo_input_draw_key(
+                canvas,
+                4 + column * TODO_INPUT_KEY_WIDTH,
+                30 + row * TODO_INPUT_KEY_HEIGHT,
+                keys[column],
+                selected);
+        }
+    }
+}
+
+static void todo_input_move(TodoInputModel* model, InputKey key) {
+    if(key == InputKeyUp && model->row > 0) {
+        model->row--;
+    } else if(key == InputKeyUp && model->row == 0 && model->suggestion_count) {
+        model->row = TODO_INPUT_SUGGESTIONS;
+    } else if(key == InputKeyDown && model->row < TODO_INPUT_ROW_COUNT - 1) {
+        model->row++;
+    } else if(model->row == TODO_INPUT_SUGGESTIONS) {
+        uint8_t count = model->suggestion_count;
+        if(key == InputKeyLeft) {
+            model->suggestion = (model->suggestion + count - 1) % count;
+        } else if(key == InputKeyRight) {
+            model->suggestion = (model->suggestion + 1) % count;
+        }
+    } else {
+        uint8_t length = strlen(todo_input_rows[model->row]);
+        if(key == InputKeyLeft) {
+            model->column = (model->column + length - 1) % length;
+        } else if(key == InputKeyRight) {
+            model->column = (model->column + 1) % length;
+        }
+    }
+    if(model->row >= 0) {
+        uint8_t length = strlen(todo_input_rows[model->row]);
+        if(model->column >= length) {
+            model->column = length - 1;
+        }
+    }
+}
+
+/**
+ * @brief      Press the selected key or take the selected suggestion.
+ * @return     true when the OK key finished the text.
+*/
+static bool todo_input_press(TodoInput* input, TodoInputModel* model, bool upper) {
+    size_t length = strlen(model->text);
+    if(model->row == TODO_INPUT_SUGGESTIONS) {
+        // Keep what was typed (and its case), add the rest of the word and a space.
+        const char* suggestion = model->suggestions[model->suggestion];
+        size_t typed = length - todo_input_word_start(model->text);
+        typed = MIN(typed, strlen(suggestion));
+        snprintf(model->text + length, model->size - length, "%s ", suggestion + typed);
+        todo_input_suggest(input, model);
+        return false;
+    }
+
+    char key = todo_input_rows[model->row][model->column];
+    if(key == TODO_INPUT_KEY_ENTER) {
+        return true;
+    }
+    if(key == TODO_INPUT_KEY_BACKSPACE) {
+        if(length) {
+            model->text[length - 1] = '\0';
+        }
+    } else if(length + 1 < model->size) {
+        model->text[length] = upper && key >= 'a' && key <= 'z' ? key - 'a' + 'A' : key;
+        model->text[length + 1] = '\0';
+    }
+    todo_input_suggest(input, model);
+    return false;
+}
+
+static bool todo_input_input_callback(InputEvent* event, void* context) {
+    TodoInput* input = context;
+    bool consumed = false;
+    bool done = false;
+
+    if(event->key == InputKeyBack) {
+        return false;
+    }
+    with_view_model(
+        input->view,
+        TodoInputModel * model,
+        {
+            if(event->key == InputKeyOk) {
+                if(event->type == InputTypeShort || event->type == InputTypeLong) {
+                    done = todo_input_press(input, model, event->type == InputTypeLong);
+                }
+            } else if(event->type == InputTypeShort || event->type == InputTypeRepeat) {
+                todo_input_move(model, event->key);
+            }
+            if(done) {
+                snprintf(input->result, input->result_size, "%s", model->text);
+                model->text[0] = '\0';
+                model->suggestion_count = 0;
+                model->row = 1;
+                model->column = 0;
+            }
+            consumed = true;
+        },
+        true);
+
+    // Outside the model lock, the callback usually switches views.
+    if(done) {
+        todo_words_learn(input->words, input->result);
+        if(input->callback) {
+            input->callback(input->context);
+        }
+    }
+    return consumed;
+}
+
+TodoInput* todo_input_alloc(View* view, TodoWords* words) {
+    TodoInput* input = malloc(sizeof(TodoInput));
+    memset(input, 0, sizeof(TodoInput));
+    input->view = view;
+    input->words = words;
+
+    view_set_context(view, input);
+    view_set_draw_callback(view, todo_input_draw_callback);
+    view_set_input_callback(view, todo_input_input_callback);
+    view_allocate_model(view, ViewModelTypeLocking, sizeof(TodoInputModel));
+    with_view_model(
+        view,
+        TodoInputModel * model,
+        {
+            model->text[0] = '\0';
+            model->size = TODO_INPUT_MAX_LENGTH;
+            model->row = 1;
+            model->column = 0;
+            model->suggestion_count = 0;
+        },
+        false);
+    return input;
+}
+
+void todo_input_free(TodoInput* input) {
+    free(input);
+}
+
+void todo_input_set_result_callback(
+    TodoInput* input,
+    TodoInputCallback callback,
+    void* context,
+    char* text,
+    size_t size) {
+    input->callback = callback;
+    input->context = context;
+    input->result = text;
+    input->result_size = size;
+    with_view_model(
+        input->view,
+        TodoInputModel * model,
+        { model->size = MIN(size, (size_t)TODO_INPUT_MAX_LENGTH); },
+        false);
+}
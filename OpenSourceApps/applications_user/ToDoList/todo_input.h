@@ -0,0 +1,39 @@
+#ifndef TODO_INPUT_H
+#define TODO_INPUT_H
+
+#include <gui/view.h>
+#include "todo_words.h"
+
+/**
+ * Text entry for tasks.  A keyboard like the firmware's TextInput, with a row above it that
+ * offers the most used completions of the word being typed.  Press Up from the top row of keys
+ * to reach the suggestions, Left/Right to pick one and OK to take it.  Hold OK on a letter for
+ * a capital.  Every finished task is learned, so the suggestions get better with use.
+ */
+
+#define TODO_INPUT_MAX_LENGTH 64
+
+typedef struct TodoInput TodoInput;
+
+typedef void (*TodoInputCallback)(void* context);
+
+/**
+ * @brief      Turn a plain View into the task keyboard.  The view keeps ownership of its model,
+ *            so free the view first (or let the view table do it), then call todo_input_free().
+*/
+TodoInput* todo_input_alloc(View* view, TodoWords* words);
+
+void todo_input_free(TodoInput* input);
+
+/**
+ * @brief      Set where the finished text goes.  callback runs after OK on the OK key, with
+ *            the text in text (at most size - 1 characters).  The keyboard then starts empty.
+*/
+void todo_input_set_result_callback(
+    TodoInput* input,
+    TodoInputCallback callback,
+    void* context,
+    char* text,
+    size_t size);
+
+#endif // TODO_INPUT_H
@@ -0,0 +1,268 @@
+#include "todo_markdown.h"
+#include <furi.h>
+
+#define TAG "TodoMarkdown"
+
+#define TODO_MARKDOWN_ITEM "- [ ] "
+
+typedef struct {
+    TodoTasks* tasks;
+    TodoMarkdownResult* result;
+} TodoMarkdownImport;
+
+void todo_markdown_parser_init(
+    TodoMarkdownParser* parser,
+    uint32_t offset,
+    TodoMarkdownItemCallback callback,
+    void* context) {
+    memset(parser, 0, sizeof(TodoMarkdownParser));
+    parser->state = TodoMarkdownStateIndent;
+    parser->offset = offset;
+    parser->line_start = offset;
+    parser->callback = callback;
+    parser->context = context;
+}
+
+// Drop a UTF-8 character that was cut in half when the text filled up
+static void todo_markdown_whole_characters(TodoMarkdownParser* parser) {
+    size_t start = parser->length;
+    while(start && ((uint8_t)parser->text[start - 1] & 0xC0) == 0x80) {
+        start--;
+    }
+    if(!start) {
+        parser->length = 0;
+        return;
+    }
+    uint8_t lead = parser->text[--start];
+    size_t size = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    if(start + size > parser->length) {
+        parser->length = start;
+    }
+}
+
+static bool todo_markdown_end_line(TodoMarkdownParser* parser) {
+    bool keep_going = true;
+    if(parser->state == TodoMarkdownStateText) {
+        if(parser->truncated) {
+            todo_markdown_whole_characters(parser);
+        }
+        while(parser->length && parser->text[parser->length - 1] == ' ') {
+            parser->length--;
+        }
+        parser->text[parser->length] = '\0';
+        if(parser->length) {
+            keep_going = parser->callback(
+                parser->text, parser->ticked, parser->truncated, parser->context);
+        }
+    }
+    parser->state = TodoMarkdownStateIndent;
+    parser->length = 0;
+    parser->ticked = false;
+    parser->truncated = false;
+    return keep_going;
+}
+
+bool todo_markdown_parser_feed(TodoMarkdownParser* parser, const uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++, parser->offset++) {
+        char c = data[i];
+        if(c == '\n') {
+            if(!todo_markdown_end_line(parser)) {
+                return false;
+            }
+            parser->line_start = parser->offset + 1;
+            continue;
+        }
+        if(c == '\r') {
+            continue;
+        }
+        bool blank = c == ' ' || c == '\t';
+
+        switch(parser->state) {
+        case TodoMarkdownStateIndent:
+            if(c == '-' || c == '*' || c == '+') {
+                parser->state = TodoMarkdownStateBulletSpace;
+            } else if(!blank) {
+                parser->state = TodoMarkdownStateSkip;
+            }
+            break;
+        case TodoMarkdownStateBulletSpace:
+            parser->state = blank ? TodoMarkdownStateOpen : TodoMarkdownStateSkip;
+            break;
+        case TodoMarkdownStateOpen:
+            if(c == '[') {
+                parser->state = TodoMarkdownStateMark;
+            } else if(!blank) {
+                parser->state = TodoMarkdownStateSkip;
+            }
+            break;
+        case TodoMarkdownStateMark:
+            parser->ticked = c == 'x' || c == 'X';
+            parser->state = parser->ticked || c == ' ' ? TodoMarkdownStateClose :
+                                                         TodoMarkdownStateSkip;
+            break;
+        case TodoMarkdownStateClose:
+            parser->state = c == ']' ? TodoMarkdownStateSpace : TodoMarkdownStateSkip;
+            break;
+        case TodoMarkdownStateSpace:
+            parser->state = blank ? TodoMarkdownStateText : TodoMarkdownStateSkip;
+            break;
+        case TodoMarkdownStateText:
+            if(parser->length == 0 && blank) {
+                break;
+            }
+            if(parser->length + 1 < TASK_LENGTH) {
+                // Tabs and control characters would only draw as boxes.
+                parser->text[parser->length++] = (uint8_t)c < ' ' ? ' ' : c;
+            } else {
+                parser->truncated = true;
+            }
+            break;
+        case TodoMarkdownStateSkip:
+            break;
+        }
+    }
+    return true;
+}
+
+bool todo_markdown_parser_finish(TodoMarkdownParser* parser) {
+    return todo_markdown_end_line(parser);
+}
+
+static bool todo_markdown_import_item(
+    const char* text,
+    bool ticked,
+    bool truncated,
+    void* context) {
+    TodoMarkdownImport* import = context;
+    TodoTasks* tasks = import->tasks;
+
+    if(ticked) {
+        import->result->ticked++;
+        return true;
+    }
+    for(size_t i = 0; i < tasks->count; i++) {
+        if(strcmp(tasks->tasks[i].text, text) == 0) {
+            import->result->duplicates++;
+            return true;
+        }
+    }
+    if(!todo_tasks_add(tasks, text)) {
+        return false;
+    }
+    import->result->added++;
+    import->result->truncated += truncated;
+    return true;
+}
+
+TodoMarkdownStatus todo_markdown_import(
+    TodoTasks* tasks,
+    const char* path,
+    uint32_t offset,
+    TodoMarkdownResult* result) {
+    TodoMarkdownImport import = {.tasks = tasks, .result = result};
+    TodoMarkdownParser parser;
+    TodoMarkdownStatus status = TodoMarkdownOk;
+    uint8_t chunk[TODO_MARKDOWN_CHUNK];
+
+    memset(result, 0, sizeof(TodoMarkdownResult));
+    todo_markdown_parser_init(&parser, offset, todo_markdown_import_item, &import);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) ||
+       !storage_file_seek(file, offset, true)) {
+        status = TodoMarkdownErrorOpen;
+    } else {
+        while(status == TodoMarkdownOk) {
+            size_t read = storage_file_read(file, chunk, sizeof(chunk));
+            if(!read) {
+                if(!storage_file_eof(file)) {
+                    status = TodoMarkdownErrorRead;
+                } else if(!todo_markdown_parser_finish(&parser)) {
+                    status = TodoMarkdownFull;
+                }
+                break;
+            }
+            if(!todo_markdown_parser_feed(&parser, chunk, read)) {
+                status = TodoMarkdownFull;
+            }
+        }
+    }
+    if(status == TodoMarkdownFull || status == TodoMarkdownErrorRead) {
+        // Always a line start, a line cut short by the error is read again next time.
+        result->resume = parser.line_start;
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_I(TAG, "Import %d: added %zu, resume at %lu", status, result->added, result->resume);
+    return status;
+}
+
+typedef struct {
+    File* file;
+    uint8_t chunk[TODO_MARKDOWN_CHUNK];
+    size_t size;
+    bool ok;
+} TodoMarkdownWriter;
+
+static void todo_markdown_flush(TodoMarkdownWriter* writer) {
+    if(writer->ok && writer->size) {
+        writer->ok = storage_file_write(writer->file, writer->chunk, writer->size) == writer->size;
+    }
+    writer->size = 0;
+}
+
+static void todo_markdown_write(TodoMarkdownWriter* writer, const char* text, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        if(writer->size == TODO_MARKDOWN_CHUNK) {
+            todo_markdown_flush(writer);
+        }
+        writer->chunk[writer->size++] = text[i];
+    }
+}
+
+TodoMarkdownStatus todo_markdown_export(const TodoTasks* tasks, const char* path) {
+    char temp_path[128];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    TodoMarkdownWriter* writer = malloc(sizeof(TodoMarkdownWriter));
+    writer->file = storage_file_alloc(storage);
+    writer->size = 0;
+    writer->ok = storage_file_open(writer->file, temp_path, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    TodoMarkdownStatus status = writer->ok ? TodoMarkdownOk : TodoMarkdownErrorOpen;
+
+    for(size_t i = 0; i < tasks->count && writer->ok; i++) {
+        char line[sizeof(TODO_MARKDOWN_ITEM) + TASK_LENGTH];
+        size_t length =
+            snprintf(line, sizeof(line), TODO_MARKDOWN_ITEM "%s", tasks->tasks[i].text);
+        // A newline from a synced task would end the item early.
+        for(size_t j = 0; j < length; j++) {
+            if(line[j] == '\n' || line[j] == '\r') {
+                line[j] = ' ';
+            }
+        }
+        line[length++] = '\n';
+        todo_markdown_write(writer, line, length);
+    }
+    todo_markdown_flush(writer);
+    if(status == TodoMarkdownOk) {
+        writer->ok = storage_file_sync(writer->file) && writer->ok;
+    }
+    storage_file_close(writer->file);
+    storage_file_free(writer->file);
+
+    if(status == TodoMarkdownOk && writer->ok) {
+        storage_simply_remove(storage, path);
+        writer->ok = storage_common_rename(storage, temp_path, path) == FSE_OK;
+    }
+    if(status == TodoMarkdownOk && !writer->ok) {
+        FURI_LOG_E(TAG, "Failed to write %s", path);
+        storage_simply_remove(storage, temp_path);
+        status = TodoMarkdownErrorWrite;
+    }
+    free(writer);
+    furi_record_close(RECORD_STORAGE);
+    return status;
+}
@@ -0,0 +1,98 @@
+#ifndef TODO_MARKDOWN_H
+#define TODO_MARKDOWN_H
+
+#include <storage/storage.h>
+#include "todo_tasks.h"
+
+/**
+ * Import and export of Markdown checklists, one "- [ ] task" per line.  Files are read and
+ * written TODO_MARKDOWN_CHUNK bytes at a time through a parser that only keeps the line it is
+ * on, so a file of any size needs the same few hundred bytes of RAM.  Other lines (headings,
+ * notes, ticked "- [x]" items) are skipped.  A task longer than TASK_LENGTH - 1 bytes is cut at
+ * the last whole UTF-8 character that fits.
+ */
+
+#define TODO_MARKDOWN_PATH  APP_DATA_PATH("todo.md")
+#define TODO_MARKDOWN_CHUNK 256
+
+typedef enum {
+    TodoMarkdownOk,
+    TodoMarkdownFull, // The list filled up, import again from result.resume once there's room
+    TodoMarkdownErrorOpen,
+    TodoMarkdownErrorRead, // Import again from result.resume to pick up where it stopped
+    TodoMarkdownErrorWrite,
+} TodoMarkdownStatus;
+
+typedef struct {
+    size_t added;
+    size_t duplicates; // Already on the list, not added again
+    size_t ticked; // "- [x]" items, done already so not imported
+    size_t truncated;
+    uint32_t resume; // Offset of the first line not imported, 0 once the whole file is in
+} TodoMarkdownResult;
+
+/**
+ * @return     false to stop the parser before this item, it will be the first one next time.
+*/
+typedef bool (*TodoMarkdownItemCallback)(
+    const char* text,
+    bool ticked,
+    bool truncated,
+    void* context);
+
+typedef enum {
+    TodoMarkdownStateIndent,
+    TodoMarkdownStateBulletSpace,
+    TodoMarkdownStateOpen,
+    TodoMarkdownStateMark,
+    TodoMarkdownStateClose,
+    TodoMarkdownStateSpace,
+    TodoMarkdownStateText,
+    TodoMarkdownStateSkip, // Not an item, wait for the next line
+} TodoMarkdownState;
+
+typedef struct {
+    TodoMarkdownState state;
+    char text[TASK_LENGTH];
+    size_t length;
+    bool ticked;
+    bool truncated;
+    uint32_t offset; // Bytes fed so far
+    uint32_t line_start; // Offset of the line being parsed
+    TodoMarkdownItemCallback callback;
+    void* context;
+} TodoMarkdownParser;
+
+void todo_markdown_parser_init(
+    TodoMarkdownParser* parser,
+    uint32_t offset,
+    TodoMarkdownItemCallback callback,
+    void* context);
+
+/**
+ * @brief      Parse the next bytes of the file.
+ * @return     false if the callback stopped it.  parser->line_start is then where to resume.
+*/
+bool todo_markdown_parser_feed(TodoMarkdownParser* parser, const uint8_t* data, size_t size);
+
+/**
+ * @brief      The file ended, take the last line even without a newline.
+*/
+bool todo_markdown_parser_finish(TodoMarkdownParser* parser);
+
+/**
+ * @brief      Add the unticked items of the file at path to tasks, starting at byte offset.
+*/
+TodoMarkdownStatus todo_markdown_import(
+    TodoTasks* tasks,
+    const char* path,
+    uint32_t offset,
+    TodoMarkdownResult* result);
+
+/**
+ * @brief      Write every task to path as "- [ ] task" lines.  The file is written next to it
+ *            first and moved into place, so a failed export leaves the old file alone.
+*/
+TodoMarkdownStatus todo_markdown_export(const TodoTasks* tasks, const char* path);
+
+#endif // TODO_MARKDOWN_H
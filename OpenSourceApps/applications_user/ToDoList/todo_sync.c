@@ -0,0 +1,291 @@
+#include "todo_sync.h"
+#include "../common/heatshrink.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TODO_SYNC_RECORD_HEADER 14
+#define TODO_SYNC_SOF_SEARCH    256 // Bytes of CLI echo we skip looking for a frame
+
+typedef struct {
+    TodoTasks* tasks;
+    const TodoSyncIo* io;
+    TodoSyncStats* stats;
+    uint8_t frame[TODO_SYNC_HEADER_SIZE + TODO_SYNC_MAX_PAYLOAD + 2];
+    uint8_t batch[TODO_SYNC_MAX_PAYLOAD];
+    size_t batch_size;
+    size_t batch_records;
+} TodoSync;
+
+static void todo_sync_put_u16(uint8_t* data, uint16_t value) {
+    data[0] = value;
+    data[1] = value >> 8;
+}
+
+static void todo_sync_put_u32(uint8_t* data, uint32_t value) {
+    todo_sync_put_u16(data, value);
+    todo_sync_put_u16(data + 2, value >> 16);
+}
+
+static uint16_t todo_sync_get_u16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+static uint32_t todo_sync_get_u32(const uint8_t* data) {
+    return todo_sync_get_u16(data) | ((uint32_t)todo_sync_get_u16(data + 2) << 16);
+}
+
+static uint16_t todo_sync_crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i = 0; i < size; i++) {
+        crc ^= data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void todo_sync_send(TodoSync* sync, uint8_t type, const uint8_t* payload, size_t size) {
+    uint8_t* frame = sync->frame;
+    uint8_t flags = 0;
+    size_t length = size;
+
+    // Worth trying once there's enough for back references to find something.
+    if(size > 32) {
+        size_t packed = heatshrink_encode(
+            payload,
+            size,
+            frame + TODO_SYNC_HEADER_SIZE + 2,
+            size - 3,
+            HEATSHRINK_WINDOW_BITS,
+            HEATSHRINK_LOOKAHEAD_BITS);
+        if(packed) {
+            todo_sync_put_u16(frame + TODO_SYNC_HEADER_SIZE, size);
+            flags = TODO_SYNC_FLAG_COMPRESSED;
+            length = packed + 2;
+        }
+    }
+    if(!flags) {
+        memcpy(frame + TODO_SYNC_HEADER_SIZE, payload, size);
+    }
+
+    frame[0] = TODO_SYNC_SOF;
+    frame[1] = type;
+    frame[2] = flags;
+    todo_sync_put_u16(frame + 3, length);
+    uint16_t crc = todo_sync_crc16(frame + 1, TODO_SYNC_HEADER_SIZE - 1 + length);
+    todo_sync_put_u16(frame + TODO_SYNC_HEADER_SIZE + length, crc);
+    sync->io->write(sync->io->context, frame, TODO_SYNC_HEADER_SIZE + length + 2);
+}
+
+static bool todo_sync_read(TodoSync* sync, uint8_t* data, size_t size) {
+    while(size) {
+        size_t got = sync->io->read(sync->io->context, data, size, TODO_SYNC_TIMEOUT_MS);
+        if(!got) {
+            return false;
+        }
+        data += got;
+        size -= got;
+    }
+    return true;
+}
+
+/**
+ * @brief      Wait for the next frame and unpack its payload into sync->batch.
+ * @return     TodoSyncOk with the type and batch_size set.
+*/
+static TodoSyncResult todo_sync_receive(TodoSync* sync, uint8_t* type) {
+    uint8_t* frame = sync->frame;
+    size_t skipped = 0;
+    do {
+        if(!todo_sync_read(sync, frame, 1)) {
+            return TodoSyncErrorTimeout;
+        }
+        if(skipped++ == TODO_SYNC_SOF_SEARCH) {
+            return TodoSyncErrorFrame;
+        }
+    } while(frame[0] != TODO_SYNC_SOF);
+
+    if(!todo_sync_read(sync, frame + 1, TODO_SYNC_HEADER_SIZE - 1)) {
+        return TodoSyncErrorTimeout;
+    }
+    size_t length = todo_sync_get_u16(frame + 3);
+    if(length > TODO_SYNC_MAX_PAYLOAD) {
+        return TodoSyncErrorFrame;
+    }
+    if(!todo_sync_read(sync, frame + TODO_SYNC_HEADER_SIZE, length + 2)) {
+        return TodoSyncErrorTimeout;
+    }
+    uint16_t crc = todo_sync_get_u16(frame + TODO_SYNC_HEADER_SIZE + length);
+    if(crc != todo_sync_crc16(frame + 1, TODO_SYNC_HEADER_SIZE - 1 + length)) {
+        return TodoSyncErrorFrame;
+    }
+
+    const uint8_t* payload = frame + TODO_SYNC_HEADER_SIZE;
+    if(frame[2] & TODO_SYNC_FLAG_COMPRESSED) {
+        if(length < 2) {
+            return TodoSyncErrorFrame;
+        }
+        sync->batch_size = todo_sync_get_u16(payload);
+        if(sync->batch_size > TODO_SYNC_MAX_PAYLOAD ||
+           !heatshrink_decode(
+               payload + 2,
+               length - 2,
+               sync->batch,
+               sync->batch_size,
+               HEATSHRINK_WINDOW_BITS,
+               HEATSHRINK_LOOKAHEAD_BITS)) {
+            return TodoSyncErrorFrame;
+        }
+    } else {
+        memcpy(sync->batch, payload, length);
+        sync->batch_size = length;
+    }
+    *type = frame[1];
+    return TodoSyncOk;
+}
+
+static void todo_sync_flush(TodoSync* sync) {
+    if(sync->batch_records) {
+        todo_sync_send(sync, TodoSyncFrameRecords, sync->batch, sync->batch_size);
+    }
+    sync->batch_size = 0;
+    sync->batch_records = 0;
+}
+
+static void todo_sync_queue(TodoSync* sync, const TodoTask* task) {
+    size_t text_length = strnlen(task->text, TASK_LENGTH - 1);
+    if(sync->batch_size + TODO_SYNC_RECORD_HEADER + text_length > TODO_SYNC_MAX_PAYLOAD) {
+        todo_sync_flush(sync);
+    }
+    uint8_t* record = sync->batch + sync->batch_size;
+    todo_sync_put_u32(record, task->id);
+    todo_sync_put_u32(record + 4, task->version[TodoReplicaDevice]);
+    todo_sync_put_u32(record + 8, task->version[TodoReplicaDesktop]);
+    record[12] = 0;
+    record[13] = text_length;
+    memcpy(record + TODO_SYNC_RECORD_HEADER, task->text, text_length);
+    sync->batch_size += TODO_SYNC_RECORD_HEADER + text_length;
+    sync->batch_records++;
+}
+
+static TodoSyncResult todo_sync_apply_batch(TodoSync* sync, size_t* records) {
+    size_t offset = 0;
+    while(offset < sync->batch_size) {
+        const uint8_t* record = sync->batch + offset;
+        if(sync->batch_size - offset < TODO_SYNC_RECORD_HEADER ||
+           sync->batch_size - offset < TODO_SYNC_RECORD_HEADER + (size_t)record[13]) {
+            return TodoSyncErrorFrame;
+        }
+
+        TodoTask task = {0};
+        task.id = todo_sync_get_u32(record);
+        task.version[TodoReplicaDevice] = todo_sync_get_u32(record + 4);
+        task.version[TodoReplicaDesktop] = todo_sync_get_u32(record + 8);
+        // Anything longer than the flipper can show gets cut, like typing it would be.
+        size_t text_length = record[13] < TASK_LENGTH ? record[13] : TASK_LENGTH - 1;
+        memcpy(task.text, record + TODO_SYNC_RECORD_HEADER, text_length);
+
+        switch(todo_tasks_apply(sync->tasks, &task, record[12] & TODO_SYNC_RECORD_DELETED)) {
+        case TodoTasksApplyChanged:
+            sync->stats->received++;
+            break;
+        case TodoTasksApplyFull:
+            sync->stats->rejected++;
+            break;
+        case TodoTasksApplyIgnored:
+            break;
+        }
+        offset += TODO_SYNC_RECORD_HEADER + record[13];
+        (*records)++;
+    }
+    return TodoSyncOk;
+}
+
+static TodoSyncResult todo_sync_exchange(TodoSync* sync) {
+    TodoTasks* tasks = sync->tasks;
+    uint8_t payload[17];
+    uint8_t type;
+
+    payload[0] = TODO_SYNC_VERSION;
+    todo_sync_put_u32(payload + 1, tasks->epoch);
+    todo_sync_put_u32(payload + 5, tasks->knowledge[TodoReplicaDevice]);
+    todo_sync_put_u32(payload + 9, tasks->knowledge[TodoReplicaDesktop]);
+    todo_sync_put_u16(payload + 13, tasks->count);
+    todo_sync_put_u16(payload + 15, MAX_TASKS);
+    todo_sync_send(sync, TodoSyncFrameHello, payload, 17);
+
+    TodoSyncResult result = todo_sync_receive(sync, &type);
+    if(result != TodoSyncOk) {
+        return result;
+    }
+    if(type != TodoSyncFrameHello || sync->batch_size < 9) {
+        return TodoSyncErrorFrame;
+    }
+    if(sync->batch[0] != TODO_SYNC_VERSION) {
+        return TodoSyncErrorVersion;
+    }
+    uint32_t desktop[TodoReplicaCount] = {
+        todo_sync_get_u32(sync->batch + 1),
+        todo_sync_get_u32(sync->batch + 5),
+    };
+
+    // Our side: only what the desktop hasn't seen.
+    sync->batch_size = 0;
+    for(size_t i = 0; i < tasks->count; i++) {
+        if(!todo_tasks_is_known(tasks->tasks[i].version, desktop)) {
+            todo_sync_queue(sync, &tasks->tasks[i]);
+            sync->stats->sent++;
+        }
+    }
+    todo_sync_flush(sync);
+    todo_sync_put_u16(payload, sync->stats->sent);
+    todo_sync_send(sync, TodoSyncFrameEnd, payload, 2);
+
+    // Their side, applied as it arrives.
+    size_t records = 0;
+    while(true) {
+        result = todo_sync_receive(sync, &type);
+        if(result != TodoSyncOk) {
+            return result;
+        }
+        if(type == TodoSyncFrameEnd) {
+            break;
+        }
+        if(type != TodoSyncFrameRecords) {
+            return TodoSyncErrorFrame;
+        }
+        result = todo_sync_apply_batch(sync, &records);
+        if(result != TodoSyncOk) {
+            return result;
+        }
+    }
+    if(sync->batch_size < 2 || todo_sync_get_u16(sync->batch) != records) {
+        return TodoSyncErrorFrame;
+    }
+
+    uint32_t* known = &tasks->knowledge[TodoReplicaDesktop];
+    if(!sync->stats->rejected && desktop[TodoReplicaDesktop] > *known) {
+        *known = desktop[TodoReplicaDesktop];
+    }
+    payload[0] = sync->stats->rejected ? TodoSyncDoneFull : TodoSyncDoneOk;
+    todo_sync_put_u32(payload + 1, tasks->knowledge[TodoReplicaDevice]);
+    todo_sync_put_u32(payload + 5, tasks->knowledge[TodoReplicaDesktop]);
+    todo_sync_send(sync, TodoSyncFrameDone, payload, 9);
+    return TodoSyncOk;
+}
+
+TodoSyncResult todo_sync_run(TodoTasks* tasks, const TodoSyncIo* io, TodoSyncStats* stats) {
+    // About 2K of buffers, too much for the CLI thread's stack.
+    TodoSync* sync = malloc(sizeof(TodoSync));
+    memset(sync, 0, sizeof(TodoSync));
+    sync->tasks = tasks;
+    sync->io = io;
+    sync->stats = stats;
+    memset(stats, 0, sizeof(TodoSyncStats));
+
+    TodoSyncResult result = todo_sync_exchange(sync);
+    free(sync);
+    return result;
+}
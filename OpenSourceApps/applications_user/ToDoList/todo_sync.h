@@ -0,0 +1,71 @@
+#ifndef TODO_SYNC_H
+#define TODO_SYNC_H
+
+#include "todo_tasks.h"
+
+/**
+ * Delta sync of the task list with HostTools/todo_sync.py, run from the "todo_sync" CLI command.
+ *
+ * Frames are 0x7E, type, flags, payload length (u16), payload, CRC-16/CCITT-FALSE of everything
+ * after the 0x7E, all little endian.  If flags has TODO_SYNC_FLAG_COMPRESSED the payload is the
+ * raw length (u16) followed by heatshrink data.  A sync is:
+ *
+ *     flipper  HELLO  version, epoch, knowledge[2], task count, capacity
+ *     desktop  HELLO  version, knowledge[2]
+ *     flipper  RECORDS... END  tasks the desktop's knowledge doesn't cover
+ *     desktop  RECORDS... END  tasks the flipper's knowledge doesn't cover
+ *     flipper  DONE   status, knowledge[2]
+ *
+ * A record is id (u32), version[2] (u32 each), flags, text length, text.  When nothing changed
+ * on either side, only the HELLO, END and DONE frames cross the cable.
+ */
+
+#define TODO_SYNC_VERSION         1
+#define TODO_SYNC_SOF             0x7E
+#define TODO_SYNC_HEADER_SIZE     5
+#define TODO_SYNC_MAX_PAYLOAD     1024
+#define TODO_SYNC_TIMEOUT_MS      2000
+#define TODO_SYNC_FLAG_COMPRESSED 0x01
+#define TODO_SYNC_RECORD_DELETED  0x01
+
+typedef enum {
+    TodoSyncFrameHello = 0x01,
+    TodoSyncFrameRecords = 0x02,
+    TodoSyncFrameEnd = 0x03,
+    TodoSyncFrameDone = 0x04,
+} TodoSyncFrame;
+
+typedef enum {
+    TodoSyncOk,
+    TodoSyncErrorTimeout, // The desktop stopped answering
+    TodoSyncErrorFrame, // Bad CRC, unexpected frame or malformed payload
+    TodoSyncErrorVersion, // The desktop speaks a different protocol version
+} TodoSyncResult;
+
+typedef enum {
+    TodoSyncDoneOk,
+    TodoSyncDoneFull, // Some new tasks didn't fit, the desktop will send them again next time
+} TodoSyncDoneStatus;
+
+typedef struct {
+    // Read up to size bytes, waiting at most timeout_ms for the first one.  Returns the count.
+    size_t (*read)(void* context, uint8_t* data, size_t size, uint32_t timeout_ms);
+    void (*write)(void* context, const uint8_t* data, size_t size);
+    void* context;
+} TodoSyncIo;
+
+typedef struct {
+    size_t sent; // Records sent to the desktop
+    size_t received; // Records that changed the list
+    size_t rejected; // New tasks that didn't fit
+} TodoSyncStats;
+
+/**
+ * @brief      Run one sync with the desktop.  The caller holds whatever lock guards tasks.
+ * @details    Records are applied as they arrive.  The flipper only takes on the desktop's
+ *            knowledge when every record was received and stored, so after an error or a full
+ *            list the desktop simply sends the rest again.
+*/
+TodoSyncResult todo_sync_run(TodoTasks* tasks, const TodoSyncIo* io, TodoSyncStats* stats);
+
+#endif // TODO_SYNC_H
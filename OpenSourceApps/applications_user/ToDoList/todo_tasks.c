@@ -0,0 +1,75 @@
+#include "todo_tasks.h"
+#include <string.h>
+
+void todo_tasks_init(TodoTasks* tasks, uint32_t epoch) {
+    memset(tasks, 0, sizeof(TodoTasks));
+    tasks->next_id = 1;
+    tasks->epoch = epoch;
+}
+
+bool todo_tasks_add(TodoTasks* tasks, const char* text) {
+    if(tasks->count >= MAX_TASKS || text[0] == '\0') {
+        return false;
+    }
+
+    TodoTask* task = &tasks->tasks[tasks->count++];
+    memset(task, 0, sizeof(TodoTask));
+    task->id = tasks->next_id++ & ~TODO_TASK_ID_DESKTOP;
+    task->version[TodoReplicaDevice] = ++tasks->knowledge[TodoReplicaDevice];
+    strncpy(task->text, text, TASK_LENGTH - 1);
+    return true;
+}
+
+TodoTask* todo_tasks_find(TodoTasks* tasks, uint32_t id) {
+    for(size_t i = 0; i < tasks->count; i++) {
+        if(tasks->tasks[i].id == id) {
+            return &tasks->tasks[i];
+        }
+    }
+    return NULL;
+}
+
+bool todo_tasks_is_known(const uint32_t version[TodoReplicaCount], const uint32_t* knowledge) {
+    for(size_t i = 0; i < TodoReplicaCount; i++) {
+        if(version[i] > knowledge[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TodoTasksApply todo_tasks_apply(TodoTasks* tasks, const TodoTask* remote, bool deleted) {
+    TodoTask* local = todo_tasks_find(tasks, remote->id);
+
+    if(!local) {
+        if(deleted) {
+            return TodoTasksApplyIgnored;
+        }
+        if(tasks->count >= MAX_TASKS) {
+            return TodoTasksApplyFull;
+        }
+        local = &tasks->tasks[tasks->count++];
+        *local = *remote;
+        local->text[TASK_LENGTH - 1] = '\0';
+        return TodoTasksApplyChanged;
+    }
+
+    if(todo_tasks_is_known(remote->version, local->version)) {
+        return TodoTasksApplyIgnored;
+    }
+    if(deleted) {
+        size_t index = local - tasks->tasks;
+        memmove(local, local + 1, (--tasks->count - index) * sizeof(TodoTask));
+        return TodoTasksApplyChanged;
+    }
+
+    // Either the desktop's version is newer, or both changed and the desktop wins anyway.
+    for(size_t i = 0; i < TodoReplicaCount; i++) {
+        if(remote->version[i] > local->version[i]) {
+            local->version[i] = remote->version[i];
+        }
+    }
+    memcpy(local->text, remote->text, TASK_LENGTH);
+    local->text[TASK_LENGTH - 1] = '\0';
+    return TodoTasksApplyChanged;
+}
@@ -0,0 +1,71 @@
+#ifndef TODO_TASKS_H
+#define TODO_TASKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The task list, with what the desktop sync needs to tell old edits from new ones.  There are
+ * two replicas, the flipper and the desktop, and each counts its own edits.  A task's version
+ * vector holds the count at its last edit on each side, and the list's knowledge vector holds
+ * the newest count seen from each side, so anything not covered by the other side's knowledge
+ * is a change it hasn't seen yet.
+ */
+
+#define MAX_TASKS   10
+#define TASK_LENGTH 64
+
+typedef enum {
+    TodoReplicaDevice, // The flipper
+    TodoReplicaDesktop, // The computer at the other end of the sync
+    TodoReplicaCount,
+} TodoReplica;
+
+// Ids made on the desktop have the top bit set, so the two sides never hand out the same one.
+#define TODO_TASK_ID_DESKTOP 0x80000000UL
+
+typedef struct {
+    uint32_t id;
+    uint32_t version[TodoReplicaCount];
+    char text[TASK_LENGTH];
+} TodoTask;
+
+typedef struct {
+    TodoTask tasks[MAX_TASKS];
+    size_t count;
+    uint32_t knowledge[TodoReplicaCount];
+    uint32_t next_id;
+    uint32_t epoch; // Random per run, the desktop starts over when it changes
+} TodoTasks;
+
+typedef enum {
+    TodoTasksApplyIgnored, // Nothing new, or lost a conflict
+    TodoTasksApplyChanged,
+    TodoTasksApplyFull, // A new task but no room for it
+} TodoTasksApply;
+
+void todo_tasks_init(TodoTasks* tasks, uint32_t epoch);
+
+/**
+ * @brief      Add a task typed on the flipper.
+ * @return     false if the list is full or text is empty.
+*/
+bool todo_tasks_add(TodoTasks* tasks, const char* text);
+
+TodoTask* todo_tasks_find(TodoTasks* tasks, uint32_t id);
+
+/**
+ * @return     true if every count in version is covered by knowledge.
+*/
+bool todo_tasks_is_known(const uint32_t version[TodoReplicaCount], const uint32_t* knowledge);
+
+/**
+ * @brief      Merge a task from the desktop.
+ * @details    The newer version wins.  If both sides edited it since they last synced, the
+ *            desktop wins and the versions are merged, the same rule the desktop applies.  A
+ *            deleted task is removed.
+*/
+TodoTasksApply todo_tasks_apply(TodoTasks* tasks, const TodoTask* remote, bool deleted);
+
+#endif // TODO_TASKS_H
@@ -0,0 +1,416 @@
+#include "todo_words.h"
+#include <furi.h>
+
+#define TAG "TodoWords"
+
+#define TODO_WORDS_NONE        0xFFFF
+#define TODO_WORDS_MAGIC       "TDWD"
+#define TODO_WORDS_VERSION     1
+#define TODO_WORDS_HEADER_SIZE 8
+#define TODO_WORDS_ENTRY_SIZE  5
+
+/**
+ * File layout, integers little endian:
+ *
+ *   header: magic[4] version 0 word_count(u16)
+ *   word_count entries: count(u16) age(u16) length letters[length]
+ *
+ * The age is how many words were learned since this one was last used, so the oldest word is
+ * still the first to go after a reload.
+ */
+
+typedef struct {
+    char letter;
+    uint16_t parent;
+    uint16_t child; // First child, children are kept in letter order
+    uint16_t next; // Next sibling, or the next free node
+    uint16_t count; // Times the word ending here was entered, 0 if no word ends here
+    uint16_t best; // Highest count in this subtree, to skip subtrees that can't make the list
+    uint16_t used; // words->clock when the word ending here was last entered
+} TodoWordsNode;
+
+struct TodoWords {
+    TodoWordsNode nodes[TODO_WORDS_MAX_NODES]; // nodes[0] is the root
+    uint16_t free;
+    uint16_t free_count;
+    uint16_t clock;
+    bool changed;
+};
+
+static char todo_words_letter(char c) {
+    if(c >= 'A' && c <= 'Z') {
+        return c - 'A' + 'a';
+    }
+    if((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+        return c;
+    }
+    return 0;
+}
+
+static void todo_words_reset(TodoWords* words) {
+    memset(words, 0, sizeof(TodoWords));
+    words->nodes[0].parent = TODO_WORDS_NONE;
+    words->nodes[0].child = TODO_WORDS_NONE;
+    for(uint16_t i = 1; i < TODO_WORDS_MAX_NODES; i++) {
+        words->nodes[i].next = i + 1 < TODO_WORDS_MAX_NODES ? i + 1 : TODO_WORDS_NONE;
+    }
+    words->free = 1;
+    words->free_count = TODO_WORDS_MAX_NODES - 1;
+}
+
+TodoWords* todo_words_alloc(void) {
+    TodoWords* words = malloc(sizeof(TodoWords));
+    todo_words_reset(words);
+    return words;
+}
+
+void todo_words_free(TodoWords* words) {
+    free(words);
+}
+
+static uint16_t todo_words_child(TodoWords* words, uint16_t node, char letter) {
+    for(uint16_t child = words->nodes[node].child; child != TODO_WORDS_NONE;
+        child = words->nodes[child].next) {
+        if(words->nodes[child].letter == letter) {
+            return child;
+        }
+        if(words->nodes[child].letter > letter) {
+            break;
+        }
+    }
+    return TODO_WORDS_NONE;
+}
+
+static uint16_t todo_words_add_child(TodoWords* words, uint16_t node, char letter) {
+    uint16_t child = words->free;
+    TodoWordsNode* added = &words->nodes[child];
+    words->free = added->next;
+    words->free_count--;
+
+    uint16_t* link = &words->nodes[node].child;
+    while(*link != TODO_WORDS_NONE && words->nodes[*link].letter < letter) {
+        link = &words->nodes[*link].next;
+    }
+    added->letter = letter;
+    added->parent = node;
+    added->child = TODO_WORDS_NONE;
+    added->next = *link;
+    added->count = 0;
+    added->best = 0;
+    *link = child;
+    return child;
+}
+
+/**
+ * @brief      Work best out again from node up to the root, after a count went down.
+*/
+static void todo_words_update_best(TodoWords* words, uint16_t node) {
+    for(; node != TODO_WORDS_NONE; node = words->nodes[node].parent) {
+        uint16_t best = words->nodes[node].count;
+        for(uint16_t child = words->nodes[node].child; child != TODO_WORDS_NONE;
+            child = words->nodes[child].next) {
+            if(words->nodes[child].best > best) {
+                best = words->nodes[child].best;
+            }
+        }
+        words->nodes[node].best = best;
+    }
+}
+
+/**
+ * @brief      Drop the least used word and the nodes only it needed.
+ * @return     false if there are no words left to drop.
+*/
+static bool todo_words_evict(TodoWords* words) {
+    uint16_t victim = TODO_WORDS_NONE;
+    for(uint16_t i = 1; i < TODO_WORDS_MAX_NODES; i++) {
+        const TodoWordsNode* node = &words->nodes[i];
+        if(!node->count) {
+            continue;
+        }
+        if(victim == TODO_WORDS_NONE || node->count < words->nodes[victim].count ||
+           (node->count == words->nodes[victim].count &&
+            (uint16_t)(words->clock - node->used) >
+                (uint16_t)(words->clock - words->nodes[victim].used))) {
+            victim = i;
+        }
+    }
+    if(victim == TODO_WORDS_NONE) {
+        return false;
+    }
+
+    uint16_t node = victim;
+    words->nodes[node].count = 0;
+    while(node && !words->nodes[node].count && words->nodes[node].child == TODO_WORDS_NONE) {
+        uint16_t parent = words->nodes[node].parent;
+        uint16_t* link = &words->nodes[parent].child;
+        while(*link != node) {
+            link = &words->nodes[*link].next;
+        }
+        *link = words->nodes[node].next;
+        words->nodes[node].next = words->free;
+        words->nodes[node].best = 0;
+        words->free = node;
+        words->free_count++;
+        node = parent;
+    }
+    todo_words_update_best(words, node);
+    return true;
+}
+
+/**
+ * @brief      Add count uses of a word, making room for it first if needed.
+ * @return     The node the word ends on.
+*/
+static uint16_t todo_words_insert(
+    TodoWords* words,
+    const char* word,
+    size_t length,
+    uint16_t count) {
+    uint16_t node;
+    size_t depth;
+    while(true) {
+        // Dropping a word can take nodes this one shares, so look again after each drop.
+        node = 0;
+        for(depth = 0; depth < length; depth++) {
+            uint16_t child = todo_words_child(words, node, word[depth]);
+            if(child == TODO_WORDS_NONE) {
+                break;
+            }
+            node = child;
+        }
+        if(length - depth <= words->free_count || !todo_words_evict(words)) {
+            break;
+        }
+    }
+    for(; depth < length; depth++) {
+        node = todo_words_add_child(words, node, word[depth]);
+    }
+
+    TodoWordsNode* end = &words->nodes[node];
+    if(end->count > UINT16_MAX - count) {
+        // Halve every count so the ranking keeps working, and old favourites fade a little.
+        for(uint16_t i = 0; i < TODO_WORDS_MAX_NODES; i++) {
+            words->nodes[i].count = (words->nodes[i].count + 1) / 2;
+            words->nodes[i].best = (words->nodes[i].best + 1) / 2;
+        }
+    }
+    end->count = end->count > UINT16_MAX - count ? UINT16_MAX : end->count + count;
+    end->used = words->clock++;
+    for(uint16_t up = node; up != TODO_WORDS_NONE; up = words->nodes[up].parent) {
+        if(words->nodes[up].best < end->count) {
+            words->nodes[up].best = end->count;
+        }
+    }
+    words->changed = true;
+    return node;
+}
+
+void todo_words_learn(TodoWords* words, const char* text) {
+    char word[TODO_WORDS_MAX_LENGTH];
+    size_t length = 0;
+    bool too_long = false;
+
+    for(const char* c = text;; c++) {
+        char letter = *c ? todo_words_letter(*c) : 0;
+        if(letter) {
+            if(length < TODO_WORDS_MAX_LENGTH) {
+                word[length++] = letter;
+            } else {
+                too_long = true;
+            }
+            continue;
+        }
+        if(!too_long && length >= TODO_WORDS_MIN_LENGTH) {
+            todo_words_insert(words, word, length, 1);
+        }
+        length = 0;
+        too_long = false;
+        if(!*c) {
+            break;
+        }
+    }
+}
+
+typedef struct {
+    uint16_t nodes[TODO_WORDS_SUGGESTIONS];
+    size_t found;
+    size_t max;
+    size_t prefix_length;
+} TodoWordsSearch;
+
+static void todo_words_search(
+    TodoWords* words,
+    TodoWordsSearch* search,
+    uint16_t node,
+    size_t depth) {
+    const TodoWordsNode* current = &words->nodes[node];
+    bool full = search->found == search->max;
+    uint16_t last = full ? words->nodes[search->nodes[search->max - 1]].count : 0;
+    if(full && current->best <= last) {
+        return;
+    }
+    if(current->count > last && depth > search->prefix_length) {
+        size_t slot = search->found < search->max ? search->found++ : search->max - 1;
+        while(slot && words->nodes[search->nodes[slot - 1]].count < current->count) {
+            search->nodes[slot] = search->nodes[slot - 1];
+            slot--;
+        }
+        search->nodes[slot] = node;
+    }
+    for(uint16_t child = current->child; child != TODO_WORDS_NONE;
+        child = words->nodes[child].next) {
+        todo_words_search(words, search, child, depth + 1);
+    }
+}
+
+static size_t todo_words_spell(TodoWords* words, uint16_t node, char* out) {
+    size_t length = 0;
+    for(uint16_t up = node; up; up = words->nodes[up].parent) {
+        length++;
+    }
+    out[length] = '\0';
+    for(size_t i = length; i > 0; i--, node = words->nodes[node].parent) {
+        out[i - 1] = words->nodes[node].letter;
+    }
+    return length;
+}
+
+size_t todo_words_complete(
+    TodoWords* words,
+    const char* prefix,
+    TodoWordsSuggestion* suggestions,
+    size_t max) {
+    TodoWordsSearch search = {.found = 0, .max = MIN(max, (size_t)TODO_WORDS_SUGGESTIONS)};
+    uint16_t node = 0;
+
+    for(; prefix[search.prefix_length]; search.prefix_length++) {
+        char letter = todo_words_letter(prefix[search.prefix_length]);
+        node = letter ? todo_words_child(words, node, letter) : TODO_WORDS_NONE;
+        if(node == TODO_WORDS_NONE) {
+            return 0;
+        }
+    }
+    if(!search.prefix_length || !search.max) {
+        return 0;
+    }
+
+    todo_words_search(words, &search, node, search.prefix_length);
+    for(size_t i = 0; i < search.found; i++) {
+        todo_words_spell(words, search.nodes[i], suggestions[i]);
+    }
+    return search.found;
+}
+
+bool todo_words_load(TodoWords* words, const char* path) {
+    todo_words_reset(words);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    uint8_t* data = NULL;
+    bool ok = false;
+
+    do {
+        if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+            break;
+        }
+        // One read for the whole file, it's at most a few KB.
+        size_t size = storage_file_size(file);
+        size_t largest = TODO_WORDS_HEADER_SIZE +
+                         TODO_WORDS_MAX_NODES * (TODO_WORDS_ENTRY_SIZE + TODO_WORDS_MAX_LENGTH);
+        if(size < TODO_WORDS_HEADER_SIZE || size > largest) {
+            break;
+        }
+        data = malloc(size);
+        if(storage_file_read(file, data, size) != size || memcmp(data, TODO_WORDS_MAGIC, 4) ||
+           data[4] != TODO_WORDS_VERSION) {
+            break;
+        }
+
+        size_t count = data[6] | (data[7] << 8);
+        size_t offset = TODO_WORDS_HEADER_SIZE;
+        ok = true;
+        for(size_t i = 0; i < count && ok; i++) {
+            const uint8_t* entry = data + offset;
+            size_t length = offset + TODO_WORDS_ENTRY_SIZE <= size ? entry[4] : 0;
+            char word[TODO_WORDS_MAX_LENGTH];
+            ok = length >= TODO_WORDS_MIN_LENGTH && length <= TODO_WORDS_MAX_LENGTH &&
+                 offset + TODO_WORDS_ENTRY_SIZE + length <= size;
+            for(size_t j = 0; j < length && ok; j++) {
+                word[j] = entry[TODO_WORDS_ENTRY_SIZE + j];
+                ok = todo_words_letter(word[j]) == word[j];
+            }
+            if(ok) {
+                uint16_t age = entry[2] | (entry[3] << 8);
+                uint16_t node = todo_words_insert(words, word, length, entry[0] | (entry[1] << 8));
+                words->clock--;
+                words->nodes[node].used = words->clock - age;
+                offset += TODO_WORDS_ENTRY_SIZE + length;
+            }
+        }
+    } while(false);
+
+    if(!ok) {
+        FURI_LOG_I(TAG, "No word list at %s, starting empty", path);
+        todo_words_reset(words);
+    }
+    words->changed = false;
+    free(data);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
+bool todo_words_save(TodoWords* words, const char* path) {
+    if(!words->changed) {
+        return true;
+    }
+
+    size_t count = 0;
+    size_t size = TODO_WORDS_HEADER_SIZE;
+    for(uint16_t i = 1; i < TODO_WORDS_MAX_NODES; i++) {
+        if(words->nodes[i].count) {
+            count++;
+            size += TODO_WORDS_ENTRY_SIZE + TODO_WORDS_MAX_LENGTH;
+        }
+    }
+    uint8_t* data = malloc(size);
+    memcpy(data, TODO_WORDS_MAGIC, 4);
+    data[4] = TODO_WORDS_VERSION;
+    data[5] = 0;
+    data[6] = count;
+    data[7] = count >> 8;
+    size = TODO_WORDS_HEADER_SIZE;
+    for(uint16_t i = 1; i < TODO_WORDS_MAX_NODES; i++) {
+        const TodoWordsNode* node = &words->nodes[i];
+        if(!node->count) {
+            continue;
+        }
+        uint16_t age = words->clock - node->used;
+        uint8_t* entry = data + size;
+        entry[0] = node->count;
+        entry[1] = node->count >> 8;
+        entry[2] = age;
+        entry[3] = age >> 8;
+        char word[TODO_WORDS_MAX_LENGTH + 1];
+        entry[4] = todo_words_spell(words, i, word);
+        memcpy(entry + TODO_WORDS_ENTRY_SIZE, word, entry[4]);
+        size += TODO_WORDS_ENTRY_SIZE + entry[4];
+    }
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, data, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    free(data);
+
+    if(ok) {
+        words->changed = false;
+    } else {
+        FURI_LOG_E(TAG, "Failed to save the word list");
+    }
+    return ok;
+}
@@ -0,0 +1,58 @@
+#ifndef TODO_WORDS_H
+#define TODO_WORDS_H
+
+#include <storage/storage.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Word completion for task entry.  Every word of every task added is counted in a trie that
+ * lives in a fixed pool of nodes, and each node remembers the highest count below it, so the
+ * most used completions of a prefix are found without looking at the words that can't make the
+ * list.  When the pool is full the least used word (the oldest one on a tie) is dropped to make
+ * room.  Words are letters and digits, lower case, TODO_WORDS_MIN_LENGTH to
+ * TODO_WORDS_MAX_LENGTH long.
+ */
+
+#define TODO_WORDS_PATH        APP_DATA_PATH("words.bin")
+#define TODO_WORDS_MAX_NODES   512 // 14 bytes each
+#define TODO_WORDS_MIN_LENGTH  3 // Shorter words aren't worth completing
+#define TODO_WORDS_MAX_LENGTH  16
+#define TODO_WORDS_SUGGESTIONS 3
+
+typedef struct TodoWords TodoWords;
+
+typedef char TodoWordsSuggestion[TODO_WORDS_MAX_LENGTH + 1];
+
+TodoWords* todo_words_alloc(void);
+void todo_words_free(TodoWords* words);
+
+/**
+ * @brief      Count every word in text.
+*/
+void todo_words_learn(TodoWords* words, const char* text);
+
+/**
+ * @brief      Find the most used words that start with prefix and are longer than it.
+ * @details    Case doesn't matter in prefix.  The suggestions are lower case, most used first.
+ * @return     How many suggestions were written, at most max.
+*/
+size_t todo_words_complete(
+    TodoWords* words,
+    const char* prefix,
+    TodoWordsSuggestion* suggestions,
+    size_t max);
+
+/**
+ * @brief      Replace the dictionary with the one saved at path.
+ * @return     false if there is no file or it isn't a word file, the dictionary is then empty.
+*/
+bool todo_words_load(TodoWords* words, const char* path);
+
+/**
+ * @brief      Save the dictionary to path, if it changed since it was loaded or last saved.
+*/
+bool todo_words_save(TodoWords* words, const char* path);
+
+#endif // TODO_WORDS_H
@@ -0,0 +1,315 @@
+#include "asset_pack.h"
+#include "heatshrink.h"
+#include <furi.h>
+
+#define TAG "AssetPack"
+
+#define ASSET_PACK_MAGIC       0x4B415041 // "APAK"
+#define ASSET_PACK_VERSION     1
+#define ASSET_PACK_HEADER_SIZE 16
+#define ASSET_PACK_ICON_SIZE   12
+#define ASSET_PACK_FRAME_SIZE  2
+#define ASSET_PACK_BLOB_SIZE   16
+
+typedef enum {
+    AssetPackStateUnread,
+    AssetPackStateReady,
+    AssetPackStateFailed, // Missing or broken, not retried until the pack is freed
+} AssetPackState;
+
+typedef struct {
+    uint8_t* bitmap; // NULL if the slot is empty
+    uint16_t blob;
+    uint16_t size;
+    uint32_t last_used;
+} AssetPackSlot;
+
+struct AssetPack {
+    FuriMutex* mutex;
+    const char* path;
+    AssetPackState state;
+    Storage* storage;
+    File* file;
+
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint16_t icon_count;
+    uint16_t frame_count;
+    uint16_t blob_count;
+    uint8_t* index; // Icon, frame and blob tables as stored in the file
+    const uint8_t* icons;
+    const uint8_t* frames;
+    const uint8_t* blobs;
+
+    AssetPackSlot slots[ASSET_PACK_CACHE_SLOTS];
+    size_t cached_bytes;
+    uint32_t clock;
+};
+
+static uint16_t asset_pack_get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t asset_pack_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static uint32_t asset_pack_hash(const char* name) {
+    uint32_t hash = 0x811C9DC5;
+    while(*name) {
+        hash = (hash ^ (uint8_t)*name++) * 0x01000193;
+    }
+    return hash;
+}
+
+static const uint8_t* asset_pack_blob(AssetPack* pack, uint16_t blob) {
+    return pack->blobs + blob * ASSET_PACK_BLOB_SIZE;
+}
+
+/**
+ * @brief      Check that every table entry points inside the file and that every frame is the
+ *            right size for its icon, so the draw path can trust the index.
+*/
+static bool asset_pack_check_index(AssetPack* pack, uint64_t file_size) {
+    for(uint16_t i = 0; i < pack->blob_count; i++) {
+        const uint8_t* blob = asset_pack_blob(pack, i);
+        uint32_t offset = asset_pack_get32(blob + 8);
+        uint16_t packed_size = asset_pack_get16(blob + 12);
+        uint16_t size = asset_pack_get16(blob + 14);
+        if(packed_size > size || (uint64_t)offset + packed_size > file_size) {
+            return false;
+        }
+    }
+    for(uint16_t i = 0; i < pack->icon_count; i++) {
+        const uint8_t* icon = pack->icons + i * ASSET_PACK_ICON_SIZE;
+        uint16_t bitmap_size = ((icon[4] + 7) / 8) * icon[5];
+        uint16_t first = asset_pack_get16(icon + 8);
+        if(icon[6] == 0 || first + icon[6] > pack->frame_count) {
+            return false;
+        }
+        for(uint16_t frame = first; frame < first + icon[6]; frame++) {
+            uint16_t blob = asset_pack_get16(pack->frames + frame * ASSET_PACK_FRAME_SIZE);
+            if(blob >= pack->blob_count ||
+               asset_pack_get16(asset_pack_blob(pack, blob) + 14) != bitmap_size) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool asset_pack_load(AssetPack* pack) {
+    uint8_t header[ASSET_PACK_HEADER_SIZE];
+
+    pack->storage = furi_record_open(RECORD_STORAGE);
+    pack->file = storage_file_alloc(pack->storage);
+    if(!storage_file_open(pack->file, pack->path, FSAM_READ, FSOM_OPEN_EXISTING) ||
+       storage_file_read(pack->file, header, sizeof(header)) != sizeof(header)) {
+        FURI_LOG_W(TAG, "Can't read %s", pack->path);
+        return false;
+    }
+    if(asset_pack_get32(header) != ASSET_PACK_MAGIC || header[4] != ASSET_PACK_VERSION ||
+       header[5] < 4 || header[5] > 15 || header[6] == 0 || header[6] >= header[5]) {
+        FURI_LOG_E(TAG, "%s is not a version %d pack", pack->path, ASSET_PACK_VERSION);
+        return false;
+    }
+    pack->window_bits = header[5];
+    pack->lookahead_bits = header[6];
+    pack->icon_count = asset_pack_get16(header + 8);
+    pack->frame_count = asset_pack_get16(header + 10);
+    pack->blob_count = asset_pack_get16(header + 12);
+
+    uint64_t file_size = storage_file_size(pack->file);
+    size_t index_size = pack->icon_count * ASSET_PACK_ICON_SIZE +
+                        pack->frame_count * ASSET_PACK_FRAME_SIZE +
+                        pack->blob_count * ASSET_PACK_BLOB_SIZE;
+    if(ASSET_PACK_HEADER_SIZE + index_size > file_size) {
+        FURI_LOG_E(TAG, "Truncated index");
+        return false;
+    }
+    pack->index = malloc(index_size);
+    if(storage_file_read(pack->file, pack->index, index_size) != index_size) {
+        return false;
+    }
+    pack->icons = pack->index;
+    pack->frames = pack->icons + pack->icon_count * ASSET_PACK_ICON_SIZE;
+    pack->blobs = pack->frames + pack->frame_count * ASSET_PACK_FRAME_SIZE;
+
+    if(!asset_pack_check_index(pack, file_size)) {
+        FURI_LOG_E(TAG, "Broken index");
+        return false;
+    }
+    FURI_LOG_D(TAG, "%u icons, %u blobs", pack->icon_count, pack->blob_count);
+    return true;
+}
+
+static void asset_pack_unload(AssetPack* pack) {
+    for(size_t i = 0; i < ASSET_PACK_CACHE_SLOTS; i++) {
+        free(pack->slots[i].bitmap);
+        pack->slots[i].bitmap = NULL;
+    }
+    pack->cached_bytes = 0;
+    free(pack->index);
+    pack->index = NULL;
+    if(pack->file) {
+        storage_file_close(pack->file);
+        storage_file_free(pack->file);
+        pack->file = NULL;
+        furi_record_close(RECORD_STORAGE);
+    }
+}
+
+/**
+ * @brief      Find an icon by name.  The icon table is sorted by name hash.
+ * @return     The icon's table entry, or NULL.
+*/
+static const uint8_t* asset_pack_find(AssetPack* pack, const char* name) {
+    if(pack->state == AssetPackStateUnread) {
+        pack->state = asset_pack_load(pack) ? AssetPackStateReady : AssetPackStateFailed;
+        if(pack->state == AssetPackStateFailed) {
+            asset_pack_unload(pack);
+        }
+    }
+    if(pack->state != AssetPackStateReady) {
+        return NULL;
+    }
+
+    uint32_t hash = asset_pack_hash(name);
+    size_t low = 0;
+    size_t high = pack->icon_count;
+    while(low < high) {
+        size_t middle = (low + high) / 2;
+        const uint8_t* icon = pack->icons + middle * ASSET_PACK_ICON_SIZE;
+        uint32_t value = asset_pack_get32(icon);
+        if(value == hash) {
+            return icon;
+        } else if(value < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return NULL;
+}
+
+static void asset_pack_evict(AssetPack* pack, AssetPackSlot* slot) {
+    pack->cached_bytes -= slot->size;
+    free(slot->bitmap);
+    slot->bitmap = NULL;
+}
+
+/**
+ * @brief      Get a blob's bitmap, unpacking it into the cache on a miss.  The least recently
+ *            used slots are dropped until the new bitmap fits.
+*/
+static const uint8_t* asset_pack_get_bitmap(AssetPack* pack, uint16_t blob) {
+    AssetPackSlot* slot = NULL;
+    pack->clock++;
+    for(size_t i = 0; i < ASSET_PACK_CACHE_SLOTS; i++) {
+        if(pack->slots[i].bitmap && pack->slots[i].blob == blob) {
+            pack->slots[i].last_used = pack->clock;
+            return pack->slots[i].bitmap;
+        }
+    }
+
+    const uint8_t* entry = asset_pack_blob(pack, blob);
+    uint32_t offset = asset_pack_get32(entry + 8);
+    uint16_t packed_size = asset_pack_get16(entry + 12);
+    uint16_t size = asset_pack_get16(entry + 14);
+    if(size > ASSET_PACK_CACHE_BYTES) {
+        FURI_LOG_E(TAG, "Blob %u is larger than the cache", blob);
+        return NULL;
+    }
+
+    while(true) {
+        AssetPackSlot* oldest = NULL;
+        slot = NULL;
+        for(size_t i = 0; i < ASSET_PACK_CACHE_SLOTS; i++) {
+            if(!pack->slots[i].bitmap) {
+                slot = slot ? slot : &pack->slots[i];
+            } else if(!oldest || pack->slots[i].last_used < oldest->last_used) {
+                oldest = &pack->slots[i];
+            }
+        }
+        if(slot && pack->cached_bytes + size <= ASSET_PACK_CACHE_BYTES) {
+            break;
+        }
+        asset_pack_evict(pack, oldest);
+    }
+
+    uint8_t* bitmap = malloc(size);
+    uint8_t* packed = packed_size == size ? bitmap : malloc(packed_size);
+    bool ok = storage_file_seek(pack->file, offset, true) &&
+              storage_file_read(pack->file, packed, packed_size) == packed_size;
+    if(packed != bitmap) {
+        if(ok) {
+            ok = heatshrink_decode(
+                packed, packed_size, bitmap, size, pack->window_bits, pack->lookahead_bits);
+        }
+        free(packed);
+    }
+    if(!ok) {
+        FURI_LOG_E(TAG, "Can't unpack blob %u", blob);
+        free(bitmap);
+        return NULL;
+    }
+
+    slot->bitmap = bitmap;
+    slot->blob = blob;
+    slot->size = size;
+    slot->last_used = pack->clock;
+    pack->cached_bytes += size;
+    return bitmap;
+}
+
+AssetPack* asset_pack_alloc(const char* path) {
+    AssetPack* pack = malloc(sizeof(AssetPack));
+    memset(pack, 0, sizeof(AssetPack));
+    pack->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    pack->path = path;
+    pack->state = AssetPackStateUnread;
+    return pack;
+}
+
+void asset_pack_free(AssetPack* pack) {
+    asset_pack_unload(pack);
+    furi_mutex_free(pack->mutex);
+    free(pack);
+}
+
+bool asset_pack_get_icon(AssetPack* pack, const char* name, AssetPackIcon* icon) {
+    furi_mutex_acquire(pack->mutex, FuriWaitForever);
+    const uint8_t* entry = asset_pack_find(pack, name);
+    if(entry) {
+        icon->width = entry[4];
+        icon->height = entry[5];
+        icon->frame_count = entry[6];
+        icon->frame_rate = entry[7];
+    }
+    furi_mutex_release(pack->mutex);
+    return entry != NULL;
+}
+
+bool asset_pack_draw(
+    AssetPack* pack,
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    const char* name,
+    uint32_t frame) {
+    const uint8_t* bitmap = NULL;
+
+    furi_mutex_acquire(pack->mutex, FuriWaitForever);
+    const uint8_t* entry = asset_pack_find(pack, name);
+    if(entry) {
+        uint16_t index = asset_pack_get16(entry + 8) + frame % entry[6];
+        uint16_t blob = asset_pack_get16(pack->frames + index * ASSET_PACK_FRAME_SIZE);
+        bitmap = asset_pack_get_bitmap(pack, blob);
+    }
+    if(bitmap) {
+        canvas_draw_xbm(canvas, x, y, entry[4], entry[5], bitmap);
+    }
+    furi_mutex_release(pack->mutex);
+    return bitmap != NULL;
+}
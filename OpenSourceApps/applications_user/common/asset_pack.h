@@ -0,0 +1,56 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <gui/canvas.h>
+#include <storage/storage.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Shared icon pack on the SD card, built by HostTools/asset_pack.py.  Each distinct frame is
+ * stored once as a heatshrink compressed 1bpp bitmap, so the apps don't each carry their own
+ * copy inside the FAP.  The index is read on first use, and frames are unpacked into a small LRU
+ * cache, so an animation only decompresses each frame once instead of on every redraw.
+ */
+
+#define ASSET_PACK_PATH        EXT_PATH("apps_assets/common/icons.pack")
+#define ASSET_PACK_CACHE_SLOTS 8
+#define ASSET_PACK_CACHE_BYTES 2048 // Unpacked bitmap bytes kept across all slots
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t frame_count;
+    uint8_t frame_rate; // Frames per second, 0 for still icons
+} AssetPackIcon;
+
+typedef struct AssetPack AssetPack;
+
+/**
+ * @brief      Allocate a pack reader.  Nothing is read until the first icon is needed.
+ * @param      path  The pack file, usually ASSET_PACK_PATH.
+*/
+AssetPack* asset_pack_alloc(const char* path);
+
+void asset_pack_free(AssetPack* pack);
+
+/**
+ * @brief      Look up an icon's size and frame count.
+ * @return     false if the pack is missing or broken, or has no icon with that name.
+*/
+bool asset_pack_get_icon(AssetPack* pack, const char* name, AssetPackIcon* icon);
+
+/**
+ * @brief      Draw one frame of an icon, like canvas_draw_icon().
+ * @param      frame  Frame to draw, wrapped around the icon's frame count.
+ * @return     false if the icon could not be drawn, so the caller can draw something else.
+*/
+bool asset_pack_draw(
+    AssetPack* pack,
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    const char* name,
+    uint32_t frame);
+
+#endif // ASSET_PACK_H
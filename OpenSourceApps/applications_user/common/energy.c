@@ -0,0 +1,321 @@
+#include "energy.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <gui/gui.h>
+#include <input/input.h>
+#include <notification/notification.h>
+#include <notification/notification_messages.h>
+
+#define TAG "Energy"
+
+static const EnergyCurrents energy_currents_default = {
+    .base_ua = 3000,
+    .cpu_ua = 7000,
+    .backlight_ua = 12000,
+    .speaker_ua = 25000,
+    .frame_us = 2000,
+};
+
+typedef enum {
+    EnergyLightOff,
+    EnergyLightDim,
+    EnergyLightFull,
+} EnergyLight;
+
+typedef struct {
+    uint32_t ticks; // On screen
+    uint32_t frames;
+    uint64_t cpu_us; // Drawing and sending frames
+    uint32_t full_ticks; // Backlight at full brightness
+    uint32_t dim_ticks;
+    uint32_t speaker_ticks;
+} EnergyStats;
+
+struct Energy {
+    const EnergyConfig* config;
+    const EnergyCurrents* currents;
+    FuriMutex* mutex; // The GUI, input and timer threads all report here
+    EnergyStats* stats; // One per config->views row
+    size_t current; // Row showing now, config->view_count for none
+    uint32_t since; // Tick the stats were last added up to
+
+    EnergyLight light;
+    bool speaker;
+    FuriTimer* idle_timer; // Dims the backlight, or guesses the firmware turned it off
+    NotificationApp* notifications;
+    NotificationMessage dim_message;
+    const NotificationMessage* dim_sequence[2];
+
+    Gui* gui;
+    FuriPubSub* input;
+    FuriPubSubSubscription* input_subscription;
+};
+
+/**
+ * @brief      Add the time since the last call to the current view.  Call with the mutex held,
+ *            before anything the stats depend on changes.
+*/
+static void energy_account(Energy* energy) {
+    uint32_t now = furi_get_tick();
+    uint32_t elapsed = now - energy->since;
+    energy->since = now;
+    if(energy->current == energy->config->view_count) {
+        return;
+    }
+
+    EnergyStats* stats = &energy->stats[energy->current];
+    stats->ticks += elapsed;
+    if(energy->light == EnergyLightFull) {
+        stats->full_ticks += elapsed;
+    } else if(energy->light == EnergyLightDim) {
+        stats->dim_ticks += elapsed;
+    }
+    if(energy->speaker) {
+        stats->speaker_ticks += elapsed;
+    }
+}
+
+/**
+ * @brief      Start the idle timer over for the current view.  Not with the mutex held, stopping
+ *            a timer waits for its callback, which takes the mutex.
+*/
+static void energy_idle_restart(Energy* energy) {
+    uint32_t delay = 0;
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    if(energy->config->backlight == EnergyBacklightAuto) {
+        delay = ENERGY_AUTO_OFF_MS;
+    } else if(
+        energy->config->backlight == EnergyBacklightDim &&
+        energy->current < energy->config->view_count) {
+        delay = energy->config->views[energy->current].dim_after_ms;
+    }
+    furi_mutex_release(energy->mutex);
+
+    if(delay) {
+        furi_timer_start(energy->idle_timer, furi_ms_to_ticks(delay));
+    } else {
+        furi_timer_stop(energy->idle_timer);
+    }
+}
+
+/**
+ * @brief      Something happened on screen, bring the backlight back up if it was dimmed.
+*/
+static void energy_wake(Energy* energy) {
+    bool wake = false;
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    energy_account(energy);
+    wake = energy->light != EnergyLightFull;
+    energy->light = EnergyLightFull;
+    furi_mutex_release(energy->mutex);
+
+    if(wake && energy->config->backlight == EnergyBacklightDim) {
+        notification_message(energy->notifications, &sequence_display_backlight_on);
+    }
+    energy_idle_restart(energy);
+}
+
+static void energy_idle_callback(void* context) {
+    Energy* energy = context;
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    energy_account(energy);
+    energy->light = energy->config->backlight == EnergyBacklightDim ? EnergyLightDim :
+                                                                     EnergyLightOff;
+    furi_mutex_release(energy->mutex);
+
+    if(energy->config->backlight == EnergyBacklightDim) {
+        notification_message(
+            energy->notifications, (const NotificationSequence*)energy->dim_sequence);
+    }
+}
+
+static void energy_input_callback(const void* message, void* context) {
+    const InputEvent* event = message;
+    if(event->type == InputTypePress) {
+        energy_wake(context);
+    }
+}
+
+// Runs on the GUI thread after every frame goes to the display
+static void energy_frame_callback(
+    uint8_t* data,
+    size_t size,
+    CanvasOrientation orientation,
+    void* context) {
+    UNUSED(data);
+    UNUSED(size);
+    UNUSED(orientation);
+    Energy* energy = context;
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    if(energy->current < energy->config->view_count) {
+        energy->stats[energy->current].frames++;
+        energy->stats[energy->current].cpu_us += energy->currents->frame_us;
+    }
+    furi_mutex_release(energy->mutex);
+}
+
+Energy* energy_alloc(const EnergyConfig* config) {
+    Energy* energy = malloc(sizeof(Energy));
+    memset(energy, 0, sizeof(Energy));
+    energy->config = config;
+    energy->currents = config->currents ? config->currents : &energy_currents_default;
+    energy->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    energy->stats = malloc(sizeof(EnergyStats) * config->view_count);
+    memset(energy->stats, 0, sizeof(EnergyStats) * config->view_count);
+    energy->current = config->view_count;
+    energy->since = furi_get_tick();
+
+    // The app was just opened with a key press, so the backlight is on.
+    energy->light = EnergyLightFull;
+    energy->dim_message.type = NotificationMessageTypeLedDisplayBacklight;
+    energy->dim_message.data.led.value = config->dim_level;
+    energy->dim_sequence[0] = &energy->dim_message;
+    energy->dim_sequence[1] = NULL;
+    energy->notifications = furi_record_open(RECORD_NOTIFICATION);
+    if(config->backlight != EnergyBacklightAuto) {
+        notification_message(energy->notifications, &sequence_display_backlight_enforce_on);
+    }
+    energy->idle_timer = furi_timer_alloc(energy_idle_callback, FuriTimerTypeOnce, energy);
+    energy_idle_restart(energy);
+
+    energy->gui = furi_record_open(RECORD_GUI);
+    gui_add_framebuffer_callback(energy->gui, energy_frame_callback, energy);
+    energy->input = furi_record_open(RECORD_INPUT_EVENTS);
+    energy->input_subscription =
+        furi_pubsub_subscribe(energy->input, energy_input_callback, energy);
+    return energy;
+}
+
+// Charge in microamp milliseconds
+static uint64_t energy_charge(Energy* energy, const EnergyStats* stats) {
+    const EnergyCurrents* currents = energy->currents;
+    uint32_t frequency = furi_kernel_get_tick_frequency();
+    uint64_t charge = (uint64_t)currents->base_ua * stats->ticks;
+    charge += (uint64_t)currents->backlight_ua * stats->full_ticks;
+    charge += (uint64_t)currents->backlight_ua * energy->config->dim_level / 255 *
+              stats->dim_ticks;
+    charge += (uint64_t)currents->speaker_ua * stats->speaker_ticks;
+    charge = charge * 1000 / frequency;
+    return charge + (uint64_t)currents->cpu_ua * stats->cpu_us / 1000;
+}
+
+static void energy_report(Energy* energy) {
+    uint32_t frequency = furi_kernel_get_tick_frequency();
+    EnergyStats total = {0};
+    uint64_t total_charge = 0;
+
+    for(size_t i = 0; i < energy->config->view_count; i++) {
+        const EnergyStats* stats = &energy->stats[i];
+        if(!stats->ticks) {
+            continue;
+        }
+        uint64_t charge = energy_charge(energy, stats);
+        FURI_LOG_I(
+            TAG,
+            "%s: %lu ms, %lu frames, CPU %lu ms, backlight full %lu ms dim %lu ms, "
+            "speaker %lu ms, %lu uAh",
+            energy->config->views[i].name,
+            (uint32_t)((uint64_t)stats->ticks * 1000 / frequency),
+            stats->frames,
+            (uint32_t)(stats->cpu_us / 1000),
+            (uint32_t)((uint64_t)stats->full_ticks * 1000 / frequency),
+            (uint32_t)((uint64_t)stats->dim_ticks * 1000 / frequency),
+            (uint32_t)((uint64_t)stats->speaker_ticks * 1000 / frequency),
+            (uint32_t)(charge / 3600000));
+
+        total.ticks += stats->ticks;
+        total.frames += stats->frames;
+        total.cpu_us += stats->cpu_us;
+        total.full_ticks += stats->full_ticks;
+        total.dim_ticks += stats->dim_ticks;
+        total.speaker_ticks += stats->speaker_ticks;
+        total_charge += charge;
+    }
+    if(!total.ticks) {
+        return;
+    }
+
+    // What the same session would have cost with the backlight held at full brightness
+    EnergyStats always_on = total;
+    always_on.full_ticks = total.ticks;
+    always_on.dim_ticks = 0;
+    uint64_t saved = energy_charge(energy, &always_on) - energy_charge(energy, &total);
+    uint32_t ms = (uint64_t)total.ticks * 1000 / frequency;
+    FURI_LOG_I(
+        TAG,
+        "Total: %lu ms, %lu frames, %lu uAh, average %lu uA, %lu uAh less than backlight on",
+        ms,
+        total.frames,
+        (uint32_t)(total_charge / 3600000),
+        (uint32_t)(total_charge / MAX(ms, 1UL)),
+        (uint32_t)(saved / 3600000));
+}
+
+void energy_free(Energy* energy) {
+    furi_pubsub_unsubscribe(energy->input, energy->input_subscription);
+    furi_record_close(RECORD_INPUT_EVENTS);
+    gui_remove_framebuffer_callback(energy->gui, energy_frame_callback, energy);
+    furi_record_close(RECORD_GUI);
+    furi_timer_stop(energy->idle_timer);
+    furi_timer_free(energy->idle_timer);
+
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    energy_account(energy);
+    furi_mutex_release(energy->mutex);
+    energy_report(energy);
+
+    if(energy->config->backlight != EnergyBacklightAuto) {
+        if(energy->light != EnergyLightFull) {
+            notification_message(energy->notifications, &sequence_display_backlight_on);
+        }
+        // Blocking, so every message queued before it is played first.  A dim from the idle
+        // timer may still be waiting, and it points into energy.
+        notification_message_block(
+            energy->notifications, &sequence_display_backlight_enforce_auto);
+    }
+    furi_record_close(RECORD_NOTIFICATION);
+
+    furi_mutex_free(energy->mutex);
+    free(energy->stats);
+    free(energy);
+}
+
+void energy_view_enter(Energy* energy, uint32_t view) {
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    energy_account(energy);
+    energy->current = energy->config->view_count;
+    for(size_t i = 0; i < energy->config->view_count; i++) {
+        if(energy->config->views[i].id == view) {
+            energy->current = i;
+            break;
+        }
+    }
+    furi_mutex_release(energy->mutex);
+
+    if(energy->config->backlight == EnergyBacklightAuto) {
+        // A switch doesn't turn the backlight on by itself, leave the firmware's timer alone.
+        return;
+    }
+    energy_wake(energy);
+}
+
+uint32_t energy_draw_begin(Energy* energy) {
+    UNUSED(energy);
+    return DWT->CYCCNT;
+}
+
+void energy_draw_end(Energy* energy, uint32_t start) {
+    uint32_t us = (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    if(energy->current < energy->config->view_count) {
+        energy->stats[energy->current].cpu_us += us;
+    }
+    furi_mutex_release(energy->mutex);
+}
+
+void energy_speaker(Energy* energy, bool on) {
+    furi_mutex_acquire(energy->mutex, FuriWaitForever);
+    energy_account(energy);
+    energy->speaker = on;
+    furi_mutex_release(energy->mutex);
+}
@@ -0,0 +1,94 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Energy profiler and backlight policy.  While the app runs it adds up, for each of its views,
+ * the time on screen, the frames sent to the display, the CPU time spent drawing them, the time
+ * the backlight was at full and at dim brightness and the time the speaker played.  Those times
+ * are turned into charge with the figures in EnergyCurrents, and the report is logged when the
+ * profiler is freed.
+ *
+ * Views are tracked through view_table_switch_to() (set config.switched in the ViewTableConfig to
+ * call energy_view_enter()), frames through the GUI's framebuffer callback and key presses
+ * through the input events record, so most views need no code of their own.  Draw callbacks that
+ * do real work can be wrapped in energy_draw_begin()/energy_draw_end() to count their CPU time.
+ */
+
+#define ENERGY_DIM_LEVEL   16 // Backlight brightness when dimmed, out of 255
+#define ENERGY_AUTO_OFF_MS 30000 // Firmware's default backlight time, for EnergyBacklightAuto
+
+typedef enum {
+    // Backlight is left to the firmware, which turns it off ENERGY_AUTO_OFF_MS after the last key
+    // (that is only an estimate, the real delay is in the user's settings).
+    EnergyBacklightAuto,
+    // Held at full brightness while the app runs.  What the apps did before, kept to compare.
+    EnergyBacklightOn,
+    // Held on while the app runs, dimmed to dim_level once the view was idle for its dim_after_ms.
+    EnergyBacklightDim,
+} EnergyBacklight;
+
+/**
+ * Current drawn in each state, in microamps.  The defaults are rough figures for a Flipper Zero
+ * running from its battery; measure your own with a USB meter and pass them in config.currents.
+ */
+typedef struct {
+    uint32_t base_ua; // Whole device with the CPU asleep and the backlight off
+    uint32_t cpu_ua; // Extra while the CPU runs
+    uint32_t backlight_ua; // Extra at full brightness, dim counts by its share of 255
+    uint32_t speaker_ua; // Extra while a tone plays
+    uint32_t frame_us; // CPU time to send one frame to the display
+} EnergyCurrents;
+
+typedef struct {
+    uint32_t id; // View id, as in the ViewTableView rows
+    const char* name; // For the report
+    uint32_t dim_after_ms; // Idle time before the backlight dims, 0 to never dim this view
+} EnergyView;
+
+typedef struct {
+    const EnergyView* views;
+    size_t view_count;
+    EnergyBacklight backlight;
+    uint8_t dim_level; // Usually ENERGY_DIM_LEVEL, must not be 0
+    const EnergyCurrents* currents; // NULL for the defaults
+} EnergyConfig;
+
+typedef struct Energy Energy;
+
+/**
+ * @brief      Start profiling and apply the backlight policy.
+ * @param      config  The tables, which must stay valid until energy_free().
+*/
+Energy* energy_alloc(const EnergyConfig* config);
+
+/**
+ * @brief      Log the report, give the backlight back to the firmware and free the profiler.
+*/
+void energy_free(Energy* energy);
+
+/**
+ * @brief      The view showing now is view.  Views not in config.views aren't counted.
+*/
+void energy_view_enter(Energy* energy, uint32_t view);
+
+/**
+ * @brief      Call at the top of a draw callback.
+ * @return     The start time to pass to energy_draw_end().
+*/
+uint32_t energy_draw_begin(Energy* energy);
+
+/**
+ * @brief      Call at the end of a draw callback to count its CPU time.
+*/
+void energy_draw_end(Energy* energy, uint32_t start);
+
+/**
+ * @brief      The speaker started (on) or stopped playing.
+*/
+void energy_speaker(Energy* energy, bool on);
+
+#endif // ENERGY_H
@@ -0,0 +1,302 @@
+#include "entropy.h"
+#include <furi.h>
+#include <furi_hal.h>
+
+#define TAG "Entropy"
+
+#define ENTROPY_POOL_SIZE    64 // Hardware bytes read per batch
+#define ENTROPY_STARTUP_SIZE 1024 // Hardware bytes tested before the first use
+#define ENTROPY_SEED_SIZE    32
+#define ENTROPY_BLOCK_SIZE   64
+#define ENTROPY_BLOCKS       4 // ChaCha20 blocks generated per buffer refill
+#define ENTROPY_BUFFER_SIZE  (ENTROPY_BLOCK_SIZE * ENTROPY_BLOCKS)
+
+// Health test cutoffs for 512 sample windows, assuming at least 6 bits of min-entropy per byte
+// and a false alarm rate of 2^-20.
+#define ENTROPY_RCT_CUTOFF 5
+#define ENTROPY_APT_WINDOW 512
+#define ENTROPY_APT_CUTOFF 25
+
+struct Entropy {
+    FuriMutex* mutex;
+    bool healthy;
+
+    // Health tested hardware bytes, used from the end.
+    uint8_t pool[ENTROPY_POOL_SIZE];
+    size_t pool_left;
+
+    // Continuous health tests.
+    uint8_t rct_value;
+    uint8_t rct_count;
+    uint8_t apt_value;
+    uint16_t apt_count;
+    uint16_t apt_samples;
+
+    // Generator.  The first ENTROPY_SEED_SIZE bytes of every buffer become the next key and are
+    // never handed out, so a later look at memory cannot recover earlier output.
+    uint32_t key[8];
+    uint8_t buffer[ENTROPY_BUFFER_SIZE];
+    size_t buffer_left;
+    size_t since_reseed;
+};
+
+#define ENTROPY_ROTATE(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define ENTROPY_QUARTER_ROUND(a, b, c, d) \
+    a += b;                               \
+    d = ENTROPY_ROTATE(d ^ a, 16);        \
+    c += d;                               \
+    b = ENTROPY_ROTATE(b ^ c, 12);        \
+    a += b;                               \
+    d = ENTROPY_ROTATE(d ^ a, 8);         \
+    c += d;                               \
+    b = ENTROPY_ROTATE(b ^ c, 7);
+
+static uint32_t entropy_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief      One ChaCha20 block with a zero nonce.  Every key is only used for one buffer, so
+ *            the block counter alone keeps the blocks apart.
+*/
+static void entropy_chacha20_block(const uint32_t key[8], uint32_t counter, uint8_t* out) {
+    uint32_t input[16] = {
+        0x61707865,
+        0x3320646e,
+        0x79622d32,
+        0x6b206574,
+        key[0],
+        key[1],
+        key[2],
+        key[3],
+        key[4],
+        key[5],
+        key[6],
+        key[7],
+        counter,
+        0,
+        0,
+        0,
+    };
+    uint32_t x[16];
+    memcpy(x, input, sizeof(x));
+
+    for(int i = 0; i < 10; i++) {
+        ENTROPY_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        ENTROPY_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        ENTROPY_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        ENTROPY_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        ENTROPY_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        ENTROPY_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        ENTROPY_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        ENTROPY_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+
+    for(int i = 0; i < 16; i++) {
+        uint32_t word = x[i] + input[i];
+        out[i * 4] = word;
+        out[i * 4 + 1] = word >> 8;
+        out[i * 4 + 2] = word >> 16;
+        out[i * 4 + 3] = word >> 24;
+    }
+    memset(x, 0, sizeof(x));
+    memset(input, 0, sizeof(input));
+}
+
+/**
+ * @brief      Generate a new buffer and take its first bytes as the next key.
+*/
+static void entropy_refill_buffer(Entropy* entropy) {
+    for(uint32_t i = 0; i < ENTROPY_BLOCKS; i++) {
+        entropy_chacha20_block(entropy->key, i, entropy->buffer + i * ENTROPY_BLOCK_SIZE);
+    }
+    for(int i = 0; i < 8; i++) {
+        entropy->key[i] = entropy_get32(entropy->buffer + i * 4);
+    }
+    memset(entropy->buffer, 0, ENTROPY_SEED_SIZE);
+    entropy->buffer_left = ENTROPY_BUFFER_SIZE - ENTROPY_SEED_SIZE;
+}
+
+static bool entropy_health_sample(Entropy* entropy, uint8_t sample) {
+    bool passed = true;
+
+    // Repetition count: the same value too many times in a row.
+    if(sample == entropy->rct_value) {
+        passed = ++entropy->rct_count < ENTROPY_RCT_CUTOFF;
+    } else {
+        entropy->rct_value = sample;
+        entropy->rct_count = 1;
+    }
+
+    // Adaptive proportion: the first value of a window turning up too often in that window.
+    if(entropy->apt_samples == 0) {
+        entropy->apt_value = sample;
+        entropy->apt_count = 1;
+    } else if(sample == entropy->apt_value) {
+        passed = passed && ++entropy->apt_count < ENTROPY_APT_CUTOFF;
+    }
+    if(++entropy->apt_samples == ENTROPY_APT_WINDOW) {
+        entropy->apt_samples = 0;
+    }
+    return passed;
+}
+
+/**
+ * @brief      Read one batch from the hardware, keeping it only if every byte passes.
+*/
+static bool entropy_refill_pool(Entropy* entropy) {
+    bool passed = true;
+
+    furi_hal_random_fill_buf(entropy->pool, ENTROPY_POOL_SIZE);
+    for(size_t i = 0; i < ENTROPY_POOL_SIZE; i++) {
+        passed = entropy_health_sample(entropy, entropy->pool[i]) && passed;
+    }
+    if(!passed) {
+        FURI_LOG_E(TAG, "Hardware RNG failed a health test");
+        memset(entropy->pool, 0, ENTROPY_POOL_SIZE);
+    }
+    entropy->healthy = passed;
+    entropy->pool_left = passed ? ENTROPY_POOL_SIZE : 0;
+    return passed;
+}
+
+static bool entropy_startup(Entropy* entropy) {
+    bool passed = true;
+
+    entropy->rct_count = 0;
+    entropy->apt_samples = 0;
+    for(size_t i = 0; i < ENTROPY_STARTUP_SIZE / ENTROPY_POOL_SIZE; i++) {
+        passed = entropy_refill_pool(entropy) && passed;
+    }
+    entropy->healthy = passed;
+    return passed;
+}
+
+/**
+ * @brief      Mix fresh pool bytes into the key and throw the current buffer away.
+ * @details    The seed is XORed in rather than replacing the key, so a bad batch can never make
+ *            the state weaker than it was.
+*/
+static bool entropy_reseed(Entropy* entropy) {
+    uint8_t seed[ENTROPY_SEED_SIZE];
+    size_t taken = 0;
+
+    while(taken < ENTROPY_SEED_SIZE) {
+        if(entropy->pool_left == 0 && !entropy_refill_pool(entropy)) {
+            memset(seed, 0, sizeof(seed));
+            return false;
+        }
+        size_t count = MIN(entropy->pool_left, ENTROPY_SEED_SIZE - taken);
+        entropy->pool_left -= count;
+        memcpy(seed + taken, entropy->pool + entropy->pool_left, count);
+        memset(entropy->pool + entropy->pool_left, 0, count);
+        taken += count;
+    }
+
+    for(int i = 0; i < 8; i++) {
+        entropy->key[i] ^= entropy_get32(seed + i * 4);
+    }
+    memset(seed, 0, sizeof(seed));
+    entropy_refill_buffer(entropy);
+    entropy->since_reseed = 0;
+    return true;
+}
+
+static void entropy_generate(Entropy* entropy, uint8_t* data, size_t size) {
+    while(size) {
+        if(entropy->buffer_left == 0) {
+            entropy_refill_buffer(entropy);
+        }
+        size_t count = MIN(entropy->buffer_left, size);
+        uint8_t* source = entropy->buffer + ENTROPY_BUFFER_SIZE - entropy->buffer_left;
+        memcpy(data, source, count);
+        memset(source, 0, count);
+        entropy->buffer_left -= count;
+        entropy->since_reseed += count;
+        data += count;
+        size -= count;
+    }
+}
+
+Entropy* entropy_alloc(void) {
+    Entropy* entropy = malloc(sizeof(Entropy));
+    memset(entropy, 0, sizeof(Entropy));
+    entropy->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+
+    if(!entropy_startup(entropy)) {
+        // Fast output still needs a seed.  Crypto requests rerun the startup test.
+        furi_hal_random_fill_buf(entropy->pool, ENTROPY_POOL_SIZE);
+        entropy->pool_left = ENTROPY_POOL_SIZE;
+    }
+    entropy_reseed(entropy);
+    return entropy;
+}
+
+void entropy_free(Entropy* entropy) {
+    furi_mutex_free(entropy->mutex);
+    memset(entropy, 0, sizeof(Entropy));
+    free(entropy);
+}
+
+static bool
+    entropy_fill_locked(Entropy* entropy, EntropyQuality quality, void* data, size_t size) {
+    if(quality == EntropyQualityCrypto) {
+        if(!entropy->healthy && !entropy_startup(entropy)) {
+            memset(data, 0, size);
+            return false;
+        }
+        if(!entropy_reseed(entropy)) {
+            memset(data, 0, size);
+            return false;
+        }
+    } else if(entropy->since_reseed >= ENTROPY_RESEED_BYTES) {
+        // A failed reseed leaves the old key in place, which is still fine for fast output.
+        entropy->since_reseed = 0;
+        entropy_reseed(entropy);
+    }
+
+    entropy_generate(entropy, data, size);
+    return true;
+}
+
+bool entropy_fill(Entropy* entropy, EntropyQuality quality, void* data, size_t size) {
+    furi_mutex_acquire(entropy->mutex, FuriWaitForever);
+    bool filled = entropy_fill_locked(entropy, quality, data, size);
+    furi_mutex_release(entropy->mutex);
+    return filled;
+}
+
+bool entropy_uniform(Entropy* entropy, EntropyQuality quality, uint32_t bound, uint32_t* value) {
+    uint32_t sample;
+    bool filled = true;
+
+    if(bound < 2) {
+        *value = 0;
+        return true;
+    }
+
+    // Multiply into 64 bits and keep the top half.  Rejecting the few low halves below
+    // 2^32 mod bound leaves exactly the same number of samples for every result.
+    furi_mutex_acquire(entropy->mutex, FuriWaitForever);
+    uint32_t threshold = (0u - bound) % bound;
+    uint64_t product;
+    do {
+        filled = entropy_fill_locked(entropy, quality, &sample, sizeof(sample));
+        product = (uint64_t)sample * bound;
+    } while(filled && (uint32_t)product < threshold);
+    furi_mutex_release(entropy->mutex);
+
+    *value = filled ? (uint32_t)(product >> 32) : 0;
+    return filled;
+}
+
+uint32_t entropy_fast_uniform(Entropy* entropy, uint32_t bound) {
+    uint32_t value;
+    entropy_uniform(entropy, EntropyQualityFast, bound, &value);
+    return value;
+}
+
+bool entropy_is_healthy(Entropy* entropy) {
+    return entropy->healthy;
+}
@@ -0,0 +1,59 @@
+#ifndef ENTROPY_H
+#define ENTROPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Shared random number service.  Hardware entropy is read in batches into a pool and health
+ * tested as it arrives (repetition count and adaptive proportion tests, SP 800-90B style).  The
+ * pool seeds a ChaCha20 generator that hands out the actual bytes, so callers never wait on the
+ * hardware one word at a time.
+ */
+
+typedef enum {
+    // Fresh, health tested hardware entropy is mixed in before every call.  Fails if the health
+    // tests fail.  Use it for keys, salts and nonces.
+    EntropyQualityCrypto,
+    // Generator output, reseeded from the pool every ENTROPY_RESEED_BYTES.  Never fails.  Use it
+    // for games, animations and anything else that just needs to look random.
+    EntropyQualityFast,
+} EntropyQuality;
+
+#define ENTROPY_RESEED_BYTES (64 * 1024)
+
+typedef struct Entropy Entropy;
+
+/**
+ * @brief      Run the startup health test and seed the generator.
+*/
+Entropy* entropy_alloc(void);
+
+void entropy_free(Entropy* entropy);
+
+/**
+ * @brief      Fill data with size random bytes.
+ * @return     false if quality is EntropyQualityCrypto and the hardware failed its health tests,
+ *            in which case data is zeroed.
+*/
+bool entropy_fill(Entropy* entropy, EntropyQuality quality, void* data, size_t size);
+
+/**
+ * @brief      Uniform random number in [0, bound), without the bias of a plain modulo.
+ * @return     false on a health test failure, see entropy_fill().
+*/
+bool entropy_uniform(Entropy* entropy, EntropyQuality quality, uint32_t bound, uint32_t* value);
+
+/**
+ * @brief      entropy_uniform() with EntropyQualityFast, which cannot fail.
+*/
+uint32_t entropy_fast_uniform(Entropy* entropy, uint32_t bound);
+
+/**
+ * @return     false if the last hardware batch failed a health test.  The next crypto request
+ *            reruns the startup test before giving up.
+*/
+bool entropy_is_healthy(Entropy* entropy);
+
+#endif // ENTROPY_H
@@ -0,0 +1,122 @@
+#include "heatshrink.h"
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t bit;
+} HeatshrinkBits;
+
+static bool heatshrink_put(HeatshrinkBits* bits, uint32_t value, uint8_t count) {
+    if(bits->bit + count > bits->size * 8) {
+        return false;
+    }
+    for(uint8_t i = count; i > 0; i--, bits->bit++) {
+        uint8_t mask = 0x80 >> (bits->bit % 8);
+        if((value >> (i - 1)) & 1) {
+            bits->data[bits->bit / 8] |= mask;
+        } else {
+            bits->data[bits->bit / 8] &= ~mask;
+        }
+    }
+    return true;
+}
+
+static bool heatshrink_take(HeatshrinkBits* bits, uint8_t count, uint32_t* value) {
+    if(bits->bit + count > bits->size * 8) {
+        return false;
+    }
+    *value = 0;
+    for(uint8_t i = 0; i < count; i++, bits->bit++) {
+        *value = (*value << 1) | ((bits->data[bits->bit / 8] >> (7 - bits->bit % 8)) & 1);
+    }
+    return true;
+}
+
+size_t heatshrink_encode(
+    const uint8_t* in,
+    size_t in_size,
+    uint8_t* out,
+    size_t out_size,
+    uint8_t window_bits,
+    uint8_t lookahead_bits) {
+    HeatshrinkBits bits = {.data = out, .size = out_size, .bit = 0};
+    size_t window = 1 << window_bits;
+    size_t longest = 1 << lookahead_bits;
+    // A back reference only pays off once it replaces more bits than it costs.
+    size_t shortest = (1 + window_bits + lookahead_bits) / 9 + 1;
+    size_t position = 0;
+
+    while(position < in_size) {
+        size_t best_length = 0;
+        size_t best_distance = 0;
+        for(size_t distance = 1; distance <= window && distance <= position; distance++) {
+            size_t length = 0;
+            while(length < longest && position + length < in_size &&
+                  in[position + length - distance] == in[position + length]) {
+                length++;
+            }
+            if(length > best_length) {
+                best_length = length;
+                best_distance = distance;
+                if(length == longest) {
+                    break;
+                }
+            }
+        }
+
+        if(best_length >= shortest) {
+            if(!heatshrink_put(&bits, 0, 1) ||
+               !heatshrink_put(&bits, best_distance - 1, window_bits) ||
+               !heatshrink_put(&bits, best_length - 1, lookahead_bits)) {
+                return 0;
+            }
+            position += best_length;
+        } else {
+            if(!heatshrink_put(&bits, 1, 1) || !heatshrink_put(&bits, in[position], 8)) {
+                return 0;
+            }
+            position++;
+        }
+    }
+    if(bits.bit % 8) {
+        // Zero the padding so the same input always gives the same bytes.
+        out[bits.bit / 8] &= 0xFF << (8 - bits.bit % 8);
+    }
+    return (bits.bit + 7) / 8;
+}
+
+bool heatshrink_decode(
+    const uint8_t* in,
+    size_t in_size,
+    uint8_t* out,
+    size_t out_size,
+    uint8_t window_bits,
+    uint8_t lookahead_bits) {
+    HeatshrinkBits bits = {.data = (uint8_t*)in, .size = in_size, .bit = 0};
+    size_t position = 0;
+
+    while(position < out_size) {
+        uint32_t value;
+        if(!heatshrink_take(&bits, 1, &value)) {
+            return false;
+        }
+        if(value) {
+            if(!heatshrink_take(&bits, 8, &value)) {
+                return false;
+            }
+            out[position++] = value;
+            continue;
+        }
+
+        uint32_t distance;
+        uint32_t length;
+        if(!heatshrink_take(&bits, window_bits, &distance) ||
+           !heatshrink_take(&bits, lookahead_bits, &length) || distance + 1 > position) {
+            return false;
+        }
+        for(length++; length && position < out_size; length--, position++) {
+            out[position] = out[position - distance - 1];
+        }
+    }
+    return true;
+}
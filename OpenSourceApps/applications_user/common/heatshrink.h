@@ -0,0 +1,42 @@
+#ifndef HEATSHRINK_H
+#define HEATSHRINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Heatshrink (LZSS) compression of whole buffers.  A 1 bit is followed by an 8 bit literal, a 0
+ * bit by a back reference: distance - 1 in window_bits, then length - 1 in lookahead_bits.  It
+ * needs no memory beyond the two buffers, which suits the small blocks the apps deal in.
+ * HostTools/asset_pack.py has the same encoder and decoder in Python.
+ */
+
+#define HEATSHRINK_WINDOW_BITS    8
+#define HEATSHRINK_LOOKAHEAD_BITS 4
+
+/**
+ * @brief      Compress in into out.
+ * @return     The compressed size, or 0 if it would not fit in out_size.
+*/
+size_t heatshrink_encode(
+    const uint8_t* in,
+    size_t in_size,
+    uint8_t* out,
+    size_t out_size,
+    uint8_t window_bits,
+    uint8_t lookahead_bits);
+
+/**
+ * @brief      Decompress exactly out_size bytes.  The output doubles as the window.
+ * @return     false if in is truncated or refers back before the start of the output.
+*/
+bool heatshrink_decode(
+    const uint8_t* in,
+    size_t in_size,
+    uint8_t* out,
+    size_t out_size,
+    uint8_t window_bits,
+    uint8_t lookahead_bits);
+
+#endif // HEATSHRINK_H
@@ -0,0 +1,189 @@
+#include "view_table.h"
+#include <furi.h>
+#include <gui/gui.h>
+#include <gui/modules/submenu.h>
+#include <gui/modules/text_input.h>
+#include <gui/modules/variable_item_list.h>
+#include <gui/modules/widget.h>
+
+#define TAG "ViewTable"
+
+struct ViewTable {
+    const ViewTableConfig* config;
+    void* app;
+    ViewDispatcher* view_dispatcher;
+    uint32_t current; // View showing now, the dispatcher has no way to ask
+};
+
+static void** view_table_slot(ViewTable* table, const ViewTableView* row) {
+    return (void**)((uint8_t*)table->app + row->offset);
+}
+
+static const ViewTableView* view_table_find(ViewTable* table, uint32_t view) {
+    for(size_t i = 0; i < table->config->view_count; i++) {
+        if(table->config->views[i].id == view) {
+            return &table->config->views[i];
+        }
+    }
+    return NULL;
+}
+
+static View* view_table_get_view(ViewTableType type, void* module) {
+    switch(type) {
+    case ViewTableTypeSubmenu:
+        return submenu_get_view(module);
+    case ViewTableTypeWidget:
+        return widget_get_view(module);
+    case ViewTableTypeTextInput:
+        return text_input_get_view(module);
+    case ViewTableTypeVariableItemList:
+        return variable_item_list_get_view(module);
+    case ViewTableTypeView:
+    default:
+        return module;
+    }
+}
+
+/**
+ * @brief      Every view's previous callback.  Returning VIEW_NONE hands Back to
+ *            view_table_navigation_callback(), which knows the current view.
+*/
+static uint32_t view_table_previous_callback(void* _context) {
+    UNUSED(_context);
+    return VIEW_NONE;
+}
+
+/**
+ * @brief      Back was pressed.
+ * @return     false to stop the dispatcher and leave the app.
+*/
+static bool view_table_navigation_callback(void* context) {
+    ViewTable* table = context;
+    const ViewTableView* row = view_table_find(table, table->current);
+    if(!row || row->previous == VIEW_NONE) {
+        return false;
+    }
+    view_table_switch_to(table, row->previous);
+    return true;
+}
+
+static bool view_table_custom_event_callback(void* context, uint32_t event) {
+    ViewTable* table = context;
+    if(!table->config->custom_event) {
+        return false;
+    }
+    return table->config->custom_event(table->app, event);
+}
+
+static void view_table_menu_callback(void* context, uint32_t index) {
+    ViewTable* table = context;
+    const ViewTableMenuItem* item = &table->config->menu[index];
+    if(item->select) {
+        item->select(table->app);
+    } else {
+        view_table_switch_to(table, item->view);
+    }
+}
+
+ViewTable* view_table_alloc(const ViewTableConfig* config, void* app) {
+    ViewTable* table = malloc(sizeof(ViewTable));
+    table->config = config;
+    table->app = app;
+    table->current = VIEW_NONE;
+
+    Gui* gui = furi_record_open(RECORD_GUI);
+    table->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(table->view_dispatcher);
+    view_dispatcher_attach_to_gui(table->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
+    view_dispatcher_set_event_callback_context(table->view_dispatcher, table);
+    view_dispatcher_set_navigation_event_callback(
+        table->view_dispatcher, view_table_navigation_callback);
+    view_dispatcher_set_custom_event_callback(
+        table->view_dispatcher, view_table_custom_event_callback);
+
+    for(size_t i = 0; i < config->view_count; i++) {
+        const ViewTableView* row = &config->views[i];
+        void* module;
+        switch(row->type) {
+        case ViewTableTypeSubmenu:
+            module = submenu_alloc();
+            break;
+        case ViewTableTypeWidget:
+            module = widget_alloc();
+            break;
+        case ViewTableTypeTextInput:
+            module = text_input_alloc();
+            break;
+        case ViewTableTypeVariableItemList:
+            module = variable_item_list_alloc();
+            break;
+        case ViewTableTypeView:
+        default:
+            module = view_alloc();
+            view_set_context(module, app);
+            break;
+        }
+        *view_table_slot(table, row) = module;
+
+        View* view = view_table_get_view(row->type, module);
+        view_set_previous_callback(view, view_table_previous_callback);
+        view_dispatcher_add_view(table->view_dispatcher, row->id, view);
+
+        if(row->id == config->menu_view && row->type == ViewTableTypeSubmenu) {
+            for(size_t item = 0; item < config->menu_count; item++) {
+                submenu_add_item(
+                    module, config->menu[item].label, item, view_table_menu_callback, table);
+            }
+        }
+    }
+
+    view_table_switch_to(table, config->start_view);
+    return table;
+}
+
+void view_table_free(ViewTable* table) {
+    for(size_t i = table->config->view_count; i > 0; i--) {
+        const ViewTableView* row = &table->config->views[i - 1];
+        void** slot = view_table_slot(table, row);
+        view_dispatcher_remove_view(table->view_dispatcher, row->id);
+        switch(row->type) {
+        case ViewTableTypeSubmenu:
+            submenu_free(*slot);
+            break;
+        case ViewTableTypeWidget:
+            widget_free(*slot);
+            break;
+        case ViewTableTypeTextInput:
+            text_input_free(*slot);
+            break;
+        case ViewTableTypeVariableItemList:
+            variable_item_list_free(*slot);
+            break;
+        case ViewTableTypeView:
+        default:
+            view_free(*slot);
+            break;
+        }
+        *slot = NULL;
+    }
+
+    view_dispatcher_free(table->view_dispatcher);
+    furi_record_close(RECORD_GUI);
+    free(table);
+}
+
+ViewDispatcher* view_table_get_view_dispatcher(ViewTable* table) {
+    return table->view_dispatcher;
+}
+
+void view_table_switch_to(ViewTable* table, uint32_t view) {
+    if(!view_table_find(table, view)) {
+        FURI_LOG_E(TAG, "View %lu is not in the table", view);
+        return;
+    }
+    table->current = view;
+    view_dispatcher_switch_to_view(table->view_dispatcher, view);
+    if(table->config->switched) {
+        table->config->switched(table->app, view);
+    }
+}
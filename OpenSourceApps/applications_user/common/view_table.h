@@ -0,0 +1,70 @@
+#ifndef VIEW_TABLE_H
+#define VIEW_TABLE_H
+
+#include <gui/view_dispatcher.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Declarative screens for an app.  The app lists its views and its main menu in const tables,
+ * and view_table_alloc() allocates every module, adds it to a ViewDispatcher, fills the menu and
+ * wires up the Back button, so each app only writes the code that is really its own.
+ *
+ * Back goes to the row's previous view, or leaves the app if that is VIEW_NONE.  For that to
+ * work the table has to know which view is showing, so always switch with view_table_switch_to()
+ * rather than calling view_dispatcher_switch_to_view() directly.
+ */
+
+typedef enum {
+    ViewTableTypeSubmenu, // Submenu*
+    ViewTableTypeWidget, // Widget*
+    ViewTableTypeTextInput, // TextInput*
+    ViewTableTypeVariableItemList, // VariableItemList*
+    ViewTableTypeView, // View*, with its context set to the app
+} ViewTableType;
+
+typedef struct {
+    uint32_t id; // View id in the dispatcher
+    ViewTableType type;
+    size_t offset; // offsetof() the app struct field that gets the allocated module
+    uint32_t previous; // View Back goes to, VIEW_NONE to leave the app
+} ViewTableView;
+
+typedef struct {
+    const char* label;
+    uint32_t view; // View to switch to when select is NULL
+    void (*select)(void* app); // Called instead of switching, for items that need to do more
+} ViewTableMenuItem;
+
+typedef struct {
+    const ViewTableView* views;
+    size_t view_count;
+    uint32_t menu_view; // A ViewTableTypeSubmenu row that gets the menu items
+    const ViewTableMenuItem* menu;
+    size_t menu_count;
+    uint32_t start_view;
+    ViewDispatcherCustomEventCallback custom_event; // Optional, called with the app as context
+    void (*switched)(void* app, uint32_t view); // Optional, after every switch (Back too)
+} ViewTableConfig;
+
+typedef struct ViewTable ViewTable;
+
+/**
+ * @brief      Allocate the dispatcher and every view in config, attach to the GUI and show
+ *            config->start_view.
+ * @param      config  The tables, which must stay valid until view_table_free().
+ * @param      app     The app struct that the offsets in config->views point into.
+*/
+ViewTable* view_table_alloc(const ViewTableConfig* config, void* app);
+
+/**
+ * @brief      Remove and free every view in the table, then the dispatcher.
+*/
+void view_table_free(ViewTable* table);
+
+ViewDispatcher* view_table_get_view_dispatcher(ViewTable* table);
+
+void view_table_switch_to(ViewTable* table, uint32_t view);
+
+#endif // VIEW_TABLE_H